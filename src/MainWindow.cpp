@@ -1,11 +1,19 @@
 #include "MainWindow.h"
 
+#include "editor/ApplyLatencyDialog.h"
+#include "editor/ApplyLatencyMonitor.h"
 #include "editor/QssEditor.h"
+#include "editor/QssRuleSet.h"
 #include "editor/SettingsManager.h"
 #include "editor/StyleManager.h"
 #include "editor/ThemeManager.h"
+#include "editor/ThemeCache.h"
 #include "editor/VariableManager.h"
 #include "editor/VariablePanel.h"
+#include "gallery/GalleryPage.h"
+#include "gallery/PaintCostDialog.h"
+#include "gallery/PaintHeatmapOverlay.h"
+#include "gallery/PaintProfiler.h"
 #include "gallery/WidgetGallery.h"
 #include "plugins/PluginManager.h"
 
@@ -23,6 +31,8 @@
 #include <QStatusBar>
 #include <QTextCursor>
 #include <QTextEdit>
+#include <QLabel>
+#include <QElapsedTimer>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
@@ -36,6 +46,12 @@ MainWindow::MainWindow(QWidget *parent)
     , m_variablePanel(nullptr)
     , m_settingsManager(nullptr)
     , m_pluginManager(nullptr)
+    , m_latencyMonitor(nullptr)
+    , m_latencyDialog(nullptr)
+    , m_latencyLabel(nullptr)
+    , m_paintProfiler(nullptr)
+    , m_paintHeatmap(nullptr)
+    , m_paintCostDialog(nullptr)
     , m_fileMenu(nullptr)
     , m_editMenu(nullptr)
     , m_viewMenu(nullptr)
@@ -48,6 +64,9 @@ MainWindow::MainWindow(QWidget *parent)
     , m_exitAction(nullptr)
     , m_applyAction(nullptr)
     , m_toggleStyleAction(nullptr)
+    , m_galleryScopeAction(nullptr)
+    , m_incrementalRestyleAction(nullptr)
+    , m_deferredRestyleAction(nullptr)
     , m_aboutAction(nullptr)
     , m_aboutQtAction(nullptr)
     , m_themeDarkAction(nullptr)
@@ -64,6 +83,8 @@ MainWindow::MainWindow(QWidget *parent)
     , m_showGalleryAction(nullptr)
     , m_refreshPluginsAction(nullptr)
     , m_pluginDirectoryAction(nullptr)
+    , m_applyLatencyAction(nullptr)
+    , m_paintHeatmapAction(nullptr)
     , m_projectModified(false)
 {
     // Create settings manager first
@@ -96,9 +117,15 @@ MainWindow::MainWindow(QWidget *parent)
     // Create variable manager
     m_variableManager = new VariableManager(this);
 
+    // Create apply pipeline latency monitor
+    m_latencyMonitor = new ApplyLatencyMonitor(this);
+
     // Create plugin manager
     m_pluginManager = new PluginManager(this);
     m_pluginManager->setPluginDirectory(m_settingsManager->pluginDirectory());
+    m_pluginManager->setCacheFile(m_settingsManager->pluginCacheFile());
+    m_pluginManager->setWidgetBudgetMs(m_settingsManager->pluginWidgetBudgetMs());
+    m_pluginManager->setParallelLoadingEnabled(true);
     
     // Create plugin directory if it doesn't exist
     QString pluginDir = m_settingsManager->pluginDirectory();
@@ -108,6 +135,7 @@ MainWindow::MainWindow(QWidget *parent)
     }
     
     m_pluginManager->loadPlugins();
+    m_pluginManager->setWatchingEnabled(true);
 
     // Connect plugin directory changes to trigger rescan
     connect(m_settingsManager, &SettingsManager::pluginDirectoryChanged,
@@ -160,8 +188,17 @@ void MainWindow::setupCentralWidget()
     addDockWidget(Qt::LeftDockWidgetArea, m_variablePanelDock);
 
     // Create Widget Gallery dock widget
-    m_gallery = new WidgetGallery(this);
+    m_gallery = new WidgetGallery(WidgetGallery::PageCreation::OnDemand, this);
     m_gallery->setPluginManager(m_pluginManager);
+    m_gallery->addStressPage();
+    m_styleManager->setScopeWidgets({m_gallery});
+
+    // Pages built while restyles are deferred become style targets of their own
+    connect(m_gallery, &WidgetGallery::pageCreated, this, [this](int, GalleryPage *page) {
+        if (m_styleManager->isDeferredRestyle()) {
+            m_styleManager->addScopeWidget(page);
+        }
+    });
     
     m_galleryDock = new QDockWidget(tr("Widget Gallery"), this);
     m_galleryDock->setObjectName("WidgetGalleryDock");
@@ -276,6 +313,38 @@ void MainWindow::setupEditMenu()
     m_toggleStyleAction->setStatusTip(tr("Toggle between custom QSS and default Qt styling (Ctrl+T)"));
     connect(m_toggleStyleAction, &QAction::triggered, this, &MainWindow::onToggleStyle);
     m_editMenu->addAction(m_toggleStyleAction);
+
+    m_editMenu->addSeparator();
+
+    // Apply Scope action
+    m_galleryScopeAction = new QAction(tr("Apply to &Gallery Only"), this);
+    m_galleryScopeAction->setCheckable(true);
+    m_galleryScopeAction->setChecked(
+        m_styleManager->applyScope() == StyleManager::ApplyScope::Widgets);
+    m_galleryScopeAction->setStatusTip(
+        tr("Restyle only the widget gallery instead of the whole application"));
+    connect(m_galleryScopeAction, &QAction::toggled, this, &MainWindow::onGalleryScopeToggled);
+    m_editMenu->addAction(m_galleryScopeAction);
+
+    // Incremental Restyle action
+    m_incrementalRestyleAction = new QAction(tr("&Incremental Restyle"), this);
+    m_incrementalRestyleAction->setCheckable(true);
+    m_incrementalRestyleAction->setChecked(m_styleManager->isIncrementalRestyle());
+    m_incrementalRestyleAction->setStatusTip(
+        tr("Re-polish only widgets matched by changed rules while editing"));
+    connect(m_incrementalRestyleAction, &QAction::toggled,
+            m_styleManager, &StyleManager::setIncrementalRestyle);
+    m_editMenu->addAction(m_incrementalRestyleAction);
+
+    // Deferred Restyle action
+    m_deferredRestyleAction = new QAction(tr("&Defer Hidden Page Restyle"), this);
+    m_deferredRestyleAction->setCheckable(true);
+    m_deferredRestyleAction->setChecked(m_styleManager->isDeferredRestyle());
+    m_deferredRestyleAction->setStatusTip(
+        tr("In gallery-only scope, restyle hidden gallery pages when they are shown"));
+    connect(m_deferredRestyleAction, &QAction::toggled,
+            this, &MainWindow::onDeferredRestyleToggled);
+    m_editMenu->addAction(m_deferredRestyleAction);
 }
 
 void MainWindow::setupViewMenu()
@@ -335,6 +404,22 @@ void MainWindow::setupViewMenu()
     connect(m_refreshPluginsAction, &QAction::triggered,
             m_pluginManager, &PluginManager::refreshPlugins);
     m_viewMenu->addAction(m_refreshPluginsAction);
+
+    m_viewMenu->addSeparator();
+
+    // Apply Latency action
+    m_applyLatencyAction = new QAction(tr("Apply &Latency..."), this);
+    m_applyLatencyAction->setStatusTip(tr("Show per-stage timings of the style apply pipeline"));
+    connect(m_applyLatencyAction, &QAction::triggered, this, &MainWindow::onShowApplyLatency);
+    m_viewMenu->addAction(m_applyLatencyAction);
+
+    // Paint Cost Heatmap action
+    m_paintHeatmapAction = new QAction(tr("Paint Cost &Heatmap"), this);
+    m_paintHeatmapAction->setCheckable(true);
+    m_paintHeatmapAction->setStatusTip(
+        tr("Time gallery widget paints and tint the gallery by paint cost"));
+    connect(m_paintHeatmapAction, &QAction::toggled, this, &MainWindow::onPaintHeatmapToggled);
+    m_viewMenu->addAction(m_paintHeatmapAction);
 }
 
 void MainWindow::setupHelpMenu()
@@ -425,10 +510,7 @@ void MainWindow::setupConnections()
 {
     // Connect editor apply request to style manager (with variable substitution)
     connect(m_editor, &QssEditor::applyRequested,
-            this, [this](const QString &qss) {
-                QString resolvedQss = m_variableManager->substitute(qss);
-                m_styleManager->applyStyleSheet(resolvedQss);
-            });
+            this, &MainWindow::applyResolvedStyle);
 
     // Connect editor default style request to style manager
     connect(m_editor, &QssEditor::defaultStyleRequested,
@@ -442,9 +524,23 @@ void MainWindow::setupConnections()
     connect(m_styleManager, &StyleManager::styleApplied,
             this, &MainWindow::onStyleApplied);
     connect(m_styleManager, &StyleManager::styleApplied,
-            m_editor, &QssEditor::refreshColorSwatches);
+            this, [this]() {
+                QElapsedTimer timer;
+                timer.start();
+                m_editor->refreshColorSwatches();
+                m_latencyMonitor->record(ApplyLatencyMonitor::SwatchRefresh, timer.nsecsElapsed());
+            });
     connect(m_styleManager, &StyleManager::styleApplied,
-            m_variablePanel, &VariablePanel::refreshColorSwatches);
+            this, [this]() {
+                QElapsedTimer timer;
+                timer.start();
+                m_variablePanel->refreshColorSwatches();
+                m_latencyMonitor->record(ApplyLatencyMonitor::PanelRefresh, timer.nsecsElapsed());
+            });
+    connect(m_styleManager, &StyleManager::styleApplySkipped,
+            this, &MainWindow::onStyleApplySkipped);
+    connect(m_styleManager, &StyleManager::deferredRestyleApplied,
+            this, &MainWindow::onDeferredRestyleApplied);
     connect(m_styleManager, &StyleManager::styleCleared,
             this, &MainWindow::onStyleCleared);
     connect(m_styleManager, &StyleManager::styleCleared,
@@ -482,6 +578,17 @@ void MainWindow::setupConnections()
     // Connect theme manager signals
     connect(m_themeManager, &ThemeManager::themeModeChanged,
             this, [this](ThemeManager::ThemeMode) { onThemeModeChanged(); });
+    connect(m_themeManager, &ThemeManager::themeApplied,
+            this, [this](ThemeManager::ThemeMode effectiveTheme, double durationMs) {
+                const QString themeName = effectiveTheme == ThemeManager::ThemeMode::Dark
+                    ? tr("Dark") : tr("Light");
+                statusBar()->showMessage(tr("%1 theme applied in %2 ms")
+                    .arg(themeName).arg(durationMs, 0, 'f', 1), 2000);
+            });
+    connect(m_themeManager->themeCache(), &ThemeCache::loadError,
+            this, [this](const QString &error) {
+                statusBar()->showMessage(error, 5000);
+            });
 
     // Connect variable manager signals for live preview
     connect(m_variableManager, &VariableManager::variableChanged,
@@ -498,8 +605,15 @@ void MainWindow::setupConnections()
             this, &MainWindow::onProjectSaved);
     connect(m_variableManager, &VariableManager::loadError,
             this, &MainWindow::onProjectLoadError);
+    connect(m_variableManager, &VariableManager::loadWarning,
+            this, &MainWindow::onProjectLoadWarning);
     connect(m_variableManager, &VariableManager::saveError,
             this, &MainWindow::onProjectSaveError);
+    connect(m_variableManager, &VariableManager::cycleDetected,
+            this, [this](const QStringList &cycle) {
+                statusBar()->showMessage(tr("Circular variable reference: %1")
+                    .arg(cycle.join(QLatin1String(" -> "))), 5000);
+            });
 
     // Connect editor content changes for live preview with variables
     connect(m_editor, &QssEditor::contentsChanged,
@@ -517,6 +631,41 @@ void MainWindow::setupConnections()
                 cursor.insertText(reference);
                 m_editor->textEdit()->setFocus();
             });
+
+    // Show apply latency in the status bar
+    m_latencyLabel = new QLabel(this);
+    m_latencyLabel->setToolTip(tr("Apply latency (View > Apply Latency... for details)"));
+    statusBar()->addPermanentWidget(m_latencyLabel);
+    connect(m_latencyMonitor, &ApplyLatencyMonitor::cycleFinished,
+            this, &MainWindow::onApplyCycleFinished);
+}
+
+void MainWindow::applyResolvedStyle(const QString &qssTemplate)
+{
+    m_latencyMonitor->beginApply();
+
+    QElapsedTimer timer;
+    timer.start();
+    QString resolvedQss = m_variableManager->substitute(qssTemplate);
+    m_latencyMonitor->record(ApplyLatencyMonitor::Substitute, timer.nsecsElapsed());
+
+    // styleApplied handlers run inside applyStyleSheet() and record their
+    // own stages, so they are subtracted from the restyle time
+    timer.restart();
+    QVector<int> changedRules;
+    QString previousQss;
+    if (m_variableManager->lastChangedRules(&changedRules, &previousQss)) {
+        // Same template as the last apply: only rules referencing edited
+        // variables differ
+        m_styleManager->applyChangedRules(resolvedQss, previousQss, changedRules);
+    } else {
+        m_styleManager->applyStyleSheet(resolvedQss);
+    }
+    const qint64 handlerNsecs = m_latencyMonitor->cycleNsecs(ApplyLatencyMonitor::SwatchRefresh)
+                              + m_latencyMonitor->cycleNsecs(ApplyLatencyMonitor::PanelRefresh);
+    m_latencyMonitor->record(ApplyLatencyMonitor::Restyle, timer.nsecsElapsed() - handlerNsecs);
+
+    m_latencyMonitor->endApply();
 }
 
 void MainWindow::updateWindowTitle()
@@ -738,9 +887,76 @@ void MainWindow::onLoadTemplate(const QString &templateName)
 
 void MainWindow::onStyleApplied()
 {
-    // Style was successfully applied
-    // Could show status bar message here
-    statusBar()->showMessage(tr("Style applied"), 2000);
+    // Report the cost of this apply next to the last apply in the other
+    // scope so the two can be compared while editing
+    const bool galleryOnly =
+        m_styleManager->applyScope() == StyleManager::ApplyScope::Widgets;
+    const double galleryMs =
+        m_styleManager->lastApplyDurationMs(StyleManager::ApplyScope::Widgets);
+    const double applicationMs =
+        m_styleManager->lastApplyDurationMs(StyleManager::ApplyScope::Application);
+
+    QString message = tr("Style applied to %1 in %2 ms")
+        .arg(galleryOnly ? tr("gallery") : tr("application"))
+        .arg(galleryOnly ? galleryMs : applicationMs, 0, 'f', 1);
+
+    message += tr(", %n widget(s) restyled", nullptr,
+                  m_styleManager->lastRestyledWidgetCount());
+    const int staleCount = m_styleManager->staleScopeWidgetCount();
+    if (staleCount > 0) {
+        message += tr(", %n hidden page(s) deferred", nullptr, staleCount);
+    }
+
+    const double otherMs = galleryOnly ? applicationMs : galleryMs;
+    if (otherMs >= 0.0) {
+        message += tr(" (last %1 apply: %2 ms)")
+            .arg(galleryOnly ? tr("application") : tr("gallery"))
+            .arg(otherMs, 0, 'f', 1);
+    }
+
+    statusBar()->showMessage(message, 2000);
+
+    // Costs measured under the previous sheet no longer apply
+    if (m_paintHeatmap) {
+        m_paintProfiler->reset();
+        m_paintCostDialog->setRules(QssRuleSet::parse(m_styleManager->currentStyleSheet()));
+    }
+}
+
+void MainWindow::onStyleApplySkipped()
+{
+    statusBar()->showMessage(tr("Style unchanged, restyle skipped (%1 skipped so far)")
+                                 .arg(m_styleManager->skippedApplyCount()), 2000);
+}
+
+void MainWindow::onGalleryScopeToggled(bool galleryOnly)
+{
+    m_styleManager->setApplyScope(galleryOnly ? StyleManager::ApplyScope::Widgets
+                                              : StyleManager::ApplyScope::Application);
+
+    // The editor and variable panel may have just gained or lost the sheet
+    m_editor->refreshColorSwatches();
+    m_variablePanel->refreshColorSwatches();
+}
+
+void MainWindow::onDeferredRestyleToggled(bool deferred)
+{
+    // A sheet on the gallery itself would re-polish every page, so while
+    // deferring it is installed on the gallery's parts separately
+    if (deferred) {
+        m_styleManager->setDeferredRestyle(true);
+        m_styleManager->setScopeWidgets(m_gallery->styleTargets());
+    } else {
+        m_styleManager->setScopeWidgets({m_gallery});
+        m_styleManager->setDeferredRestyle(false);
+    }
+}
+
+void MainWindow::onDeferredRestyleApplied(QWidget *widget, int widgetCount, double durationMs)
+{
+    Q_UNUSED(widget);
+    statusBar()->showMessage(tr("Hidden page restyled on show: %n widget(s) in %1 ms", nullptr,
+                                widgetCount).arg(durationMs, 0, 'f', 1), 2000);
 }
 
 void MainWindow::onStyleCleared()
@@ -828,10 +1044,49 @@ void MainWindow::onRegenerateStyle()
 {
     // Only regenerate if custom style mode is active
     if (m_editor && m_editor->isCustomStyleActive()) {
-        QString qssTemplate = m_editor->styleSheet();
-        QString resolvedQss = m_variableManager->substitute(qssTemplate);
-        m_styleManager->applyStyleSheet(resolvedQss);
+        applyResolvedStyle(m_editor->styleSheet());
+    }
+}
+
+void MainWindow::onApplyCycleFinished()
+{
+    m_latencyLabel->setText(tr("Apply: %1 ms (p95 %2 ms)")
+        .arg(m_latencyMonitor->lastMs(ApplyLatencyMonitor::Total), 0, 'f', 1)
+        .arg(m_latencyMonitor->percentileMs(ApplyLatencyMonitor::Total, 95.0), 0, 'f', 1));
+}
+
+void MainWindow::onShowApplyLatency()
+{
+    if (!m_latencyDialog) {
+        m_latencyDialog = new ApplyLatencyDialog(m_latencyMonitor, this);
     }
+    m_latencyDialog->refresh();
+    m_latencyDialog->show();
+    m_latencyDialog->raise();
+    m_latencyDialog->activateWindow();
+}
+
+void MainWindow::onPaintHeatmapToggled(bool enabled)
+{
+    if (!enabled) {
+        delete m_paintHeatmap;
+        m_paintHeatmap = nullptr;
+        m_paintProfiler->detach();
+        m_paintCostDialog->hide();
+        return;
+    }
+
+    if (!m_paintProfiler) {
+        m_paintProfiler = new PaintProfiler(this);
+        m_paintCostDialog = new PaintCostDialog(m_paintProfiler, this);
+    }
+    m_paintProfiler->attach(m_gallery);
+    m_paintHeatmap = new PaintHeatmapOverlay(m_paintProfiler, m_gallery);
+    m_paintHeatmap->show();
+
+    m_paintCostDialog->setRules(QssRuleSet::parse(m_styleManager->currentStyleSheet()));
+    m_paintCostDialog->show();
+    m_paintCostDialog->raise();
 }
 
 void MainWindow::onVariableChanged(const QString &name, const QString &value)
@@ -990,6 +1245,15 @@ void MainWindow::onProjectLoadError(const QString &error)
     );
 }
 
+void MainWindow::onProjectLoadWarning(const QString &warning)
+{
+    QMessageBox::warning(
+        this,
+        tr("Project Load Warning"),
+        tr("The project was loaded with problems:\n%1").arg(warning)
+    );
+}
+
 void MainWindow::onProjectSaveError(const QString &error)
 {
     QMessageBox::critical(
@@ -1118,3 +1382,8 @@ PluginManager* MainWindow::pluginManager() const
 {
     return m_pluginManager;
 }
+
+ApplyLatencyMonitor* MainWindow::latencyMonitor() const
+{
+    return m_latencyMonitor;
+}
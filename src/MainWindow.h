@@ -17,6 +17,12 @@ class VariableManager;
 class VariablePanel;
 class SettingsManager;
 class PluginManager;
+class ApplyLatencyMonitor;
+class ApplyLatencyDialog;
+class PaintProfiler;
+class PaintHeatmapOverlay;
+class PaintCostDialog;
+class QLabel;
 
 /**
  * @brief Main application window for QtVanity.
@@ -93,6 +99,12 @@ public:
      */
     PluginManager* pluginManager() const;
 
+    /**
+     * @brief Returns the apply latency monitor.
+     * @return Pointer to the ApplyLatencyMonitor.
+     */
+    ApplyLatencyMonitor* latencyMonitor() const;
+
 protected:
     /**
      * @brief Handles close event with unsaved changes check.
@@ -107,6 +119,10 @@ private slots:
     void onToggleStyle();
     void onLoadTemplate(const QString &templateName);
     void onStyleApplied();
+    void onStyleApplySkipped();
+    void onGalleryScopeToggled(bool galleryOnly);
+    void onDeferredRestyleToggled(bool deferred);
+    void onDeferredRestyleApplied(QWidget *widget, int widgetCount, double durationMs);
     void onStyleCleared();
     void onStyleModeChanged(bool customActive);
     void onLoadError(const QString &error);
@@ -119,6 +135,9 @@ private slots:
     void onThemeSystem();
     void onThemeModeChanged();
     void onRegenerateStyle();
+    void onApplyCycleFinished();
+    void onShowApplyLatency();
+    void onPaintHeatmapToggled(bool enabled);
     void onVariableChanged(const QString &name, const QString &value);
     void onVariableRemoved(const QString &name);
     void onVariablesCleared();
@@ -132,6 +151,7 @@ private slots:
     void onProjectLoaded();
     void onProjectSaved();
     void onProjectLoadError(const QString &error);
+    void onProjectLoadWarning(const QString &warning);
     void onProjectSaveError(const QString &error);
     
     // Recent projects
@@ -152,6 +172,7 @@ private:
     void setupRecentProjectsMenu();
     void updateRecentProjectsMenu();
     void setupConnections();
+    void applyResolvedStyle(const QString &qssTemplate);
     void updateWindowTitle();
     void updateThemeActions();
     bool maybeSave();
@@ -169,6 +190,12 @@ private:
     VariablePanel *m_variablePanel;
     SettingsManager *m_settingsManager;
     PluginManager *m_pluginManager;
+    ApplyLatencyMonitor *m_latencyMonitor;
+    ApplyLatencyDialog *m_latencyDialog;
+    QLabel *m_latencyLabel;
+    PaintProfiler *m_paintProfiler;
+    PaintHeatmapOverlay *m_paintHeatmap;
+    PaintCostDialog *m_paintCostDialog;
 
     // Menus
     QMenu *m_fileMenu;
@@ -185,6 +212,9 @@ private:
     QAction *m_exitAction;
     QAction *m_applyAction;
     QAction *m_toggleStyleAction;
+    QAction *m_galleryScopeAction;
+    QAction *m_incrementalRestyleAction;
+    QAction *m_deferredRestyleAction;
     QAction *m_aboutAction;
     QAction *m_aboutQtAction;
     QAction *m_themeDarkAction;
@@ -207,6 +237,10 @@ private:
     // Plugin actions
     QAction *m_refreshPluginsAction;
     QAction *m_pluginDirectoryAction;
+    
+    // Diagnostics actions
+    QAction *m_applyLatencyAction;
+    QAction *m_paintHeatmapAction;
 
     QString m_currentFilePath;
     QString m_currentProjectPath;
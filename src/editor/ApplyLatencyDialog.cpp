@@ -0,0 +1,114 @@
+#include "ApplyLatencyDialog.h"
+#include "ApplyLatencyMonitor.h"
+
+#include <QTableWidget>
+#include <QHeaderView>
+#include <QVBoxLayout>
+#include <QDialogButtonBox>
+#include <QPushButton>
+#include <QLabel>
+
+namespace {
+
+QString formatMs(double ms)
+{
+    return ms < 0.0 ? QStringLiteral("-") : QString::number(ms, 'f', 2);
+}
+
+} // namespace
+
+ApplyLatencyDialog::ApplyLatencyDialog(ApplyLatencyMonitor *monitor, QWidget *parent)
+    : QDialog(parent)
+    , m_monitor(monitor)
+    , m_summaryTable(nullptr)
+    , m_histogramTable(nullptr)
+{
+    setupUi();
+    refresh();
+
+    connect(m_monitor, &ApplyLatencyMonitor::cycleFinished,
+            this, &ApplyLatencyDialog::refresh);
+}
+
+void ApplyLatencyDialog::setupUi()
+{
+    setWindowTitle(tr("Apply Latency"));
+    resize(720, 420);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+
+    QLabel *summaryLabel = new QLabel(
+        tr("Timings in milliseconds over the last %1 applies:")
+            .arg(ApplyLatencyMonitor::WINDOW_SIZE), this);
+    layout->addWidget(summaryLabel);
+
+    const QStringList summaryHeaders = {
+        tr("Last"), tr("Median"), tr("p95"), tr("Max"), tr("Samples")
+    };
+    m_summaryTable = new QTableWidget(ApplyLatencyMonitor::StageCount,
+                                      summaryHeaders.size(), this);
+    m_summaryTable->setHorizontalHeaderLabels(summaryHeaders);
+    m_summaryTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_summaryTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    layout->addWidget(m_summaryTable);
+
+    QLabel *histogramLabel = new QLabel(tr("Sample distribution (upper bound in ms):"), this);
+    layout->addWidget(histogramLabel);
+
+    QStringList bucketHeaders;
+    for (double bound : ApplyLatencyMonitor::bucketUpperBoundsMs()) {
+        bucketHeaders << QStringLiteral("<= %1").arg(bound);
+    }
+    bucketHeaders << QStringLiteral("> %1").arg(ApplyLatencyMonitor::bucketUpperBoundsMs().last());
+
+    m_histogramTable = new QTableWidget(ApplyLatencyMonitor::StageCount,
+                                        bucketHeaders.size(), this);
+    m_histogramTable->setHorizontalHeaderLabels(bucketHeaders);
+    m_histogramTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_histogramTable->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    layout->addWidget(m_histogramTable);
+
+    QStringList stageNames;
+    for (int stage = 0; stage < ApplyLatencyMonitor::StageCount; ++stage) {
+        stageNames << ApplyLatencyMonitor::stageName(static_cast<ApplyLatencyMonitor::Stage>(stage));
+    }
+    m_summaryTable->setVerticalHeaderLabels(stageNames);
+    m_histogramTable->setVerticalHeaderLabels(stageNames);
+
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    QPushButton *resetButton = buttons->addButton(tr("Reset"), QDialogButtonBox::ResetRole);
+    connect(resetButton, &QPushButton::clicked, this, [this]() {
+        m_monitor->reset();
+        refresh();
+    });
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    layout->addWidget(buttons);
+}
+
+void ApplyLatencyDialog::refresh()
+{
+    for (int row = 0; row < ApplyLatencyMonitor::StageCount; ++row) {
+        const auto stage = static_cast<ApplyLatencyMonitor::Stage>(row);
+
+        const QStringList values = {
+            formatMs(m_monitor->lastMs(stage)),
+            formatMs(m_monitor->percentileMs(stage, 50.0)),
+            formatMs(m_monitor->percentileMs(stage, 95.0)),
+            formatMs(m_monitor->maxMs(stage)),
+            QString::number(m_monitor->sampleCount(stage))
+        };
+        for (int column = 0; column < values.size(); ++column) {
+            QTableWidgetItem *item = new QTableWidgetItem(values.at(column));
+            item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+            m_summaryTable->setItem(row, column, item);
+        }
+
+        const QVector<int> counts = m_monitor->histogram(stage);
+        for (int column = 0; column < counts.size(); ++column) {
+            QTableWidgetItem *item = new QTableWidgetItem(
+                counts.at(column) > 0 ? QString::number(counts.at(column)) : QString());
+            item->setTextAlignment(Qt::AlignCenter);
+            m_histogramTable->setItem(row, column, item);
+        }
+    }
+}
@@ -0,0 +1,42 @@
+#ifndef APPLYLATENCYDIALOG_H
+#define APPLYLATENCYDIALOG_H
+
+#include <QDialog>
+
+class QTableWidget;
+class ApplyLatencyMonitor;
+
+/**
+ * @brief Dialog showing apply-pipeline latency statistics.
+ *
+ * Presents, for every stage recorded by an ApplyLatencyMonitor, the last
+ * sample, median, p95 and maximum over the sample window, along with the
+ * bucketed histogram of the window. The tables refresh after each apply.
+ */
+class ApplyLatencyDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Constructs an ApplyLatencyDialog.
+     * @param monitor The monitor to display (must outlive the dialog).
+     * @param parent The parent widget.
+     */
+    explicit ApplyLatencyDialog(ApplyLatencyMonitor *monitor, QWidget *parent = nullptr);
+
+public slots:
+    /**
+     * @brief Refreshes the tables from the monitor.
+     */
+    void refresh();
+
+private:
+    void setupUi();
+
+    ApplyLatencyMonitor *m_monitor;
+    QTableWidget *m_summaryTable;
+    QTableWidget *m_histogramTable;
+};
+
+#endif // APPLYLATENCYDIALOG_H
@@ -0,0 +1,158 @@
+#include "ApplyLatencyMonitor.h"
+
+#include <QtMath>
+
+#include <algorithm>
+
+ApplyLatencyMonitor::ApplyLatencyMonitor(QObject *parent)
+    : QObject(parent)
+    , m_inApply(false)
+{
+}
+
+void ApplyLatencyMonitor::beginApply()
+{
+    if (m_inApply) {
+        return;
+    }
+
+    m_inApply = true;
+    for (StageSamples &stage : m_stages) {
+        stage.inCycle = 0;
+    }
+    m_cycleTimer.start();
+}
+
+void ApplyLatencyMonitor::endApply()
+{
+    if (!m_inApply) {
+        return;
+    }
+
+    record(Total, m_cycleTimer.nsecsElapsed());
+    m_inApply = false;
+    emit cycleFinished();
+}
+
+bool ApplyLatencyMonitor::isInApply() const
+{
+    return m_inApply;
+}
+
+void ApplyLatencyMonitor::record(Stage stage, qint64 nsecs)
+{
+    if (stage < 0 || stage >= StageCount) {
+        return;
+    }
+
+    StageSamples &samples = m_stages[stage];
+    if (samples.samples.size() < WINDOW_SIZE) {
+        samples.samples.append(nsecs);
+    } else {
+        samples.samples[samples.next] = nsecs;
+    }
+    samples.next = (samples.next + 1) % WINDOW_SIZE;
+    samples.last = nsecs;
+
+    if (m_inApply) {
+        samples.inCycle += nsecs;
+    }
+}
+
+qint64 ApplyLatencyMonitor::cycleNsecs(Stage stage) const
+{
+    if (!m_inApply || stage < 0 || stage >= StageCount) {
+        return 0;
+    }
+    return m_stages[stage].inCycle;
+}
+
+double ApplyLatencyMonitor::lastMs(Stage stage) const
+{
+    if (stage < 0 || stage >= StageCount || m_stages[stage].last < 0) {
+        return -1.0;
+    }
+    return m_stages[stage].last / 1000000.0;
+}
+
+double ApplyLatencyMonitor::percentileMs(Stage stage, double percentile) const
+{
+    QVector<qint64> samples = window(stage);
+    if (samples.isEmpty()) {
+        return -1.0;
+    }
+
+    // Nearest-rank percentile
+    const double clamped = qBound(0.0, percentile, 100.0);
+    int rank = qCeil(clamped / 100.0 * samples.size()) - 1;
+    rank = qBound(0, rank, samples.size() - 1);
+    std::nth_element(samples.begin(), samples.begin() + rank, samples.end());
+    return samples.at(rank) / 1000000.0;
+}
+
+double ApplyLatencyMonitor::maxMs(Stage stage) const
+{
+    const QVector<qint64> samples = window(stage);
+    if (samples.isEmpty()) {
+        return -1.0;
+    }
+    return *std::max_element(samples.constBegin(), samples.constEnd()) / 1000000.0;
+}
+
+int ApplyLatencyMonitor::sampleCount(Stage stage) const
+{
+    return window(stage).size();
+}
+
+QVector<int> ApplyLatencyMonitor::histogram(Stage stage) const
+{
+    const QVector<double> bounds = bucketUpperBoundsMs();
+    QVector<int> counts(bounds.size() + 1, 0);
+
+    for (qint64 nsecs : window(stage)) {
+        const double ms = nsecs / 1000000.0;
+        const auto bucket = std::lower_bound(bounds.constBegin(), bounds.constEnd(), ms);
+        ++counts[int(bucket - bounds.constBegin())];
+    }
+    return counts;
+}
+
+QVector<double> ApplyLatencyMonitor::bucketUpperBoundsMs()
+{
+    return {0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0, 25.0, 50.0, 100.0, 250.0, 500.0, 1000.0};
+}
+
+QString ApplyLatencyMonitor::stageName(Stage stage)
+{
+    switch (stage) {
+    case Substitute:
+        return tr("Variable substitution");
+    case Restyle:
+        return tr("Restyle");
+    case SwatchRefresh:
+        return tr("Editor swatch refresh");
+    case PanelRefresh:
+        return tr("Variable panel refresh");
+    case Total:
+        return tr("Total");
+    case StageCount:
+        break;
+    }
+    return QString();
+}
+
+void ApplyLatencyMonitor::reset()
+{
+    for (StageSamples &stage : m_stages) {
+        stage = StageSamples();
+    }
+    m_inApply = false;
+}
+
+QVector<qint64> ApplyLatencyMonitor::window(Stage stage) const
+{
+    if (stage < 0 || stage >= StageCount) {
+        return QVector<qint64>();
+    }
+    return m_stages[stage].samples;
+}
@@ -0,0 +1,154 @@
+#ifndef APPLYLATENCYMONITOR_H
+#define APPLYLATENCYMONITOR_H
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <QElapsedTimer>
+
+/**
+ * @brief Records per-stage timings of the apply pipeline.
+ *
+ * An apply cycle runs from the start of an apply to the return of the last
+ * styleApplied handler. The editor applies on every edit while the custom
+ * style is active, so the time from an edit to its apply is not a stage:
+ * - Substitute: VariableManager::substitute()
+ * - Restyle: StyleManager::applyStyleSheet() without its signal handlers
+ * - SwatchRefresh: QssEditor::refreshColorSwatches()
+ * - PanelRefresh: VariablePanel::refreshColorSwatches()
+ * - Total: the whole cycle
+ *
+ * Each stage keeps the last WINDOW_SIZE samples in a ring buffer from which
+ * percentiles and a bucketed histogram are computed on demand.
+ */
+class ApplyLatencyMonitor : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Pipeline stages, in execution order.
+     */
+    enum Stage {
+        Substitute,
+        Restyle,
+        SwatchRefresh,
+        PanelRefresh,
+        Total,
+        StageCount
+    };
+    Q_ENUM(Stage)
+
+    /**
+     * @brief Number of samples kept per stage.
+     */
+    static constexpr int WINDOW_SIZE = 256;
+
+    /**
+     * @brief Constructs an ApplyLatencyMonitor.
+     * @param parent The parent QObject.
+     */
+    explicit ApplyLatencyMonitor(QObject *parent = nullptr);
+
+    /**
+     * @brief Starts an apply cycle.
+     *
+     * Nested calls are ignored.
+     */
+    void beginApply();
+
+    /**
+     * @brief Ends the apply cycle, records Total and emits cycleFinished().
+     */
+    void endApply();
+
+    /**
+     * @brief Returns whether an apply cycle is in progress.
+     */
+    bool isInApply() const;
+
+    /**
+     * @brief Records a sample for a stage.
+     * @param stage The stage that was measured.
+     * @param nsecs The duration in nanoseconds.
+     */
+    void record(Stage stage, qint64 nsecs);
+
+    /**
+     * @brief Returns the time recorded for a stage during the current cycle.
+     * @param stage The stage to query.
+     * @return Nanoseconds recorded since beginApply(), or 0 outside a cycle.
+     */
+    qint64 cycleNsecs(Stage stage) const;
+
+    /**
+     * @brief Returns the most recent sample of a stage.
+     * @return The duration in milliseconds, or -1 if there are no samples.
+     */
+    double lastMs(Stage stage) const;
+
+    /**
+     * @brief Returns a percentile over the sample window of a stage.
+     * @param stage The stage to query.
+     * @param percentile The percentile in the range 0-100 (nearest rank).
+     * @return The duration in milliseconds, or -1 if there are no samples.
+     */
+    double percentileMs(Stage stage, double percentile) const;
+
+    /**
+     * @brief Returns the largest sample in the window of a stage.
+     * @return The duration in milliseconds, or -1 if there are no samples.
+     */
+    double maxMs(Stage stage) const;
+
+    /**
+     * @brief Returns the number of samples in the window of a stage.
+     */
+    int sampleCount(Stage stage) const;
+
+    /**
+     * @brief Returns the window of a stage bucketed by bucketUpperBoundsMs().
+     * @return One count per bucket; the last bucket is unbounded.
+     */
+    QVector<int> histogram(Stage stage) const;
+
+    /**
+     * @brief Returns the inclusive upper bounds of the histogram buckets.
+     *
+     * histogram() has one more bucket than this list for larger samples.
+     */
+    static QVector<double> bucketUpperBoundsMs();
+
+    /**
+     * @brief Returns a human-readable stage name.
+     */
+    static QString stageName(Stage stage);
+
+    /**
+     * @brief Discards all samples.
+     */
+    void reset();
+
+signals:
+    /**
+     * @brief Emitted when an apply cycle finishes.
+     */
+    void cycleFinished();
+
+private:
+    QVector<qint64> window(Stage stage) const;
+
+    struct StageSamples
+    {
+        QVector<qint64> samples;
+        int next = 0;
+        qint64 last = -1;
+        qint64 inCycle = 0;
+    };
+
+    StageSamples m_stages[StageCount];
+    QElapsedTimer m_cycleTimer;
+    bool m_inApply;
+};
+
+#endif // APPLYLATENCYMONITOR_H
@@ -8,6 +8,11 @@
 #include <QMouseEvent>
 #include <QColorDialog>
 #include <QToolTip>
+#include <QTimer>
+#include <QTextLayout>
+#include <QAbstractTextDocumentLayout>
+
+#include <algorithm>
 
 ColorSwatchOverlay::ColorSwatchOverlay(QTextEdit *editor, QWidget *parent)
     : QWidget(parent ? parent : editor->viewport())
@@ -15,8 +20,16 @@ ColorSwatchOverlay::ColorSwatchOverlay(QTextEdit *editor, QWidget *parent)
     , m_swatchSize(12)
     , m_enabled(true)
     , m_hoveredSwatch(nullptr)
-    , m_editingSwatch(nullptr)
     , m_colorDialog(nullptr)
+    , m_documentLength(0)
+    , m_blockCount(0)
+    , m_parsedBlockCount(0)
+    , m_colorsStale(false)
+    , m_positionsScheduled(false)
+    , m_visibleBegin(0)
+    , m_visibleEnd(0)
+    , m_geometryGeneration(0)
+    , m_layoutRectCount(0)
 {
     // Match hex colors: #RGB, #RRGGBB, #AARRGGBB
     m_colorRegex = QRegularExpression(QStringLiteral("#([0-9a-fA-F]{3}|[0-9a-fA-F]{6}|[0-9a-fA-F]{8})\\b"));
@@ -30,12 +43,20 @@ ColorSwatchOverlay::ColorSwatchOverlay(QTextEdit *editor, QWidget *parent)
     }
     
     // Connect to editor signals
-    connect(m_editor->document(), &QTextDocument::contentsChanged,
-            this, &ColorSwatchOverlay::onTextChanged);
+    connect(m_editor->document(), &QTextDocument::contentsChange,
+            this, &ColorSwatchOverlay::onContentsChange);
     connect(m_editor->verticalScrollBar(), &QScrollBar::valueChanged,
             this, &ColorSwatchOverlay::onScrolled);
     connect(m_editor->horizontalScrollBar(), &QScrollBar::valueChanged,
             this, &ColorSwatchOverlay::onScrolled);
+
+    // Cached geometry is dropped whenever the layout may have moved lines
+    connect(m_editor->document()->documentLayout(), &QAbstractTextDocumentLayout::documentSizeChanged,
+            this, [this]() {
+                invalidateGeometry();
+                scheduleSwatchPositions();
+            });
+    m_editor->viewport()->installEventFilter(this);
     
     // Initial parse
     updateColors();
@@ -50,6 +71,7 @@ void ColorSwatchOverlay::setSwatchSize(int size)
 {
     if (m_swatchSize != size) {
         m_swatchSize = qMax(8, qMin(24, size));
+        invalidateGeometry();
         updateSwatchPositions();
         update();
     }
@@ -61,91 +83,260 @@ void ColorSwatchOverlay::setEnabled(bool enabled)
         m_enabled = enabled;
         setVisible(enabled);
         if (enabled) {
-            updateColors();
+            if (m_colorsStale) {
+                updateColors();
+            } else {
+                refreshSwatchPositions();
+            }
         }
     }
 }
 
 void ColorSwatchOverlay::updateColors()
 {
-    if (!m_enabled) return;
+    if (!m_enabled) {
+        m_colorsStale = true;
+        return;
+    }
     
     parseColors();
     updateSwatchPositions();
     update();
 }
 
+void ColorSwatchOverlay::refreshSwatchPositions()
+{
+    if (!m_enabled) return;
+
+    invalidateGeometry();
+    updateSwatchPositions();
+    update();
+}
+
+void ColorSwatchOverlay::invalidateGeometry()
+{
+    ++m_geometryGeneration;
+}
+
 void ColorSwatchOverlay::parseColors()
 {
+    m_hoveredSwatch = nullptr;
     m_colors.clear();
+    m_visibleBegin = m_visibleEnd = 0;
+    m_colorsStale = false;
     
     if (!m_editor || !m_editor->document()) return;
     
     QTextDocument *doc = m_editor->document();
-    QTextBlock block = doc->begin();
+    m_documentLength = doc->characterCount();
+    m_blockCount = doc->blockCount();
+
+    for (QTextBlock block = doc->begin(); block.isValid(); block = block.next()) {
+        parseBlock(block, m_colors);
+    }
+}
+
+void ColorSwatchOverlay::parseBlock(const QTextBlock &block, QVector<ColorInfo> &colors)
+{
+    ++m_parsedBlockCount;
+
+    const QString text = block.text();
+    QRegularExpressionMatchIterator it = m_colorRegex.globalMatch(text);
     
-    while (block.isValid()) {
-        QString text = block.text();
-        QRegularExpressionMatchIterator it = m_colorRegex.globalMatch(text);
+    while (it.hasNext()) {
+        QRegularExpressionMatch match = it.next();
+        ColorInfo info;
+        info.line = block.blockNumber();
+        info.startPos = block.position() + match.capturedStart();
+        info.length = match.capturedLength();
+        info.colorCode = match.captured();
+        info.color = QColor(info.colorCode);
         
-        while (it.hasNext()) {
-            QRegularExpressionMatch match = it.next();
-            ColorInfo info;
-            info.line = block.blockNumber();
-            info.startPos = block.position() + match.capturedStart();
-            info.length = match.capturedLength();
-            info.colorCode = match.captured();
-            info.color = QColor(info.colorCode);
-            
-            if (info.color.isValid()) {
-                m_colors.append(info);
-            }
+        if (info.color.isValid()) {
+            colors.append(info);
         }
-        
-        block = block.next();
     }
 }
 
+void ColorSwatchOverlay::onContentsChange(int position, int charsRemoved, int charsAdded)
+{
+    Q_UNUSED(charsRemoved);
+
+    QTextDocument *doc = m_editor->document();
+    const int length = doc->characterCount();
+    const int blockCount = doc->blockCount();
+
+    // The length delta is taken from the document itself; charsRemoved is
+    // unreliable when the whole document is replaced
+    const int delta = length - m_documentLength;
+    const int blockDelta = blockCount - m_blockCount;
+    m_documentLength = length;
+    m_blockCount = blockCount;
+
+    if (!m_enabled || m_colorsStale) {
+        m_colorsStale = true;
+        return;
+    }
+
+    const QTextBlock first = doc->findBlock(qBound(0, position, length - 1));
+    const QTextBlock last = doc->findBlock(qBound(0, position + charsAdded, length - 1));
+    if (!first.isValid() || !last.isValid()) {
+        updateColors();
+        return;
+    }
+
+    // Blocks [first, last] hold the new text; in old offsets they spanned
+    // [from, oldEnd)
+    const int from = first.position();
+    const int newEnd = last.position() + last.length();
+    const int oldEnd = newEnd - delta;
+
+    const auto byStart = [](const ColorInfo &info, int pos) { return info.startPos < pos; };
+    const auto begin = std::lower_bound(m_colors.begin(), m_colors.end(), from, byStart);
+    const auto end = std::lower_bound(begin, m_colors.end(), oldEnd, byStart);
+    const int beginIndex = int(begin - m_colors.begin());
+    const int endIndex = int(end - m_colors.begin());
+
+    for (int i = endIndex; i < m_colors.size(); ++i) {
+        m_colors[i].startPos += delta;
+        m_colors[i].line += blockDelta;
+    }
+
+    QVector<ColorInfo> parsed;
+    for (QTextBlock block = first; block.isValid(); block = block.next()) {
+        parseBlock(block, parsed);
+        if (block == last) {
+            break;
+        }
+    }
+
+    // Splice the re-parsed codes in place of the old ones; the visible
+    // range is recomputed before the next paint
+    m_hoveredSwatch = nullptr;
+    m_visibleBegin = m_visibleEnd = 0;
+    const int common = qMin(parsed.size(), endIndex - beginIndex);
+    for (int i = 0; i < common; ++i) {
+        m_colors[beginIndex + i] = parsed.at(i);
+    }
+    if (parsed.size() > common) {
+        m_colors.insert(beginIndex + common, parsed.size() - common, ColorInfo());
+        for (int i = common; i < parsed.size(); ++i) {
+            m_colors[beginIndex + i] = parsed.at(i);
+        }
+    } else {
+        m_colors.remove(beginIndex + common, endIndex - beginIndex - common);
+    }
+
+    scheduleSwatchPositions();
+}
+
+void ColorSwatchOverlay::scheduleSwatchPositions()
+{
+    // Coalesce edits; positions are computed once the layout has caught up
+    if (m_positionsScheduled) {
+        return;
+    }
+    m_positionsScheduled = true;
+    QTimer::singleShot(0, this, [this]() {
+        m_positionsScheduled = false;
+        if (m_enabled) {
+            updateSwatchPositions();
+            update();
+        }
+    });
+}
+
 void ColorSwatchOverlay::updateSwatchPositions()
 {
     if (!m_editor || !m_editor->viewport()) return;
     
     // Update geometry to match viewport
-    setGeometry(m_editor->viewport()->rect());
-    
-    QFontMetrics fm(m_editor->font());
-    int lineHeight = fm.height();
-    int margin = 4;
-    
-    for (int i = 0; i < m_colors.size(); ++i) {
+    const QRect viewportRect = m_editor->viewport()->rect();
+    if (geometry() != viewportRect) {
+        setGeometry(viewportRect);
+    }
+
+    // Forget the rectangles of the previously visible swatches
+    for (int i = m_visibleBegin; i < m_visibleEnd && i < m_colors.size(); ++i) {
+        m_colors[i].swatchRect = QRect();
+    }
+    m_hoveredSwatch = nullptr;
+
+    if (m_colors.isEmpty()) {
+        m_visibleBegin = m_visibleEnd = 0;
+        return;
+    }
+
+    const int firstLine = m_editor->cursorForPosition(viewportRect.topLeft()).blockNumber();
+    const int lastLine = m_editor->cursorForPosition(viewportRect.bottomRight()).blockNumber();
+
+    const auto lineBefore = [](const ColorInfo &info, int line) { return info.line < line; };
+    const auto lineAfter = [](int line, const ColorInfo &info) { return line < info.line; };
+    const auto begin = std::lower_bound(m_colors.begin(), m_colors.end(), firstLine, lineBefore);
+    const auto end = std::upper_bound(begin, m_colors.end(), lastLine, lineAfter);
+    m_visibleBegin = int(begin - m_colors.begin());
+    m_visibleEnd = int(end - m_colors.begin());
+
+    const QPoint scrollOffset(m_editor->horizontalScrollBar()->value(),
+                              m_editor->verticalScrollBar()->value());
+
+    for (int i = m_visibleBegin; i < m_visibleEnd; ++i) {
         ColorInfo &info = m_colors[i];
-        
-        // Get the cursor position at the end of the color code
-        QTextCursor cursor(m_editor->document());
-        cursor.setPosition(info.startPos + info.length);
-        QRect cursorRect = m_editor->cursorRect(cursor);
-        
-        // Position swatch after the color code
-        int x = cursorRect.right() + margin;
-        int y = cursorRect.top() + (lineHeight - m_swatchSize) / 2;
-        
-        info.swatchRect = QRect(x, y, m_swatchSize, m_swatchSize);
+        if (info.layoutGeneration != m_geometryGeneration) {
+            info.layoutRect = computeLayoutRect(info);
+            info.layoutGeneration = m_geometryGeneration;
+        }
+        info.swatchRect = info.layoutRect.isNull() ? QRect() : info.layoutRect.translated(-scrollOffset);
+    }
+}
+
+QRect ColorSwatchOverlay::computeLayoutRect(const ColorInfo &info)
+{
+    ++m_layoutRectCount;
+
+    QTextDocument *doc = m_editor->document();
+    const QTextBlock block = doc->findBlock(info.startPos);
+    const QTextLayout *layout = block.layout();
+    if (!block.isValid() || !layout) {
+        return QRect();
     }
+
+    // Position swatch after the color code, centered on its line
+    const QRectF blockRect = doc->documentLayout()->blockBoundingRect(block);
+    const int end = info.startPos + info.length - block.position();
+    const QTextLine line = layout->lineForTextPosition(end);
+    if (!line.isValid()) {
+        return QRect();
+    }
+
+    const int margin = 4;
+    const int x = qRound(blockRect.left() + line.cursorToX(end)) + margin;
+    const int y = qRound(blockRect.top() + line.y() + (line.height() - m_swatchSize) / 2);
+    return QRect(x, y, m_swatchSize, m_swatchSize);
+}
+
+bool ColorSwatchOverlay::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched == m_editor->viewport() && event->type() == QEvent::Resize) {
+        // A new width rewraps lines
+        invalidateGeometry();
+        scheduleSwatchPositions();
+    }
+    return QWidget::eventFilter(watched, event);
 }
 
 void ColorSwatchOverlay::paintEvent(QPaintEvent *event)
 {
-    Q_UNUSED(event);
-    
     if (!m_enabled || m_colors.isEmpty()) return;
     
     QPainter painter(this);
     painter.setRenderHint(QPainter::Antialiasing);
     
-    QRect visibleRect = rect();
+    const QRect visibleRect = event->rect();
     
-    for (const ColorInfo &info : qAsConst(m_colors)) {
-        // Only draw visible swatches
+    for (int i = m_visibleBegin; i < m_visibleEnd && i < m_colors.size(); ++i) {
+        const ColorInfo &info = m_colors.at(i);
+        // Only draw swatches in the repainted area
         if (!visibleRect.intersects(info.swatchRect)) continue;
         
         // Draw border
@@ -192,7 +383,10 @@ void ColorSwatchOverlay::mousePressEvent(QMouseEvent *event)
     ColorInfo *swatch = findSwatchAt(event->pos());
     
     if (swatch && event->button() == Qt::LeftButton) {
-        m_editingSwatch = swatch;
+        // A cursor rather than a pointer into m_colors, which edits reshape
+        m_editingCursor = QTextCursor(m_editor->document());
+        m_editingCursor.setPosition(swatch->startPos);
+        m_editingCursor.setPosition(swatch->startPos + swatch->length, QTextCursor::KeepAnchor);
         
         // Create color dialog if needed
         if (!m_colorDialog) {
@@ -254,20 +448,26 @@ void ColorSwatchOverlay::leaveEvent(QEvent *event)
 
 ColorSwatchOverlay::ColorInfo* ColorSwatchOverlay::findSwatchAt(const QPoint &pos)
 {
-    for (int i = 0; i < m_colors.size(); ++i) {
-        if (m_colors[i].swatchRect.contains(pos)) {
-            return &m_colors[i];
+    const int end = qMin(m_visibleEnd, m_colors.size());
+    if (m_visibleBegin >= end) {
+        return nullptr;
+    }
+
+    // Visible swatches are ordered top to bottom, so skip the ones that
+    // end above the point and test those starting at or above it
+    const auto first = m_colors.begin() + m_visibleBegin;
+    const auto last = m_colors.begin() + end;
+    auto it = std::lower_bound(first, last, pos.y(), [](const ColorInfo &info, int y) {
+        return info.swatchRect.bottom() < y;
+    });
+    for (; it != last && it->swatchRect.top() <= pos.y(); ++it) {
+        if (it->swatchRect.contains(pos)) {
+            return &*it;
         }
     }
     return nullptr;
 }
 
-void ColorSwatchOverlay::onTextChanged()
-{
-    // Debounce updates - use a small delay
-    QMetaObject::invokeMethod(this, "updateColors", Qt::QueuedConnection);
-}
-
 void ColorSwatchOverlay::onScrolled()
 {
     updateSwatchPositions();
@@ -276,23 +476,19 @@ void ColorSwatchOverlay::onScrolled()
 
 void ColorSwatchOverlay::onColorSelected(const QColor &color)
 {
-    if (!m_editingSwatch) return;
+    if (m_editingCursor.isNull()) return;
     
-    QString oldCode = m_editingSwatch->colorCode;
+    QString oldCode = m_editingCursor.selectedText();
     QString newCode = colorToHex(color);
     
-    if (oldCode != newCode) {
+    if (!oldCode.isEmpty() && oldCode != newCode) {
         // Replace the color in the document
-        QTextCursor cursor(m_editor->document());
-        cursor.setPosition(m_editingSwatch->startPos);
-        cursor.setPosition(m_editingSwatch->startPos + m_editingSwatch->length, 
-                          QTextCursor::KeepAnchor);
-        cursor.insertText(newCode);
+        m_editingCursor.insertText(newCode);
         
         emit colorChanged(oldCode, newCode);
     }
     
-    m_editingSwatch = nullptr;
+    m_editingCursor = QTextCursor();
 }
 
 QString ColorSwatchOverlay::colorToHex(const QColor &color) const
@@ -4,8 +4,10 @@
 #include <QWidget>
 #include <QVector>
 #include <QRegularExpression>
+#include <QTextCursor>
 
 class QTextEdit;
+class QTextBlock;
 class QColorDialog;
 
 /**
@@ -14,6 +16,16 @@ class QColorDialog;
  * This widget sits on top of a QTextEdit and draws small colored squares
  * at the end of lines containing hex color codes. Clicking a swatch opens
  * a color picker to change the color.
+ *
+ * Color codes are kept in document order and maintained from the
+ * QTextDocument::contentsChange ranges: only the blocks an edit touches are
+ * re-parsed, and the offsets of the codes after them are shifted.
+ *
+ * Swatch rectangles are computed only for codes on visible lines, from the
+ * block layout, and cached in document coordinates until the layout changes;
+ * scrolling merely translates them. Because the list is ordered by line it
+ * doubles as the line index: the visible range and hit tests are found by
+ * binary search.
  */
 class ColorSwatchOverlay : public QWidget
 {
@@ -29,7 +41,9 @@ public:
         int length;         ///< Length of color code string
         QString colorCode;  ///< The color code string (e.g., "#ff0000")
         QColor color;       ///< Parsed color
-        QRect swatchRect;   ///< Rectangle for the swatch (in overlay coordinates)
+        QRect swatchRect;   ///< Rectangle for the swatch (in overlay coordinates); null when off-screen
+        QRect layoutRect;   ///< Cached swatch rectangle in document coordinates
+        int layoutGeneration = -1;  ///< Geometry generation layoutRect belongs to
     };
 
     explicit ColorSwatchOverlay(QTextEdit *editor, QWidget *parent = nullptr);
@@ -48,12 +62,39 @@ public:
     void setEnabled(bool enabled);
     bool isOverlayEnabled() const { return m_enabled; }
 
+    /**
+     * @brief Returns the color codes found in the document, in document order.
+     */
+    const QVector<ColorInfo> &colors() const { return m_colors; }
+
+    /**
+     * @brief Returns the number of blocks scanned for color codes so far.
+     *
+     * Intended for tests and profiling of incremental updates.
+     */
+    int parsedBlockCount() const { return m_parsedBlockCount; }
+
+    /**
+     * @brief Returns the number of swatch rectangles computed from the layout so far.
+     *
+     * Intended for tests and profiling of the geometry cache.
+     */
+    int layoutRectCount() const { return m_layoutRectCount; }
+
 public slots:
     /**
-     * @brief Updates the color positions based on current document content.
+     * @brief Re-parses the whole document and updates the swatches.
      */
     void updateColors();
 
+    /**
+     * @brief Recomputes swatch positions without re-parsing the document.
+     *
+     * Call this when the editor layout changed but its text did not, for
+     * example after a stylesheet changed the editor font.
+     */
+    void refreshSwatchPositions();
+
 signals:
     /**
      * @brief Emitted when a color is changed via the color picker.
@@ -63,19 +104,24 @@ signals:
     void colorChanged(const QString &oldColor, const QString &newColor);
 
 protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
     void paintEvent(QPaintEvent *event) override;
     void mousePressEvent(QMouseEvent *event) override;
     void mouseMoveEvent(QMouseEvent *event) override;
     void leaveEvent(QEvent *event) override;
 
 private slots:
-    void onTextChanged();
+    void onContentsChange(int position, int charsRemoved, int charsAdded);
     void onScrolled();
     void onColorSelected(const QColor &color);
 
 private:
     void parseColors();
+    void parseBlock(const QTextBlock &block, QVector<ColorInfo> &colors);
+    void scheduleSwatchPositions();
     void updateSwatchPositions();
+    void invalidateGeometry();
+    QRect computeLayoutRect(const ColorInfo &info);
     ColorInfo* findSwatchAt(const QPoint &pos);
     QString colorToHex(const QColor &color) const;
 
@@ -85,8 +131,17 @@ private:
     int m_swatchSize;
     bool m_enabled;
     ColorInfo *m_hoveredSwatch;
-    ColorInfo *m_editingSwatch;
+    QTextCursor m_editingCursor;    ///< Selects the code being edited; follows edits
     QColorDialog *m_colorDialog;
+    int m_documentLength;           ///< Character count when m_colors was last updated
+    int m_blockCount;
+    int m_parsedBlockCount;
+    bool m_colorsStale;             ///< Text changed while the overlay was disabled
+    bool m_positionsScheduled;
+    int m_visibleBegin;             ///< First entry of m_colors on a visible line
+    int m_visibleEnd;               ///< One past the last visible entry
+    int m_geometryGeneration;
+    int m_layoutRectCount;
 };
 
 #endif // COLORSWATCHOVERLAY_H
@@ -9,8 +9,43 @@
 #include <QVBoxLayout>
 #include <QTextDocument>
 #include <QTextBlock>
+#include <QScrollBar>
+#include <QThreadPool>
 #include <QApplication>
 
+#include <algorithm>
+
+namespace {
+
+/**
+ * @brief Returns the document text in [from, to) as toPlainText() would.
+ */
+QString plainTextRange(QTextDocument *document, int from, int to)
+{
+    QTextCursor cursor(document);
+    cursor.setPosition(from);
+    cursor.setPosition(to, QTextCursor::KeepAnchor);
+
+    QString text = cursor.selectedText();
+    QChar *data = text.data();
+    for (int i = 0; i < text.size(); ++i) {
+        switch (data[i].unicode()) {
+        case QChar::ParagraphSeparator:
+        case QChar::LineSeparator:
+            data[i] = QLatin1Char('\n');
+            break;
+        case QChar::Nbsp:
+            data[i] = QLatin1Char(' ');
+            break;
+        default:
+            break;
+        }
+    }
+    return text;
+}
+
+} // namespace
+
 FindReplaceBar::FindReplaceBar(QTextEdit *editor, QWidget *parent)
     : QWidget(parent)
     , m_editor(editor)
@@ -18,18 +53,30 @@ FindReplaceBar::FindReplaceBar(QTextEdit *editor, QWidget *parent)
     , m_prevButton(nullptr)
     , m_nextButton(nullptr)
     , m_caseSensitiveButton(nullptr)
+    , m_wholeWordsButton(nullptr)
+    , m_regexButton(nullptr)
     , m_closeButton(nullptr)
     , m_matchCountLabel(nullptr)
     , m_replaceRow(nullptr)
     , m_replaceInput(nullptr)
     , m_replaceButton(nullptr)
     , m_replaceAllButton(nullptr)
+    , m_searchGeneration(0)
+    , m_searchPending(false)
+    , m_selectFirstMatch(true)
+    , m_anchorPosition(0)
+    , m_replacing(false)
+    , m_documentLength(editor ? editor->document()->characterCount() : 0)
     , m_currentMatchIndex(-1)
     , m_caseSensitive(false)
+    , m_wholeWords(false)
+    , m_regularExpression(false)
     , m_darkTheme(false)
     , m_matchHighlightColor(QColor("#FFFF00"))        // Yellow for light theme
     , m_currentMatchHighlightColor(QColor("#FF9632")) // Orange for light theme
 {
+    qRegisterMetaType<QVector<TextMatch>>();
+
     setupUi();
     setupConnections();
     
@@ -39,7 +86,8 @@ FindReplaceBar::FindReplaceBar(QTextEdit *editor, QWidget *parent)
 
 FindReplaceBar::~FindReplaceBar()
 {
-    // Qt handles child widget deletion
+    // Qt handles child widget deletion; a running scan only needs to stop
+    cancelSearch();
 }
 
 void FindReplaceBar::setupUi()
@@ -79,6 +127,20 @@ void FindReplaceBar::setupUi()
     m_caseSensitiveButton->setCheckable(true);
     m_caseSensitiveButton->setChecked(false);
 
+    // Whole word toggle button
+    m_wholeWordsButton = new QToolButton(this);
+    m_wholeWordsButton->setText(tr("W"));
+    m_wholeWordsButton->setToolTip(tr("Match Whole Word"));
+    m_wholeWordsButton->setCheckable(true);
+    m_wholeWordsButton->setChecked(false);
+
+    // Regular expression toggle button
+    m_regexButton = new QToolButton(this);
+    m_regexButton->setText(tr(".*"));
+    m_regexButton->setToolTip(tr("Use Regular Expression"));
+    m_regexButton->setCheckable(true);
+    m_regexButton->setChecked(false);
+
     // Match count label
     m_matchCountLabel = new QLabel(this);
     m_matchCountLabel->setMinimumWidth(60);
@@ -94,6 +156,8 @@ void FindReplaceBar::setupUi()
     findLayout->addWidget(m_prevButton);
     findLayout->addWidget(m_nextButton);
     findLayout->addWidget(m_caseSensitiveButton);
+    findLayout->addWidget(m_wholeWordsButton);
+    findLayout->addWidget(m_regexButton);
     findLayout->addWidget(m_matchCountLabel);
     findLayout->addStretch();
     findLayout->addWidget(m_closeButton);
@@ -154,6 +218,12 @@ void FindReplaceBar::setupConnections()
     connect(m_caseSensitiveButton, &QToolButton::toggled,
             this, &FindReplaceBar::onCaseSensitivityChanged);
 
+    // Whole word and regular expression toggles
+    connect(m_wholeWordsButton, &QToolButton::toggled,
+            this, &FindReplaceBar::onWholeWordsChanged);
+    connect(m_regexButton, &QToolButton::toggled,
+            this, &FindReplaceBar::onRegularExpressionChanged);
+
     // Close button
     connect(m_closeButton, &QToolButton::clicked,
             this, &FindReplaceBar::hide);
@@ -163,6 +233,14 @@ void FindReplaceBar::setupConnections()
             this, &FindReplaceBar::replaceCurrent);
     connect(m_replaceAllButton, &QPushButton::clicked,
             this, &FindReplaceBar::replaceAll);
+
+    // Editor: keep matches in sync with edits and highlights with scrolling
+    if (m_editor) {
+        connect(m_editor->document(), &QTextDocument::contentsChange,
+                this, &FindReplaceBar::onContentsChange);
+        connect(m_editor->verticalScrollBar(), &QScrollBar::valueChanged,
+                this, &FindReplaceBar::onEditorScrolled);
+    }
 }
 
 // === Mode Control ===
@@ -227,6 +305,28 @@ void FindReplaceBar::setCaseSensitive(bool sensitive)
     m_caseSensitiveButton->setChecked(sensitive);
 }
 
+bool FindReplaceBar::isWholeWords() const
+{
+    return m_wholeWords;
+}
+
+void FindReplaceBar::setWholeWords(bool wholeWords)
+{
+    m_wholeWords = wholeWords;
+    m_wholeWordsButton->setChecked(wholeWords);
+}
+
+bool FindReplaceBar::isRegularExpression() const
+{
+    return m_regularExpression;
+}
+
+void FindReplaceBar::setRegularExpression(bool regularExpression)
+{
+    m_regularExpression = regularExpression;
+    m_regexButton->setChecked(regularExpression);
+}
+
 // === Match Information ===
 
 int FindReplaceBar::matchCount() const
@@ -239,6 +339,11 @@ int FindReplaceBar::currentMatchIndex() const
     return m_currentMatchIndex;
 }
 
+bool FindReplaceBar::isSearching() const
+{
+    return m_searchPending;
+}
+
 // === Theme Support ===
 
 void FindReplaceBar::setDarkTheme(bool dark)
@@ -299,21 +404,18 @@ void FindReplaceBar::replaceCurrent()
         return;
     }
     
-    QTextCursor cursor = m_matches[m_currentMatchIndex];
+    const QString replacement = replacementFor(m_currentMatchIndex);
+    QTextCursor cursor = matchCursor(m_currentMatchIndex);
     cursor.beginEditBlock();
     cursor.removeSelectedText();
-    cursor.insertText(m_replaceInput->text());
+    cursor.insertText(replacement);
     cursor.endEditBlock();
     
-    // Re-search to update matches
-    performSearch();
+    // onContentsChange() has updated the matches around the replacement
+    // and made the one after it current
     
     // Navigate to next match if any remain
     if (!m_matches.isEmpty()) {
-        // Adjust index if needed (current was removed)
-        if (m_currentMatchIndex >= m_matches.count()) {
-            m_currentMatchIndex = 0;
-        }
         selectCurrentMatch();
         scrollToCurrentMatch();
     }
@@ -324,28 +426,42 @@ void FindReplaceBar::replaceCurrent()
 
 void FindReplaceBar::replaceAll()
 {
+    // Replacing needs every match, not just those found so far
+    if (m_searchPending) {
+        performSearch(Synchronous);
+    }
+
     if (m_matches.isEmpty()) {
         return;
     }
     
     int replacementCount = m_matches.count();
-    QString replacementText = m_replaceInput->text();
+    
+    // Capture groups refer to the text before any replacement
+    QStringList replacements;
+    replacements.reserve(m_matches.count());
+    for (int i = 0; i < m_matches.count(); ++i) {
+        replacements.append(replacementFor(i));
+    }
     
     // Use a single edit block for atomic undo
     QTextCursor cursor(m_editor->document());
+    m_replacing = true;
     cursor.beginEditBlock();
     
     // Replace in reverse order to preserve positions
     for (int i = m_matches.count() - 1; i >= 0; --i) {
-        QTextCursor matchCursor = m_matches[i];
-        matchCursor.removeSelectedText();
-        matchCursor.insertText(replacementText);
+        QTextCursor replaceCursor = matchCursor(i);
+        replaceCursor.removeSelectedText();
+        replaceCursor.insertText(replacements.at(i));
     }
     
     cursor.endEditBlock();
+    m_replacing = false;
     
-    // Re-search to update matches (should be empty now)
-    performSearch();
+    // Re-search to update matches (should be empty now); synchronously, so
+    // a late background result does not overwrite the label below
+    performSearch(Synchronous);
     
     // Update label to show replacement count
     m_matchCountLabel->setText(tr("%1 replaced").arg(replacementCount));
@@ -370,6 +486,79 @@ void FindReplaceBar::onCaseSensitivityChanged(bool checked)
     highlightMatches();
 }
 
+void FindReplaceBar::onWholeWordsChanged(bool checked)
+{
+    m_wholeWords = checked;
+    performSearch();
+    updateMatchCountLabel();
+    highlightMatches();
+}
+
+void FindReplaceBar::onRegularExpressionChanged(bool checked)
+{
+    m_regularExpression = checked;
+    performSearch();
+    updateMatchCountLabel();
+    highlightMatches();
+}
+
+void FindReplaceBar::onMatchesFound(int generation, const QVector<TextMatch> &matches)
+{
+    if (generation != m_searchGeneration) {
+        return;
+    }
+    appendMatches(matches);
+    updateMatchCountLabel();
+    highlightMatches();
+}
+
+void FindReplaceBar::onSearchFinished(int generation)
+{
+    if (generation != m_searchGeneration) {
+        return;
+    }
+    finishSearch();
+    updateMatchCountLabel();
+    highlightMatches();
+}
+
+void FindReplaceBar::onContentsChange(int position, int charsRemoved, int charsAdded)
+{
+    Q_UNUSED(charsRemoved)
+
+    // The length delta is taken from the document itself; charsRemoved is
+    // unreliable when the whole document is replaced
+    const int length = m_editor->document()->characterCount();
+    const int delta = length - m_documentLength;
+    m_documentLength = length;
+
+    // Nothing to do while no search is active
+    if (m_replacing || m_searchInput->text().isEmpty()) {
+        return;
+    }
+    if (!isVisible() && m_matches.isEmpty() && !m_searchPending) {
+        return;
+    }
+
+    const int removed = charsAdded - delta;
+    if (m_searchPending || removed < 0 || position < 0 || position + charsAdded >= length) {
+        // A running scan works on a stale snapshot; start it over
+        performSearch(Refresh);
+    } else {
+        updateMatchesAfterEdit(position, removed, charsAdded);
+    }
+    updateMatchCountLabel();
+    highlightMatches();
+}
+
+void FindReplaceBar::onEditorScrolled()
+{
+    // Below the limit every match is highlighted already
+    if (m_matches.count() > HIGHLIGHT_ALL_LIMIT) {
+        highlightMatches();
+    }
+}
+
 void FindReplaceBar::updateHighlights()
 {
     highlightMatches();
@@ -377,6 +566,8 @@ void FindReplaceBar::updateHighlights()
 
 void FindReplaceBar::updateMatchCountLabel()
 {
+    m_matchCountLabel->setToolTip(m_pattern.errorString());
+    
     if (m_searchInput->text().isEmpty()) {
         m_matchCountLabel->clear();
         m_prevButton->setEnabled(false);
@@ -384,13 +575,18 @@ void FindReplaceBar::updateMatchCountLabel()
         m_replaceButton->setEnabled(false);
         m_replaceAllButton->setEnabled(false);
     } else if (m_matches.isEmpty()) {
-        m_matchCountLabel->setText(tr("No results"));
+        if (!m_pattern.isValid()) {
+            m_matchCountLabel->setText(tr("Invalid pattern"));
+        } else {
+            m_matchCountLabel->setText(m_searchPending ? tr("Searching...") : tr("No results"));
+        }
         m_prevButton->setEnabled(false);
         m_nextButton->setEnabled(false);
         m_replaceButton->setEnabled(false);
         m_replaceAllButton->setEnabled(false);
     } else {
-        m_matchCountLabel->setText(tr("%1 of %2").arg(m_currentMatchIndex + 1).arg(m_matches.count()));
+        const QString text = m_searchPending ? tr("%1 of %2+") : tr("%1 of %2");
+        m_matchCountLabel->setText(text.arg(m_currentMatchIndex + 1).arg(m_matches.count()));
         m_prevButton->setEnabled(true);
         m_nextButton->setEnabled(true);
         m_replaceButton->setEnabled(true);
@@ -402,40 +598,241 @@ void FindReplaceBar::updateMatchCountLabel()
 
 // === Private Methods ===
 
-void FindReplaceBar::performSearch()
+void FindReplaceBar::performSearch(SearchMode mode)
 {
+    cancelSearch();
     m_matches.clear();
     m_currentMatchIndex = -1;
     
-    QString searchStr = m_searchInput->text();
-    if (searchStr.isEmpty() || !m_editor) {
+    TextSearchPattern::Options options;
+    if (m_caseSensitive) {
+        options |= TextSearchPattern::CaseSensitive;
+    }
+    if (m_wholeWords) {
+        options |= TextSearchPattern::WholeWords;
+    }
+    if (m_regularExpression) {
+        options |= TextSearchPattern::RegularExpression;
+    }
+    m_pattern = TextSearchPattern(m_searchInput->text(), options);
+    
+    if (m_pattern.isEmpty() || !m_pattern.isValid() || !m_editor) {
         return;
     }
     
-    QTextDocument *doc = m_editor->document();
-    QTextDocument::FindFlags flags;
+    // After an edit the current match is the first one at or after the
+    // editor cursor, and the cursor itself stays where the user put it
+    m_selectFirstMatch = mode != Refresh;
+    m_anchorPosition = mode == Refresh ? m_editor->textCursor().selectionStart() : 0;
     
-    if (m_caseSensitive) {
-        flags |= QTextDocument::FindCaseSensitively;
+    // Plain text positions map one-to-one to document positions
+    const QString text = m_editor->document()->toPlainText();
+    
+    if (mode == Synchronous || text.size() < BACKGROUND_SEARCH_THRESHOLD) {
+        appendMatches(m_pattern.findAll(text));
+        finishSearch();
+        return;
     }
     
-    // Find all matches
-    QTextCursor cursor(doc);
-    while (!cursor.isNull() && !cursor.atEnd()) {
-        cursor = doc->find(searchStr, cursor, flags);
-        if (!cursor.isNull()) {
-            m_matches.append(cursor);
-        }
+    TextSearchTask *task = new TextSearchTask(m_searchGeneration, text, m_pattern);
+    connect(task, &TextSearchTask::matchesFound,
+            this, &FindReplaceBar::onMatchesFound, Qt::QueuedConnection);
+    connect(task, &TextSearchTask::finished,
+            this, &FindReplaceBar::onSearchFinished, Qt::QueuedConnection);
+    m_searchTask = task;
+    m_searchPending = true;
+    QThreadPool::globalInstance()->start(task);
+}
+
+void FindReplaceBar::cancelSearch()
+{
+    if (m_searchTask) {
+        m_searchTask->cancel();
     }
+    m_searchTask.clear();
+    m_searchPending = false;
     
-    // Set current match to first one if matches exist
-    if (!m_matches.isEmpty()) {
-        m_currentMatchIndex = 0;
+    // Batches already queued by the old task are dropped on arrival
+    ++m_searchGeneration;
+}
+
+void FindReplaceBar::appendMatches(const QVector<TextMatch> &matches)
+{
+    const int firstNew = m_matches.count();
+    m_matches += matches;
+    
+    if (m_currentMatchIndex >= 0) {
+        return;
+    }
+    for (int i = firstNew; i < m_matches.count(); ++i) {
+        if (m_matches.at(i).start >= m_anchorPosition) {
+            m_currentMatchIndex = i;
+            break;
+        }
+    }
+    if (m_currentMatchIndex >= 0 && m_selectFirstMatch) {
         selectCurrentMatch();
         scrollToCurrentMatch();
     }
 }
 
+void FindReplaceBar::finishSearch()
+{
+    m_searchTask.clear();
+    m_searchPending = false;
+    
+    // Nothing after the anchor: wrap around to the first match
+    if (m_currentMatchIndex < 0 && !m_matches.isEmpty()) {
+        m_currentMatchIndex = 0;
+        if (m_selectFirstMatch) {
+            selectCurrentMatch();
+            scrollToCurrentMatch();
+        }
+    }
+}
+
+void FindReplaceBar::updateMatchesAfterEdit(int position, int charsRemoved, int charsAdded)
+{
+    QTextDocument *doc = m_editor->document();
+    const int delta = charsAdded - charsRemoved;
+    const int textEnd = doc->characterCount() - 1;
+    const auto endsBefore = [](const TextMatch &match, int pos) { return match.end() <= pos; };
+    const auto startsBefore = [](const TextMatch &match, int pos) { return match.start < pos; };
+    
+    int first;
+    int next;
+    QVector<TextMatch> found;
+    
+    if (m_pattern.isLineBased()) {
+        // Regular expression matches stay within a line, so rescanning the
+        // lines the edit touched is enough
+        const QTextBlock firstBlock = doc->findBlock(position);
+        const QTextBlock lastBlock = doc->findBlock(position + charsAdded);
+        const int from = firstBlock.position();
+        const int to = lastBlock.position() + lastBlock.length() - 1;
+        
+        first = int(std::lower_bound(m_matches.constBegin(), m_matches.constEnd(),
+                                     from, startsBefore) - m_matches.constBegin());
+        next = int(std::lower_bound(m_matches.constBegin() + first, m_matches.constEnd(),
+                                    to - delta + 1, startsBefore) - m_matches.constBegin());
+        
+        const QString region = plainTextRange(doc, from, to);
+        found = m_pattern.findAll(region);
+        for (TextMatch &match : found) {
+            match.start += from;
+        }
+    } else {
+        // Matches ending before the edit stay, since greedy matching picks
+        // them before anything the edit creates; [first, tail) overlap the
+        // edit and matches from tail on lie after it in old offsets. Whole
+        // words also depend on one neighbouring character on each side.
+        const int queryLength = m_pattern.query().size();
+        const int context = m_pattern.context();
+        const int from = qMax(0, position - queryLength + 1 - context);
+        first = int(std::lower_bound(m_matches.constBegin(), m_matches.constEnd(),
+                                     position - context, endsBefore) - m_matches.constBegin());
+        const int tail = int(std::lower_bound(m_matches.constBegin() + first, m_matches.constEnd(),
+                                              position + charsRemoved + context, startsBefore)
+                             - m_matches.constBegin());
+        
+        // Rescan until the new match sequence rejoins the old one: every
+        // match starting at or after limit is untouched text, unless an old
+        // match straddles the scan position and hid matches inside it
+        int scanned = qMax(first > 0 ? m_matches.at(first - 1).end() : 0, from);
+        int limit = qMin(textEnd, position + charsAdded + queryLength - 1 + context);
+        next = tail;
+        for (;;) {
+            if (scanned < limit) {
+                const int regionStart = qMax(0, scanned - context);
+                const int regionEnd = qMin(textEnd, limit + queryLength - 1 + context);
+                const QString region = plainTextRange(doc, regionStart, regionEnd);
+                QVector<TextMatch> regionMatches;
+                const int resume = m_pattern.findInRange(region, scanned - regionStart,
+                                                         limit - regionStart, &regionMatches);
+                for (TextMatch match : qAsConst(regionMatches)) {
+                    match.start += regionStart;
+                    found.append(match);
+                }
+                scanned = regionStart + resume;
+            }
+            
+            while (next < m_matches.count() && m_matches.at(next).start + delta < scanned) {
+                ++next;
+            }
+            if (next > tail && m_matches.at(next - 1).end() + delta > scanned) {
+                limit = m_matches.at(next - 1).end() + delta;
+                continue;
+            }
+            break;
+        }
+    }
+    
+    // Work out the current match before the list changes: it keeps its
+    // identity if it survived, otherwise the next match after the edit
+    int current = -1;
+    if (m_currentMatchIndex >= 0 && m_currentMatchIndex < first) {
+        current = m_currentMatchIndex;
+    } else if (m_currentMatchIndex >= next) {
+        current = m_currentMatchIndex - (next - first) + found.count();
+    } else if (m_currentMatchIndex >= 0) {
+        TextMatch old = m_matches.at(m_currentMatchIndex);
+        if (old.start >= position + charsRemoved) {
+            old.start += delta;
+        }
+        for (int i = 0; i < found.count(); ++i) {
+            if (found.at(i).start == old.start && found.at(i).length == old.length) {
+                current = first + i;
+                break;
+            }
+        }
+    }
+    
+    // Splice the rescanned matches in place of the old ones
+    for (int i = next; i < m_matches.count(); ++i) {
+        m_matches[i].start += delta;
+    }
+    const int common = qMin(found.count(), next - first);
+    for (int i = 0; i < common; ++i) {
+        m_matches[first + i] = found.at(i);
+    }
+    if (found.count() > common) {
+        m_matches.insert(first + common, found.count() - common, TextMatch());
+        for (int i = common; i < found.count(); ++i) {
+            m_matches[first + i] = found.at(i);
+        }
+    } else {
+        m_matches.remove(first + common, next - first - common);
+    }
+    
+    if (current < 0 && !m_matches.isEmpty()) {
+        const auto after = std::lower_bound(m_matches.constBegin(), m_matches.constEnd(),
+                                            position + charsAdded, startsBefore);
+        current = after == m_matches.constEnd() ? 0 : int(after - m_matches.constBegin());
+    }
+    m_currentMatchIndex = current;
+}
+
+QString FindReplaceBar::replacementFor(int index) const
+{
+    if (!m_pattern.isLineBased()) {
+        return m_replaceInput->text();
+    }
+    const QTextBlock block = m_editor->document()->findBlock(m_matches.at(index).start);
+    const QString line = plainTextRange(m_editor->document(), block.position(),
+                                        block.position() + block.length() - 1);
+    return m_pattern.replacementFor(line, block.position(), m_matches.at(index),
+                                    m_replaceInput->text());
+}
+
+QTextCursor FindReplaceBar::matchCursor(int index) const
+{
+    const TextMatch &match = m_matches.at(index);
+    QTextCursor cursor(m_editor->document());
+    cursor.setPosition(match.start);
+    cursor.setPosition(match.end(), QTextCursor::KeepAnchor);
+    return cursor;
+}
+
 void FindReplaceBar::highlightMatches()
 {
     if (!m_editor) {
@@ -444,8 +841,35 @@ void FindReplaceBar::highlightMatches()
     
     QList<QTextEdit::ExtraSelection> extraSelections;
     
-    // Highlight all matches
-    for (int i = 0; i < m_matches.count(); ++i) {
+    int first = 0;
+    int last = m_matches.count();
+    if (m_matches.count() > HIGHLIGHT_ALL_LIMIT) {
+        // Only the viewport plus one page above and below it, so scrolling
+        // a short way does not show unhighlighted matches
+        const QWidget *viewport = m_editor->viewport();
+        const int from = m_editor->cursorForPosition(QPoint(0, -viewport->height())).position();
+        const int to = m_editor->cursorForPosition(
+            QPoint(viewport->width(), 2 * viewport->height())).position();
+        
+        first = int(std::lower_bound(m_matches.constBegin(), m_matches.constEnd(), from,
+                                     [](const TextMatch &match, int position) {
+                                         return match.end() <= position;
+                                     }) - m_matches.constBegin());
+        last = int(std::upper_bound(m_matches.constBegin() + first, m_matches.constEnd(), to,
+                                    [](int position, const TextMatch &match) {
+                                        return position < match.start;
+                                    }) - m_matches.constBegin());
+    }
+    
+    // The current match is highlighted even when scrolled out of view
+    if (m_currentMatchIndex >= 0 && (m_currentMatchIndex < first || m_currentMatchIndex >= last)) {
+        QTextEdit::ExtraSelection selection;
+        selection.format.setBackground(m_currentMatchHighlightColor);
+        selection.cursor = matchCursor(m_currentMatchIndex);
+        extraSelections.append(selection);
+    }
+    
+    for (int i = first; i < last; ++i) {
         QTextEdit::ExtraSelection selection;
         
         if (i == m_currentMatchIndex) {
@@ -456,7 +880,7 @@ void FindReplaceBar::highlightMatches()
             selection.format.setBackground(m_matchHighlightColor);
         }
         
-        selection.cursor = m_matches[i];
+        selection.cursor = matchCursor(i);
         extraSelections.append(selection);
     }
     
@@ -468,6 +892,7 @@ void FindReplaceBar::clearHighlights()
     if (m_editor) {
         m_editor->setExtraSelections(QList<QTextEdit::ExtraSelection>());
     }
+    cancelSearch();
     m_matches.clear();
     m_currentMatchIndex = -1;
 }
@@ -475,7 +900,7 @@ void FindReplaceBar::clearHighlights()
 void FindReplaceBar::selectCurrentMatch()
 {
     if (m_currentMatchIndex >= 0 && m_currentMatchIndex < m_matches.count() && m_editor) {
-        m_editor->setTextCursor(m_matches[m_currentMatchIndex]);
+        m_editor->setTextCursor(matchCursor(m_currentMatchIndex));
     }
 }
 
@@ -4,9 +4,13 @@
 #include <QWidget>
 #include <QString>
 #include <QList>
+#include <QVector>
+#include <QPointer>
 #include <QTextCursor>
 #include <QColor>
 
+#include "TextSearchTask.h"
+
 class QTextEdit;
 class QLineEdit;
 class QPushButton;
@@ -19,16 +23,36 @@ class QLabel;
  * The FindReplaceBar provides:
  * - Search input with match highlighting
  * - Navigation between matches (next/previous)
- * - Case-sensitive search toggle
+ * - Case-sensitive, whole-word and regular expression search toggles
  * - Replace functionality (single and all)
  * - Match count display
  * - Theme-aware highlight colors
+ *
+ * Documents of BACKGROUND_SEARCH_THRESHOLD characters or more are searched
+ * on a worker thread over a snapshot of the text; the match count streams
+ * into the label as batches arrive and a new query cancels the running scan.
+ * When there are more than HIGHLIGHT_ALL_LIMIT matches, only those in or
+ * near the viewport get an extra selection.
+ *
+ * Matches are kept up to date as the document changes: an edit, or a
+ * single replacement, rescans only the text around it and shifts the
+ * offsets of later matches.
  */
 class FindReplaceBar : public QWidget
 {
     Q_OBJECT
 
 public:
+    /**
+     * @brief Document length in characters from which searches run in the background.
+     */
+    static constexpr int BACKGROUND_SEARCH_THRESHOLD = 256 * 1024;
+
+    /**
+     * @brief Match count above which only matches near the viewport are highlighted.
+     */
+    static constexpr int HIGHLIGHT_ALL_LIMIT = 1000;
+
     /**
      * @brief Constructs a FindReplaceBar widget.
      * @param editor The QTextEdit to search within.
@@ -85,6 +109,31 @@ public:
      */
     void setCaseSensitive(bool sensitive);
 
+    /**
+     * @brief Returns whether only whole words are matched.
+     */
+    bool isWholeWords() const;
+
+    /**
+     * @brief Sets whether only whole words are matched.
+     * @param wholeWords true to reject matches inside longer words.
+     */
+    void setWholeWords(bool wholeWords);
+
+    /**
+     * @brief Returns whether the search text is a regular expression.
+     */
+    bool isRegularExpression() const;
+
+    /**
+     * @brief Sets whether the search text is a regular expression.
+     *
+     * Regular expressions match within a line. The replacement text may
+     * refer to capture groups as \1 or $1.
+     * @param regularExpression true for regular expression search.
+     */
+    void setRegularExpression(bool regularExpression);
+
     // Match information
     /**
      * @brief Returns the total number of matches found.
@@ -97,6 +146,13 @@ public:
      */
     int currentMatchIndex() const;
 
+    /**
+     * @brief Returns whether a background search is still producing matches.
+     *
+     * While true, matchCount() is the number of matches found so far.
+     */
+    bool isSearching() const;
+
     // Theme support
     /**
      * @brief Sets the color theme for match highlighting.
@@ -147,13 +203,34 @@ public slots:
 private slots:
     void onSearchTextChanged(const QString &text);
     void onCaseSensitivityChanged(bool checked);
+    void onWholeWordsChanged(bool checked);
+    void onRegularExpressionChanged(bool checked);
+    void onMatchesFound(int generation, const QVector<TextMatch> &matches);
+    void onSearchFinished(int generation);
+    void onContentsChange(int position, int charsRemoved, int charsAdded);
+    void onEditorScrolled();
     void updateHighlights();
     void updateMatchCountLabel();
 
 private:
+    /**
+     * @brief How performSearch() runs and what it does with the first match.
+     */
+    enum SearchMode {
+        Interactive, ///< Background for large documents; selects the first match
+        Synchronous, ///< Always on the UI thread; selects the first match
+        Refresh      ///< Background for large documents; leaves the editor cursor alone
+    };
+
     void setupUi();
     void setupConnections();
-    void performSearch();
+    void performSearch(SearchMode mode = Interactive);
+    void cancelSearch();
+    void appendMatches(const QVector<TextMatch> &matches);
+    void finishSearch();
+    void updateMatchesAfterEdit(int position, int charsRemoved, int charsAdded);
+    QTextCursor matchCursor(int index) const;
+    QString replacementFor(int index) const;
     void highlightMatches();
     void clearHighlights();
     void selectCurrentMatch();
@@ -167,6 +244,8 @@ private:
     QPushButton *m_prevButton;
     QPushButton *m_nextButton;
     QToolButton *m_caseSensitiveButton;
+    QToolButton *m_wholeWordsButton;
+    QToolButton *m_regexButton;
     QToolButton *m_closeButton;
     QLabel *m_matchCountLabel;
     
@@ -177,9 +256,19 @@ private:
     QPushButton *m_replaceAllButton;
 
     // Search state
-    QList<QTextCursor> m_matches;
+    TextSearchPattern m_pattern;
+    QVector<TextMatch> m_matches;
+    QPointer<TextSearchTask> m_searchTask;
+    int m_searchGeneration;
+    bool m_searchPending;
+    bool m_selectFirstMatch;
+    int m_anchorPosition;
+    bool m_replacing;
+    int m_documentLength;
     int m_currentMatchIndex;
     bool m_caseSensitive;
+    bool m_wholeWords;
+    bool m_regularExpression;
     bool m_darkTheme;
 
     // Highlight colors
@@ -12,6 +12,7 @@
 #include <QHBoxLayout>
 #include <QTextCursor>
 #include <QShortcut>
+#include <QScrollBar>
 
 QssEditor::QssEditor(QWidget *parent)
     : QWidget(parent)
@@ -117,6 +118,13 @@ void QssEditor::setupConnections()
     connect(m_textEdit, &QTextEdit::textChanged,
             this, &QssEditor::onTextChanged);
 
+    // Track the visible blocks for lazy highlighting; the range changes
+    // with the document height and the viewport size
+    connect(m_textEdit->verticalScrollBar(), &QScrollBar::valueChanged,
+            this, &QssEditor::updateVisibleBlocks);
+    connect(m_textEdit->verticalScrollBar(), &QScrollBar::rangeChanged,
+            this, &QssEditor::updateVisibleBlocks);
+
     // Connect Apply button
     connect(m_applyButton, &QPushButton::clicked,
             this, &QssEditor::onApplyClicked);
@@ -153,10 +161,23 @@ QString QssEditor::styleSheet() const
 
 void QssEditor::setStyleSheet(const QString &qss)
 {
+    // Large stylesheets only get their visible part highlighted up front
+    const bool lazy = qss.size() >= LAZY_HIGHLIGHT_THRESHOLD;
+    if (lazy) {
+        m_highlighter->setLazyHighlighting(true);
+        m_highlighter->setVisibleBlockRange(0, -1);
+    }
+
     // Block signals to avoid triggering unsaved changes
     m_textEdit->blockSignals(true);
     m_textEdit->setPlainText(qss);
     m_textEdit->blockSignals(false);
+
+    if (lazy) {
+        updateVisibleBlocks();
+    } else {
+        m_highlighter->setLazyHighlighting(false);
+    }
     
     // Reset unsaved changes state
     m_hasUnsavedChanges = false;
@@ -308,6 +329,18 @@ void QssEditor::onAutoApplyToggled(bool checked)
     }
 }
 
+void QssEditor::updateVisibleBlocks()
+{
+    if (!m_highlighter || !m_highlighter->isLazyHighlighting()) {
+        return;
+    }
+
+    const QRect rect = m_textEdit->viewport()->rect();
+    const int first = m_textEdit->cursorForPosition(rect.topLeft()).blockNumber();
+    const int last = m_textEdit->cursorForPosition(rect.bottomRight()).blockNumber();
+    m_highlighter->setVisibleBlockRange(first, last);
+}
+
 void QssEditor::setAvailableStyles(const QStringList &styles)
 {
     // Block signals to avoid emitting styleChangeRequested during population
@@ -487,9 +520,8 @@ void QssEditor::refreshColorSwatches()
     if (m_colorSwatchOverlay) {
         // Ensure overlay geometry matches viewport after style changes
         m_colorSwatchOverlay->setGeometry(m_textEdit->viewport()->rect());
-        // Force update of color positions and repaint
-        m_colorSwatchOverlay->updateColors();
-        m_colorSwatchOverlay->update();
+        // Colors are tracked incrementally; only the positions may be stale
+        m_colorSwatchOverlay->refreshSwatchPositions();
     }
 }
 
@@ -24,6 +24,9 @@ class FindReplaceBar;
  * - Auto-apply mode with configurable delay
  * - Unsaved changes tracking
  * - Cursor position preservation after style application
+ *
+ * Stylesheets of LAZY_HIGHLIGHT_THRESHOLD characters or more are highlighted
+ * lazily: visible blocks first, the rest while the event loop is idle.
  */
 class QssEditor : public QWidget
 {
@@ -244,6 +247,7 @@ private slots:
     void onAutoApplyTimeout();
     void onApplyClicked();
     void onAutoApplyToggled(bool checked);
+    void updateVisibleBlocks();
 
 private:
     void setupUi();
@@ -269,6 +273,9 @@ private:
     bool m_isApplying;
 
     static constexpr int DEFAULT_AUTO_APPLY_DELAY_MS = 500;
+
+    // Stylesheets at least this long are highlighted lazily
+    static constexpr int LAZY_HIGHLIGHT_THRESHOLD = 256 * 1024;
 };
 
 #endif // QSSEDITOR_H
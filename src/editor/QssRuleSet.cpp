@@ -0,0 +1,409 @@
+#include "QssRuleSet.h"
+
+#include <QHash>
+#include <QSet>
+#include <QWidget>
+#include <QMetaObject>
+
+#include <algorithm>
+
+namespace {
+
+/**
+ * @brief Removes comments, leaving quoted strings untouched.
+ */
+QString stripComments(const QString &qss)
+{
+    QString result;
+    result.reserve(qss.size());
+
+    const int length = qss.size();
+    QChar quote;
+    for (int i = 0; i < length; ++i) {
+        const QChar c = qss.at(i);
+        if (!quote.isNull()) {
+            result += c;
+            if (c == QLatin1Char('\\') && i + 1 < length) {
+                result += qss.at(++i);
+            } else if (c == quote) {
+                quote = QChar();
+            }
+            continue;
+        }
+        if (c == QLatin1Char('"') || c == QLatin1Char('\'')) {
+            quote = c;
+            result += c;
+        } else if (c == QLatin1Char('/') && i + 1 < length && qss.at(i + 1) == QLatin1Char('*')) {
+            const int end = qss.indexOf(QLatin1String("*/"), i + 2);
+            if (end < 0) {
+                break;
+            }
+            result += QLatin1Char(' ');
+            i = end + 1;
+        } else {
+            result += c;
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Finds the next occurrence of any of the given characters at top level.
+ *
+ * Characters inside quotes, parentheses or brackets are skipped.
+ * @return The index of the character, or -1 if not found.
+ */
+int findTopLevel(const QString &text, int from, const QString &chars)
+{
+    QChar quote;
+    int depth = 0;
+    for (int i = from; i < text.size(); ++i) {
+        const QChar c = text.at(i);
+        if (!quote.isNull()) {
+            if (c == QLatin1Char('\\')) {
+                ++i;
+            } else if (c == quote) {
+                quote = QChar();
+            }
+        } else if (c == QLatin1Char('"') || c == QLatin1Char('\'')) {
+            quote = c;
+        } else if (c == QLatin1Char('(') || c == QLatin1Char('[')) {
+            ++depth;
+        } else if ((c == QLatin1Char(')') || c == QLatin1Char(']')) && depth > 0) {
+            --depth;
+        } else if (depth == 0 && chars.contains(c)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Splits text on a separator that is not quoted or parenthesized.
+ */
+QStringList splitTopLevel(const QString &text, QChar separator)
+{
+    QStringList parts;
+    const QString separators(separator);
+    int start = 0;
+    int index;
+    while ((index = findTopLevel(text, start, separators)) >= 0) {
+        parts << text.mid(start, index - start);
+        start = index + 1;
+    }
+    parts << text.mid(start);
+    return parts;
+}
+
+int identifierEnd(const QString &text, int from)
+{
+    int i = from;
+    while (i < text.size()) {
+        const QChar c = text.at(i);
+        if (!c.isLetterOrNumber() && c != QLatin1Char('_') && c != QLatin1Char('-')) {
+            break;
+        }
+        ++i;
+    }
+    return i;
+}
+
+QssSelector parseSelector(const QString &rawText)
+{
+    QssSelector selector;
+
+    // Normalize child combinators so compounds are separated by single spaces
+    QString text = rawText.simplified();
+    text.replace(QLatin1String(" >"), QLatin1String(">"));
+    text.replace(QLatin1String("> "), QLatin1String(">"));
+    text.replace(QLatin1String(">"), QLatin1String(" > "));
+    selector.text = text;
+
+    // The subject is the compound after the last top-level space
+    int start = 0;
+    int space;
+    while ((space = findTopLevel(text, start, QStringLiteral(" "))) >= 0) {
+        start = space + 1;
+    }
+
+    int i = start;
+    if (i < text.size() && text.at(i) == QLatin1Char('*')) {
+        ++i;
+    } else if (i < text.size() && (text.at(i).isLetter() || text.at(i) == QLatin1Char('_'))) {
+        const int end = identifierEnd(text, i);
+        selector.typeName = text.mid(i, end - i);
+        // Namespaced classes are written as ns--Class in style sheets
+        selector.typeName.replace(QLatin1String("--"), QLatin1String("::"));
+        i = end;
+    }
+
+    while (i < text.size()) {
+        const QChar c = text.at(i);
+        if (c == QLatin1Char('.') || c == QLatin1Char('#')) {
+            const int end = identifierEnd(text, i + 1);
+            QString name = text.mid(i + 1, end - i - 1);
+            if (c == QLatin1Char('.')) {
+                selector.className = name.replace(QLatin1String("--"), QLatin1String("::"));
+            } else {
+                selector.objectName = name;
+            }
+            i = end;
+        } else if (c == QLatin1Char('[')) {
+            const int end = findTopLevel(text, i + 1, QStringLiteral("]"));
+            i = end < 0 ? text.size() : end + 1;
+        } else {
+            break;
+        }
+    }
+    selector.subjectEnd = i;
+
+    return selector;
+}
+
+} // namespace
+
+bool QssSelector::isTargetable() const
+{
+    return !typeName.isEmpty() || !className.isEmpty() || !objectName.isEmpty();
+}
+
+bool QssSelector::mayMatch(const QWidget *widget) const
+{
+    if (!widget) {
+        return false;
+    }
+
+    if (!objectName.isEmpty() && widget->objectName() != objectName) {
+        return false;
+    }
+
+    const QMetaObject *metaObject = widget->metaObject();
+    if (!className.isEmpty() && QLatin1String(metaObject->className()) != className) {
+        return false;
+    }
+
+    if (!typeName.isEmpty()) {
+        for (const QMetaObject *mo = metaObject; mo; mo = mo->superClass()) {
+            if (QLatin1String(mo->className()) == typeName) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    return true;
+}
+
+QssRuleSet QssRuleSet::parse(const QString &qss)
+{
+    QssRuleSet set;
+    const QString text = stripComments(qss);
+
+    int pos = 0;
+    while (pos < text.size()) {
+        const int open = findTopLevel(text, pos, QStringLiteral("{}"));
+        if (open < 0) {
+            // Anything other than whitespace after the last rule is stray text
+            if (!text.mid(pos).trimmed().isEmpty()) {
+                set.m_wellFormed = false;
+            }
+            break;
+        }
+        if (text.at(open) == QLatin1Char('}')) {
+            set.m_wellFormed = false;
+            pos = open + 1;
+            continue;
+        }
+
+        const int close = findTopLevel(text, open + 1, QStringLiteral("{}"));
+        if (close < 0 || text.at(close) == QLatin1Char('{')) {
+            set.m_wellFormed = false;
+            break;
+        }
+
+        QssRule rule;
+        const QStringList selectorParts = splitTopLevel(text.mid(pos, open - pos), QLatin1Char(','));
+        QStringList selectorTexts;
+        for (const QString &part : selectorParts) {
+            if (part.trimmed().isEmpty()) {
+                continue;
+            }
+            QssSelector selector = parseSelector(part);
+            selectorTexts << selector.text;
+            rule.selectors.append(selector);
+        }
+        rule.selectorText = selectorTexts.join(QLatin1String(", "));
+
+        QStringList declarations;
+        const QStringList declarationParts = splitTopLevel(text.mid(open + 1, close - open - 1),
+                                                           QLatin1Char(';'));
+        for (const QString &part : declarationParts) {
+            const QString declaration = part.trimmed();
+            if (declaration.isEmpty()) {
+                continue;
+            }
+            const int colon = declaration.indexOf(QLatin1Char(':'));
+            if (colon <= 0) {
+                set.m_wellFormed = false;
+                continue;
+            }
+            const QString name = declaration.left(colon).trimmed().toLower();
+            declarations << name + QLatin1String(": ") + declaration.mid(colon + 1).simplified();
+            rule.propertyNames << name;
+        }
+        rule.declarations = declarations.join(QLatin1String("; "));
+
+        if (rule.selectors.isEmpty()) {
+            set.m_wellFormed = false;
+        } else {
+            set.m_rules.append(rule);
+        }
+
+        pos = close + 1;
+    }
+
+    return set;
+}
+
+QssRuleSet::Diff QssRuleSet::diff(const QssRuleSet &from, const QssRuleSet &to)
+{
+    Diff result;
+
+    if (!from.m_wellFormed || !to.m_wellFormed) {
+        result.requiresFullRestyle = true;
+        return result;
+    }
+
+    // Rules are identified by selector text plus occurrence, so a selector
+    // repeated in the document keeps a stable identity for each repetition
+    auto keysOf = [](const QssRuleSet &set) {
+        QStringList keys;
+        QHash<QString, int> occurrences;
+        keys.reserve(set.m_rules.size());
+        for (const QssRule &rule : set.m_rules) {
+            const int occurrence = occurrences[rule.selectorText]++;
+            keys << rule.selectorText + QLatin1Char('\n') + QString::number(occurrence);
+        }
+        return keys;
+    };
+
+    const QStringList fromKeys = keysOf(from);
+    const QStringList toKeys = keysOf(to);
+
+    QHash<QString, int> toIndex;
+    toIndex.reserve(toKeys.size());
+    for (int i = 0; i < toKeys.size(); ++i) {
+        toIndex.insert(toKeys.at(i), i);
+    }
+
+    QSet<QString> fromKeySet;
+    int previousIndex = -1;
+    for (int i = 0; i < fromKeys.size(); ++i) {
+        fromKeySet.insert(fromKeys.at(i));
+
+        const auto it = toIndex.constFind(fromKeys.at(i));
+        if (it == toIndex.constEnd() || it.value() < previousIndex) {
+            // Removed or reordered rules change the cascade for widgets
+            // that no new rule mentions
+            result.requiresFullRestyle = true;
+            return result;
+        }
+        previousIndex = it.value();
+
+        const QssRule &oldRule = from.m_rules.at(i);
+        const QssRule &newRule = to.m_rules.at(it.value());
+        if (oldRule.declarations == newRule.declarations) {
+            continue;
+        }
+        for (const QString &property : oldRule.propertyNames) {
+            if (!newRule.propertyNames.contains(property)) {
+                result.requiresFullRestyle = true;
+                return result;
+            }
+        }
+        result.changedRules.append(it.value());
+    }
+
+    for (int i = 0; i < toKeys.size(); ++i) {
+        if (!fromKeySet.contains(toKeys.at(i))) {
+            result.changedRules.append(i);
+        }
+    }
+    std::sort(result.changedRules.begin(), result.changedRules.end());
+
+    return result;
+}
+
+QString QssRuleSet::normalize(const QString &qss)
+{
+    const QString text = stripComments(qss);
+    QString result;
+    result.reserve(text.size());
+
+    int depth = 0;
+    QChar quote;
+    bool pendingSpace = false;
+
+    // Whitespace next to these is insignificant; ':' only inside blocks,
+    // since "QDialog :hover" and "QDialog:hover" select different widgets
+    auto isSeparator = [&depth](QChar c) {
+        return c == QLatin1Char('{') || c == QLatin1Char('}') || c == QLatin1Char(',')
+            || c == QLatin1Char(';') || c == QLatin1Char('>')
+            || (depth > 0 && c == QLatin1Char(':'));
+    };
+
+    for (int i = 0; i < text.size(); ++i) {
+        const QChar c = text.at(i);
+        if (!quote.isNull()) {
+            result += c;
+            if (c == QLatin1Char('\\') && i + 1 < text.size()) {
+                result += text.at(++i);
+            } else if (c == quote) {
+                quote = QChar();
+            }
+            continue;
+        }
+
+        if (c.isSpace()) {
+            pendingSpace = true;
+            continue;
+        }
+        if (pendingSpace) {
+            if (!result.isEmpty() && !isSeparator(result.back()) && !isSeparator(c)) {
+                result += QLatin1Char(' ');
+            }
+            pendingSpace = false;
+        }
+
+        if (c == QLatin1Char('{')) {
+            ++depth;
+        } else if (c == QLatin1Char('}')) {
+            if (result.endsWith(QLatin1Char(';'))) {
+                result.chop(1);
+            }
+            if (depth > 0) {
+                --depth;
+            }
+        } else if (c == QLatin1Char('"') || c == QLatin1Char('\'')) {
+            quote = c;
+        }
+        result += c;
+    }
+
+    return result;
+}
+
+const QVector<QssRule> &QssRuleSet::rules() const
+{
+    return m_rules;
+}
+
+bool QssRuleSet::isWellFormed() const
+{
+    return m_wellFormed;
+}
+
+bool QssRuleSet::isEmpty() const
+{
+    return m_rules.isEmpty();
+}
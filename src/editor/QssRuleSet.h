@@ -0,0 +1,174 @@
+#ifndef QSSRULESET_H
+#define QSSRULESET_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+class QWidget;
+
+/**
+ * @brief A single selector of a QSS rule, with its subject compound decoded.
+ *
+ * The subject is the last compound selector (the part that names the widget
+ * the rule is applied to). Only its type, .class and #objectName parts are
+ * decoded; pseudo-states, sub-controls and attribute selectors are kept in
+ * the text but ignored for matching, so matching is a conservative superset.
+ */
+struct QssSelector
+{
+    /**
+     * @brief Normalized selector text (whitespace collapsed).
+     */
+    QString text;
+
+    /**
+     * @brief Type selector of the subject (e.g., "QPushButton"), or empty.
+     *
+     * Matches the named class and all of its subclasses.
+     */
+    QString typeName;
+
+    /**
+     * @brief Class selector of the subject (e.g., ".QPushButton"), without the dot.
+     *
+     * Matches the named class exactly, not its subclasses.
+     */
+    QString className;
+
+    /**
+     * @brief ID selector of the subject (e.g., "#okButton"), without the hash.
+     */
+    QString objectName;
+
+    /**
+     * @brief Offset in text where subject qualifiers can be appended.
+     *
+     * Points just past the type/class/ID/attribute part of the subject,
+     * i.e. before any pseudo-state or sub-control.
+     */
+    int subjectEnd = 0;
+
+    /**
+     * @brief Returns whether the subject names a type, class or object name.
+     *
+     * Universal selectors ("*", ":hover", "QDialog *") are not targetable.
+     */
+    bool isTargetable() const;
+
+    /**
+     * @brief Returns whether the subject may match the given widget.
+     * @param widget The widget to test.
+     * @return true if every type, class and ID part of the subject matches.
+     *         Subjects without such parts (e.g. "*") match any widget.
+     */
+    bool mayMatch(const QWidget *widget) const;
+};
+
+/**
+ * @brief A QSS rule: one or more selectors and a declaration block.
+ */
+struct QssRule
+{
+    /**
+     * @brief The comma-separated selectors of the rule.
+     */
+    QVector<QssSelector> selectors;
+
+    /**
+     * @brief Normalized selector list, used as the rule's identity.
+     */
+    QString selectorText;
+
+    /**
+     * @brief Normalized declarations ("name: value; ..."), without braces.
+     */
+    QString declarations;
+
+    /**
+     * @brief Property names declared in the block, in declaration order.
+     */
+    QStringList propertyNames;
+};
+
+/**
+ * @brief A stylesheet parsed into rules for comparison between applies.
+ *
+ * QssRuleSet performs a lightweight structural parse of a QSS document:
+ * comments are dropped, whitespace is normalized and every rule is split
+ * into selectors and declarations. It is not a validating parser; content
+ * that does not form "selectors { declarations }" is reported through
+ * isWellFormed() so callers can fall back to a full restyle.
+ */
+class QssRuleSet
+{
+public:
+    /**
+     * @brief Result of comparing two rule sets.
+     */
+    struct Diff
+    {
+        /**
+         * @brief Indices (into the new set) of added or modified rules.
+         */
+        QVector<int> changedRules;
+
+        /**
+         * @brief True if the change cannot be expressed by overriding rules.
+         *
+         * Set when rules or properties were removed, rules were reordered
+         * or either document is not well formed. Removing a declaration
+         * cannot be undone by adding more specific rules, so such changes
+         * require the whole document to be re-applied.
+         */
+        bool requiresFullRestyle = false;
+    };
+
+    /**
+     * @brief Parses a QSS document.
+     * @param qss The stylesheet text.
+     * @return The parsed rule set.
+     */
+    static QssRuleSet parse(const QString &qss);
+
+    /**
+     * @brief Compares two rule sets.
+     * @param from The previously applied rules.
+     * @param to The rules about to be applied.
+     * @return The rules of to that differ from from.
+     */
+    static Diff diff(const QssRuleSet &from, const QssRuleSet &to);
+
+    /**
+     * @brief Returns a canonical form of a QSS document.
+     * @param qss The stylesheet text.
+     * @return The text without comments and insignificant whitespace.
+     *
+     * Two documents that differ only in comments, indentation, line breaks
+     * or a trailing semicolon in a block normalize to the same string.
+     * Whitespace that is significant (descendant combinators, values such
+     * as "1px solid") and quoted strings are preserved.
+     */
+    static QString normalize(const QString &qss);
+
+    /**
+     * @brief Returns the parsed rules in document order.
+     */
+    const QVector<QssRule> &rules() const;
+
+    /**
+     * @brief Returns whether the whole document parsed as rules.
+     */
+    bool isWellFormed() const;
+
+    /**
+     * @brief Returns whether the set contains no rules.
+     */
+    bool isEmpty() const;
+
+private:
+    QVector<QssRule> m_rules;
+    bool m_wellFormed = true;
+};
+
+#endif // QSSRULESET_H
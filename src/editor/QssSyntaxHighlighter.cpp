@@ -1,15 +1,289 @@
 #include "QssSyntaxHighlighter.h"
 
+#include <QHash>
+#include <QTextBlock>
+#include <QTextDocument>
+#include <QTextLayout>
+#include <QTimer>
+
+namespace {
+
+/**
+ * @brief Records the formatting generation a block was highlighted in.
+ */
+class HighlightData : public QTextBlockUserData
+{
+public:
+    explicit HighlightData(int generation) : generation(generation) {}
+
+    int generation;
+};
+
+/**
+ * @brief Categories a keyword belongs to; a word may be in several.
+ */
+enum KeywordFlag {
+    WidgetTypeKeyword = 0x01,
+    PropertyKeyword = 0x02,
+    ValueKeyword = 0x04,
+    PseudoStateKeyword = 0x08,
+    SubControlKeyword = 0x10,
+    FunctionKeyword = 0x20,     ///< Value functions such as rgb() or qlineargradient()
+    UrlKeyword = 0x40
+};
+
+void addKeywords(QHash<QString, int> &table, const char *const words[], int flag)
+{
+    for (int i = 0; words[i]; ++i) {
+        table[QLatin1String(words[i])] |= flag;
+    }
+}
+
+QHash<QString, int> buildKeywordTable()
+{
+    // Complete lists from the Qt style sheet reference
+    static const char *const widgetTypes[] = {
+        "QAbstractScrollArea", "QAbstractSpinBox", "QAbstractItemView",
+        "QCheckBox", "QColumnView", "QComboBox",
+        "QDateEdit", "QDateTimeEdit", "QDialog", "QDialogButtonBox",
+        "QDockWidget", "QDoubleSpinBox",
+        "QFrame", "QGroupBox", "QHeaderView",
+        "QLabel", "QLineEdit", "QListView", "QListWidget",
+        "QMainWindow", "QMenu", "QMenuBar", "QMessageBox",
+        "QProgressBar", "QPushButton", "QRadioButton",
+        "QScrollArea", "QScrollBar", "QSizeGrip", "QSlider",
+        "QSpinBox", "QSplitter", "QStatusBar",
+        "QTabBar", "QTabWidget", "QTableView", "QTableWidget",
+        "QTextEdit", "QTimeEdit", "QToolBar", "QToolBox",
+        "QToolButton", "QToolTip", "QTreeView", "QTreeWidget",
+        "QWidget", "QAbstractButton", "QPlainTextEdit",
+        "QCalendarWidget", "QFontComboBox", "QMdiArea", "QMdiSubWindow",
+        nullptr
+    };
+
+    static const char *const properties[] = {
+        "background", "background-color", "background-image", "background-repeat",
+        "background-position", "background-attachment", "background-clip", "background-origin",
+        "alternate-background-color", "accent-color",
+        "border", "border-color", "border-width", "border-style", "border-radius", "border-image",
+        "border-top", "border-right", "border-bottom", "border-left",
+        "border-top-color", "border-right-color", "border-bottom-color", "border-left-color",
+        "border-top-width", "border-right-width", "border-bottom-width", "border-left-width",
+        "border-top-style", "border-right-style", "border-bottom-style", "border-left-style",
+        "border-top-left-radius", "border-top-right-radius",
+        "border-bottom-left-radius", "border-bottom-right-radius",
+        "margin", "margin-top", "margin-right", "margin-bottom", "margin-left",
+        "padding", "padding-top", "padding-right", "padding-bottom", "padding-left",
+        "spacing", "min-width", "min-height", "max-width", "max-height", "width", "height",
+        "font", "font-family", "font-size", "font-weight", "font-style",
+        "color", "selection-color", "selection-background-color",
+        "placeholder-text-color", "gridline-color",
+        "position", "top", "left", "right", "bottom",
+        "subcontrol-origin", "subcontrol-position",
+        "image", "image-position", "icon", "icon-size", "opacity",
+        "text-align", "text-decoration", "letter-spacing", "word-spacing",
+        "outline", "outline-color", "outline-offset", "outline-style", "outline-radius",
+        "outline-bottom-left-radius", "outline-bottom-right-radius",
+        "outline-top-left-radius", "outline-top-right-radius",
+        "lineedit-password-character", "lineedit-password-mask-delay",
+        "messagebox-text-interaction-flags", "show-decoration-selected",
+        "button-layout", "dialogbuttonbox-buttons-have-icons",
+        "titlebar-show-tooltips-on-buttons", "widget-animation-duration",
+        "paint-alternating-row-colors-for-empty-area",
+        "-qt-background-role", "-qt-style-features",
+        nullptr
+    };
+
+    // Named colors are matched case-insensitively, so they are stored lower case
+    static const char *const values[] = {
+        "transparent", "black", "white", "red", "green", "blue", "yellow", "cyan", "magenta",
+        "gray", "grey", "darkgray", "darkgrey", "lightgray", "lightgrey",
+        "darkred", "darkgreen", "darkblue", "darkcyan", "darkmagenta", "darkyellow",
+        "orange", "pink", "purple", "brown", "navy", "teal", "olive", "maroon", "aqua",
+        "fuchsia", "lime", "silver",
+        "none", "solid", "dashed", "dotted", "double", "groove", "ridge", "inset", "outset",
+        "dot-dash", "dot-dot-dash",
+        "normal", "bold", "italic", "oblique", "underline", "overline", "line-through",
+        "relative", "absolute", "top", "bottom", "left", "right", "center",
+        "margin", "border", "padding", "content",
+        "repeat", "repeat-x", "repeat-y", "no-repeat",
+        "scroll", "fixed",
+        nullptr
+    };
+
+    static const char *const pseudoStates[] = {
+        "active", "adjoins-item", "alternate", "bottom", "checked", "closable",
+        "closed", "default", "disabled", "editable", "edit-focus", "enabled",
+        "exclusive", "first", "flat", "floatable", "focus", "has-children",
+        "has-siblings", "horizontal", "hover", "indeterminate", "last", "left",
+        "maximized", "middle", "minimized", "movable", "no-frame", "non-exclusive",
+        "off", "on", "only-one", "open", "next-selected", "pressed",
+        "previous-selected", "read-only", "right", "selected", "top",
+        "unchecked", "vertical", "window",
+        nullptr
+    };
+
+    static const char *const subControls[] = {
+        "add-line", "add-page", "branch", "chunk", "close-button", "corner",
+        "down-arrow", "down-button", "drop-down", "float-button", "groove",
+        "indicator", "handle", "icon", "item", "left-arrow", "left-corner",
+        "menu-arrow", "menu-button", "menu-indicator", "right-arrow", "pane",
+        "right-corner", "scroller", "section", "separator", "sub-line",
+        "sub-page", "tab", "tab-bar", "tear", "tearoff", "text", "title",
+        "up-arrow", "up-button",
+        nullptr
+    };
+
+    static const char *const functions[] = {
+        "rgb", "rgba", "hsv", "hsva", "hsl", "hsla",
+        "qlineargradient", "qradialgradient", "qconicalgradient", "palette",
+        nullptr
+    };
+
+    static const char *const urls[] = { "url", nullptr };
+
+    QHash<QString, int> table;
+    table.reserve(400);
+    addKeywords(table, widgetTypes, WidgetTypeKeyword);
+    addKeywords(table, properties, PropertyKeyword);
+    addKeywords(table, values, ValueKeyword);
+    addKeywords(table, pseudoStates, PseudoStateKeyword);
+    addKeywords(table, subControls, SubControlKeyword);
+    addKeywords(table, functions, FunctionKeyword);
+    addKeywords(table, urls, UrlKeyword);
+    return table;
+}
+
+/**
+ * @brief Looks up a word without copying it.
+ * @return The KeywordFlag bits of the word, 0 if it is not a keyword.
+ */
+int keywordFlags(const QChar *word, int length)
+{
+    static const QHash<QString, int> table = buildKeywordTable();
+    if (length <= 0) {
+        return 0;
+    }
+    return table.value(QString::fromRawData(word, length), 0);
+}
+
+/**
+ * @brief Returns whether a word is a value keyword in any letter case.
+ */
+bool isNamedColor(const QChar *word, int length)
+{
+    bool hasUpper = false;
+    for (int i = 0; i < length && !hasUpper; ++i) {
+        hasUpper = word[i].isUpper();
+    }
+    if (!hasUpper) {
+        return false;
+    }
+    const QString lower = QString(word, length).toLower();
+    return keywordFlags(lower.constData(), lower.size()) & ValueKeyword;
+}
+
+bool isIdentifierStart(QChar c)
+{
+    return c.isLetter() || c == QLatin1Char('_');
+}
+
+bool isIdentifierChar(QChar c)
+{
+    return c.isLetterOrNumber() || c == QLatin1Char('_') || c == QLatin1Char('-');
+}
+
+bool isHexDigit(QChar c)
+{
+    const ushort u = c.unicode();
+    return (u >= '0' && u <= '9') || (u >= 'a' && u <= 'f') || (u >= 'A' && u <= 'F');
+}
+
+int identifierEnd(const QChar *data, int from, int length)
+{
+    int i = from;
+    while (i < length && isIdentifierChar(data[i])) {
+        ++i;
+    }
+    return i;
+}
+
+/**
+ * @brief Returns the end of a ${name} reference starting at from, or from
+ *        if there is no valid reference there.
+ */
+int variableEnd(const QChar *data, int from, int length)
+{
+    int i = from + 2;
+    const auto isNameStart = [](QChar c) {
+        const ushort u = c.unicode();
+        return (u >= 'a' && u <= 'z') || (u >= 'A' && u <= 'Z') || u == '_';
+    };
+    if (i >= length || !isNameStart(data[i])) {
+        return from;
+    }
+    ++i;
+    while (i < length) {
+        const ushort u = data[i].unicode();
+        if (!isNameStart(data[i]) && !(u >= '0' && u <= '9') && u != '-') {
+            break;
+        }
+        ++i;
+    }
+    return i < length && data[i] == QLatin1Char('}') ? i + 1 : from;
+}
+
+/**
+ * @brief Returns the end of a number with an optional unit (px, pt, em, ex, %).
+ */
+int numberEnd(const QChar *data, int from, int length)
+{
+    int i = from;
+    if (data[i] == QLatin1Char('-')) {
+        ++i;
+    }
+    while (i < length && data[i].isDigit()) {
+        ++i;
+    }
+    if (i + 1 < length && data[i] == QLatin1Char('.') && data[i + 1].isDigit()) {
+        i += 2;
+        while (i < length && data[i].isDigit()) {
+            ++i;
+        }
+    }
+
+    if (i < length && data[i] == QLatin1Char('%')) {
+        return i + 1;
+    }
+    static const char *const units[] = { "px", "pt", "em", "ex" };
+    for (const char *unit : units) {
+        if (i + 1 < length && data[i] == QLatin1Char(unit[0]) && data[i + 1] == QLatin1Char(unit[1])
+            && (i + 2 == length || !isIdentifierChar(data[i + 2]))) {
+            return i + 2;
+        }
+    }
+    return i;
+}
+
+} // namespace
+
 QssSyntaxHighlighter::QssSyntaxHighlighter(QTextDocument *parent)
     : QSyntaxHighlighter(parent)
     , m_colorScheme(DarkScheme)
+    , m_lazy(false)
+    , m_generation(0)
+    , m_firstVisibleBlock(0)
+    , m_lastVisibleBlock(-1)
+    , m_idleTimer(nullptr)
+    , m_sliceBudgetMs(IDLE_SLICE_MS)
+    , m_inSlice(false)
 {
     setupFormats();
-    setupRules();
 
-    // Multi-line comment patterns
-    m_commentStartExpression = QRegularExpression(QStringLiteral("/\\*"));
-    m_commentEndExpression = QRegularExpression(QStringLiteral("\\*/"));
+    m_idleTimer = new QTimer(this);
+    m_idleTimer->setSingleShot(true);
+    m_idleTimer->setInterval(0);
+    connect(m_idleTimer, &QTimer::timeout, this, &QssSyntaxHighlighter::onIdleTimeout);
 }
 
 void QssSyntaxHighlighter::setColorScheme(ColorScheme scheme)
@@ -17,7 +291,161 @@ void QssSyntaxHighlighter::setColorScheme(ColorScheme scheme)
     if (m_colorScheme != scheme) {
         m_colorScheme = scheme;
         setupFormats();
-        rehighlight();
+        if (m_lazy && document()) {
+            // Every block is out of date; redo the visible ones now and
+            // queue the whole document
+            ++m_generation;
+            highlightVisibleBlocks();
+            scheduleFrom(document()->firstBlock());
+        } else {
+            rehighlight();
+        }
+    }
+}
+
+void QssSyntaxHighlighter::setLazyHighlighting(bool enabled)
+{
+    if (m_lazy == enabled) {
+        return;
+    }
+    if (!enabled) {
+        highlightPendingBlocks();
+    }
+    m_lazy = enabled;
+}
+
+void QssSyntaxHighlighter::setVisibleBlockRange(int firstBlock, int lastBlock)
+{
+    m_firstVisibleBlock = firstBlock;
+    m_lastVisibleBlock = lastBlock;
+    if (m_lazy) {
+        highlightVisibleBlocks();
+    }
+}
+
+bool QssSyntaxHighlighter::isHighlightingPending() const
+{
+    return !m_resumeCursor.isNull();
+}
+
+void QssSyntaxHighlighter::highlightPendingBlocks()
+{
+    if (!isHighlightingPending()) {
+        return;
+    }
+    m_idleTimer->stop();
+    processPendingBlocks(-1);
+    emit highlightingFinished();
+}
+
+void QssSyntaxHighlighter::onIdleTimeout()
+{
+    if (processPendingBlocks(IDLE_SLICE_MS)) {
+        m_idleTimer->start();
+    } else {
+        emit highlightingFinished();
+    }
+}
+
+bool QssSyntaxHighlighter::processPendingBlocks(int budgetMs)
+{
+    QTextDocument *doc = document();
+    if (!doc || m_resumeCursor.isNull() || m_resumeCursor.document() != doc) {
+        m_resumeCursor = QTextCursor();
+        return false;
+    }
+
+    m_sliceBudgetMs = budgetMs;
+    m_sliceTimer.start();
+    m_inSlice = true;
+
+    // A block whose state changes makes QSyntaxHighlighter continue with the
+    // next one, so a single rehighlightBlock() call may cover many blocks
+    // until the state settles or the slice runs out
+    QTextBlock block = m_resumeCursor.block();
+    while (block.isValid() && (budgetMs < 0 || m_sliceTimer.elapsed() < budgetMs)) {
+        if (isStale(block)) {
+            rehighlightBlock(block);
+        }
+        block = block.next();
+    }
+
+    m_inSlice = false;
+    if (block.isValid()) {
+        m_resumeCursor = QTextCursor(block);
+        return true;
+    }
+    m_resumeCursor = QTextCursor();
+    return false;
+}
+
+void QssSyntaxHighlighter::highlightVisibleBlocks()
+{
+    QTextDocument *doc = document();
+    if (!doc || m_lastVisibleBlock < m_firstVisibleBlock) {
+        return;
+    }
+
+    QTextBlock block = doc->findBlockByNumber(m_firstVisibleBlock);
+    while (block.isValid() && block.blockNumber() <= m_lastVisibleBlock) {
+        if (isStale(block)) {
+            rehighlightBlock(block);
+        }
+        block = block.next();
+    }
+}
+
+bool QssSyntaxHighlighter::isStale(const QTextBlock &block) const
+{
+    const auto *data = static_cast<const HighlightData *>(block.userData());
+    return !data || data->generation != m_generation;
+}
+
+bool QssSyntaxHighlighter::shouldHighlightNow(int blockNumber) const
+{
+    if (blockNumber >= m_firstVisibleBlock && blockNumber <= m_lastVisibleBlock) {
+        return true;
+    }
+    return m_inSlice && (m_sliceBudgetMs < 0 || m_sliceTimer.elapsed() < m_sliceBudgetMs);
+}
+
+void QssSyntaxHighlighter::scheduleFrom(const QTextBlock &block)
+{
+    if (m_resumeCursor.isNull() || m_resumeCursor.document() != block.document()
+        || block.position() < m_resumeCursor.position()) {
+        m_resumeCursor = QTextCursor(block);
+    }
+    if (!m_inSlice && !m_idleTimer->isActive()) {
+        m_idleTimer->start();
+    }
+}
+
+void QssSyntaxHighlighter::deferBlock()
+{
+    const QTextBlock block = currentBlock();
+
+    // Keep the previous formatting and state so the block does not flash
+    // and QSyntaxHighlighter does not carry on into the next block
+    if (const QTextLayout *layout = block.layout()) {
+        const auto ranges = layout->formats();
+        for (const QTextLayout::FormatRange &range : ranges) {
+            setFormat(range.start, range.length, range.format);
+        }
+    }
+    setCurrentBlockState(currentBlockState());
+
+    if (auto *data = static_cast<HighlightData *>(currentBlockUserData())) {
+        data->generation = -1;
+    }
+    scheduleFrom(block);
+}
+
+void QssSyntaxHighlighter::markHighlighted()
+{
+    if (auto *data = static_cast<HighlightData *>(currentBlockUserData())) {
+        data->generation = m_generation;
+    } else {
+        setCurrentBlockUserData(new HighlightData(m_generation));
     }
 }
 
@@ -100,259 +528,209 @@ void QssSyntaxHighlighter::setupLightFormats()
     m_variableFormat.setFontWeight(QFont::Bold);
 }
 
-void QssSyntaxHighlighter::setupRules()
-{
-    HighlightingRule rule;
-
-    // Sub-controls (must be before selectors to match :: properly)
-    // Complete list from Qt documentation
-    QString subControls = QStringLiteral(
-        "::add-line|::add-page|::branch|::chunk|::close-button|::corner|"
-        "::down-arrow|::down-button|::drop-down|::float-button|::groove|"
-        "::indicator|::handle|::icon|::item|::left-arrow|::left-corner|"
-        "::menu-arrow|::menu-button|::menu-indicator|::right-arrow|::pane|"
-        "::right-corner|::scroller|::section|::separator|::sub-line|"
-        "::sub-page|::tab|::tab-bar|::tear|::tearoff|::text|::title|"
-        "::up-arrow|::up-button"
-    );
-    rule.pattern = QRegularExpression(subControls);
-    rule.format = &m_subControlFormat;
-    m_rules.append(rule);
-
-    // Pseudo-states (must be before selectors)
-    // Complete list from Qt documentation
-    QString pseudoStates = QStringLiteral(
-        ":active|:adjoins-item|:alternate|:bottom|:checked|:closable|"
-        ":closed|:default|:disabled|:editable|:edit-focus|:enabled|"
-        ":exclusive|:first|:flat|:floatable|:focus|:has-children|"
-        ":has-siblings|:horizontal|:hover|:indeterminate|:last|:left|"
-        ":maximized|:middle|:minimized|:movable|:no-frame|:non-exclusive|"
-        ":off|:on|:only-one|:open|:next-selected|:pressed|"
-        ":previous-selected|:read-only|:right|:selected|:top|"
-        ":unchecked|:vertical|:window"
-    );
-    // Match pseudo-states - allow when followed by :: (sub-control) but not single : (another pseudo-state)
-    // (?!:[^:]) means "not followed by a colon that isn't followed by another colon"
-    rule.pattern = QRegularExpression(QStringLiteral("(?<!:)(") + pseudoStates + QStringLiteral(")(?!:[^:])"));
-    rule.format = &m_pseudoStateFormat;
-    m_rules.append(rule);
-
-    // Selectors - Qt widget type names
-    // Common Qt widgets that can be styled
-    QString selectors = QStringLiteral(
-        "\\bQAbstractScrollArea\\b|\\bQAbstractSpinBox\\b|\\bQAbstractItemView\\b|"
-        "\\bQCheckBox\\b|\\bQColumnView\\b|\\bQComboBox\\b|"
-        "\\bQDateEdit\\b|\\bQDateTimeEdit\\b|\\bQDialog\\b|\\bQDialogButtonBox\\b|"
-        "\\bQDockWidget\\b|\\bQDoubleSpinBox\\b|"
-        "\\bQFrame\\b|\\bQGroupBox\\b|\\bQHeaderView\\b|"
-        "\\bQLabel\\b|\\bQLineEdit\\b|\\bQListView\\b|\\bQListWidget\\b|"
-        "\\bQMainWindow\\b|\\bQMenu\\b|\\bQMenuBar\\b|\\bQMessageBox\\b|"
-        "\\bQProgressBar\\b|\\bQPushButton\\b|\\bQRadioButton\\b|"
-        "\\bQScrollArea\\b|\\bQScrollBar\\b|\\bQSizeGrip\\b|\\bQSlider\\b|"
-        "\\bQSpinBox\\b|\\bQSplitter\\b|\\bQStatusBar\\b|"
-        "\\bQTabBar\\b|\\bQTabWidget\\b|\\bQTableView\\b|\\bQTableWidget\\b|"
-        "\\bQTextEdit\\b|\\bQTimeEdit\\b|\\bQToolBar\\b|\\bQToolBox\\b|"
-        "\\bQToolButton\\b|\\bQToolTip\\b|\\bQTreeView\\b|\\bQTreeWidget\\b|"
-        "\\bQWidget\\b|\\bQAbstractButton\\b|\\bQPlainTextEdit\\b|"
-        "\\bQCalendarWidget\\b|\\bQFontComboBox\\b|\\bQMdiArea\\b|\\bQMdiSubWindow\\b"
-    );
-    rule.pattern = QRegularExpression(selectors);
-    rule.format = &m_selectorFormat;
-    m_rules.append(rule);
-
-    // Universal selector
-    rule.pattern = QRegularExpression(QStringLiteral("(?<![\\w#.])\\*(?![\\w])"));
-    rule.format = &m_selectorFormat;
-    m_rules.append(rule);
-
-    // ID selector (#objectName)
-    rule.pattern = QRegularExpression(QStringLiteral("#[a-zA-Z_][a-zA-Z0-9_]*"));
-    rule.format = &m_selectorFormat;
-    m_rules.append(rule);
-
-    // Class selector (.className)
-    rule.pattern = QRegularExpression(QStringLiteral("\\.[A-Z][a-zA-Z0-9]*"));
-    rule.format = &m_selectorFormat;
-    m_rules.append(rule);
-
-    // Property names (inside braces, before colon)
-    // Common QSS properties from documentation
-    QString properties = QStringLiteral(
-        "\\b(background|background-color|background-image|background-repeat|"
-        "background-position|background-attachment|background-clip|background-origin|"
-        "alternate-background-color|accent-color|"
-        "border|border-color|border-width|border-style|border-radius|border-image|"
-        "border-top|border-right|border-bottom|border-left|"
-        "border-top-color|border-right-color|border-bottom-color|border-left-color|"
-        "border-top-width|border-right-width|border-bottom-width|border-left-width|"
-        "border-top-style|border-right-style|border-bottom-style|border-left-style|"
-        "border-top-left-radius|border-top-right-radius|"
-        "border-bottom-left-radius|border-bottom-right-radius|"
-        "margin|margin-top|margin-right|margin-bottom|margin-left|"
-        "padding|padding-top|padding-right|padding-bottom|padding-left|"
-        "spacing|min-width|min-height|max-width|max-height|width|height|"
-        "font|font-family|font-size|font-weight|font-style|"
-        "color|selection-color|selection-background-color|"
-        "placeholder-text-color|gridline-color|"
-        "position|top|left|right|bottom|"
-        "subcontrol-origin|subcontrol-position|"
-        "image|image-position|icon|icon-size|opacity|"
-        "text-align|text-decoration|letter-spacing|word-spacing|"
-        "outline|outline-color|outline-offset|outline-style|outline-radius|"
-        "outline-bottom-left-radius|outline-bottom-right-radius|"
-        "outline-top-left-radius|outline-top-right-radius|"
-        "lineedit-password-character|lineedit-password-mask-delay|"
-        "messagebox-text-interaction-flags|show-decoration-selected|"
-        "button-layout|dialogbuttonbox-buttons-have-icons|"
-        "titlebar-show-tooltips-on-buttons|widget-animation-duration|"
-        "paint-alternating-row-colors-for-empty-area|"
-        "-qt-background-role|-qt-style-features)\\s*:"
-    );
-    rule.pattern = QRegularExpression(properties);
-    rule.format = &m_propertyFormat;
-    m_rules.append(rule);
-
-    // Color values - hex colors
-    rule.pattern = QRegularExpression(QStringLiteral("#[0-9a-fA-F]{3,8}\\b"));
-    rule.format = &m_valueFormat;
-    m_rules.append(rule);
-
-    // Color values - rgb(), rgba(), hsv(), hsva(), hsl(), hsla()
-    rule.pattern = QRegularExpression(QStringLiteral("\\b(rgb|rgba|hsv|hsva|hsl|hsla)\\s*\\([^)]*\\)"));
-    rule.format = &m_valueFormat;
-    m_rules.append(rule);
-
-    // Gradient values - qlineargradient, qradialgradient, qconicalgradient
-    rule.pattern = QRegularExpression(QStringLiteral("\\b(qlineargradient|qradialgradient|qconicalgradient)\\s*\\([^)]*\\)"));
-    rule.format = &m_valueFormat;
-    m_rules.append(rule);
-
-    // URL values
-    rule.pattern = QRegularExpression(QStringLiteral("\\burl\\s*\\([^)]*\\)"));
-    rule.format = &m_stringFormat;
-    m_rules.append(rule);
-
-    // Palette values
-    rule.pattern = QRegularExpression(QStringLiteral("\\bpalette\\s*\\([^)]*\\)"));
-    rule.format = &m_valueFormat;
-    m_rules.append(rule);
-
-    // Named colors (common CSS color names)
-    QString namedColors = QStringLiteral(
-        "\\b(transparent|black|white|red|green|blue|yellow|cyan|magenta|"
-        "gray|grey|darkgray|darkgrey|lightgray|lightgrey|"
-        "darkred|darkgreen|darkblue|darkcyan|darkmagenta|darkyellow|"
-        "orange|pink|purple|brown|navy|teal|olive|maroon|aqua|fuchsia|lime|silver)\\b"
-    );
-    rule.pattern = QRegularExpression(namedColors, QRegularExpression::CaseInsensitiveOption);
-    rule.format = &m_valueFormat;
-    m_rules.append(rule);
-
-    // Border style values
-    QString borderStyles = QStringLiteral(
-        "\\b(none|solid|dashed|dotted|double|groove|ridge|inset|outset|"
-        "dot-dash|dot-dot-dash)\\b"
-    );
-    rule.pattern = QRegularExpression(borderStyles);
-    rule.format = &m_valueFormat;
-    m_rules.append(rule);
-
-    // Font weight/style values
-    QString fontValues = QStringLiteral(
-        "\\b(normal|bold|italic|oblique|underline|overline|line-through)\\b"
-    );
-    rule.pattern = QRegularExpression(fontValues);
-    rule.format = &m_valueFormat;
-    m_rules.append(rule);
-
-    // Position/alignment values
-    QString positionValues = QStringLiteral(
-        "\\b(relative|absolute|top|bottom|left|right|center|"
-        "margin|border|padding|content|"
-        "repeat|repeat-x|repeat-y|no-repeat|"
-        "scroll|fixed)\\b"
-    );
-    rule.pattern = QRegularExpression(positionValues);
-    rule.format = &m_valueFormat;
-    m_rules.append(rule);
-
-    // Numbers with units
-    rule.pattern = QRegularExpression(QStringLiteral("-?\\d+(\\.\\d+)?\\s*(px|pt|em|ex|%)?\\b"));
-    rule.format = &m_numberFormat;
-    m_rules.append(rule);
-
-    // Strings in quotes
-    rule.pattern = QRegularExpression(QStringLiteral("\"[^\"]*\"|'[^']*'"));
-    rule.format = &m_stringFormat;
-    m_rules.append(rule);
-
-    // Variable references - ${variable_name}
-    // Pattern: \$\{[a-zA-Z_][a-zA-Z0-9_-]*\}
-    rule.pattern = QRegularExpression(QStringLiteral("\\$\\{[a-zA-Z_][a-zA-Z0-9_-]*\\}"));
-    rule.format = &m_variableFormat;
-    m_rules.append(rule);
-}
-
 void QssSyntaxHighlighter::highlightBlock(const QString &text)
 {
-    // Apply single-line rules
-    for (const HighlightingRule &rule : qAsConst(m_rules)) {
-        QRegularExpressionMatchIterator matchIterator = rule.pattern.globalMatch(text);
-        while (matchIterator.hasNext()) {
-            QRegularExpressionMatch match = matchIterator.next();
-            setFormat(match.capturedStart(), match.capturedLength(), *rule.format);
-        }
+    if (!m_lazy) {
+        lexBlock(text);
+        return;
     }
 
-    // Handle multi-line comments
-    highlightMultilineComments(text);
+    if (!shouldHighlightNow(currentBlock().blockNumber())) {
+        deferBlock();
+        return;
+    }
+    lexBlock(text);
+    markHighlighted();
 }
 
-void QssSyntaxHighlighter::highlightMultilineComments(const QString &text)
+void QssSyntaxHighlighter::lexBlock(const QString &text)
 {
-    setCurrentBlockState(Normal);
-
-    int startIndex = 0;
-    if (previousBlockState() != InComment) {
-        // Not in a comment from previous block, look for comment start
-        QRegularExpressionMatch startMatch = m_commentStartExpression.match(text);
-        startIndex = startMatch.hasMatch() ? startMatch.capturedStart() : -1;
-    }
-
-    while (startIndex >= 0) {
-        QRegularExpressionMatch endMatch;
-        int searchStart = (previousBlockState() == InComment && startIndex == 0) 
-                          ? 0 
-                          : startIndex + 2;
-        
-        endMatch = m_commentEndExpression.match(text, searchStart);
-        
-        int endIndex = endMatch.hasMatch() ? endMatch.capturedStart() : -1;
-        int commentLength;
-
-        if (endIndex == -1) {
-            // Comment extends to end of block
-            setCurrentBlockState(InComment);
-            commentLength = text.length() - startIndex;
-        } else {
-            // Comment ends in this block
-            commentLength = endIndex - startIndex + endMatch.capturedLength();
+    const int previous = previousBlockState();
+    const int state = previous < 0 ? Normal : previous;
+    bool inComment = state & InComment;
+    bool inValue = state & InValue;
+    int depth = state >> DepthShift;
+
+    const int length = text.size();
+    const QChar *data = text.constData();
+    int i = 0;
+
+    while (i < length) {
+        if (inComment) {
+            const int end = text.indexOf(QLatin1String("*/"), i);
+            const int commentEnd = end < 0 ? length : end + 2;
+            setFormat(i, commentEnd - i, m_commentFormat);
+            inComment = end < 0;
+            i = commentEnd;
+            continue;
         }
 
-        setFormat(startIndex, commentLength, m_commentFormat);
+        const QChar c = data[i];
+        const QChar next = i + 1 < length ? data[i + 1] : QChar();
 
-        // Look for next comment start
-        QRegularExpressionMatch nextStartMatch = m_commentStartExpression.match(text, startIndex + commentLength);
-        startIndex = nextStartMatch.hasMatch() ? nextStartMatch.capturedStart() : -1;
-    }
+        if (c == QLatin1Char('/') && next == QLatin1Char('*')) {
+            const int end = text.indexOf(QLatin1String("*/"), i + 2);
+            const int commentEnd = end < 0 ? length : end + 2;
+            setFormat(i, commentEnd - i, m_commentFormat);
+            inComment = end < 0;
+            i = commentEnd;
+            continue;
+        }
 
-    // If we started in a comment and didn't find an end, we're still in a comment
-    if (previousBlockState() == InComment && currentBlockState() != InComment) {
-        // Check if we actually found an end
-        QRegularExpressionMatch endMatch = m_commentEndExpression.match(text);
-        if (!endMatch.hasMatch()) {
-            setCurrentBlockState(InComment);
-            setFormat(0, text.length(), m_commentFormat);
+        if (c == QLatin1Char('"') || c == QLatin1Char('\'')) {
+            const int end = text.indexOf(c, i + 1);
+            const int stringEnd = end < 0 ? length : end + 1;
+            setFormat(i, stringEnd - i, m_stringFormat);
+            i = stringEnd;
+            continue;
+        }
+
+        if (c == QLatin1Char('$') && next == QLatin1Char('{')) {
+            const int end = variableEnd(data, i, length);
+            if (end > i) {
+                setFormat(i, end - i, m_variableFormat);
+                i = end;
+                continue;
+            }
+            ++i;
+            continue;
+        }
+
+        if (c == QLatin1Char('{')) {
+            depth = qMin(depth + 1, int(MaxDepth));
+            inValue = false;
+            ++i;
+            continue;
+        }
+        if (c == QLatin1Char('}')) {
+            if (depth > 0) {
+                --depth;
+            }
+            inValue = false;
+            ++i;
+            continue;
         }
+        if (c == QLatin1Char(';')) {
+            inValue = false;
+            ++i;
+            continue;
+        }
+
+        if (c == QLatin1Char(':') && !inValue) {
+            if (next == QLatin1Char(':')) {
+                const int end = identifierEnd(data, i + 2, length);
+                if (keywordFlags(data + i + 2, end - i - 2) & SubControlKeyword) {
+                    setFormat(i, end - i, m_subControlFormat);
+                }
+                i = qMax(end, i + 2);
+                continue;
+            }
+            if (depth == 0) {
+                const int nameStart = next == QLatin1Char('!') ? i + 2 : i + 1;
+                const int end = identifierEnd(data, nameStart, length);
+                if (keywordFlags(data + nameStart, end - nameStart) & PseudoStateKeyword) {
+                    setFormat(i, end - i, m_pseudoStateFormat);
+                    i = end;
+                    continue;
+                }
+            } else {
+                // Colon after a property name this highlighter does not know
+                inValue = true;
+            }
+            ++i;
+            continue;
+        }
+
+        if (c == QLatin1Char('#')) {
+            if (inValue) {
+                int end = i + 1;
+                while (end < length && isHexDigit(data[end])) {
+                    ++end;
+                }
+                const int digits = end - i - 1;
+                if (digits >= 3 && digits <= 8 && (end == length || !isIdentifierChar(data[end]))) {
+                    setFormat(i, end - i, m_valueFormat);
+                }
+                i = qMax(end, i + 1);
+                continue;
+            }
+            const int end = identifierEnd(data, i + 1, length);
+            if (end > i + 1) {
+                setFormat(i, end - i, m_selectorFormat);
+            }
+            i = qMax(end, i + 1);
+            continue;
+        }
+
+        if (c == QLatin1Char('.') && !inValue && next.isUpper()) {
+            const int end = identifierEnd(data, i + 1, length);
+            setFormat(i, end - i, m_selectorFormat);
+            i = end;
+            continue;
+        }
+
+        if (c == QLatin1Char('*') && !inValue && depth == 0) {
+            setFormat(i, 1, m_selectorFormat);
+            ++i;
+            continue;
+        }
+
+        if (c.isDigit()
+            || ((c == QLatin1Char('-') || c == QLatin1Char('.')) && next.isDigit())) {
+            const int end = numberEnd(data, i, length);
+            setFormat(i, end - i, m_numberFormat);
+            i = end;
+            continue;
+        }
+
+        if (isIdentifierStart(c) || (c == QLatin1Char('-') && isIdentifierStart(next))) {
+            const int end = identifierEnd(data, i + 1, length);
+            const int flags = keywordFlags(data + i, end - i);
+
+            int after = end;
+            while (after < length && data[after].isSpace()) {
+                ++after;
+            }
+            const QChar following = after < length ? data[after] : QChar();
+
+            // Functional values are formatted through their closing parenthesis
+            if (following == QLatin1Char('(') && (flags & (FunctionKeyword | UrlKeyword))) {
+                const int close = text.indexOf(QLatin1Char(')'), after);
+                const int callEnd = close < 0 ? length : close + 1;
+                setFormat(i, callEnd - i, (flags & UrlKeyword) ? m_stringFormat : m_valueFormat);
+                i = callEnd;
+                continue;
+            }
+
+            if (!inValue) {
+                if ((flags & PropertyKeyword) && following == QLatin1Char(':')
+                    && (depth > 0 || !(flags & WidgetTypeKeyword))) {
+                    setFormat(i, end - i, m_propertyFormat);
+                    inValue = true;
+                    i = after + 1;
+                    continue;
+                }
+                if (depth == 0 && (flags & WidgetTypeKeyword)) {
+                    setFormat(i, end - i, m_selectorFormat);
+                }
+            } else if (flags & ValueKeyword) {
+                setFormat(i, end - i, m_valueFormat);
+            } else if (isNamedColor(data + i, end - i)) {
+                setFormat(i, end - i, m_valueFormat);
+            }
+            i = end;
+            continue;
+        }
+
+        ++i;
+    }
+
+    int newState = qMin(depth, int(MaxDepth)) << DepthShift;
+    if (inComment) {
+        newState |= InComment;
+    }
+    if (inValue) {
+        newState |= InValue;
     }
+    setCurrentBlockState(newState);
 }
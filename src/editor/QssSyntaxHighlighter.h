@@ -3,8 +3,11 @@
 
 #include <QSyntaxHighlighter>
 #include <QTextCharFormat>
-#include <QRegularExpression>
-#include <QVector>
+#include <QTextCursor>
+#include <QElapsedTimer>
+
+class QTimer;
+class QTextBlock;
 
 /**
  * @brief Syntax highlighter for QSS (Qt Style Sheets) code.
@@ -18,6 +21,18 @@
  * - Comments (block comments)
  * 
  * Supports both light and dark color schemes.
+ *
+ * Each block is scanned once by a hand-written lexer. Identifiers are
+ * classified through hashed keyword tables according to their context:
+ * widget types in selectors, property names before a colon inside a rule,
+ * and value keywords after it. The block state carries comment, rule and
+ * declaration context to the next block.
+ *
+ * In lazy mode only the blocks in the visible range are highlighted as the
+ * document changes. Every other block keeps its previous formatting and is
+ * queued; queued blocks are highlighted from the top of the document in
+ * time-sliced chunks whenever the event loop is idle, so comment and rule
+ * state reaches every block even though visible blocks were formatted first.
  * 
  * Reference: qss-docs.md for complete QSS syntax specification.
  */
@@ -86,6 +101,49 @@ public:
      */
     QTextCharFormat variableFormat() const { return m_variableFormat; }
 
+    /**
+     * @brief Enables or disables lazy highlighting.
+     * @param enabled true to highlight only visible blocks immediately.
+     *
+     * Disabling lazy mode highlights all queued blocks before returning.
+     */
+    void setLazyHighlighting(bool enabled);
+
+    /**
+     * @brief Returns whether lazy highlighting is enabled.
+     */
+    bool isLazyHighlighting() const { return m_lazy; }
+
+    /**
+     * @brief Sets the blocks currently shown in the editor.
+     * @param firstBlock Number of the first visible block.
+     * @param lastBlock Number of the last visible block.
+     *
+     * In lazy mode, queued blocks in the range are highlighted immediately.
+     */
+    void setVisibleBlockRange(int firstBlock, int lastBlock);
+
+    /**
+     * @brief Returns whether blocks are queued for idle highlighting.
+     */
+    bool isHighlightingPending() const;
+
+    /**
+     * @brief Highlights all queued blocks synchronously.
+     */
+    void highlightPendingBlocks();
+
+    /**
+     * @brief Duration of one idle highlighting chunk in milliseconds.
+     */
+    static constexpr int IDLE_SLICE_MS = 8;
+
+signals:
+    /**
+     * @brief Emitted when the last queued block has been highlighted.
+     */
+    void highlightingFinished();
+
 protected:
     /**
      * @brief Highlights a single block of text.
@@ -93,23 +151,24 @@ protected:
      */
     void highlightBlock(const QString &text) override;
 
+private slots:
+    void onIdleTimeout();
+
 private:
-    /**
-     * @brief Highlighting rule structure.
-     */
-    struct HighlightingRule {
-        QRegularExpression pattern;
-        QTextCharFormat *format;  // Pointer to allow format updates
-    };
+    void lexBlock(const QString &text);
+    void deferBlock();
+    void markHighlighted();
+    bool isStale(const QTextBlock &block) const;
+    bool shouldHighlightNow(int blockNumber) const;
+    void scheduleFrom(const QTextBlock &block);
+    bool processPendingBlocks(int budgetMs);
+    void highlightVisibleBlocks();
 
     void setupFormats();
     void setupDarkFormats();
     void setupLightFormats();
-    void setupRules();
-    void highlightMultilineComments(const QString &text);
 
     ColorScheme m_colorScheme;
-    QVector<HighlightingRule> m_rules;
 
     // Text formats for different syntax elements
     QTextCharFormat m_selectorFormat;
@@ -122,15 +181,26 @@ private:
     QTextCharFormat m_numberFormat;
     QTextCharFormat m_variableFormat;
 
-    // Multi-line comment handling
-    QRegularExpression m_commentStartExpression;
-    QRegularExpression m_commentEndExpression;
-
-    // Block state for multi-line comments
+    // Block state carried from one block to the next; the brace depth is
+    // stored above the flag bits
     enum BlockState {
         Normal = 0,
-        InComment = 1
+        InComment = 0x1,        ///< Inside an unterminated comment
+        InValue = 0x2           ///< After a property colon, before ';'
     };
+    static constexpr int DepthShift = 2;
+    static constexpr int MaxDepth = 0xFFFF;
+
+    // Lazy highlighting
+    bool m_lazy;
+    int m_generation;           ///< Bumped when every block must be redone
+    int m_firstVisibleBlock;
+    int m_lastVisibleBlock;
+    QTextCursor m_resumeCursor; ///< First queued block; follows edits
+    QTimer *m_idleTimer;
+    QElapsedTimer m_sliceTimer;
+    int m_sliceBudgetMs;
+    bool m_inSlice;
 };
 
 #endif // QSSSYNTAXHIGHLIGHTER_H
@@ -9,6 +9,7 @@ namespace {
     const QString KeyBaseStyle = QStringLiteral("appearance/baseStyle");
     const QString KeyRecentProjects = QStringLiteral("recentProjects");
     const QString KeyPluginDirectory = QStringLiteral("plugins/directory");
+    const QString KeyPluginWidgetBudget = QStringLiteral("plugins/widgetBudgetMs");
 }
 
 SettingsManager::SettingsManager(QObject *parent)
@@ -108,6 +109,22 @@ QString SettingsManager::defaultPluginDirectory() const
     return QDir(appDataPath).filePath(QStringLiteral("plugins"));
 }
 
+QString SettingsManager::pluginCacheFile() const
+{
+    QString appDataPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    return QDir(appDataPath).filePath(QStringLiteral("plugincache.json"));
+}
+
+int SettingsManager::pluginWidgetBudgetMs() const
+{
+    return m_settings.value(KeyPluginWidgetBudget, DefaultPluginWidgetBudgetMs).toInt();
+}
+
+void SettingsManager::setPluginWidgetBudgetMs(int milliseconds)
+{
+    m_settings.setValue(KeyPluginWidgetBudget, milliseconds);
+}
+
 // Recent projects
 void SettingsManager::addRecentProject(const QString &filePath)
 {
@@ -131,6 +131,24 @@ public:
      */
     QString defaultPluginDirectory() const;
 
+    /**
+     * @brief Returns the path of the plugin scan cache file.
+     * @return The path: {app_data}/plugincache.json
+     */
+    QString pluginCacheFile() const;
+
+    /**
+     * @brief Returns the time budget for creating a plugin widget.
+     * @return The budget in milliseconds, or 0 if widgets are never deferred.
+     */
+    int pluginWidgetBudgetMs() const;
+
+    /**
+     * @brief Sets the time budget for creating a plugin widget.
+     * @param milliseconds The budget in milliseconds; 0 disables it.
+     */
+    void setPluginWidgetBudgetMs(int milliseconds);
+
     // Recent projects
     /**
      * @brief Adds a project to the recent projects list.
@@ -168,6 +186,11 @@ public:
      */
     static constexpr int MaxRecentProjects = 10;
 
+    /**
+     * @brief Default time budget for creating a plugin widget, in milliseconds.
+     */
+    static constexpr int DefaultPluginWidgetBudgetMs = 50;
+
 signals:
     /**
      * @brief Emitted when the recent projects list changes.
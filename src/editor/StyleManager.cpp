@@ -8,9 +8,28 @@
 #include <QStandardPaths>
 #include <QStyleFactory>
 #include <QStyle>
+#include <QWidget>
+#include <QElapsedTimer>
+#include <QEvent>
+#include <QSet>
+#include <QCryptographicHash>
+
+#include <algorithm>
+
+namespace {
+    // Dynamic property marking widgets that carry an incremental overlay sheet
+    const char OverlayProperty[] = "qtvanityOverlay";
+}
 
 StyleManager::StyleManager(QObject *parent)
     : QObject(parent)
+    , m_applyScope(ApplyScope::Application)
+    , m_lastApplyNsecs{-1, -1}
+    , m_incrementalRestyle(false)
+    , m_lastApplyWasIncremental(false)
+    , m_lastRestyledWidgetCount(0)
+    , m_deferredRestyle(false)
+    , m_skippedApplyCount(0)
 {
     // Detect the platform default style at startup
     QStyle *appStyle = QApplication::style();
@@ -58,11 +77,514 @@ StyleManager::StyleManager(QObject *parent)
 
 void StyleManager::applyStyleSheet(const QString &qss)
 {
+    // Hinted applies leave the hash to be computed when it is first needed
+    if (m_appliedHash.isEmpty() && !m_currentStyleSheet.isEmpty()) {
+        m_appliedHash = contentHash(m_currentStyleSheet);
+    }
+
+    // Edits in comments or whitespace, or variables set to their current
+    // value, resolve to the same content; restyling for them is wasted work
+    const QByteArray hash = contentHash(qss);
+    if (hash == m_appliedHash && isInstalled()) {
+        m_currentStyleSheet = qss;
+        ++m_skippedApplyCount;
+        emit styleApplySkipped();
+        return;
+    }
+
     m_currentStyleSheet = qss;
-    qApp->setStyleSheet(qss);
+    if (!m_incrementalRestyle || !applyIncrementally(qss)) {
+        installStyleSheet(qss);
+    }
+    m_appliedHash = hash;
+    emit styleApplied();
+}
+
+void StyleManager::applyChangedRules(const QString &qss, const QString &previousQss,
+                                     const QVector<int> &changedRules)
+{
+    if (previousQss != m_currentStyleSheet || m_currentStyleSheet.isEmpty() || !isInstalled()) {
+        applyStyleSheet(qss);
+        return;
+    }
+
+    // Only comments changed, so the normalized content and its hash are
+    // the same as before
+    if (changedRules.isEmpty()) {
+        m_currentStyleSheet = qss;
+        ++m_skippedApplyCount;
+        emit styleApplySkipped();
+        return;
+    }
+
+    m_currentStyleSheet = qss;
+    if (!m_incrementalRestyle || !applyIncrementally(qss, changedRules)) {
+        installStyleSheet(qss);
+    }
+    m_appliedHash.clear();
+    emit styleApplied();
+}
+
+int StyleManager::skippedApplyCount() const
+{
+    return m_skippedApplyCount;
+}
+
+QByteArray StyleManager::contentHash(const QString &qss)
+{
+    return QCryptographicHash::hash(QssRuleSet::normalize(qss).toUtf8(),
+                                    QCryptographicHash::Sha1);
+}
+
+void StyleManager::setApplyScope(ApplyScope scope)
+{
+    if (m_applyScope == scope) {
+        return;
+    }
+
+    uninstallStyleSheet(m_applyScope);
+    m_applyScope = scope;
+
+    if (!m_currentStyleSheet.isEmpty()) {
+        installStyleSheet(m_currentStyleSheet);
+    }
+}
+
+StyleManager::ApplyScope StyleManager::applyScope() const
+{
+    return m_applyScope;
+}
+
+void StyleManager::setScopeWidgets(const QList<QWidget*> &widgets)
+{
+    if (m_applyScope == ApplyScope::Widgets) {
+        uninstallStyleSheet(ApplyScope::Widgets);
+    }
+
+    for (const QPointer<QWidget> &widget : qAsConst(m_scopeWidgets)) {
+        if (widget) {
+            widget->removeEventFilter(this);
+        }
+    }
+
+    m_scopeWidgets.clear();
+    for (QWidget *widget : widgets) {
+        if (widget) {
+            m_scopeWidgets.append(QPointer<QWidget>(widget));
+            widget->installEventFilter(this);
+        }
+    }
+
+    if (m_applyScope == ApplyScope::Widgets && !m_currentStyleSheet.isEmpty()) {
+        installStyleSheet(m_currentStyleSheet);
+    }
+}
+
+void StyleManager::addScopeWidget(QWidget *widget)
+{
+    if (!widget || scopeWidgets().contains(widget)) {
+        return;
+    }
+
+    m_scopeWidgets.append(QPointer<QWidget>(widget));
+    widget->installEventFilter(this);
+
+    if (m_applyScope == ApplyScope::Widgets && !m_installedStyleSheet.isEmpty()) {
+        installOnScopeWidget(widget, m_installedStyleSheet);
+    }
+}
+
+QList<QWidget*> StyleManager::scopeWidgets() const
+{
+    QList<QWidget*> widgets;
+    for (const QPointer<QWidget> &widget : m_scopeWidgets) {
+        if (widget) {
+            widgets.append(widget.data());
+        }
+    }
+    return widgets;
+}
+
+double StyleManager::lastApplyDurationMs(ApplyScope scope) const
+{
+    qint64 nsecs = m_lastApplyNsecs[static_cast<int>(scope)];
+    return nsecs < 0 ? -1.0 : nsecs / 1000000.0;
+}
+
+void StyleManager::setIncrementalRestyle(bool enabled)
+{
+    if (m_incrementalRestyle == enabled) {
+        return;
+    }
+
+    m_incrementalRestyle = enabled;
+    if (enabled) {
+        m_installedRules = QssRuleSet::parse(m_installedStyleSheet);
+    } else {
+        consolidate();
+        m_installedRules = QssRuleSet();
+    }
+}
+
+bool StyleManager::isIncrementalRestyle() const
+{
+    return m_incrementalRestyle;
+}
+
+bool StyleManager::lastApplyWasIncremental() const
+{
+    return m_lastApplyWasIncremental;
+}
+
+int StyleManager::lastRestyledWidgetCount() const
+{
+    return m_lastRestyledWidgetCount;
+}
+
+void StyleManager::setDeferredRestyle(bool enabled)
+{
+    if (m_deferredRestyle == enabled) {
+        return;
+    }
+
+    m_deferredRestyle = enabled;
+    if (!enabled) {
+        const QList<QPointer<QWidget>> staleWidgets = m_staleScopeWidgets;
+        m_staleScopeWidgets.clear();
+        for (const QPointer<QWidget> &widget : staleWidgets) {
+            if (widget) {
+                widget->setStyleSheet(m_installedStyleSheet);
+            }
+        }
+    }
+}
+
+bool StyleManager::isDeferredRestyle() const
+{
+    return m_deferredRestyle;
+}
+
+int StyleManager::staleScopeWidgetCount() const
+{
+    int count = 0;
+    for (const QPointer<QWidget> &widget : m_staleScopeWidgets) {
+        if (widget) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+bool StyleManager::eventFilter(QObject *watched, QEvent *event)
+{
+    if (event->type() == QEvent::Show && !m_staleScopeWidgets.isEmpty()) {
+        QWidget *widget = qobject_cast<QWidget*>(watched);
+        if (widget && m_staleScopeWidgets.contains(widget)) {
+            restyleStaleWidget(widget);
+        }
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+void StyleManager::installStyleSheet(const QString &qss)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    clearOverlays();
+
+    if (m_applyScope == ApplyScope::Application) {
+        qApp->setStyleSheet(qss);
+    } else {
+        m_staleScopeWidgets.clear();
+        for (const QPointer<QWidget> &widget : qAsConst(m_scopeWidgets)) {
+            if (widget) {
+                installOnScopeWidget(widget, qss);
+            }
+        }
+    }
+
+    m_lastApplyNsecs[static_cast<int>(m_applyScope)] = timer.nsecsElapsed();
+
+    m_installedStyleSheet = qss;
+    m_installedRules = m_incrementalRestyle ? QssRuleSet::parse(qss) : QssRuleSet();
+    m_lastApplyWasIncremental = false;
+    m_lastRestyledWidgetCount = restyleCandidates().size();
+}
+
+void StyleManager::installOnScopeWidget(QWidget *widget, const QString &qss)
+{
+    // Each page of a tab widget is a hidden scope widget until its tab is
+    // selected; re-polishing it now would only delay the visible ones
+    if (m_deferredRestyle && !widget->isVisible()) {
+        if (widget->styleSheet() != qss && !m_staleScopeWidgets.contains(widget)) {
+            m_staleScopeWidgets.append(QPointer<QWidget>(widget));
+        }
+        return;
+    }
+    widget->setStyleSheet(qss);
+}
+
+void StyleManager::restyleStaleWidget(QWidget *widget)
+{
+    m_staleScopeWidgets.removeAll(widget);
+
+    // Overlays on its descendants already carry the later incremental edits
+    QElapsedTimer timer;
+    timer.start();
+    widget->setStyleSheet(m_installedStyleSheet);
+    const double durationMs = timer.nsecsElapsed() / 1000000.0;
+
+    emit deferredRestyleApplied(widget, widget->findChildren<QWidget*>().size() + 1, durationMs);
+}
+
+void StyleManager::uninstallStyleSheet(ApplyScope scope)
+{
+    clearOverlays();
+    m_installedStyleSheet.clear();
+    m_installedRules = QssRuleSet();
+    m_staleScopeWidgets.clear();
+
+    if (scope == ApplyScope::Application) {
+        if (!qApp->styleSheet().isEmpty()) {
+            qApp->setStyleSheet(QString());
+        }
+    } else {
+        for (const QPointer<QWidget> &widget : qAsConst(m_scopeWidgets)) {
+            if (widget && !widget->styleSheet().isEmpty()) {
+                widget->setStyleSheet(QString());
+            }
+        }
+    }
+}
+
+bool StyleManager::applyIncrementally(const QString &qss)
+{
+    if (qss.isEmpty() || m_installedStyleSheet.isEmpty()) {
+        return false;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // Compare against the installed sheet rather than the previous apply, so
+    // overlays always describe the full difference and can be dropped freely
+    const QssRuleSet rules = QssRuleSet::parse(qss);
+    const QssRuleSet::Diff diff = QssRuleSet::diff(m_installedRules, rules);
+    if (diff.requiresFullRestyle || !applyOverlays(rules, diff.changedRules)) {
+        return false;
+    }
+
+    m_lastApplyNsecs[static_cast<int>(m_applyScope)] = timer.nsecsElapsed();
+    return true;
+}
+
+bool StyleManager::applyIncrementally(const QString &qss, const QVector<int> &changedRules)
+{
+    if (qss.isEmpty() || m_installedStyleSheet.isEmpty()) {
+        return false;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // The indices are only meaningful while the rule structure matches the
+    // installed sheet, which a value containing a brace would break
+    const QssRuleSet rules = QssRuleSet::parse(qss);
+    const QVector<QssRule> &installedRules = m_installedRules.rules();
+    if (!rules.isWellFormed() || !m_installedRules.isWellFormed()
+        || rules.rules().size() != installedRules.size()) {
+        return false;
+    }
+
+    // Overlays describe the difference from the installed sheet, so rules
+    // changed by earlier incremental applies stay in the set
+    QVector<int> changed = m_overlayRules;
+    for (int index : changedRules) {
+        if (index < 0 || index >= installedRules.size()) {
+            return false;
+        }
+        const QssRule &oldRule = installedRules.at(index);
+        const QssRule &newRule = rules.rules().at(index);
+        if (oldRule.selectorText != newRule.selectorText) {
+            return false;
+        }
+        for (const QString &property : oldRule.propertyNames) {
+            if (!newRule.propertyNames.contains(property)) {
+                return false;
+            }
+        }
+        changed.append(index);
+    }
+    std::sort(changed.begin(), changed.end());
+    changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+
+    if (!applyOverlays(rules, changed)) {
+        return false;
+    }
+
+    m_lastApplyNsecs[static_cast<int>(m_applyScope)] = timer.nsecsElapsed();
+    return true;
+}
+
+bool StyleManager::applyOverlays(const QssRuleSet &rules, const QVector<int> &changedRules)
+{
+    // Overlays are kept until a full apply is needed anyway, but every
+    // overlay repeats the changed rules, so a long edit session stops here
+    if (changedRules.size() > MAX_OVERLAY_RULES) {
+        return false;
+    }
+
+    QVector<QssSelector> changedSelectors;
+    for (int index : changedRules) {
+        for (const QssSelector &selector : rules.rules().at(index).selectors) {
+            if (!selector.isTargetable()) {
+                return false;
+            }
+            changedSelectors.append(selector);
+        }
+    }
+
+    const QList<QWidget*> candidates = restyleCandidates();
+    const QList<QWidget*> roots = m_applyScope == ApplyScope::Widgets ? scopeWidgets()
+                                                                      : QList<QWidget*>();
+    QList<QWidget*> affected;
+    for (QWidget *widget : candidates) {
+        for (const QssSelector &selector : qAsConst(changedSelectors)) {
+            if (!selector.mayMatch(widget)) {
+                continue;
+            }
+            // Scope roots hold the installed sheet, and widgets with a sheet
+            // of their own would lose it to the overlay
+            if (roots.contains(widget)
+                || (!widget->property(OverlayProperty).toBool() && !widget->styleSheet().isEmpty())) {
+                return false;
+            }
+            affected.append(widget);
+            break;
+        }
+    }
+
+    // Past this point overlays cost more than a single global repolish
+    if (affected.size() * 2 > candidates.size()) {
+        return false;
+    }
+
+    // Each overlay holds every new rule that may match its widget, so the
+    // cascade among them is preserved while they win over the installed
+    // sheet. The property qualifier keeps them from matching descendants.
+    const QString qualifier = QStringLiteral("[%1=\"true\"]").arg(QLatin1String(OverlayProperty));
+    QSet<QWidget*> restyled;
+    QSet<QWidget*> affectedSet;
+    for (QWidget *widget : qAsConst(affected)) {
+        QString overlay;
+        for (const QssRule &rule : rules.rules()) {
+            QStringList selectors;
+            for (const QssSelector &selector : rule.selectors) {
+                if (selector.mayMatch(widget)) {
+                    QString text = selector.text;
+                    selectors << text.insert(selector.subjectEnd, qualifier);
+                }
+            }
+            if (!selectors.isEmpty()) {
+                overlay += selectors.join(QLatin1String(", "))
+                         + QLatin1String(" { ") + rule.declarations + QLatin1String(" }\n");
+            }
+        }
+
+        affectedSet.insert(widget);
+        if (widget->styleSheet() != overlay) {
+            widget->setProperty(OverlayProperty, true);
+            widget->setStyleSheet(overlay);
+            markRestyled(widget, restyled);
+        }
+    }
+
+    // Widgets whose changes were reverted go back to the installed sheet
+    for (const QPointer<QWidget> &widget : qAsConst(m_overlaidWidgets)) {
+        if (widget && !affectedSet.contains(widget.data())) {
+            widget->setStyleSheet(QString());
+            widget->setProperty(OverlayProperty, QVariant());
+            markRestyled(widget.data(), restyled);
+        }
+    }
+
+    m_overlaidWidgets.clear();
+    for (QWidget *widget : qAsConst(affected)) {
+        m_overlaidWidgets.append(QPointer<QWidget>(widget));
+    }
+
+    m_overlayRules = changedRules;
+    m_lastApplyWasIncremental = true;
+    m_lastRestyledWidgetCount = restyled.size();
+    return true;
+}
+
+void StyleManager::markRestyled(QWidget *widget, QSet<QWidget*> &restyled)
+{
+    // Setting a sheet on a container re-polishes its whole subtree
+    restyled.insert(widget);
+    for (QWidget *child : widget->findChildren<QWidget*>()) {
+        restyled.insert(child);
+    }
+}
+
+void StyleManager::consolidate()
+{
+    if (m_overlaidWidgets.isEmpty()) {
+        return;
+    }
+
+    installStyleSheet(m_currentStyleSheet);
     emit styleApplied();
 }
 
+void StyleManager::clearOverlays()
+{
+    for (const QPointer<QWidget> &widget : qAsConst(m_overlaidWidgets)) {
+        if (widget) {
+            widget->setStyleSheet(QString());
+            widget->setProperty(OverlayProperty, QVariant());
+        }
+    }
+    m_overlaidWidgets.clear();
+    m_overlayRules.clear();
+}
+
+QList<QWidget*> StyleManager::restyleCandidates() const
+{
+    if (m_applyScope == ApplyScope::Application) {
+        return QApplication::allWidgets();
+    }
+
+    QList<QWidget*> widgets;
+    for (QWidget *root : scopeWidgets()) {
+        if (m_staleScopeWidgets.contains(root)) {
+            continue;
+        }
+        widgets.append(root);
+        widgets.append(root->findChildren<QWidget*>());
+    }
+    return widgets;
+}
+
+bool StyleManager::isInstalled() const
+{
+    // The sheet may have been replaced behind our back (e.g. by a direct
+    // qApp->setStyleSheet call), in which case it has to be applied again
+    if (m_applyScope == ApplyScope::Application) {
+        return qApp->styleSheet() == m_installedStyleSheet;
+    }
+
+    // Stale scope widgets receive the installed sheet when they are shown
+    for (QWidget *root : scopeWidgets()) {
+        if (root->styleSheet() != m_installedStyleSheet && !m_staleScopeWidgets.contains(root)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 QString StyleManager::loadFromFile(const QString &filePath)
 {
     QFile file(filePath);
@@ -146,7 +668,8 @@ QString StyleManager::currentStyleSheet() const
 void StyleManager::clearStyleSheet()
 {
     m_currentStyleSheet = QString();
-    qApp->setStyleSheet(QString());
+    m_appliedHash.clear();
+    installStyleSheet(QString());
     emit styleCleared();
 }
 
@@ -215,7 +738,7 @@ void StyleManager::setStyle(const QString &styleName)
     
     // Reapply the current QSS to make sure it works with the new base style
     if (!m_currentStyleSheet.isEmpty()) {
-        qApp->setStyleSheet(m_currentStyleSheet);
+        installStyleSheet(m_currentStyleSheet);
     }
     
     emit styleChanged(m_currentStyle);
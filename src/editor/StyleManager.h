@@ -4,6 +4,16 @@
 #include <QObject>
 #include <QString>
 #include <QStringList>
+#include <QPointer>
+#include <QList>
+#include <QByteArray>
+#include <QVector>
+#include <QSet>
+
+#include "QssRuleSet.h"
+
+class QWidget;
+class QEvent;
 
 /**
  * @brief Manages stylesheet loading, saving, and application.
@@ -19,6 +29,20 @@ class StyleManager : public QObject
     Q_OBJECT
 
 public:
+    /**
+     * @brief Where applied stylesheets are installed.
+     *
+     * Application scope calls qApp->setStyleSheet(), which re-polishes every
+     * widget in every top-level window. Widgets scope installs the sheet only
+     * on the registered scope widgets (typically the widget gallery), so the
+     * editor and docks are left alone and only that subtree is re-polished.
+     */
+    enum class ApplyScope {
+        Application,
+        Widgets
+    };
+    Q_ENUM(ApplyScope)
+
     /**
      * @brief Constructs a StyleManager.
      * @param parent The parent QObject.
@@ -26,11 +50,157 @@ public:
     explicit StyleManager(QObject *parent = nullptr);
 
     /**
-     * @brief Applies a stylesheet to the entire application.
+     * @brief Applies a stylesheet using the current apply scope.
      * @param qss The QSS content to apply.
+     *
+     * In Application scope (the default) the stylesheet is applied to the
+     * entire application; in Widgets scope it is applied to the scope widgets.
+     *
+     * If the content hash of qss matches the applied stylesheet and that
+     * stylesheet is still installed, no restyle happens and
+     * styleApplySkipped() is emitted instead of styleApplied().
      */
     void applyStyleSheet(const QString &qss);
 
+    /**
+     * @brief Applies a stylesheet that differs from the current one in known rules.
+     * @param qss The QSS content to apply.
+     * @param previousQss The stylesheet the rule indices are relative to.
+     * @param changedRules Indices, in QssRuleSet::parse() order, of the rules
+     *        of qss whose text differs from previousQss.
+     *
+     * Used by the variable regeneration path, which knows from the variable
+     * reference index which rules an edit touched. The content hash and the
+     * rule diff are skipped: with no changed rules the apply is skipped, and
+     * with incremental restyling only widgets the changed rules may match
+     * are restyled. If previousQss is not the current stylesheet the hint is
+     * stale and this behaves like applyStyleSheet().
+     */
+    void applyChangedRules(const QString &qss, const QString &previousQss,
+                           const QVector<int> &changedRules);
+
+    /**
+     * @brief Sets where stylesheets are installed.
+     * @param scope The new apply scope.
+     *
+     * If a stylesheet is currently applied it is moved to the new scope:
+     * removed from the old target(s) and reapplied to the new one(s).
+     */
+    void setApplyScope(ApplyScope scope);
+
+    /**
+     * @brief Returns the current apply scope.
+     * @return The apply scope (Application by default).
+     */
+    ApplyScope applyScope() const;
+
+    /**
+     * @brief Sets the widgets that receive the stylesheet in Widgets scope.
+     * @param widgets The root widgets of the styled subtrees.
+     *
+     * Widgets are tracked with QPointer, so destroyed widgets are skipped.
+     */
+    void setScopeWidgets(const QList<QWidget*> &widgets);
+
+    /**
+     * @brief Adds a widget to the scope widgets.
+     * @param widget The root of a styled subtree.
+     *
+     * Unlike setScopeWidgets(), the installed stylesheet is only installed
+     * on the new widget; the other scope widgets are not re-polished.
+     */
+    void addScopeWidget(QWidget *widget);
+
+    /**
+     * @brief Returns the widgets that receive the stylesheet in Widgets scope.
+     * @return The live scope widgets.
+     */
+    QList<QWidget*> scopeWidgets() const;
+
+    /**
+     * @brief Returns how long the last apply in the given scope took.
+     * @param scope The scope to query.
+     * @return The duration in milliseconds, or -1 if no apply was measured.
+     *
+     * The duration covers the setStyleSheet() call(s) including the
+     * synchronous re-polish they trigger.
+     */
+    double lastApplyDurationMs(ApplyScope scope) const;
+
+    /**
+     * @brief Enables rule-level incremental restyling.
+     * @param enabled true to restyle only widgets affected by changed rules.
+     *
+     * When enabled, applyStyleSheet() compares the new document with the
+     * installed one rule by rule. If the edit only adds rules or changes
+     * property values, the new rules that may match each affected widget are
+     * installed on that widget as an overlay sheet and only those widgets are
+     * re-polished. The overlays stay until an edit needs a full restyle, which
+     * is any other edit or one leaving more than MAX_OVERLAY_RULES rules
+     * changed from the installed sheet; disabling installs the complete sheet.
+     */
+    void setIncrementalRestyle(bool enabled);
+
+    /**
+     * @brief Returns whether incremental restyling is enabled.
+     * @return true if enabled (disabled by default).
+     */
+    bool isIncrementalRestyle() const;
+
+    /**
+     * @brief Returns whether the last apply used per-widget overlays.
+     * @return true if the last apply was incremental.
+     */
+    bool lastApplyWasIncremental() const;
+
+    /**
+     * @brief Returns the number of widgets restyled by the last apply.
+     * @return Widgets whose style sheet changed for an incremental apply,
+     *         with their descendants, or all widgets in scope for a full apply.
+     */
+    int lastRestyledWidgetCount() const;
+
+    /**
+     * @brief Defers restyling hidden scope widgets until they are shown.
+     * @param enabled true to skip hidden scope widgets when installing.
+     *
+     * Only affects Widgets scope. When enabled, a full apply installs the
+     * stylesheet on visible scope widgets only; hidden ones are marked stale
+     * and receive the installed sheet when they are next shown, emitting
+     * deferredRestyleApplied(). Disabling restyles the stale widgets at once.
+     */
+    void setDeferredRestyle(bool enabled);
+
+    /**
+     * @brief Returns whether restyling hidden scope widgets is deferred.
+     * @return true if enabled (disabled by default).
+     */
+    bool isDeferredRestyle() const;
+
+    /**
+     * @brief Returns the number of scope widgets waiting to be restyled.
+     * @return Hidden scope widgets that do not hold the installed sheet yet.
+     */
+    int staleScopeWidgetCount() const;
+
+    /**
+     * @brief Returns the number of applies skipped as redundant.
+     * @return Count of applyStyleSheet() calls whose content hash matched.
+     */
+    int skippedApplyCount() const;
+
+    /**
+     * @brief Returns the content hash of a stylesheet.
+     * @param qss The QSS content.
+     * @return SHA-1 of the comment and whitespace normalized content.
+     */
+    static QByteArray contentHash(const QString &qss);
+
+    /**
+     * @brief Changed rules overlays may carry before a full apply replaces them.
+     */
+    static constexpr int MAX_OVERLAY_RULES = 16;
+
     /**
      * @brief Loads QSS content from a file.
      * @param filePath The path to the .qss file.
@@ -121,6 +291,22 @@ signals:
      */
     void styleApplied();
 
+    /**
+     * @brief Emitted when an apply is skipped because nothing changed.
+     *
+     * The new stylesheet differs from the applied one only in comments or
+     * whitespace, so the installed stylesheet is kept as is.
+     */
+    void styleApplySkipped();
+
+    /**
+     * @brief Emitted when a stale scope widget has been restyled on show.
+     * @param widget The scope widget.
+     * @param widgetCount The number of widgets in its subtree.
+     * @param durationMs How long installing the sheet took.
+     */
+    void deferredRestyleApplied(QWidget *widget, int widgetCount, double durationMs);
+
     /**
      * @brief Emitted when the stylesheet is cleared.
      */
@@ -150,11 +336,50 @@ signals:
      */
     void styleChangeError(const QString &error);
 
+protected:
+    /**
+     * @brief Restyles stale scope widgets when they are shown.
+     */
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
 private:
+    void installStyleSheet(const QString &qss);
+    void installOnScopeWidget(QWidget *widget, const QString &qss);
+    void restyleStaleWidget(QWidget *widget);
+    void uninstallStyleSheet(ApplyScope scope);
+    bool applyIncrementally(const QString &qss);
+    bool applyIncrementally(const QString &qss, const QVector<int> &changedRules);
+    bool applyOverlays(const QssRuleSet &rules, const QVector<int> &changedRules);
+    static void markRestyled(QWidget *widget, QSet<QWidget*> &restyled);
+    void consolidate();
+    void clearOverlays();
+    QList<QWidget*> restyleCandidates() const;
+    bool isInstalled() const;
+
     QString m_templatesPath;
     QString m_currentStyleSheet;
     QString m_currentStyle;
     QString m_defaultStyle;
+    ApplyScope m_applyScope;
+    QList<QPointer<QWidget>> m_scopeWidgets;
+    qint64 m_lastApplyNsecs[2];
+
+    // Incremental restyle state
+    bool m_incrementalRestyle;
+    bool m_lastApplyWasIncremental;
+    int m_lastRestyledWidgetCount;
+    QString m_installedStyleSheet;
+    QssRuleSet m_installedRules;
+    QList<QPointer<QWidget>> m_overlaidWidgets;
+    QVector<int> m_overlayRules;
+
+    // Hidden scope widgets still holding an older sheet
+    bool m_deferredRestyle;
+    QList<QPointer<QWidget>> m_staleScopeWidgets;
+
+    // Redundant apply detection; empty until needed after a hinted apply
+    QByteArray m_appliedHash;
+    int m_skippedApplyCount;
 };
 
 #endif // STYLEMANAGER_H
@@ -0,0 +1,237 @@
+#include "TextSearchPattern.h"
+
+#include <algorithm>
+
+namespace {
+
+inline ushort foldCase(ushort c)
+{
+    if (c < 0x80) {
+        return (c >= 'A' && c <= 'Z') ? ushort(c + ('a' - 'A')) : c;
+    }
+    return QChar(c).toCaseFolded().unicode();
+}
+
+inline bool isWordChar(QChar c)
+{
+    return c.isLetterOrNumber() || c == QLatin1Char('_');
+}
+
+bool isWholeWordAt(const QString &text, int start, int length)
+{
+    const int end = start + length;
+    return (start == 0 || !isWordChar(text.at(start - 1)))
+        && (end >= text.size() || !isWordChar(text.at(end)));
+}
+
+} // namespace
+
+TextSearchPattern::TextSearchPattern()
+    : m_options(NoOptions)
+{
+    std::fill(std::begin(m_skip), std::end(m_skip), 1);
+}
+
+TextSearchPattern::TextSearchPattern(const QString &query, Options options)
+    : m_query(query)
+    , m_options(options)
+{
+    if (m_options.testFlag(RegularExpression)) {
+        std::fill(std::begin(m_skip), std::end(m_skip), 1);
+
+        QString pattern = query;
+        if (m_options.testFlag(WholeWords)) {
+            pattern = QStringLiteral("\\b(?:%1)\\b").arg(query);
+        }
+        m_regex.setPattern(pattern);
+        if (!m_options.testFlag(CaseSensitive)) {
+            m_regex.setPatternOptions(QRegularExpression::CaseInsensitiveOption);
+        }
+        return;
+    }
+
+    m_needle = query;
+    if (!m_options.testFlag(CaseSensitive)) {
+        QChar *data = m_needle.data();
+        for (int i = 0; i < m_needle.size(); ++i) {
+            data[i] = QChar(foldCase(data[i].unicode()));
+        }
+    }
+
+    // Horspool shift table, keyed by the low byte of each UTF-16 unit;
+    // units sharing a low byte share the smallest shift, which stays safe
+    const int length = m_needle.size();
+    std::fill(std::begin(m_skip), std::end(m_skip), qMax(1, length));
+    for (int i = 0; i < length - 1; ++i) {
+        m_skip[m_needle.at(i).unicode() & 0xff] = length - 1 - i;
+    }
+}
+
+QString TextSearchPattern::query() const
+{
+    return m_query;
+}
+
+TextSearchPattern::Options TextSearchPattern::options() const
+{
+    return m_options;
+}
+
+bool TextSearchPattern::isEmpty() const
+{
+    return m_query.isEmpty();
+}
+
+bool TextSearchPattern::isValid() const
+{
+    return !m_options.testFlag(RegularExpression) || m_regex.isValid();
+}
+
+QString TextSearchPattern::errorString() const
+{
+    return isValid() ? QString() : m_regex.errorString();
+}
+
+bool TextSearchPattern::isLineBased() const
+{
+    return m_options.testFlag(RegularExpression);
+}
+
+int TextSearchPattern::context() const
+{
+    return !isLineBased() && m_options.testFlag(WholeWords) ? 1 : 0;
+}
+
+int TextSearchPattern::findInRange(const QString &text, int from, int limit,
+                                   QVector<TextMatch> *matches) const
+{
+    limit = qMin(limit, int(text.size()));
+    if (m_query.isEmpty() || !isValid() || from >= limit) {
+        return qMax(from, limit);
+    }
+    return isLineBased() ? findRegularExpression(text, from, limit, matches)
+                         : findLiteral(text, from, limit, matches);
+}
+
+QVector<TextMatch> TextSearchPattern::findAll(const QString &text) const
+{
+    QVector<TextMatch> matches;
+    findInRange(text, 0, text.size(), &matches);
+    return matches;
+}
+
+QString TextSearchPattern::replacementFor(const QString &line, int lineStart,
+                                          const TextMatch &match,
+                                          const QString &replaceText) const
+{
+    if (!isLineBased() || !isValid()) {
+        return replaceText;
+    }
+
+    // Matching again from the match start yields the same leftmost match,
+    // with its capture groups
+    const int offset = match.start - lineStart;
+    const QRegularExpressionMatch result = m_regex.match(line, offset);
+    if (!result.hasMatch() || result.capturedStart() != offset) {
+        return replaceText;
+    }
+
+    QString replacement;
+    replacement.reserve(replaceText.size());
+    for (int i = 0; i < replaceText.size(); ++i) {
+        const QChar c = replaceText.at(i);
+        const QChar next = i + 1 < replaceText.size() ? replaceText.at(i + 1) : QChar();
+        if ((c == QLatin1Char('\\') || c == QLatin1Char('$')) && next.isDigit()) {
+            replacement += result.captured(next.digitValue());
+            ++i;
+        } else if (c == QLatin1Char('\\') && next == QLatin1Char('n')) {
+            replacement += QLatin1Char('\n');
+            ++i;
+        } else if (c == QLatin1Char('\\') && next == QLatin1Char('t')) {
+            replacement += QLatin1Char('\t');
+            ++i;
+        } else if (c == QLatin1Char('\\') && next == QLatin1Char('\\')) {
+            replacement += QLatin1Char('\\');
+            ++i;
+        } else {
+            replacement += c;
+        }
+    }
+    return replacement;
+}
+
+int TextSearchPattern::findLiteral(const QString &text, int from, int limit,
+                                   QVector<TextMatch> *matches) const
+{
+    const int length = m_needle.size();
+    const bool fold = !m_options.testFlag(CaseSensitive);
+    const bool wholeWords = m_options.testFlag(WholeWords);
+
+    // Matches that start before limit may run past it
+    const int lastStart = qMin(limit - 1, int(text.size()) - length);
+    const QChar *haystack = text.constData();
+    const QChar *needle = m_needle.constData();
+    const ushort last = needle[length - 1].unicode();
+
+    int position = qMax(0, from);
+    int i = position;
+    while (i <= lastStart) {
+        ushort c = haystack[i + length - 1].unicode();
+        if (fold) {
+            c = foldCase(c);
+        }
+        if (c == last) {
+            int k = length - 2;
+            while (k >= 0) {
+                ushort t = haystack[i + k].unicode();
+                if (fold) {
+                    t = foldCase(t);
+                }
+                if (t != needle[k].unicode()) {
+                    break;
+                }
+                --k;
+            }
+            if (k < 0 && (!wholeWords || isWholeWordAt(text, i, length))) {
+                matches->append(TextMatch{i, length});
+                i += length;
+                position = i;
+                continue;
+            }
+        }
+        i += m_skip[c & 0xff];
+    }
+    return qMax(position, limit);
+}
+
+int TextSearchPattern::findRegularExpression(const QString &text, int from, int limit,
+                                             QVector<TextMatch> *matches) const
+{
+    int position = qMax(0, from);
+    int lineStart = position > 0 ? text.lastIndexOf(QLatin1Char('\n'), position - 1) + 1 : 0;
+
+    while (lineStart < limit) {
+        int lineEnd = text.indexOf(QLatin1Char('\n'), lineStart);
+        if (lineEnd < 0) {
+            lineEnd = text.size();
+        }
+
+        // The whole line is the subject, so lookbehind sees text before from
+        const QString line = text.mid(lineStart, lineEnd - lineStart);
+        QRegularExpressionMatchIterator it = m_regex.globalMatch(line, qMax(0, position - lineStart));
+        while (it.hasNext()) {
+            const QRegularExpressionMatch match = it.next();
+            const int start = lineStart + match.capturedStart();
+            if (start >= limit) {
+                return qMax(position, limit);
+            }
+            if (match.capturedLength() == 0) {
+                continue;
+            }
+            matches->append(TextMatch{start, match.capturedLength()});
+            position = start + match.capturedLength();
+        }
+        lineStart = lineEnd + 1;
+    }
+    return qMax(position, limit);
+}
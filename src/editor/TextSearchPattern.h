@@ -0,0 +1,141 @@
+#ifndef TEXTSEARCHPATTERN_H
+#define TEXTSEARCHPATTERN_H
+
+#include <QString>
+#include <QVector>
+#include <QMetaType>
+#include <QRegularExpression>
+
+/**
+ * @brief A single search match, as a range of document positions.
+ */
+struct TextMatch
+{
+    int start = 0;
+    int length = 0;
+
+    int end() const { return start + length; }
+};
+
+Q_DECLARE_METATYPE(TextMatch)
+
+/**
+ * @brief A compiled find query that scans flat text for non-overlapping matches.
+ *
+ * Plain queries are matched with Boyer-Moore-Horspool over the text, folding
+ * case on the fly for case-insensitive searches. Whole-word queries reject
+ * occurrences that touch a letter, digit or underscore. Regular expressions
+ * are matched one line at a time, like QTextDocument::find(), so a match
+ * never spans a line break; empty matches are skipped.
+ *
+ * Patterns are immutable once built and may be used from several threads.
+ */
+class TextSearchPattern
+{
+public:
+    /**
+     * @brief Search options.
+     */
+    enum Option {
+        NoOptions = 0x0,
+        CaseSensitive = 0x1,
+        WholeWords = 0x2,
+        RegularExpression = 0x4
+    };
+    Q_DECLARE_FLAGS(Options, Option)
+
+    /**
+     * @brief Constructs an empty pattern that matches nothing.
+     */
+    TextSearchPattern();
+
+    /**
+     * @brief Compiles a query.
+     * @param query The text or regular expression to find.
+     * @param options How to match it.
+     */
+    TextSearchPattern(const QString &query, Options options);
+
+    /**
+     * @brief Returns the query the pattern was built from.
+     */
+    QString query() const;
+
+    /**
+     * @brief Returns the options the pattern was built with.
+     */
+    Options options() const;
+
+    /**
+     * @brief Returns whether the query is empty.
+     */
+    bool isEmpty() const;
+
+    /**
+     * @brief Returns false if the query is an invalid regular expression.
+     */
+    bool isValid() const;
+
+    /**
+     * @brief Returns the regular expression error, or an empty string.
+     */
+    QString errorString() const;
+
+    /**
+     * @brief Returns whether matches are found line by line (regular expressions).
+     *
+     * Otherwise every match is exactly query().size() characters long.
+     */
+    bool isLineBased() const;
+
+    /**
+     * @brief Returns how many characters beside a match decide whether it matches.
+     *
+     * 1 for whole-word literals, which look at their neighbours, otherwise 0.
+     */
+    int context() const;
+
+    /**
+     * @brief Appends the matches that start in [from, limit) to matches.
+     *
+     * Matches may run past limit. Scanning continues from the end of each
+     * match, so calling again with the returned position as from continues
+     * the same non-overlapping sequence.
+     * @return The position to continue scanning from (at least limit).
+     */
+    int findInRange(const QString &text, int from, int limit, QVector<TextMatch> *matches) const;
+
+    /**
+     * @brief Returns all matches in text, in order.
+     */
+    QVector<TextMatch> findAll(const QString &text) const;
+
+    /**
+     * @brief Returns the text that replaces a match.
+     *
+     * For regular expressions, \1 or $1 in replaceText insert capture groups
+     * (\0 or $0 the whole match), and \n, \t and \\ are unescaped. Other
+     * patterns insert replaceText unchanged.
+     * @param line The text of the line holding the match.
+     * @param lineStart The position of the line in the text the match refers to.
+     * @param match The match to replace.
+     * @param replaceText The replacement as typed by the user.
+     */
+    QString replacementFor(const QString &line, int lineStart, const TextMatch &match,
+                           const QString &replaceText) const;
+
+private:
+    int findLiteral(const QString &text, int from, int limit, QVector<TextMatch> *matches) const;
+    int findRegularExpression(const QString &text, int from, int limit,
+                              QVector<TextMatch> *matches) const;
+
+    QString m_query;
+    Options m_options;
+    QString m_needle;
+    int m_skip[256];
+    QRegularExpression m_regex;
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(TextSearchPattern::Options)
+
+#endif // TEXTSEARCHPATTERN_H
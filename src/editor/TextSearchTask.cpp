@@ -0,0 +1,60 @@
+#include "TextSearchTask.h"
+
+#include <QElapsedTimer>
+
+TextSearchTask::TextSearchTask(int generation, const QString &text,
+                               const TextSearchPattern &pattern)
+    : m_generation(generation)
+    , m_text(text)
+    , m_pattern(pattern)
+    , m_cancelled(false)
+{
+    setAutoDelete(false);
+}
+
+int TextSearchTask::generation() const
+{
+    return m_generation;
+}
+
+void TextSearchTask::cancel()
+{
+    m_cancelled.store(true);
+}
+
+bool TextSearchTask::isCancelled() const
+{
+    return m_cancelled.load();
+}
+
+void TextSearchTask::run()
+{
+    const int length = m_text.size();
+
+    QVector<TextMatch> batch;
+    QElapsedTimer batchTimer;
+    batchTimer.start();
+
+    int position = 0;
+    while (!m_pattern.isEmpty() && position < length && !isCancelled()) {
+        const int limit = length - position > CHUNK_SIZE ? position + CHUNK_SIZE : length;
+        position = m_pattern.findInRange(m_text, position, limit, &batch);
+
+        if (batch.size() >= BATCH_SIZE
+            || (!batch.isEmpty() && batchTimer.elapsed() >= BATCH_INTERVAL_MS)) {
+            emit matchesFound(m_generation, batch);
+            batch.clear();
+            batchTimer.restart();
+        }
+    }
+
+    if (!isCancelled()) {
+        if (!batch.isEmpty()) {
+            emit matchesFound(m_generation, batch);
+        }
+        emit finished(m_generation);
+    }
+
+    // The task lives on the UI thread, where QPointers to it are read
+    deleteLater();
+}
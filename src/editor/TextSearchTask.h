@@ -0,0 +1,90 @@
+#ifndef TEXTSEARCHTASK_H
+#define TEXTSEARCHTASK_H
+
+#include <QObject>
+#include <QRunnable>
+#include <QString>
+#include <QVector>
+
+#include "TextSearchPattern.h"
+
+#include <atomic>
+
+/**
+ * @brief Enumerates the matches of a query in a text snapshot on a worker thread.
+ *
+ * The task owns an implicitly shared copy of the text, so the document can
+ * keep changing on the UI thread while the scan runs. Matches are reported
+ * in document order, in batches, through queued signals tagged with the
+ * generation the task was started for; receivers drop batches from older
+ * generations.
+ *
+ * The task deletes itself (via deleteLater()) once run() returns. Use a
+ * QPointer to reach it from the UI thread, e.g. to cancel().
+ */
+class TextSearchTask : public QObject, public QRunnable
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Number of matches after which a matchesFound() batch is sent.
+     */
+    static constexpr int BATCH_SIZE = 4096;
+
+    /**
+     * @brief Longest interval in milliseconds between two batches.
+     */
+    static constexpr int BATCH_INTERVAL_MS = 50;
+
+    /**
+     * @brief Number of characters scanned between cancellation checks.
+     */
+    static constexpr int CHUNK_SIZE = 64 * 1024;
+
+    /**
+     * @brief Constructs a TextSearchTask.
+     * @param generation Tag passed back with every signal.
+     * @param text The text snapshot to search.
+     * @param pattern The compiled query (must not be empty).
+     */
+    TextSearchTask(int generation, const QString &text, const TextSearchPattern &pattern);
+
+    /**
+     * @brief Returns the generation the task was started for.
+     */
+    int generation() const;
+
+    /**
+     * @brief Asks the scan to stop; no signals are emitted afterwards.
+     *
+     * Thread-safe.
+     */
+    void cancel();
+
+    /**
+     * @brief Returns whether cancel() has been called.
+     */
+    bool isCancelled() const;
+
+    void run() override;
+
+signals:
+    /**
+     * @brief Emitted from the worker thread with the next matches in order.
+     */
+    void matchesFound(int generation, const QVector<TextMatch> &matches);
+
+    /**
+     * @brief Emitted from the worker thread after the last batch.
+     */
+    void finished(int generation);
+
+private:
+    const int m_generation;
+    const QString m_text;
+    const TextSearchPattern m_pattern;
+    std::atomic<bool> m_cancelled;
+};
+
+#endif // TEXTSEARCHTASK_H
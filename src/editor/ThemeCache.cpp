@@ -0,0 +1,196 @@
+#include "ThemeCache.h"
+#include "VariableManager.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QTextStream>
+#include <QTimer>
+
+namespace {
+
+/**
+ * @brief Returns the file a template resolves to, or an empty string.
+ */
+QString templateFilePath(const QString &templatesPath, const QString &templateName)
+{
+    const QString basePath = templatesPath + QLatin1Char('/') + templateName;
+    const QString projectPath = basePath + QStringLiteral(".qvp");
+    if (QFile::exists(projectPath)) {
+        return projectPath;
+    }
+    const QString styleSheetPath = basePath + QStringLiteral(".qss");
+    if (QFile::exists(styleSheetPath)) {
+        return styleSheetPath;
+    }
+    return QString();
+}
+
+} // namespace
+
+ThemeCache::ThemeCache(QObject *parent)
+    : QObject(parent)
+    , m_watcher(nullptr)
+    , m_reloadTimer(nullptr)
+    , m_loadCount(0)
+{
+    m_watcher = new QFileSystemWatcher(this);
+    connect(m_watcher, &QFileSystemWatcher::fileChanged,
+            this, &ThemeCache::onFileChanged);
+    connect(m_watcher, &QFileSystemWatcher::directoryChanged,
+            this, &ThemeCache::onDirectoryChanged);
+
+    // Editors often save in several writes; reload once they are done
+    m_reloadTimer = new QTimer(this);
+    m_reloadTimer->setSingleShot(true);
+    m_reloadTimer->setInterval(RELOAD_DELAY_MS);
+    connect(m_reloadTimer, &QTimer::timeout, this, &ThemeCache::reloadChanged);
+}
+
+void ThemeCache::setTemplatesPath(const QString &path)
+{
+    if (path == m_templatesPath) {
+        return;
+    }
+
+    m_templatesPath = path;
+    clear();
+}
+
+QString ThemeCache::templatesPath() const
+{
+    return m_templatesPath;
+}
+
+QString ThemeCache::styleSheet(const QString &templateName)
+{
+    const auto it = m_entries.constFind(templateName);
+    if (it != m_entries.constEnd()) {
+        return it->styleSheet;
+    }
+
+    const Entry entry = load(templateName);
+    m_entries.insert(templateName, entry);
+    return entry.styleSheet;
+}
+
+void ThemeCache::preload(const QStringList &templateNames)
+{
+    for (const QString &templateName : templateNames) {
+        styleSheet(templateName);
+    }
+}
+
+bool ThemeCache::contains(const QString &templateName) const
+{
+    return m_entries.contains(templateName);
+}
+
+void ThemeCache::clear()
+{
+    m_entries.clear();
+    m_changedTemplates.clear();
+    m_reloadTimer->stop();
+    resetWatcher();
+}
+
+int ThemeCache::loadCount() const
+{
+    return m_loadCount;
+}
+
+void ThemeCache::onFileChanged(const QString &path)
+{
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        if (it->filePath == path) {
+            m_changedTemplates.insert(it.key());
+            it = m_entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    if (!m_changedTemplates.isEmpty()) {
+        m_reloadTimer->start();
+    }
+}
+
+void ThemeCache::onDirectoryChanged()
+{
+    // A template may have appeared, disappeared, or gained a project file
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        if (templateFilePath(m_templatesPath, it.key()) != it->filePath) {
+            m_changedTemplates.insert(it.key());
+            it = m_entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    if (!m_changedTemplates.isEmpty()) {
+        m_reloadTimer->start();
+    }
+}
+
+void ThemeCache::reloadChanged()
+{
+    QStringList templateNames = m_changedTemplates.values();
+    m_changedTemplates.clear();
+    templateNames.sort();
+
+    for (const QString &templateName : qAsConst(templateNames)) {
+        styleSheet(templateName);
+    }
+    for (const QString &templateName : qAsConst(templateNames)) {
+        emit templateReloaded(templateName);
+    }
+}
+
+ThemeCache::Entry ThemeCache::load(const QString &templateName)
+{
+    Entry entry;
+    entry.filePath = templateFilePath(m_templatesPath, templateName);
+    if (entry.filePath.isEmpty()) {
+        return entry;
+    }
+    ++m_loadCount;
+
+    // Files replaced by a rename drop out of the watcher
+    if (!m_watcher->files().contains(entry.filePath)) {
+        m_watcher->addPath(entry.filePath);
+    }
+
+    if (entry.filePath.endsWith(QStringLiteral(".qvp"))) {
+        VariableManager variables;
+        connect(&variables, &VariableManager::loadError,
+                this, [this, &templateName](const QString &error) {
+            emit loadError(tr("Cannot load theme '%1': %2").arg(templateName, error));
+        });
+
+        QString qssTemplate;
+        if (variables.loadProject(entry.filePath, qssTemplate)) {
+            entry.styleSheet = variables.substitute(qssTemplate);
+        }
+        return entry;
+    }
+
+    QFile file(entry.filePath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        emit loadError(tr("Cannot load theme '%1': %2").arg(templateName, file.errorString()));
+        return entry;
+    }
+    QTextStream in(&file);
+    entry.styleSheet = in.readAll();
+    return entry;
+}
+
+void ThemeCache::resetWatcher()
+{
+    const QStringList watched = m_watcher->files() + m_watcher->directories();
+    if (!watched.isEmpty()) {
+        m_watcher->removePaths(watched);
+    }
+    if (!m_templatesPath.isEmpty() && QFileInfo(m_templatesPath).isDir()) {
+        m_watcher->addPath(m_templatesPath);
+    }
+}
@@ -0,0 +1,123 @@
+#ifndef THEMECACHE_H
+#define THEMECACHE_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QSet>
+
+class QFileSystemWatcher;
+class QTimer;
+
+/**
+ * @brief Keeps the resolved stylesheets of theme templates in memory.
+ *
+ * A template named "dark" is read from dark.qvp in the templates directory,
+ * and its variables are substituted through a VariableManager; a plain
+ * dark.qss is used as is when there is no project. Each template is loaded
+ * and resolved once. The files are watched: when one changes, its entry is
+ * dropped and reloaded after RELOAD_DELAY_MS, then templateReloaded() is
+ * emitted. Templates that were not found are cached as empty until a file
+ * appears in the templates directory.
+ */
+class ThemeCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Delay after a file change before the template is reloaded.
+     */
+    static constexpr int RELOAD_DELAY_MS = 100;
+
+    /**
+     * @brief Constructs a ThemeCache.
+     * @param parent The parent QObject.
+     */
+    explicit ThemeCache(QObject *parent = nullptr);
+
+    /**
+     * @brief Sets the directory templates are loaded from.
+     * @param path The templates directory.
+     *
+     * Changing the directory empties the cache.
+     */
+    void setTemplatesPath(const QString &path);
+
+    /**
+     * @brief Returns the directory templates are loaded from.
+     */
+    QString templatesPath() const;
+
+    /**
+     * @brief Returns the resolved stylesheet of a template.
+     * @param templateName The template name, without extension.
+     * @return The stylesheet, or an empty string if the template was not
+     *         found or failed to load.
+     *
+     * Loads the template on the first call; later calls do no I/O.
+     */
+    QString styleSheet(const QString &templateName);
+
+    /**
+     * @brief Loads templates that are not cached yet.
+     * @param templateNames The template names, without extension.
+     */
+    void preload(const QStringList &templateNames);
+
+    /**
+     * @brief Returns whether a template is cached, found or not.
+     */
+    bool contains(const QString &templateName) const;
+
+    /**
+     * @brief Drops every cached template.
+     */
+    void clear();
+
+    /**
+     * @brief Returns how many times a template has been read from disk.
+     */
+    int loadCount() const;
+
+signals:
+    /**
+     * @brief Emitted after a changed template has been reloaded.
+     * @param templateName The template name.
+     */
+    void templateReloaded(const QString &templateName);
+
+    /**
+     * @brief Emitted when a template file cannot be read or resolved.
+     * @param error The error message.
+     */
+    void loadError(const QString &error);
+
+private slots:
+    void onFileChanged(const QString &path);
+    void onDirectoryChanged();
+    void reloadChanged();
+
+private:
+    /**
+     * @brief A cached template; filePath is empty if it was not found.
+     */
+    struct Entry
+    {
+        QString filePath;
+        QString styleSheet;
+    };
+
+    Entry load(const QString &templateName);
+    void resetWatcher();
+
+    QString m_templatesPath;
+    QHash<QString, Entry> m_entries;
+    QSet<QString> m_changedTemplates;
+    QFileSystemWatcher *m_watcher;
+    QTimer *m_reloadTimer;
+    int m_loadCount;
+};
+
+#endif // THEMECACHE_H
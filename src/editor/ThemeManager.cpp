@@ -1,27 +1,73 @@
 #include "ThemeManager.h"
 #include "StyleManager.h"
+#include "ThemeCache.h"
 
 #include <QSettings>
 #include <QTimer>
-
-#ifdef Q_OS_WIN
-#include <QSettings>
-#endif
-
-#ifdef Q_OS_MACOS
+#include <QElapsedTimer>
+#include <QEvent>
+#include <QCoreApplication>
+#include <QGuiApplication>
+#include <QFileSystemWatcher>
+#include <QFileInfo>
 #include <QProcess>
+#include <QDir>
+#include <QWidget>
+
+#if QT_VERSION >= QT_VERSION_CHECK(6, 5, 0)
+#include <QStyleHints>
 #endif
 
 #ifdef Q_OS_LINUX
-#include <QDir>
 #include <QFile>
 #include <QTextStream>
-#include <QProcess>
 #endif
 
 namespace {
     const QString SETTINGS_KEY = QStringLiteral("appearance/themeMode");
-    const int SYSTEM_THEME_POLL_INTERVAL_MS = 5000; // 5 seconds
+    const QString SYSTEM_DARK_KEY = QStringLiteral("appearance/lastSystemDark");
+    const int SYSTEM_THEME_REFRESH_DELAY_MS = 100; // Coalesces bursts of change events
+
+    /**
+     * @brief Returns the desktop settings files whose changes may switch the appearance.
+     */
+    QStringList systemSettingsFiles()
+    {
+#ifdef Q_OS_LINUX
+        // dconf/user is not watched: it is rewritten for every gsettings key,
+        // and each write would start a gsettings run. The platform theme
+        // reports color-scheme changes through ThemeChange instead.
+        return QStringList()
+            << QDir::homePath() + QStringLiteral("/.config/gtk-3.0/settings.ini");
+#else
+        return QStringList();
+#endif
+    }
+
+    /**
+     * @brief Returns the helper command that prints the system appearance.
+     * @return false if the platform has none.
+     */
+    bool detectionCommand(QString *program, QStringList *arguments)
+    {
+#if defined(Q_OS_MACOS)
+        *program = QStringLiteral("defaults");
+        *arguments = QStringList() << QStringLiteral("read")
+                                   << QStringLiteral("-g")
+                                   << QStringLiteral("AppleInterfaceStyle");
+        return true;
+#elif defined(Q_OS_LINUX)
+        *program = QStringLiteral("gsettings");
+        *arguments = QStringList() << QStringLiteral("get")
+                                   << QStringLiteral("org.gnome.desktop.interface")
+                                   << QStringLiteral("color-scheme");
+        return true;
+#else
+        Q_UNUSED(program);
+        Q_UNUSED(arguments);
+        return false;
+#endif
+    }
 }
 
 ThemeManager::ThemeManager(StyleManager *styleManager, QObject *parent)
@@ -29,18 +75,34 @@ ThemeManager::ThemeManager(StyleManager *styleManager, QObject *parent)
     , m_styleManager(styleManager)
     , m_currentMode(ThemeMode::System)
     , m_lastEffectiveTheme(ThemeMode::Light)
-    , m_systemThemeTimer(nullptr)
+    , m_systemDark(false)
+    , m_refreshTimer(nullptr)
+    , m_settingsWatcher(nullptr)
+    , m_detectionProcess(nullptr)
+    , m_detectionRerun(false)
+    , m_themeCache(nullptr)
+    , m_lastSwitchNsecs(-1)
 {
+    m_themeCache = new ThemeCache(this);
+    connect(m_themeCache, &ThemeCache::templateReloaded,
+            this, &ThemeManager::onTemplateReloaded);
+
     loadPreference();
-    m_lastEffectiveTheme = effectiveTheme();
+    updateThemeCache();
     setupSystemThemeWatcher();
+    if (m_currentMode == ThemeMode::System) {
+        updateSystemDarkMode();
+    }
+    m_lastEffectiveTheme = effectiveTheme();
     applyCurrentTheme();
 }
 
 ThemeManager::~ThemeManager()
 {
-    if (m_systemThemeTimer) {
-        m_systemThemeTimer->stop();
+    if (m_detectionProcess) {
+        m_detectionProcess->disconnect(this);
+        m_detectionProcess->kill();
+        m_detectionProcess->waitForFinished(100);
     }
 }
 
@@ -61,13 +123,9 @@ void ThemeManager::setThemeMode(ThemeMode mode)
 
     emit themeModeChanged(mode);
 
-    // Update system theme watcher based on mode
-    if (m_systemThemeTimer) {
-        if (mode == ThemeMode::System) {
-            m_systemThemeTimer->start();
-        } else {
-            m_systemThemeTimer->stop();
-        }
+    // The cached system appearance is only kept current in System mode
+    if (mode == ThemeMode::System) {
+        updateSystemDarkMode();
     }
 
     applyCurrentTheme();
@@ -81,17 +139,36 @@ void ThemeManager::setThemeMode(ThemeMode mode)
 
 bool ThemeManager::isSystemDarkMode() const
 {
-    return detectSystemDarkMode();
+    return m_systemDark;
 }
 
 ThemeManager::ThemeMode ThemeManager::effectiveTheme() const
 {
     if (m_currentMode == ThemeMode::System) {
-        return detectSystemDarkMode() ? ThemeMode::Dark : ThemeMode::Light;
+        return m_systemDark ? ThemeMode::Dark : ThemeMode::Light;
     }
     return m_currentMode;
 }
 
+QStringList ThemeManager::templateNames(ThemeMode effectiveTheme)
+{
+    if (effectiveTheme == ThemeMode::Dark) {
+        return QStringList() << QStringLiteral("dark");
+    }
+    // No light project ships with the application; VS Code Light stands in
+    return QStringList() << QStringLiteral("light") << QStringLiteral("vscode-light");
+}
+
+ThemeCache *ThemeManager::themeCache() const
+{
+    return m_themeCache;
+}
+
+double ThemeManager::lastSwitchDurationMs() const
+{
+    return m_lastSwitchNsecs < 0 ? -1.0 : m_lastSwitchNsecs / 1e6;
+}
+
 void ThemeManager::onSystemThemeChanged()
 {
     if (m_currentMode != ThemeMode::System) {
@@ -106,20 +183,106 @@ void ThemeManager::onSystemThemeChanged()
     }
 }
 
+void ThemeManager::refreshSystemTheme()
+{
+    if (m_currentMode != ThemeMode::System) {
+        return;
+    }
+
+    updateSystemDarkMode();
+    onSystemThemeChanged();
+}
+
+void ThemeManager::onSettingsPathChanged()
+{
+    // Editors that save by renaming drop the file from the watcher
+    watchSettingsPaths();
+    scheduleSystemThemeRefresh();
+}
+
+void ThemeManager::onDetectionProcessFinished()
+{
+    QProcess *process = m_detectionProcess;
+    if (!process) {
+        return;
+    }
+    m_detectionProcess = nullptr;
+
+    // A failed start, a crash or a missing key all count as light mode
+    bool dark = false;
+    if (process->exitStatus() == QProcess::NormalExit && process->exitCode() == 0) {
+        const QString output = QString::fromUtf8(process->readAllStandardOutput()).trimmed();
+        dark = output.contains(QStringLiteral("dark"), Qt::CaseInsensitive);
+    }
+    process->deleteLater();
+
+    // Remembered so the next start applies it before the helper reports back
+    if (dark != m_systemDark) {
+        QSettings settings;
+        settings.setValue(SYSTEM_DARK_KEY, dark);
+    }
+    m_systemDark = dark;
+    if (m_detectionRerun) {
+        startDetectionProcess();
+    }
+    onSystemThemeChanged();
+}
+
+bool ThemeManager::eventFilter(QObject *watched, QEvent *event)
+{
+    if (event->type() == QEvent::ApplicationPaletteChange
+        || event->type() == QEvent::ThemeChange) {
+        scheduleSystemThemeRefresh();
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+void ThemeManager::onTemplateReloaded(const QString &templateName)
+{
+    if (templateName == m_appliedTemplate) {
+        applyCurrentTheme();
+    }
+}
+
 void ThemeManager::applyCurrentTheme()
 {
     if (!m_styleManager) {
         return;
     }
 
-    ThemeMode effective = effectiveTheme();
-    QString templateName = (effective == ThemeMode::Dark) ? QStringLiteral("dark") 
-                                                          : QStringLiteral("light");
+    updateThemeCache();
+
+    QElapsedTimer timer;
+    timer.start();
 
-    QString qss = m_styleManager->loadTemplate(templateName);
-    if (!qss.isEmpty()) {
-        m_styleManager->applyStyleSheet(qss);
+    const ThemeMode effective = effectiveTheme();
+    QString qss;
+    for (const QString &templateName : templateNames(effective)) {
+        qss = m_themeCache->styleSheet(templateName);
+        if (!qss.isEmpty()) {
+            m_appliedTemplate = templateName;
+            break;
+        }
+    }
+    if (qss.isEmpty()) {
+        return;
     }
+
+    m_styleManager->applyStyleSheet(qss);
+
+    m_lastSwitchNsecs = timer.nsecsElapsed();
+    emit themeApplied(effective, lastSwitchDurationMs());
+}
+
+void ThemeManager::updateThemeCache()
+{
+    if (!m_styleManager || m_themeCache->templatesPath() == m_styleManager->templatesPath()) {
+        return;
+    }
+
+    // Resolve both themes up front so switching does no I/O
+    m_themeCache->setTemplatesPath(m_styleManager->templatesPath());
+    m_themeCache->preload(templateNames(ThemeMode::Dark) + templateNames(ThemeMode::Light));
 }
 
 void ThemeManager::loadPreference()
@@ -133,6 +296,10 @@ void ThemeManager::loadPreference()
     } else {
         m_currentMode = static_cast<ThemeMode>(modeValue);
     }
+
+    // The last appearance the helper process reported stands in until it
+    // reports again, so System mode does not start in the wrong theme
+    m_systemDark = settings.value(SYSTEM_DARK_KEY, false).toBool();
 }
 
 void ThemeManager::savePreference()
@@ -142,78 +309,156 @@ void ThemeManager::savePreference()
 }
 
 
-bool ThemeManager::detectSystemDarkMode() const
+bool ThemeManager::detectSystemDarkMode(bool *dark) const
 {
+#if QT_VERSION >= QT_VERSION_CHECK(6, 5, 0)
+    // The platform theme knows the answer on most desktops
+    if (qobject_cast<QGuiApplication *>(QCoreApplication::instance())) {
+        const Qt::ColorScheme scheme = QGuiApplication::styleHints()->colorScheme();
+        if (scheme != Qt::ColorScheme::Unknown) {
+            *dark = scheme == Qt::ColorScheme::Dark;
+            return true;
+        }
+    }
+#endif
+
 #ifdef Q_OS_WIN
     // Windows: Read registry AppsUseLightTheme
     // Value of 0 means dark mode, 1 means light mode
     QSettings settings(
         QStringLiteral("HKEY_CURRENT_USER\\Software\\Microsoft\\Windows\\CurrentVersion\\Themes\\Personalize"),
         QSettings::NativeFormat);
-    return settings.value(QStringLiteral("AppsUseLightTheme"), 1).toInt() == 0;
+    *dark = settings.value(QStringLiteral("AppsUseLightTheme"), 1).toInt() == 0;
+    return true;
 #elif defined(Q_OS_MACOS)
-    // macOS: Use defaults read for AppleInterfaceStyle
-    QProcess process;
-    process.start(QStringLiteral("defaults"), 
-                  QStringList() << QStringLiteral("read") 
-                               << QStringLiteral("-g") 
-                               << QStringLiteral("AppleInterfaceStyle"));
-    process.waitForFinished(1000);
-    QString output = QString::fromUtf8(process.readAllStandardOutput()).trimmed();
-    return output.compare(QStringLiteral("Dark"), Qt::CaseInsensitive) == 0;
+    // macOS: AppleInterfaceStyle is only readable through defaults
+    *dark = false;
+    return false;
 #elif defined(Q_OS_LINUX)
     // Linux: Check GTK theme name for "dark" keyword
-    // Try multiple locations for GTK settings
-    
-    // First try GTK 3.0 settings.ini
-    QString configPath = QDir::homePath() + QStringLiteral("/.config/gtk-3.0/settings.ini");
-    QFile file(configPath);
+    QFile file(systemSettingsFiles().first());
     if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
         QTextStream in(&file);
         while (!in.atEnd()) {
             QString line = in.readLine();
             if (line.startsWith(QStringLiteral("gtk-theme-name"), Qt::CaseInsensitive)) {
-                file.close();
-                return line.contains(QStringLiteral("dark"), Qt::CaseInsensitive);
+                *dark = line.contains(QStringLiteral("dark"), Qt::CaseInsensitive);
+                return true;
             }
         }
-        file.close();
     }
-    
+
     // Try environment variable
     QString gtkTheme = qEnvironmentVariable("GTK_THEME");
     if (!gtkTheme.isEmpty()) {
-        return gtkTheme.contains(QStringLiteral("dark"), Qt::CaseInsensitive);
-    }
-    
-    // Fallback: check XDG color-scheme via gsettings (if available)
-    QProcess process;
-    process.start(QStringLiteral("gsettings"), 
-                  QStringList() << QStringLiteral("get") 
-                               << QStringLiteral("org.gnome.desktop.interface") 
-                               << QStringLiteral("color-scheme"));
-    process.waitForFinished(1000);
-    if (process.exitCode() == 0) {
-        QString output = QString::fromUtf8(process.readAllStandardOutput()).trimmed();
-        return output.contains(QStringLiteral("dark"), Qt::CaseInsensitive);
-    }
-    
-    // Default to light mode if detection fails
+        *dark = gtkTheme.contains(QStringLiteral("dark"), Qt::CaseInsensitive);
+        return true;
+    }
+
+    // The XDG color-scheme is only readable through gsettings
+    *dark = false;
     return false;
 #else
     // Unknown platform: default to light mode
-    return false;
+    *dark = false;
+    return true;
 #endif
 }
 
+void ThemeManager::updateSystemDarkMode()
+{
+    bool dark = false;
+    if (detectSystemDarkMode(&dark)) {
+        m_systemDark = dark;
+    } else {
+        startDetectionProcess();
+    }
+}
+
+void ThemeManager::startDetectionProcess()
+{
+    if (m_detectionProcess) {
+        // The running process may have read the old value
+        m_detectionRerun = true;
+        return;
+    }
+
+    QString program;
+    QStringList arguments;
+    if (!detectionCommand(&program, &arguments)) {
+        m_systemDark = false;
+        return;
+    }
+
+    m_detectionRerun = false;
+    m_detectionProcess = new QProcess(this);
+    connect(m_detectionProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, &ThemeManager::onDetectionProcessFinished);
+    connect(m_detectionProcess, &QProcess::errorOccurred,
+            this, [this](QProcess::ProcessError error) {
+        // finished() is not emitted when the helper is missing
+        if (error == QProcess::FailedToStart) {
+            onDetectionProcessFinished();
+        }
+    });
+    m_detectionProcess->start(program, arguments);
+}
+
+void ThemeManager::scheduleSystemThemeRefresh()
+{
+    if (m_currentMode == ThemeMode::System && m_refreshTimer) {
+        m_refreshTimer->start();
+    }
+}
+
+void ThemeManager::watchSettingsPaths()
+{
+    if (!m_settingsWatcher) {
+        return;
+    }
+
+    const QStringList watched = m_settingsWatcher->files() + m_settingsWatcher->directories();
+    QStringList paths;
+    for (const QString &file : systemSettingsFiles()) {
+        // The directory catches the file being created or replaced
+        const QStringList candidates = { QFileInfo(file).absolutePath(), file };
+        for (const QString &path : candidates) {
+            if (!watched.contains(path) && !paths.contains(path) && QFileInfo::exists(path)) {
+                paths << path;
+            }
+        }
+    }
+    if (!paths.isEmpty()) {
+        m_settingsWatcher->addPaths(paths);
+    }
+}
+
 void ThemeManager::setupSystemThemeWatcher()
 {
-    m_systemThemeTimer = new QTimer(this);
-    m_systemThemeTimer->setInterval(SYSTEM_THEME_POLL_INTERVAL_MS);
-    connect(m_systemThemeTimer, &QTimer::timeout, this, &ThemeManager::onSystemThemeChanged);
+    m_refreshTimer = new QTimer(this);
+    m_refreshTimer->setSingleShot(true);
+    m_refreshTimer->setInterval(SYSTEM_THEME_REFRESH_DELAY_MS);
+    connect(m_refreshTimer, &QTimer::timeout, this, &ThemeManager::refreshSystemTheme);
 
-    // Only start the timer if we're in System mode
-    if (m_currentMode == ThemeMode::System) {
-        m_systemThemeTimer->start();
+    // Palette and theme changes reach every top-level, so the owning window
+    // is enough; a filter on the application would see every event
+    if (QWidget *widget = qobject_cast<QWidget *>(parent())) {
+        widget->window()->installEventFilter(this);
+    }
+
+#if QT_VERSION >= QT_VERSION_CHECK(6, 5, 0)
+    if (qobject_cast<QGuiApplication *>(QCoreApplication::instance())) {
+        connect(QGuiApplication::styleHints(), &QStyleHints::colorSchemeChanged,
+                this, &ThemeManager::scheduleSystemThemeRefresh);
+    }
+#endif
+
+    if (!systemSettingsFiles().isEmpty()) {
+        m_settingsWatcher = new QFileSystemWatcher(this);
+        connect(m_settingsWatcher, &QFileSystemWatcher::fileChanged,
+                this, &ThemeManager::onSettingsPathChanged);
+        connect(m_settingsWatcher, &QFileSystemWatcher::directoryChanged,
+                this, &ThemeManager::onSettingsPathChanged);
+        watchSettingsPaths();
     }
 }
@@ -2,9 +2,14 @@
 #define THEMEMANAGER_H
 
 #include <QObject>
+#include <QString>
+#include <QStringList>
 
 class StyleManager;
+class ThemeCache;
 class QTimer;
+class QProcess;
+class QFileSystemWatcher;
 
 /**
  * @brief Manages UI theme preferences (Dark, Light, System).
@@ -14,6 +19,18 @@ class QTimer;
  * - Detecting the system's current appearance setting
  * - Persisting preferences via QSettings
  * - Automatically updating the theme when system appearance changes
+ *
+ * The system appearance is cached and refreshed only when something signals
+ * a change: palette or theme change events on the window that owns the
+ * manager, the style hints' color scheme (Qt 6.5+), or edits to the GTK
+ * settings file. Sources that can only be queried through a helper process
+ * (gsettings, defaults) are read asynchronously; until the process reports
+ * back, the previous result stays in effect, starting with the last one
+ * saved in QSettings.
+ *
+ * The dark and light templates are resolved once into a ThemeCache, so a
+ * switch only installs an in-memory stylesheet. The time each switch takes
+ * is reported through themeApplied().
  */
 class ThemeManager : public QObject
 {
@@ -58,7 +75,7 @@ public:
 
     /**
      * @brief Checks if the system is currently in dark mode.
-     * @return true if system dark mode is detected, false otherwise.
+     * @return The cached result of the last detection.
      */
     bool isSystemDarkMode() const;
 
@@ -68,6 +85,33 @@ public:
      */
     ThemeMode effectiveTheme() const;
 
+    /**
+     * @brief Returns the template names tried, in order, for an effective theme.
+     * @param effectiveTheme ThemeMode::Dark or ThemeMode::Light.
+     *
+     * The first template that resolves to a non-empty stylesheet is applied.
+     */
+    static QStringList templateNames(ThemeMode effectiveTheme);
+
+    /**
+     * @brief Returns the cache holding the resolved theme stylesheets.
+     */
+    ThemeCache *themeCache() const;
+
+    /**
+     * @brief Returns how long the last theme switch took.
+     * @return The duration in milliseconds, or -1 if no theme was applied.
+     *
+     * The duration covers the cache lookup and the StyleManager apply.
+     */
+    double lastSwitchDurationMs() const;
+
+protected:
+    /**
+     * @brief Watches palette and theme change events on the owning window.
+     */
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
 signals:
     /**
      * @brief Emitted when the theme mode changes.
@@ -85,18 +129,50 @@ signals:
      */
     void effectiveThemeChanged(ThemeMode effectiveTheme);
 
+    /**
+     * @brief Emitted after a theme stylesheet has been applied.
+     * @param effectiveTheme The applied theme (Dark or Light).
+     * @param durationMs How long the switch took, in milliseconds.
+     */
+    void themeApplied(ThemeMode effectiveTheme, double durationMs);
+
 private slots:
     /**
-     * @brief Called when the system theme may have changed.
+     * @brief Called when the cached system appearance may have changed.
      */
     void onSystemThemeChanged();
 
+    /**
+     * @brief Re-detects the system appearance and applies it.
+     */
+    void refreshSystemTheme();
+
+    /**
+     * @brief Called when a watched settings file or directory changes.
+     */
+    void onSettingsPathChanged();
+
+    /**
+     * @brief Called when the detection helper process exits.
+     */
+    void onDetectionProcessFinished();
+
+    /**
+     * @brief Reapplies the theme if its template changed on disk.
+     */
+    void onTemplateReloaded(const QString &templateName);
+
 private:
     /**
      * @brief Applies the current theme based on mode and system settings.
      */
     void applyCurrentTheme();
 
+    /**
+     * @brief Points the theme cache at the StyleManager templates and fills it.
+     */
+    void updateThemeCache();
+
     /**
      * @brief Loads the theme preference from QSettings.
      */
@@ -108,20 +184,50 @@ private:
     void savePreference();
 
     /**
-     * @brief Detects if the system is in dark mode.
-     * @return true if system dark mode is detected.
+     * @brief Detects if the system is in dark mode without blocking.
+     * @param dark Set to true if system dark mode is detected.
+     * @return false if only the helper process can tell.
+     */
+    bool detectSystemDarkMode(bool *dark) const;
+
+    /**
+     * @brief Updates the cached system appearance.
+     *
+     * Starts the helper process when the non-blocking sources are inconclusive.
+     */
+    void updateSystemDarkMode();
+
+    /**
+     * @brief Starts the detection helper process, or queues a rerun if one is running.
+     */
+    void startDetectionProcess();
+
+    /**
+     * @brief Restarts the coalescing timer for system theme refreshes.
+     */
+    void scheduleSystemThemeRefresh();
+
+    /**
+     * @brief Adds the existing settings files and directories to the watcher.
      */
-    bool detectSystemDarkMode() const;
+    void watchSettingsPaths();
 
     /**
-     * @brief Sets up the system theme change watcher.
+     * @brief Sets up the system theme change watchers.
      */
     void setupSystemThemeWatcher();
 
     StyleManager *m_styleManager;
     ThemeMode m_currentMode;
     ThemeMode m_lastEffectiveTheme;
-    QTimer *m_systemThemeTimer;
+    bool m_systemDark;
+    QTimer *m_refreshTimer;
+    QFileSystemWatcher *m_settingsWatcher;
+    QProcess *m_detectionProcess;
+    bool m_detectionRerun;
+    ThemeCache *m_themeCache;
+    QString m_appliedTemplate;
+    qint64 m_lastSwitchNsecs;
 };
 
 #endif // THEMEMANAGER_H
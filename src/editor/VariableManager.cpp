@@ -6,9 +6,244 @@
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QRegularExpression>
+#include <QSet>
+
+#include <algorithm>
+
+namespace {
+
+/**
+ * @brief A ${name} reference found in text.
+ */
+struct ReferenceSpan
+{
+    int start;
+    int length;
+    QString name;
+};
+
+/**
+ * @brief Finds the ${name} references in text, left to right.
+ *
+ * A name starts with an ASCII letter or underscore and continues with
+ * letters, digits, underscores or hyphens.
+ */
+QVector<ReferenceSpan> scanReferences(const QString &text)
+{
+    auto isNameStart = [](QChar c) {
+        const ushort u = c.unicode();
+        return (u >= 'a' && u <= 'z') || (u >= 'A' && u <= 'Z') || u == '_';
+    };
+    auto isNameChar = [&isNameStart](QChar c) {
+        const ushort u = c.unicode();
+        return isNameStart(c) || (u >= '0' && u <= '9') || u == '-';
+    };
+
+    QVector<ReferenceSpan> spans;
+    const int length = text.size();
+    const QChar *data = text.constData();
+    int i = 0;
+    while (i + 2 < length) {
+        if (data[i] != QLatin1Char('$') || data[i + 1] != QLatin1Char('{')
+            || !isNameStart(data[i + 2])) {
+            ++i;
+            continue;
+        }
+
+        int end = i + 3;
+        while (end < length && isNameChar(data[end])) {
+            ++end;
+        }
+        if (end >= length || data[end] != QLatin1Char('}')) {
+            ++i;
+            continue;
+        }
+
+        spans.append({i, end + 1 - i, QString(data + i + 2, end - i - 2)});
+        i = end + 1;
+    }
+    return spans;
+}
+
+/**
+ * @brief Returns the distinct variable names referenced by a value.
+ */
+QStringList referencedNames(const QString &value)
+{
+    QStringList names;
+    for (const ReferenceSpan &span : scanReferences(value)) {
+        if (!names.contains(span.name)) {
+            names.append(span.name);
+        }
+    }
+    return names;
+}
+
+bool findPath(const QString &current, const QString &target,
+              const QHash<QString, QStringList> &dependencies,
+              QSet<QString> &visited, QStringList &path)
+{
+    for (const QString &dependency : dependencies.value(current)) {
+        if (dependency == target) {
+            path.append(dependency);
+            return true;
+        }
+        if (visited.contains(dependency)) {
+            continue;
+        }
+        visited.insert(dependency);
+        path.append(dependency);
+        if (findPath(dependency, target, dependencies, visited, path)) {
+            return true;
+        }
+        path.removeLast();
+    }
+    return false;
+}
+
+/**
+ * @brief Finds a dependency cycle through a variable.
+ * @return The cycle as a path starting and ending with start, or an empty
+ *         list if start is not on a cycle.
+ */
+QStringList findDependencyCycle(const QString &start, const QHash<QString, QStringList> &dependencies)
+{
+    QStringList path{start};
+    QSet<QString> visited{start};
+    if (findPath(start, start, dependencies, visited, path)) {
+        return path;
+    }
+    return QStringList();
+}
+
+/**
+ * @brief Tarjan's strongly connected components walk, see cyclicNames().
+ */
+struct ComponentSearch
+{
+    const QHash<QString, QStringList> &dependencies;
+    QHash<QString, int> index;
+    QHash<QString, int> lowLink;
+    QStringList stack;
+    QSet<QString> onStack;
+    QSet<QString> cyclic;
+
+    void visit(const QString &name)
+    {
+        const int order = index.size();
+        index.insert(name, order);
+        lowLink.insert(name, order);
+        stack.append(name);
+        onStack.insert(name);
+
+        for (const QString &dependency : dependencies.value(name)) {
+            if (!index.contains(dependency)) {
+                visit(dependency);
+                lowLink[name] = qMin(lowLink.value(name), lowLink.value(dependency));
+            } else if (onStack.contains(dependency)) {
+                lowLink[name] = qMin(lowLink.value(name), index.value(dependency));
+            }
+        }
+
+        if (lowLink.value(name) != index.value(name)) {
+            return;
+        }
+
+        // A component is a cycle if it has several members or references itself
+        QStringList component;
+        QString member;
+        do {
+            member = stack.takeLast();
+            onStack.remove(member);
+            component.append(member);
+        } while (member != name);
+        if (component.size() > 1 || dependencies.value(name).contains(name)) {
+            for (const QString &cyclicName : qAsConst(component)) {
+                cyclic.insert(cyclicName);
+            }
+        }
+    }
+};
+
+/**
+ * @brief Finds every variable that lies on a dependency cycle.
+ *
+ * One pass over the whole graph, so callers can memoize the result
+ * instead of searching for a cycle through each variable.
+ */
+QSet<QString> cyclicNames(const QHash<QString, QStringList> &dependencies)
+{
+    ComponentSearch search{dependencies, {}, {}, {}, {}, {}};
+    for (auto it = dependencies.constBegin(); it != dependencies.constEnd(); ++it) {
+        if (!search.index.contains(it.key())) {
+            search.visit(it.key());
+        }
+    }
+    return search.cyclic;
+}
+
+/**
+ * @brief Orders variables so each comes after the variables it references.
+ *
+ * Kahn's algorithm; variables on a cycle, or depending on one, are left
+ * out of the order and returned through blocked.
+ */
+QStringList topologicalOrder(const QStringList &names,
+                             const QHash<QString, QStringList> &dependencies,
+                             QStringList *blocked)
+{
+    const QSet<QString> defined(names.constBegin(), names.constEnd());
+    QHash<QString, int> pending;
+    QHash<QString, QStringList> dependents;
+    QStringList ready;
+    for (const QString &name : names) {
+        int count = 0;
+        for (const QString &dependency : dependencies.value(name)) {
+            // References to undefined variables never block resolution
+            if (defined.contains(dependency)) {
+                dependents[dependency].append(name);
+                ++count;
+            }
+        }
+        pending.insert(name, count);
+        if (count == 0) {
+            ready.append(name);
+        }
+    }
+
+    QStringList order;
+    order.reserve(names.size());
+    for (int i = 0; i < ready.size(); ++i) {
+        const QString name = ready.at(i);
+        order.append(name);
+        for (const QString &dependent : dependents.value(name)) {
+            if (--pending[dependent] == 0) {
+                ready.append(dependent);
+            }
+        }
+    }
+
+    if (blocked) {
+        blocked->clear();
+        for (const QString &name : names) {
+            if (pending.value(name) > 0) {
+                blocked->append(name);
+            }
+        }
+    }
+    return order;
+}
+
+} // namespace
 
 VariableManager::VariableManager(QObject *parent)
     : QObject(parent)
+    , m_valueResolveCount(0)
+    , m_cyclesKnown(false)
+    , m_hasCompiledTemplate(false)
+    , m_templateCompileCount(0)
+    , m_hasResult(false)
+    , m_changedRulesKnown(false)
 {
 }
 
@@ -19,12 +254,20 @@ VariableManager::VariableManager(QObject *parent)
 void VariableManager::setVariable(const QString &name, const QString &value)
 {
     m_variables[name] = value;
+    updateDependencies(name);
+    invalidateResolved(name);
     emit variableChanged(name, value);
+
+    if (cyclicVariables().contains(name)) {
+        emit cycleDetected(findDependencyCycle(name, m_dependencies));
+    }
 }
 
 void VariableManager::removeVariable(const QString &name)
 {
     if (m_variables.remove(name) > 0) {
+        updateDependencies(name);
+        invalidateResolved(name);
         emit variableRemoved(name);
     }
 }
@@ -52,62 +295,379 @@ bool VariableManager::hasVariable(const QString &name) const
 void VariableManager::clearVariables()
 {
     m_variables.clear();
+    m_dependencies.clear();
+    m_dependents.clear();
+    m_resolvedCache.clear();
+    m_cyclicVariables.clear();
+    m_cyclesKnown = false;
     emit variablesCleared();
 }
 
+// =============================================================================
+// Nested Variables
+// =============================================================================
+
+QString VariableManager::resolvedValue(const QString &name) const
+{
+    const auto cached = m_resolvedCache.constFind(name);
+    if (cached != m_resolvedCache.constEnd()) {
+        return cached.value();
+    }
+
+    const auto raw = m_variables.constFind(name);
+    if (raw == m_variables.constEnd()) {
+        return QString();
+    }
+
+    ++m_valueResolveCount;
+
+    // A variable on a cycle keeps its references unresolved; any other
+    // variable only depends on variables that resolve without reaching it
+    QString resolved;
+    if (cyclicVariables().contains(name)) {
+        resolved = raw.value();
+    } else {
+        resolved = resolveValue(raw.value());
+    }
+
+    m_resolvedCache.insert(name, resolved);
+    return resolved;
+}
+
+QString VariableManager::resolveValue(const QString &value) const
+{
+    const QVector<ReferenceSpan> spans = scanReferences(value);
+    if (spans.isEmpty()) {
+        return value;
+    }
+
+    QString result;
+    result.reserve(value.size());
+    int pos = 0;
+    for (const ReferenceSpan &span : spans) {
+        result.append(value.constData() + pos, span.start - pos);
+        if (m_variables.contains(span.name)) {
+            result += resolvedValue(span.name);
+        } else {
+            result.append(value.constData() + span.start, span.length);
+        }
+        pos = span.start + span.length;
+    }
+    result.append(value.constData() + pos, value.size() - pos);
+    return result;
+}
+
+QStringList VariableManager::dependencies(const QString &name) const
+{
+    return m_dependencies.value(name);
+}
+
+QStringList VariableManager::dependents(const QString &name) const
+{
+    QStringList result;
+    QSet<QString> seen{name};
+    QStringList queue{name};
+    for (int i = 0; i < queue.size(); ++i) {
+        for (const QString &dependent : m_dependents.value(queue.at(i))) {
+            if (!seen.contains(dependent)) {
+                seen.insert(dependent);
+                queue.append(dependent);
+                result.append(dependent);
+            }
+        }
+    }
+    return result;
+}
+
+QStringList VariableManager::resolutionOrder(QStringList *blocked) const
+{
+    return topologicalOrder(m_variables.keys(), m_dependencies, blocked);
+}
+
+QStringList VariableManager::findCycle(const QString &name) const
+{
+    return findDependencyCycle(name, m_dependencies);
+}
+
+int VariableManager::valueResolveCount() const
+{
+    return m_valueResolveCount;
+}
+
+const QSet<QString> &VariableManager::cyclicVariables() const
+{
+    if (!m_cyclesKnown) {
+        m_cyclicVariables = cyclicNames(m_dependencies);
+        m_cyclesKnown = true;
+    }
+    return m_cyclicVariables;
+}
+
+void VariableManager::updateDependencies(const QString &name)
+{
+    m_cyclesKnown = false;
+    for (const QString &dependency : m_dependencies.value(name)) {
+        auto it = m_dependents.find(dependency);
+        if (it != m_dependents.end()) {
+            it.value().remove(name);
+            if (it.value().isEmpty()) {
+                m_dependents.erase(it);
+            }
+        }
+    }
+
+    const QStringList names = m_variables.contains(name)
+        ? referencedNames(m_variables.value(name)) : QStringList();
+    if (names.isEmpty()) {
+        m_dependencies.remove(name);
+        return;
+    }
+
+    m_dependencies.insert(name, names);
+    for (const QString &dependency : names) {
+        m_dependents[dependency].insert(name);
+    }
+}
+
+void VariableManager::invalidateResolved(const QString &name)
+{
+    // Only the variable and whatever transitively references it can change
+    m_resolvedCache.remove(name);
+    for (const QString &dependent : dependents(name)) {
+        m_resolvedCache.remove(dependent);
+    }
+}
+
+void VariableManager::rebuildDependencies()
+{
+    m_dependencies.clear();
+    m_dependents.clear();
+    m_resolvedCache.clear();
+    m_cyclesKnown = false;
+    for (auto it = m_variables.constBegin(); it != m_variables.constEnd(); ++it) {
+        updateDependencies(it.key());
+    }
+}
+
 // =============================================================================
 // Substitution
 // =============================================================================
 
 QString VariableManager::substitute(const QString &qssTemplate) const
 {
-    QString result = qssTemplate;
-    
-    // Pattern: ${variable_name} where name starts with letter/underscore
-    // and contains letters, numbers, underscores, or hyphens
-    static const QRegularExpression varPattern(
-        QStringLiteral("\\$\\{([a-zA-Z_][a-zA-Z0-9_-]*)\\}")
-    );
-    
-    // Find all matches and replace from end to start to preserve positions
-    QRegularExpressionMatchIterator it = varPattern.globalMatch(qssTemplate);
-    QList<QRegularExpressionMatch> matches;
-    while (it.hasNext()) {
-        matches.append(it.next());
+    compileTemplate(qssTemplate);
+
+    // Resolved values of the referenced variables; undefined ones are absent
+    QHash<QString, QString> values;
+    values.reserve(m_referenceIndex.size());
+    for (auto it = m_referenceIndex.constBegin(); it != m_referenceIndex.constEnd(); ++it) {
+        if (m_variables.contains(it.key())) {
+            values.insert(it.key(), resolvedValue(it.key()));
+        }
     }
-    
-    // Process matches in reverse order
-    for (int i = matches.size() - 1; i >= 0; --i) {
-        const QRegularExpressionMatch &match = matches[i];
-        QString varName = match.captured(1);
-        
-        // Only substitute if variable exists
-        if (m_variables.contains(varName)) {
-            result.replace(match.capturedStart(), match.capturedLength(),
-                          m_variables.value(varName));
+
+    if (m_hasResult) {
+        // Same template as the previous call: the reverse index tells which
+        // rules are touched by variables whose value changed since then
+        QVector<int> changedRules;
+        bool changed = false;
+        for (auto it = m_referenceIndex.constBegin(); it != m_referenceIndex.constEnd(); ++it) {
+            const auto current = values.constFind(it.key());
+            const auto previous = m_resolvedValues.constFind(it.key());
+            const bool definedNow = current != values.constEnd();
+            const bool definedBefore = previous != m_resolvedValues.constEnd();
+            if (definedNow == definedBefore && (!definedNow || current.value() == previous.value())) {
+                continue;
+            }
+            changed = true;
+            for (int index : it.value()) {
+                if (m_segments.at(index).rule >= 0) {
+                    changedRules.append(m_segments.at(index).rule);
+                }
+            }
         }
+
+        std::sort(changedRules.begin(), changedRules.end());
+        changedRules.erase(std::unique(changedRules.begin(), changedRules.end()),
+                           changedRules.end());
+        m_changedRules = changedRules;
+        m_changedRulesKnown = true;
+        m_previousResult = m_lastResult;
+        if (!changed) {
+            return m_lastResult;
+        }
+    } else {
+        m_changedRules.clear();
+        m_changedRulesKnown = false;
+        m_previousResult.clear();
     }
-    
+
+    // Size the output up front so the join never reallocates
+    int resolvedLength = 0;
+    for (const TemplateSegment &segment : qAsConst(m_segments)) {
+        if (!segment.name.isEmpty()) {
+            const auto it = values.constFind(segment.name);
+            if (it != values.constEnd()) {
+                resolvedLength += it.value().size();
+                continue;
+            }
+        }
+        resolvedLength += segment.length;
+    }
+
+    QString result;
+    result.reserve(resolvedLength);
+
+    const QChar *source = m_compiledTemplate.constData();
+    for (const TemplateSegment &segment : qAsConst(m_segments)) {
+        if (!segment.name.isEmpty()) {
+            const auto it = values.constFind(segment.name);
+            if (it != values.constEnd()) {
+                result += it.value();
+                continue;
+            }
+        }
+        // Literals and undefined references are copied through unchanged
+        result.append(source + segment.start, segment.length);
+    }
+
+    // Remember the values this result was built from
+    m_resolvedValues = values;
+    m_lastResult = result;
+    m_hasResult = true;
+
     return result;
 }
 
+int VariableManager::templateCompileCount() const
+{
+    return m_templateCompileCount;
+}
+
+bool VariableManager::lastChangedRules(QVector<int> *rules, QString *previousResult) const
+{
+    if (!m_changedRulesKnown) {
+        return false;
+    }
+    if (rules) {
+        *rules = m_changedRules;
+    }
+    if (previousResult) {
+        *previousResult = m_previousResult;
+    }
+    return true;
+}
+
+QVector<int> VariableManager::referenceOffsets(const QString &name) const
+{
+    QVector<int> offsets;
+    for (int index : m_referenceIndex.value(name)) {
+        offsets.append(m_segments.at(index).start);
+    }
+    return offsets;
+}
+
+QVector<int> VariableManager::rulesReferencing(const QString &name) const
+{
+    QVector<int> rules;
+    for (int index : m_referenceIndex.value(name)) {
+        const int rule = m_segments.at(index).rule;
+        if (rule >= 0 && (rules.isEmpty() || rules.last() != rule)) {
+            rules.append(rule);
+        }
+    }
+    return rules;
+}
+
+void VariableManager::compileTemplate(const QString &qssTemplate) const
+{
+    if (m_hasCompiledTemplate && m_compiledTemplate == qssTemplate) {
+        return;
+    }
+
+    m_compiledTemplate = qssTemplate;
+    m_segments.clear();
+    m_referenceIndex.clear();
+    m_hasCompiledTemplate = true;
+    m_hasResult = false;
+    ++m_templateCompileCount;
+
+    const int length = qssTemplate.size();
+    const QChar *text = qssTemplate.constData();
+    int literalStart = 0;
+    for (const ReferenceSpan &span : scanReferences(qssTemplate)) {
+        if (span.start > literalStart) {
+            m_segments.append({literalStart, span.start - literalStart, QString(), -1});
+        }
+        m_segments.append({span.start, span.length, span.name, -1});
+        literalStart = span.start + span.length;
+    }
+    if (literalStart < length) {
+        m_segments.append({literalStart, length - literalStart, QString(), -1});
+    }
+
+    // Number the rules the way QssRuleSet::parse() does, skipping comments,
+    // quoted strings and parenthesized text, so each reference knows which
+    // rule of the resolved document it lands in. References in comments
+    // belong to no rule.
+    int rule = 0;
+    bool inBlock = false;
+    bool inComment = false;
+    int depth = 0;
+    QChar quote;
+    for (int index = 0; index < m_segments.size(); ++index) {
+        TemplateSegment &segment = m_segments[index];
+        if (!segment.name.isEmpty()) {
+            segment.rule = inComment ? -1 : rule;
+            m_referenceIndex[segment.name].append(index);
+            continue;
+        }
+
+        const int segmentEnd = segment.start + segment.length;
+        for (int pos = segment.start; pos < segmentEnd; ++pos) {
+            const QChar c = text[pos];
+            const bool hasNext = pos + 1 < segmentEnd;
+            if (inComment) {
+                if (c == QLatin1Char('*') && hasNext && text[pos + 1] == QLatin1Char('/')) {
+                    inComment = false;
+                    ++pos;
+                }
+            } else if (!quote.isNull()) {
+                if (c == QLatin1Char('\\')) {
+                    ++pos;
+                } else if (c == quote) {
+                    quote = QChar();
+                }
+            } else if (c == QLatin1Char('/') && hasNext && text[pos + 1] == QLatin1Char('*')) {
+                inComment = true;
+                ++pos;
+            } else if (c == QLatin1Char('"') || c == QLatin1Char('\'')) {
+                quote = c;
+            } else if (c == QLatin1Char('(') || c == QLatin1Char('[')) {
+                ++depth;
+            } else if ((c == QLatin1Char(')') || c == QLatin1Char(']')) && depth > 0) {
+                --depth;
+            } else if (depth == 0 && c == QLatin1Char('{')) {
+                inBlock = true;
+            } else if (depth == 0 && c == QLatin1Char('}') && inBlock) {
+                inBlock = false;
+                ++rule;
+            }
+        }
+    }
+}
+
 QStringList VariableManager::findVariableReferences(const QString &qssTemplate) const
 {
+    compileTemplate(qssTemplate);
+
     QStringList references;
-    
-    static const QRegularExpression varPattern(
-        QStringLiteral("\\$\\{([a-zA-Z_][a-zA-Z0-9_-]*)\\}")
-    );
-    
-    QRegularExpressionMatchIterator it = varPattern.globalMatch(qssTemplate);
-    while (it.hasNext()) {
-        QRegularExpressionMatch match = it.next();
-        QString varName = match.captured(1);
-        if (!references.contains(varName)) {
-            references.append(varName);
+    for (const TemplateSegment &segment : qAsConst(m_segments)) {
+        if (!segment.name.isEmpty() && !references.contains(segment.name)) {
+            references.append(segment.name);
         }
     }
-    
+
     return references;
 }
 
@@ -198,13 +758,43 @@ bool VariableManager::loadProject(const QString &filePath, QString &qssTemplate)
     }
     
     // Load variables
-    m_variables.clear();
+    QMap<QString, QString> variables;
     if (root.contains(QStringLiteral("variables"))) {
         QJsonObject varsObj = root[QStringLiteral("variables")].toObject();
         for (auto it = varsObj.constBegin(); it != varsObj.constEnd(); ++it) {
-            m_variables[it.key()] = it.value().toString();
+            variables[it.key()] = it.value().toString();
         }
     }
+
+    m_variables = variables;
+    rebuildDependencies();
+
+    // Resolving in dependency order means each value only joins values
+    // that are already memoized
+    QStringList blocked;
+    for (const QString &name : resolutionOrder(&blocked)) {
+        resolvedValue(name);
+    }
+
+    // A cycle saved from the editor still loads; its variables keep their
+    // references unresolved, as they do while editing, and all cycles are
+    // reported together
+    QSet<QString> reported;
+    QStringList cycles;
+    for (const QString &name : qAsConst(blocked)) {
+        if (reported.contains(name) || !cyclicVariables().contains(name)) {
+            continue;
+        }
+        const QStringList cycle = findCycle(name);
+        for (const QString &member : cycle) {
+            reported.insert(member);
+        }
+        cycles.append(cycle.join(QLatin1String(" -> ")));
+    }
+    if (!cycles.isEmpty()) {
+        emit loadWarning(tr("Circular variable references, left unresolved:\n%1")
+                             .arg(cycles.join(QLatin1Char('\n'))));
+    }
     
     // Load template
     qssTemplate = root[QStringLiteral("qssTemplate")].toString();
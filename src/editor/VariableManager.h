@@ -5,6 +5,9 @@
 #include <QString>
 #include <QStringList>
 #include <QMap>
+#include <QVector>
+#include <QHash>
+#include <QSet>
 
 /**
  * @brief Manages QSS variables for substitution in stylesheets.
@@ -12,6 +15,7 @@
  * The VariableManager is responsible for:
  * - Storing and managing named variables with values
  * - Substituting variable references (${name}) in QSS templates
+ * - Resolving variables whose values reference other variables
  * - Saving and loading project files (.qvp format)
  * - Exporting resolved QSS to .qss files
  */
@@ -74,17 +78,120 @@ public:
      */
     void clearVariables();
 
+    // =========================================================================
+    // Nested Variables
+    // =========================================================================
+
+    /**
+     * @brief Returns a variable's value with nested references resolved.
+     *
+     * Values may reference other variables (e.g. button_bg = ${accent}).
+     * Resolved values are memoized; changing a variable only invalidates it
+     * and its transitive dependents. References to undefined variables, and
+     * the references of variables on a dependency cycle, are left unchanged.
+     *
+     * @param name The variable name.
+     * @return The resolved value, or empty string if not found.
+     */
+    QString resolvedValue(const QString &name) const;
+
+    /**
+     * @brief Resolves the variable references in an arbitrary value.
+     * @param value Text that may contain ${name} references.
+     * @return The text with defined references replaced by resolved values.
+     */
+    QString resolveValue(const QString &value) const;
+
+    /**
+     * @brief Returns the variables directly referenced by a variable's value.
+     * @param name The variable name.
+     */
+    QStringList dependencies(const QString &name) const;
+
+    /**
+     * @brief Returns the variables that transitively reference a variable.
+     * @param name The variable name.
+     */
+    QStringList dependents(const QString &name) const;
+
+    /**
+     * @brief Orders the variables so each comes after those it references.
+     * @param blocked Receives the variables on or behind a dependency cycle,
+     *        which are left out of the order.
+     * @return The variable names in topological order.
+     */
+    QStringList resolutionOrder(QStringList *blocked = nullptr) const;
+
+    /**
+     * @brief Finds a dependency cycle through a variable.
+     * @param name The variable name.
+     * @return The cycle as a path from name back to name, or an empty list.
+     */
+    QStringList findCycle(const QString &name) const;
+
+    /**
+     * @brief Returns how many variable values have been resolved.
+     *
+     * Memoized lookups are not counted, so this grows by the number of
+     * invalidated variables that are looked up again after an edit.
+     */
+    int valueResolveCount() const;
+
     // =========================================================================
     // Substitution
     // =========================================================================
 
     /**
      * @brief Substitutes variable references in a QSS template.
+     *
+     * The template is tokenized once into literal and reference segments;
+     * the token list is cached until a different template is passed, so
+     * re-resolving the same template after a variable edit only joins the
+     * cached segments. References to undefined variables are left unchanged.
+     *
      * @param qssTemplate The template containing ${name} references.
      * @return The resolved QSS with variables substituted.
      */
     QString substitute(const QString &qssTemplate) const;
 
+    /**
+     * @brief Returns how many times a template has been tokenized.
+     *
+     * Stays constant while substitute() is called with the same template.
+     */
+    int templateCompileCount() const;
+
+    /**
+     * @brief Reports which rules the last substitute() call changed.
+     *
+     * When substitute() is called again with the same template, the
+     * variables whose value changed since the previous call are looked up
+     * in the reference index, and the rules containing their references
+     * are recorded. Rules are numbered in QssRuleSet::parse() order,
+     * assuming references in rules are defined and variable values contain
+     * no braces, quotes or comments.
+     *
+     * @param rules Receives the sorted indices of the changed rules.
+     * @param previousResult Receives the result of the call before the last.
+     * @return false if the last call tokenized a new template, in which case
+     *         the changed rules are unknown and the outputs are untouched.
+     */
+    bool lastChangedRules(QVector<int> *rules, QString *previousResult = nullptr) const;
+
+    /**
+     * @brief Returns where a variable is referenced in the tokenized template.
+     * @param name The variable name.
+     * @return Offsets of the ${name} references, in ascending order.
+     */
+    QVector<int> referenceOffsets(const QString &name) const;
+
+    /**
+     * @brief Returns the rules of the tokenized template that reference a variable.
+     * @param name The variable name.
+     * @return Sorted rule indices; references inside comments are not counted.
+     */
+    QVector<int> rulesReferencing(const QString &name) const;
+
     /**
      * @brief Finds all variable references in a template.
      * @param qssTemplate The template to search.
@@ -115,7 +222,10 @@ public:
      * @brief Loads variables and template from a project file.
      * @param filePath The path to load from (.qvp file).
      * @param qssTemplate Output parameter for the loaded template.
-     * @return true if successful.
+     * @return true if successful; false if the file is invalid.
+     *
+     * Variables referencing each other in a cycle still load, unresolved,
+     * and are reported through loadWarning().
      */
     bool loadProject(const QString &filePath, QString &qssTemplate);
 
@@ -176,6 +286,14 @@ signals:
      */
     void variablesCleared();
 
+    /**
+     * @brief Emitted when a variable edit closes a dependency cycle.
+     * @param cycle The cycle as a path from the edited variable back to it.
+     *
+     * Loading a project with cycles reports them through loadWarning() instead.
+     */
+    void cycleDetected(const QStringList &cycle);
+
     /**
      * @brief Emitted when a project is loaded.
      */
@@ -192,6 +310,13 @@ signals:
      */
     void loadError(const QString &error);
 
+    /**
+     * @brief Emitted once for a project that loaded with dependency cycles.
+     * @param warning The message, listing every cycle; their variables are
+     *        left unresolved.
+     */
+    void loadWarning(const QString &warning);
+
     /**
      * @brief Emitted when a save error occurs.
      * @param error The error message.
@@ -199,7 +324,51 @@ signals:
     void saveError(const QString &error);
 
 private:
+    /**
+     * @brief A run of template text: a literal, or a ${name} reference.
+     */
+    struct TemplateSegment
+    {
+        int start;          ///< Offset in the template
+        int length;         ///< Length in the template, including ${ and }
+        QString name;       ///< Variable name, empty for literals
+        int rule;           ///< Rule holding the reference, -1 if none
+    };
+
+    void compileTemplate(const QString &qssTemplate) const;
+    void updateDependencies(const QString &name);
+    void invalidateResolved(const QString &name);
+    void rebuildDependencies();
+    const QSet<QString> &cyclicVariables() const;
+
     QMap<QString, QString> m_variables;
+
+    // Dependency graph between variables and memoized resolved values
+    QHash<QString, QStringList> m_dependencies;
+    QHash<QString, QSet<QString>> m_dependents;
+    mutable QHash<QString, QString> m_resolvedCache;
+    mutable int m_valueResolveCount;
+
+    // Variables on a dependency cycle, recomputed after the graph changes
+    mutable QSet<QString> m_cyclicVariables;
+    mutable bool m_cyclesKnown;
+
+    // Tokenized form of the last template passed to substitute()
+    mutable QString m_compiledTemplate;
+    mutable QVector<TemplateSegment> m_segments;
+    mutable bool m_hasCompiledTemplate;
+    mutable int m_templateCompileCount;
+
+    // Reverse index: variable name -> indices of its reference segments
+    mutable QHash<QString, QVector<int>> m_referenceIndex;
+
+    // Last result and the variable values it was built from
+    mutable QString m_lastResult;
+    mutable QString m_previousResult;
+    mutable QHash<QString, QString> m_resolvedValues;
+    mutable bool m_hasResult;
+    mutable QVector<int> m_changedRules;
+    mutable bool m_changedRulesKnown;
 };
 
 #endif // VARIABLEMANAGER_H
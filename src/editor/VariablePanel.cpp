@@ -264,7 +264,7 @@ void VariablePanel::openColorPickerForRow(int row)
     // Parse color using existing parseColor() method, use white as default
     QColor initialColor = Qt::white;
     if (!currentValue.isEmpty()) {
-        QColor parsed = parseColor(currentValue);
+        QColor parsed = parseColor(m_variableManager->resolveValue(currentValue));
         if (parsed.isValid()) {
             initialColor = parsed;
         }
@@ -322,6 +322,16 @@ void VariablePanel::onVariableChanged(const QString &name, const QString &value)
         if (emptyNameItem) emptyNameItem->setText(QString());
         if (emptyValueItem) emptyValueItem->setText(QString());
     }
+
+    // Variables referencing this one resolve to a new color too
+    for (const QString &dependent : m_variableManager->dependents(name)) {
+        const int dependentRow = findRowByName(dependent);
+        QTableWidgetItem *dependentItem = dependentRow >= 0
+            ? m_variableTable->item(dependentRow, COL_VALUE) : nullptr;
+        if (dependentItem) {
+            updateColorSwatch(dependentRow, dependentItem->text());
+        }
+    }
     
     m_updatingTable = false;
 }
@@ -441,8 +451,10 @@ void VariablePanel::refreshVariableList()
     ensureEmptyRowExists();
 }
 
-void VariablePanel::updateColorSwatch(int row, const QString &value)
+void VariablePanel::updateColorSwatch(int row, const QString &rawValue)
 {
+    // Values referencing other variables show the color they resolve to
+    const QString value = m_variableManager ? m_variableManager->resolveValue(rawValue) : rawValue;
     if (VariableManager::isColorValue(value)) {
         QColor color = parseColor(value);
         if (color.isValid()) {
@@ -3,16 +3,22 @@
 #include "PluginManager.h"
 #include "PluginMetadata.h"
 #include "WidgetPluginInterface.h"
+#include "FirstPaintTimer.h"
 
 #include <QGroupBox>
 #include <QHBoxLayout>
 #include <QVBoxLayout>
 #include <QLabel>
+#include <QPushButton>
+#include <QElapsedTimer>
 #include <QMap>
 
+#include <algorithm>
+
 CustomWidgetsPage::CustomWidgetsPage(PluginManager *pluginManager, QWidget *parent)
     : GalleryPage(parent)
     , m_pluginManager(pluginManager)
+    , m_emptyStateGroup(nullptr)
 {
     setupWidgets();
 }
@@ -33,6 +39,10 @@ void CustomWidgetsPage::rebuildWidgets()
 {
     // Clear existing custom widgets list
     m_customWidgets.clear();
+    m_groups.clear();
+    m_displays.clear();
+    m_emptyStateGroup = nullptr;
+    m_reloadPositions.clear();
     
     // Clear all existing content from the layout
     // Remove all widgets except the stretch at the end
@@ -48,6 +58,79 @@ void CustomWidgetsPage::rebuildWidgets()
     setupWidgets();
 }
 
+void CustomWidgetsPage::onPluginAboutToBeUnloaded(const PluginMetadata &metadata)
+{
+    // Remember where the display was, so a reloaded plugin keeps its place
+    const PluginDisplay display = m_displays.value(metadata.filePath);
+    if (display.container && display.container->parentWidget()) {
+        m_reloadPositions.insert(metadata.filePath,
+                                 display.container->parentWidget()->layout()->indexOf(display.container));
+    }
+    removeWidgetDisplay(metadata.filePath);
+}
+
+void CustomWidgetsPage::onPluginReloaded(const PluginMetadata &previous, const PluginMetadata &current)
+{
+    const int position = m_reloadPositions.value(current.filePath, -1);
+    m_reloadPositions.clear();
+    
+    bool hasValidPlugins = false;
+    for (const PluginMetadata &meta : m_pluginManager->loadedPlugins()) {
+        if (meta.isValid) {
+            hasValidPlugins = true;
+            break;
+        }
+    }
+    
+    // Switching to or from the empty state needs the whole page
+    if (m_emptyStateGroup || !hasValidPlugins) {
+        rebuildWidgets();
+        return;
+    }
+    
+    // Only the reloaded plugin's display is recreated; it moves to another
+    // group only if its category changed
+    removeWidgetDisplay(current.filePath);
+    if (current.isValid) {
+        const bool sameCategory = previous.isValid && categoryName(previous) == categoryName(current);
+        addWidgetDisplay(current, sameCategory ? position : -1);
+    }
+}
+
+void CustomWidgetsPage::onLibraryLoadFinished(const PluginMetadata &metadata)
+{
+    if (m_emptyStateGroup) {
+        if (metadata.isValid) {
+            rebuildWidgets();
+        }
+        return;
+    }
+    
+    auto display = m_displays.find(metadata.filePath);
+    if (display == m_displays.end()) {
+        // A plugin described only now, once its library is loaded
+        if (metadata.isValid) {
+            addWidgetDisplay(metadata);
+        }
+        return;
+    }
+    
+    if (!metadata.isValid) {
+        removeWidgetDisplay(metadata.filePath);
+        if (m_groups.isEmpty()) {
+            rebuildWidgets();
+        }
+        return;
+    }
+    
+    // Only this plugin's placeholder is replaced; its siblings keep their widgets
+    if (display->loadingLabel) {
+        delete display->loadingLabel;
+        display->loadingLabel = nullptr;
+        createPluginWidget(metadata.name, display->container, display->timingLabel);
+    }
+}
+
 void CustomWidgetsPage::setupWidgets()
 {
     QList<PluginMetadata> plugins = m_pluginManager->loadedPlugins();
@@ -69,8 +152,7 @@ void CustomWidgetsPage::setupWidgets()
     // Group plugins by category
     QMap<QString, QList<PluginMetadata>> pluginsByCategory;
     for (const PluginMetadata &meta : validPlugins) {
-        QString category = meta.category.isEmpty() ? tr("Custom") : meta.category;
-        pluginsByCategory[category].append(meta);
+        pluginsByCategory[categoryName(meta)].append(meta);
     }
     
     // Create widget groups for each category
@@ -82,6 +164,7 @@ void CustomWidgetsPage::setupWidgets()
 void CustomWidgetsPage::setupEmptyState()
 {
     QGroupBox *group = qobject_cast<QGroupBox*>(createGroup(tr("No Plugins Loaded")));
+    m_emptyStateGroup = group;
     QVBoxLayout *groupLayout = qobject_cast<QVBoxLayout*>(group->layout());
     
     QLabel *messageLabel = new QLabel(group);
@@ -103,37 +186,109 @@ void CustomWidgetsPage::createWidgetGroup(const QString &category,
     QGroupBox *group = qobject_cast<QGroupBox*>(createGroup(category));
     QVBoxLayout *groupLayout = qobject_cast<QVBoxLayout*>(group->layout());
     
+    // Keep groups sorted by category when one is recreated
+    m_groups.insert(category, group);
+    const int index = static_cast<int>(std::distance(m_groups.begin(), m_groups.find(category)));
+    mainLayout()->removeWidget(group);
+    mainLayout()->insertWidget(index, group);
+    
     for (const PluginMetadata &metadata : plugins) {
         QWidget *widgetDisplay = createWidgetDisplay(metadata);
         groupLayout->addWidget(widgetDisplay);
     }
 }
 
-QWidget* CustomWidgetsPage::createWidgetDisplay(const PluginMetadata &metadata)
+void CustomWidgetsPage::removeWidgetGroup(const QString &category)
 {
-    QWidget *container = new QWidget(contentWidget());
-    QVBoxLayout *layout = new QVBoxLayout(container);
-    layout->setContentsMargins(0, 0, 0, 8);
-    layout->setSpacing(4);
+    QGroupBox *group = m_groups.take(category);
+    if (!group) {
+        return;
+    }
     
-    // Add name label
-    QLabel *nameLabel = new QLabel(metadata.name, container);
-    nameLabel->setStyleSheet("font-weight: bold;");
-    layout->addWidget(nameLabel);
+    m_customWidgets.erase(std::remove_if(m_customWidgets.begin(), m_customWidgets.end(),
+                                         [group](QWidget *widget) {
+                                             return group->isAncestorOf(widget);
+                                         }),
+                          m_customWidgets.end());
+    for (auto it = m_displays.begin(); it != m_displays.end();) {
+        if (group->isAncestorOf(it->container)) {
+            it = m_displays.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    delete group;
+}
+
+void CustomWidgetsPage::addWidgetDisplay(const PluginMetadata &metadata, int position)
+{
+    QGroupBox *group = m_groups.value(categoryName(metadata));
+    if (!group) {
+        createWidgetGroup(categoryName(metadata), QList<PluginMetadata>() << metadata);
+        return;
+    }
     
-    // Add description
-    QLabel *descLabel = new QLabel(metadata.description, container);
-    descLabel->setWordWrap(true);
-    layout->addWidget(descLabel);
+    QVBoxLayout *groupLayout = qobject_cast<QVBoxLayout*>(group->layout());
+    groupLayout->insertWidget(qMin(position, groupLayout->count()), createWidgetDisplay(metadata));
+}
+
+void CustomWidgetsPage::removeWidgetDisplay(const QString &filePath)
+{
+    const PluginDisplay display = m_displays.take(filePath);
+    if (!display.container) {
+        return;
+    }
+    
+    QWidget *container = display.container;
+    m_customWidgets.erase(std::remove_if(m_customWidgets.begin(), m_customWidgets.end(),
+                                         [container](QWidget *widget) {
+                                             return container->isAncestorOf(widget);
+                                         }),
+                          m_customWidgets.end());
+    
+    // A group left without plugins goes with its last one
+    QGroupBox *group = qobject_cast<QGroupBox*>(container->parentWidget());
+    delete container;
+    const bool groupEmpty = std::none_of(m_displays.constBegin(), m_displays.constEnd(),
+                                         [group](const PluginDisplay &other) {
+                                             return other.container->parentWidget() == group;
+                                         });
+    if (group && groupEmpty) {
+        removeWidgetGroup(m_groups.key(group));
+    }
+}
+
+void CustomWidgetsPage::createPluginWidget(const QString &name, QWidget *container, QLabel *timingLabel)
+{
+    QVBoxLayout *layout = qobject_cast<QVBoxLayout*>(container->layout());
     
     // Try to create widget instance
-    WidgetPluginInterface *interface = m_pluginManager->pluginInterface(metadata.name);
+    WidgetPluginInterface *interface = m_pluginManager->pluginInterface(name);
     
     if (interface) {
+        QElapsedTimer timer;
+        timer.start();
         QWidget *widget = interface->createWidget(container);
+        const double createMs = timer.nsecsElapsed() / 1000000.0;
+        
         if (widget) {
+            // Polish now, under the current style and stylesheet, to time it
+            timer.restart();
+            widget->ensurePolished();
+            const double polishMs = timer.nsecsElapsed() / 1000000.0;
+            
             layout->addWidget(widget);
             m_customWidgets.append(widget);
+            
+            m_pluginManager->setWidgetTimings(name, createMs, polishMs, -1.0);
+            timingLabel->setText(timingText(m_pluginManager->pluginMetadata(name)));
+            
+            FirstPaintTimer *paintTimer = new FirstPaintTimer(widget);
+            connect(paintTimer, &FirstPaintTimer::finished, timingLabel,
+                    [this, name, createMs, polishMs, timingLabel](double paintMs) {
+                        m_pluginManager->setWidgetTimings(name, createMs, polishMs, paintMs);
+                        timingLabel->setText(timingText(m_pluginManager->pluginMetadata(name)));
+                    });
         } else {
             // Handle createWidget() returning nullptr with error placeholder
             QLabel *errorLabel = new QLabel(
@@ -142,12 +297,95 @@ QWidget* CustomWidgetsPage::createWidgetDisplay(const PluginMetadata &metadata)
             layout->addWidget(errorLabel);
         }
     } else {
-        // Plugin interface not found (shouldn't happen for valid metadata)
+        // The library failed to load on first use, or the interface is missing
+        const QString error = m_pluginManager->pluginMetadata(name).errorMessage;
         QLabel *errorLabel = new QLabel(
-            tr("Error: Plugin interface not found"), container);
+            error.isEmpty() ? tr("Error: Plugin interface not found")
+                            : tr("Error: %1").arg(error), container);
+        errorLabel->setWordWrap(true);
         errorLabel->setStyleSheet("color: red;");
         layout->addWidget(errorLabel);
     }
+}
+
+QString CustomWidgetsPage::timingText(const PluginMetadata &metadata) const
+{
+    if (metadata.createWidgetMs < 0.0) {
+        return tr("Not created yet");
+    }
+    
+    QString text = tr("Created in %1 ms").arg(metadata.createWidgetMs, 0, 'f', 1);
+    if (metadata.polishMs >= 0.0) {
+        text += tr(", polished in %1 ms").arg(metadata.polishMs, 0, 'f', 1);
+    }
+    if (metadata.firstPaintMs >= 0.0) {
+        text += tr(", first paint %1 ms").arg(metadata.firstPaintMs, 0, 'f', 1);
+    }
+    return text;
+}
+
+QString CustomWidgetsPage::categoryName(const PluginMetadata &metadata) const
+{
+    return metadata.category.isEmpty() ? tr("Custom") : metadata.category;
+}
+
+QWidget* CustomWidgetsPage::createWidgetDisplay(const PluginMetadata &metadata)
+{
+    QWidget *container = new QWidget(contentWidget());
+    QVBoxLayout *layout = new QVBoxLayout(container);
+    layout->setContentsMargins(0, 0, 0, 8);
+    layout->setSpacing(4);
+    
+    // Add name label
+    QLabel *nameLabel = new QLabel(metadata.name, container);
+    nameLabel->setStyleSheet("font-weight: bold;");
+    layout->addWidget(nameLabel);
+    
+    // Add description
+    QLabel *descLabel = new QLabel(metadata.description, container);
+    descLabel->setWordWrap(true);
+    layout->addWidget(descLabel);
+    
+    // Add measured cost of the widget
+    const PluginMetadata current = m_pluginManager->pluginMetadata(metadata.name);
+    QLabel *timingLabel = new QLabel(timingText(current), container);
+    timingLabel->setEnabled(false);
+    layout->addWidget(timingLabel);
+    
+    PluginDisplay &display = m_displays[metadata.filePath];
+    display.container = container;
+    display.timingLabel = timingLabel;
+    display.loadingLabel = nullptr;
+    
+    // Widgets over the budget are created when asked for, not with the page
+    if (!m_requestedPlugins.contains(metadata.name)
+        && m_pluginManager->exceedsWidgetBudget(metadata.name)) {
+        timingLabel->setText(tr("Deferred: took %1 ms last time, over the %2 ms budget")
+                             .arg(current.widgetCostMs(), 0, 'f', 1)
+                             .arg(m_pluginManager->widgetBudgetMs(), 0, 'f', 0));
+        
+        QPushButton *createButton = new QPushButton(tr("Create Widget"), container);
+        layout->addWidget(createButton, 0, Qt::AlignLeft);
+        const QString name = metadata.name;
+        connect(createButton, &QPushButton::clicked, this, [this, name, container, createButton, timingLabel]() {
+            m_requestedPlugins.insert(name);
+            createButton->hide();
+            createButton->deleteLater();
+            createPluginWidget(name, container, timingLabel);
+        });
+        return container;
+    }
+    
+    // Libraries not loaded yet are loaded in the background if possible
+    if (!current.isLoaded && m_pluginManager->loadPluginAsync(metadata.name)) {
+        QLabel *loadingLabel = new QLabel(tr("Loading plugin library..."), container);
+        loadingLabel->setEnabled(false);
+        layout->addWidget(loadingLabel);
+        display.loadingLabel = loadingLabel;
+        return container;
+    }
+    
+    createPluginWidget(metadata.name, container, timingLabel);
     
     return container;
 }
@@ -4,10 +4,15 @@
 #include "GalleryPage.h"
 
 #include <QList>
+#include <QMap>
+#include <QHash>
+#include <QSet>
 
 class PluginManager;
 class PluginMetadata;
 class QWidget;
+class QGroupBox;
+class QLabel;
 
 /**
  * @brief Gallery page that displays custom widgets from loaded plugins.
@@ -20,6 +25,9 @@ class QWidget;
  * - A helpful message when no plugins are loaded
  * - Support for enabling/disabling all custom widgets
  * - Automatic rebuilding when plugins are refreshed
+ * - Recreating only the affected plugin's display when one plugin is reloaded
+ * - Timing each widget's creation, first polish and first paint
+ * - Deferring widgets over the PluginManager's budget behind a placeholder
  * 
  * The page integrates with the PluginManager to:
  * - Retrieve loaded plugin metadata
@@ -84,6 +92,41 @@ public slots:
      * when plugins are refreshed.
      */
     void rebuildWidgets();
+    
+    /**
+     * @brief Removes the widgets of a plugin that is about to be unloaded.
+     * 
+     * Deletes the plugin's display, so no widget created by the plugin
+     * outlives its library. Other plugins in the category are left alone.
+     * Connect to PluginManager::pluginAboutToBeUnloaded().
+     * 
+     * @param metadata The metadata of the plugin being unloaded.
+     */
+    void onPluginAboutToBeUnloaded(const PluginMetadata &metadata);
+    
+    /**
+     * @brief Recreates the display of a reloaded plugin.
+     * 
+     * The display goes back to its place in the group, or to the end of the
+     * group of its new category if the category changed. Other plugins and
+     * their widgets are left alone. Connect to PluginManager::pluginReloaded().
+     * 
+     * @param previous The plugin's metadata before reloading.
+     * @param current The plugin's metadata after reloading.
+     */
+    void onPluginReloaded(const PluginMetadata &previous, const PluginMetadata &current);
+    
+    /**
+     * @brief Replaces the placeholder of a plugin whose library has loaded.
+     * 
+     * Creates the plugin's widget in place of its loading placeholder if the
+     * load succeeded, or removes the plugin's display if it failed. Other
+     * plugins in the category are left alone. Connect to
+     * PluginManager::libraryLoadFinished().
+     * 
+     * @param metadata The plugin's metadata after the load.
+     */
+    void onLibraryLoadFinished(const PluginMetadata &metadata);
 
 private:
     /**
@@ -114,20 +157,86 @@ private:
     void createWidgetGroup(const QString &category, 
                            const QList<PluginMetadata> &plugins);
     
+    /**
+     * @brief Deletes the group of one category and its widgets.
+     * 
+     * @param category The category name for the group.
+     */
+    void removeWidgetGroup(const QString &category);
+    
+    /**
+     * @brief Adds the display of a plugin to its category group.
+     * 
+     * Creates the group if the category has none yet.
+     * 
+     * @param metadata The metadata for the plugin to display.
+     * @param position Index in the group's layout, or -1 to append.
+     */
+    void addWidgetDisplay(const PluginMetadata &metadata, int position = -1);
+    
+    /**
+     * @brief Deletes the display of one plugin and its widget.
+     * 
+     * Deletes the plugin's category group too if no other plugin is left in it.
+     * 
+     * @param filePath The file path of the plugin.
+     */
+    void removeWidgetDisplay(const QString &filePath);
+    
+    /**
+     * @brief Returns the group title used for a plugin.
+     */
+    QString categoryName(const PluginMetadata &metadata) const;
+    
     /**
      * @brief Creates the display for a single plugin widget.
      * 
      * Creates a container with the widget's name, description, and
      * an instance of the widget itself. If widget creation fails,
-     * displays an error placeholder instead.
+     * displays an error placeholder instead. If the plugin's library can
+     * be loaded in the background, shows a loading placeholder until
+     * onLibraryLoadFinished() replaces it. If the widget was
+     * measured over the budget, shows a button that creates it instead.
      * 
      * @param metadata The metadata for the plugin to display.
      * @return Pointer to the created display container widget.
      */
     QWidget* createWidgetDisplay(const PluginMetadata &metadata);
+    
+    /**
+     * @brief Creates a plugin's widget in its display container.
+     * 
+     * Times createWidget(), the first polish and the first paint, and
+     * records them with PluginManager::setWidgetTimings().
+     * 
+     * @param name The widget name of the plugin.
+     * @param container The display container from createWidgetDisplay().
+     * @param timingLabel The label showing the measured times.
+     */
+    void createPluginWidget(const QString &name, QWidget *container, QLabel *timingLabel);
+    
+    /**
+     * @brief Returns the description of a plugin's measured widget times.
+     */
+    QString timingText(const PluginMetadata &metadata) const;
+    
+    /**
+     * @brief The display of one plugin, see createWidgetDisplay().
+     */
+    struct PluginDisplay
+    {
+        QWidget *container = nullptr;   ///< Container holding the plugin's labels and widget
+        QLabel *timingLabel = nullptr;  ///< Label showing the measured times
+        QLabel *loadingLabel = nullptr; ///< Placeholder while the library loads
+    };
 
     PluginManager *m_pluginManager;     ///< Plugin manager providing access to plugins
     QList<QWidget*> m_customWidgets;    ///< List of created custom widget instances
+    QMap<QString, QGroupBox*> m_groups; ///< Category groups, in display order
+    QHash<QString, PluginDisplay> m_displays; ///< Plugin displays by plugin file path
+    QGroupBox *m_emptyStateGroup;       ///< Group shown when no plugins are loaded
+    QHash<QString, int> m_reloadPositions; ///< Layout index of displays removed ahead of a reload
+    QSet<QString> m_requestedPlugins;   ///< Over-budget plugins created on request
 };
 
 #endif // CUSTOMWIDGETSPAGE_H
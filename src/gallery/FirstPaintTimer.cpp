@@ -0,0 +1,84 @@
+#include "FirstPaintTimer.h"
+#include "ProfilingApplication.h"
+
+#include <QWidget>
+#include <QEvent>
+#include <QTimer>
+
+FirstPaintTimer::FirstPaintTimer(QWidget *widget)
+    : QObject(widget)
+    , m_widget(widget)
+    , m_giveUpTimer(nullptr)
+    , m_paintNsecs(0)
+    , m_finishing(false)
+{
+    if (!ProfilingApplication::instance()) {
+        // Paints cannot be timed; nothing to wait for
+        deleteLater();
+        return;
+    }
+
+    m_giveUpTimer = new QTimer(this);
+    m_giveUpTimer->setSingleShot(true);
+    m_giveUpTimer->setInterval(GIVE_UP_MS);
+    connect(m_giveUpTimer, &QTimer::timeout, this, &FirstPaintTimer::giveUp);
+
+    // Show and Hide tell when the widget can paint, including through its ancestors
+    widget->installEventFilter(this);
+    setFollowingPaints(widget->isVisible());
+}
+
+bool FirstPaintTimer::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched == m_widget && !m_finishing) {
+        if (event->type() == QEvent::Show) {
+            setFollowingPaints(true);
+        } else if (event->type() == QEvent::Hide) {
+            setFollowingPaints(false);
+        }
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+void FirstPaintTimer::setFollowingPaints(bool following)
+{
+    ProfilingApplication *app = ProfilingApplication::instance();
+    if (following) {
+        m_giveUpTimer->stop();
+        connect(app, &ProfilingApplication::paintTimed, this, &FirstPaintTimer::onPaintTimed,
+                Qt::UniqueConnection);
+    } else {
+        disconnect(app, &ProfilingApplication::paintTimed, this, &FirstPaintTimer::onPaintTimed);
+        m_giveUpTimer->start();
+    }
+}
+
+void FirstPaintTimer::onPaintTimed(QObject *receiver, qint64 nsecs)
+{
+    if (receiver != m_widget
+        && !(receiver->isWidgetType() && m_widget->isAncestorOf(static_cast<QWidget*>(receiver)))) {
+        return;
+    }
+    m_paintNsecs += nsecs;
+
+    // Children are painted later in the same pass; collect them first
+    if (receiver == m_widget && !m_finishing) {
+        m_finishing = true;
+        QTimer::singleShot(0, this, &FirstPaintTimer::finish);
+    }
+}
+
+void FirstPaintTimer::finish()
+{
+    m_widget->removeEventFilter(this);
+    disconnect(ProfilingApplication::instance(), &ProfilingApplication::paintTimed,
+               this, &FirstPaintTimer::onPaintTimed);
+    emit finished(m_paintNsecs / 1000000.0);
+    deleteLater();
+}
+
+void FirstPaintTimer::giveUp()
+{
+    m_widget->removeEventFilter(this);
+    deleteLater();
+}
@@ -0,0 +1,64 @@
+#ifndef FIRSTPAINTTIMER_H
+#define FIRSTPAINTTIMER_H
+
+#include <QObject>
+
+class QWidget;
+class QEvent;
+class QTimer;
+
+/**
+ * @brief Times the first paint of a widget and its children.
+ *
+ * FirstPaintTimer adds up the Paint event times that ProfilingApplication
+ * reports for a widget and its descendants, without changing how the events
+ * are delivered. Once the widget has painted for the first time, it waits
+ * for the rest of that paint pass (which paints the children), emits
+ * finished() with the total and deletes itself.
+ *
+ * Paints are only followed while the widget is visible. A widget that stays
+ * hidden for GIVE_UP_MS, such as one on a page that is never shown, is not
+ * timed: the timer deletes itself without emitting finished(). It is also a
+ * child of the widget, so it goes away with it.
+ */
+class FirstPaintTimer : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Time a hidden widget is waited for before giving up.
+     */
+    static constexpr int GIVE_UP_MS = 10000;
+
+    /**
+     * @brief Starts watching a widget.
+     * @param widget The widget to time; becomes the timer's parent.
+     */
+    explicit FirstPaintTimer(QWidget *widget);
+
+signals:
+    /**
+     * @brief Emitted once after the widget's first paint pass.
+     * @param paintMs Time spent painting the widget and its children.
+     */
+    void finished(double paintMs);
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private slots:
+    void onPaintTimed(QObject *receiver, qint64 nsecs);
+    void finish();
+    void giveUp();
+
+private:
+    void setFollowingPaints(bool following);
+
+    QWidget *m_widget;
+    QTimer *m_giveUpTimer;
+    qint64 m_paintNsecs;
+    bool m_finishing;
+};
+
+#endif // FIRSTPAINTTIMER_H
@@ -0,0 +1,116 @@
+#include "GeneratedItemModel.h"
+
+#include <algorithm>
+
+GeneratedItemModel::GeneratedItemModel(QObject *parent)
+    : GeneratedItemModel(0, 0, 0, parent)
+{
+}
+
+GeneratedItemModel::GeneratedItemModel(int rows, int columns, int childrenPerRow, QObject *parent)
+    : QAbstractItemModel(parent)
+    , m_rows(std::max(rows, 0))
+    , m_columns(std::max(columns, 0))
+    , m_childrenPerRow(std::max(childrenPerRow, 0))
+{
+}
+
+void GeneratedItemModel::setDimensions(int rows, int columns, int childrenPerRow)
+{
+    rows = std::max(rows, 0);
+    columns = std::max(columns, 0);
+    childrenPerRow = std::max(childrenPerRow, 0);
+    if (rows == m_rows && columns == m_columns && childrenPerRow == m_childrenPerRow) {
+        return;
+    }
+
+    beginResetModel();
+    m_rows = rows;
+    m_columns = columns;
+    m_childrenPerRow = childrenPerRow;
+    endResetModel();
+}
+
+int GeneratedItemModel::childrenPerRow() const
+{
+    return m_childrenPerRow;
+}
+
+QModelIndex GeneratedItemModel::index(int row, int column, const QModelIndex &parent) const
+{
+    if (!hasIndex(row, column, parent)) {
+        return QModelIndex();
+    }
+    const quintptr parentId = parent.isValid() ? quintptr(parent.row()) + 1 : 0;
+    return createIndex(row, column, parentId);
+}
+
+QModelIndex GeneratedItemModel::parent(const QModelIndex &child) const
+{
+    if (!child.isValid() || child.internalId() == 0) {
+        return QModelIndex();
+    }
+    return createIndex(int(child.internalId() - 1), 0, quintptr(0));
+}
+
+int GeneratedItemModel::rowCount(const QModelIndex &parent) const
+{
+    if (!parent.isValid()) {
+        return m_rows;
+    }
+
+    // Only top-level rows have children
+    if (parent.column() != 0 || parent.internalId() != 0) {
+        return 0;
+    }
+    return m_childrenPerRow;
+}
+
+int GeneratedItemModel::columnCount(const QModelIndex &parent) const
+{
+    Q_UNUSED(parent);
+    return m_columns;
+}
+
+bool GeneratedItemModel::hasChildren(const QModelIndex &parent) const
+{
+    return rowCount(parent) > 0 && m_columns > 0;
+}
+
+QVariant GeneratedItemModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid()) {
+        return QVariant();
+    }
+
+    const bool isChild = index.internalId() != 0;
+    const int topRow = isChild ? int(index.internalId() - 1) : index.row();
+
+    switch (role) {
+    case Qt::DisplayRole:
+        if (index.column() == 0) {
+            return isChild ? tr("Item %1.%2").arg(topRow + 1).arg(index.row() + 1)
+                           : tr("Item %1").arg(topRow + 1);
+        }
+        // Deterministic values that vary per cell
+        return (topRow * 31 + index.row() * 7 + index.column() * 13) % 1000;
+    case Qt::TextAlignmentRole:
+        if (index.column() > 0) {
+            return int(Qt::AlignRight | Qt::AlignVCenter);
+        }
+        return QVariant();
+    default:
+        return QVariant();
+    }
+}
+
+QVariant GeneratedItemModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (role != Qt::DisplayRole) {
+        return QVariant();
+    }
+    if (orientation == Qt::Horizontal) {
+        return section == 0 ? tr("Name") : tr("Value %1").arg(section);
+    }
+    return section + 1;
+}
@@ -0,0 +1,68 @@
+#ifndef GENERATEDITEMMODEL_H
+#define GENERATEDITEMMODEL_H
+
+#include <QAbstractItemModel>
+
+/**
+ * @brief Item model whose data is computed from the index on request.
+ *
+ * GeneratedItemModel reports any number of rows and columns without storing
+ * anything per item, so views can be stress tested at production sizes
+ * (hundreds of thousands of rows) where QStandardItemModel would allocate an
+ * item for every cell.
+ *
+ * With a non-zero child count every top-level row has that many children,
+ * giving tree views branches to draw. Indexes carry their parent row in the
+ * internal id: 0 for top-level rows, parent row + 1 for children.
+ */
+class GeneratedItemModel : public QAbstractItemModel
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Constructs an empty GeneratedItemModel.
+     * @param parent The parent object.
+     */
+    explicit GeneratedItemModel(QObject *parent = nullptr);
+
+    /**
+     * @brief Constructs a GeneratedItemModel.
+     * @param rows The number of top-level rows.
+     * @param columns The number of columns.
+     * @param childrenPerRow The number of children of each top-level row.
+     * @param parent The parent object.
+     */
+    GeneratedItemModel(int rows, int columns, int childrenPerRow = 0, QObject *parent = nullptr);
+
+    /**
+     * @brief Changes the model dimensions, resetting attached views.
+     * @param rows The number of top-level rows.
+     * @param columns The number of columns.
+     * @param childrenPerRow The number of children of each top-level row.
+     *
+     * Negative values are treated as 0.
+     */
+    void setDimensions(int rows, int columns, int childrenPerRow);
+
+    /**
+     * @brief Returns the number of children of each top-level row.
+     */
+    int childrenPerRow() const;
+
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex &child) const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    bool hasChildren(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation,
+                        int role = Qt::DisplayRole) const override;
+
+private:
+    int m_rows;
+    int m_columns;
+    int m_childrenPerRow;
+};
+
+#endif // GENERATEDITEMMODEL_H
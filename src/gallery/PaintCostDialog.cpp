@@ -0,0 +1,86 @@
+#include "PaintCostDialog.h"
+#include "PaintProfiler.h"
+
+#include <QTableWidget>
+#include <QHeaderView>
+#include <QVBoxLayout>
+#include <QDialogButtonBox>
+#include <QPushButton>
+#include <QLabel>
+
+PaintCostDialog::PaintCostDialog(PaintProfiler *profiler, QWidget *parent)
+    : QDialog(parent)
+    , m_profiler(profiler)
+    , m_table(nullptr)
+{
+    setupUi();
+    refresh();
+}
+
+void PaintCostDialog::setupUi()
+{
+    setWindowTitle(tr("Paint Cost"));
+    resize(820, 460);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+
+    QLabel *label = new QLabel(
+        tr("Slowest widget types by average paint time, excluding their children:"), this);
+    layout->addWidget(label);
+
+    const QStringList headers = {
+        tr("Type"), tr("Widgets"), tr("Paints"), tr("Avg (ms)"), tr("Max (ms)"), tr("Matching Rules")
+    };
+    m_table = new QTableWidget(0, headers.size(), this);
+    m_table->setHorizontalHeaderLabels(headers);
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table->verticalHeader()->setVisible(false);
+    m_table->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    m_table->horizontalHeader()->setStretchLastSection(true);
+    layout->addWidget(m_table);
+
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    QPushButton *refreshButton = buttons->addButton(tr("Refresh"), QDialogButtonBox::ActionRole);
+    connect(refreshButton, &QPushButton::clicked, this, &PaintCostDialog::refresh);
+    QPushButton *resetButton = buttons->addButton(tr("Reset"), QDialogButtonBox::ResetRole);
+    connect(resetButton, &QPushButton::clicked, this, [this]() {
+        m_profiler->reset();
+        refresh();
+    });
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    layout->addWidget(buttons);
+}
+
+void PaintCostDialog::setRules(const QssRuleSet &rules)
+{
+    m_rules = rules;
+    refresh();
+}
+
+void PaintCostDialog::refresh()
+{
+    const QVector<PaintProfiler::TypeCost> types = m_profiler->slowestTypes(m_rules, TYPE_LIMIT);
+    m_table->setRowCount(types.size());
+
+    for (int row = 0; row < types.size(); ++row) {
+        const PaintProfiler::TypeCost &type = types.at(row);
+
+        const QStringList values = {
+            QString::number(type.widgetCount),
+            QString::number(type.paintCount),
+            QString::number(type.averageMs(), 'f', 3),
+            QString::number(type.maxNsecs / 1000000.0, 'f', 3)
+        };
+        m_table->setItem(row, 0, new QTableWidgetItem(type.typeName));
+        for (int column = 0; column < values.size(); ++column) {
+            QTableWidgetItem *item = new QTableWidgetItem(values.at(column));
+            item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+            m_table->setItem(row, column + 1, item);
+        }
+
+        QTableWidgetItem *rulesItem = new QTableWidgetItem(
+            type.matchingRules.isEmpty() ? tr("(none)") : type.matchingRules.join(QLatin1String("; ")));
+        rulesItem->setToolTip(type.matchingRules.join(QLatin1Char('\n')));
+        m_table->setItem(row, 5, rulesItem);
+    }
+}
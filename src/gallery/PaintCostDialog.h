@@ -0,0 +1,55 @@
+#ifndef PAINTCOSTDIALOG_H
+#define PAINTCOSTDIALOG_H
+
+#include "QssRuleSet.h"
+
+#include <QDialog>
+
+class QTableWidget;
+class PaintProfiler;
+
+/**
+ * @brief Dialog listing the widget types that are slowest to paint.
+ *
+ * Shows, for the slowest types recorded by a PaintProfiler, how many widgets
+ * painted, their average and maximum paint time, and the rules of the
+ * current stylesheet that may apply to them.
+ */
+class PaintCostDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Number of types listed.
+     */
+    static constexpr int TYPE_LIMIT = 25;
+
+    /**
+     * @brief Constructs a PaintCostDialog.
+     * @param profiler The profiler to display (must outlive the dialog).
+     * @param parent The parent widget.
+     */
+    explicit PaintCostDialog(PaintProfiler *profiler, QWidget *parent = nullptr);
+
+    /**
+     * @brief Sets the stylesheet whose rules are matched against each type.
+     * @param rules The parsed stylesheet.
+     */
+    void setRules(const QssRuleSet &rules);
+
+public slots:
+    /**
+     * @brief Refreshes the table from the profiler.
+     */
+    void refresh();
+
+private:
+    void setupUi();
+
+    PaintProfiler *m_profiler;
+    QssRuleSet m_rules;
+    QTableWidget *m_table;
+};
+
+#endif // PAINTCOSTDIALOG_H
@@ -0,0 +1,193 @@
+#include "PaintHeatmapOverlay.h"
+#include "PaintProfiler.h"
+
+#include <QPainter>
+#include <QPaintEvent>
+#include <QTimer>
+#include <QVector>
+#include <QPair>
+#include <QRegion>
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Costs above this fraction of the slowest widget are labelled
+    const double LabelRatio = 0.5;
+}
+
+PaintHeatmapOverlay::PaintHeatmapOverlay(PaintProfiler *profiler, QWidget *target)
+    : QWidget(target)
+    , m_profiler(profiler)
+    , m_refreshTimer(nullptr)
+    , m_paintCountAtLastPaint(-1)
+    , m_shownMaxMs(0.0)
+{
+    setAttribute(Qt::WA_TransparentForMouseEvents);
+    setFocusPolicy(Qt::NoFocus);
+    m_profiler->ignoreWidget(this);
+
+    setGeometry(target->rect());
+    target->installEventFilter(this);
+    raise();
+
+    m_refreshTimer = new QTimer(this);
+    m_refreshTimer->setInterval(REFRESH_INTERVAL_MS);
+    connect(m_refreshTimer, &QTimer::timeout, this, &PaintHeatmapOverlay::refresh);
+    m_refreshTimer->start();
+}
+
+PaintHeatmapOverlay::~PaintHeatmapOverlay()
+{
+    m_profiler->setPaused(false);
+}
+
+void PaintHeatmapOverlay::repaintHeatmap(const QRegion &region)
+{
+    if (!isVisible()) {
+        return;
+    }
+
+    // The widgets underneath repaint with the overlay; resumed in paintEvent()
+    m_profiler->setPaused(true);
+    if (region.isEmpty()) {
+        update();
+    } else {
+        update(region);
+    }
+}
+
+QColor PaintHeatmapOverlay::heatColor(double ratio)
+{
+    ratio = std::clamp(ratio, 0.0, 1.0);
+    return QColor::fromHsvF((1.0 - ratio) / 3.0, 1.0, 1.0, 0.15 + 0.45 * ratio);
+}
+
+bool PaintHeatmapOverlay::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched == parentWidget()) {
+        if (event->type() == QEvent::Resize) {
+            setGeometry(parentWidget()->rect());
+        } else if (event->type() == QEvent::ChildAdded) {
+            raise();
+        }
+    }
+    return QWidget::eventFilter(watched, event);
+}
+
+void PaintHeatmapOverlay::refresh()
+{
+    const qint64 paintCount = m_profiler->totalPaintCount();
+    if (paintCount == m_paintCountAtLastPaint || m_profiler->isPaused()) {
+        return;
+    }
+    m_paintCountAtLastPaint = paintCount;
+
+    // Colors are relative to the slowest widget, so a new maximum redraws all
+    const double maxMs = m_profiler->maxAverageMs();
+    if (std::abs(maxMs - m_shownMaxMs) > REFRESH_THRESHOLD * maxMs) {
+        repaintHeatmap();
+        return;
+    }
+
+    QWidget *target = parentWidget();
+    QRegion changed;
+    for (QWidget *widget : m_profiler->profiledWidgets()) {
+        const PaintProfiler::WidgetCost cost = m_profiler->cost(widget);
+        if (widget == target || cost.paintCount == 0 || !widget->isVisible()) {
+            continue;
+        }
+        auto shown = m_shownAverages.constFind(widget);
+        if (shown == m_shownAverages.constEnd()
+            || std::abs(cost.averageMs() - shown.value()) > REFRESH_THRESHOLD * maxMs) {
+            changed += visibleRect(widget);
+        }
+    }
+    if (!changed.isEmpty()) {
+        repaintHeatmap(changed);
+    }
+}
+
+QRect PaintHeatmapOverlay::visibleRect(QWidget *widget) const
+{
+    // Clip to the ancestors so scrolled-out children are not drawn
+    QWidget *target = parentWidget();
+    QRect rect(widget->mapTo(target, QPoint(0, 0)), widget->size());
+    for (QWidget *ancestor = widget->parentWidget(); ancestor != target && !rect.isEmpty();
+         ancestor = ancestor->parentWidget()) {
+        rect &= QRect(ancestor->mapTo(target, QPoint(0, 0)), ancestor->size());
+    }
+    return rect;
+}
+
+void PaintHeatmapOverlay::paintEvent(QPaintEvent *event)
+{
+    QWidget *target = parentWidget();
+    const double maxMs = m_profiler->maxAverageMs();
+    const bool fullRepaint = event->rect().contains(rect());
+    if (fullRepaint) {
+        m_shownAverages.clear();
+    }
+
+    // Fill parents before children so nested widgets stay distinguishable
+    QVector<QPair<int, QWidget*>> widgets;
+    if (maxMs > 0.0) {
+        for (QWidget *widget : m_profiler->profiledWidgets()) {
+            if (widget == target || !widget->isVisible() || !target->isAncestorOf(widget)
+                || m_profiler->cost(widget).paintCount == 0) {
+                continue;
+            }
+            int depth = 0;
+            for (QWidget *ancestor = widget->parentWidget(); ancestor != target;
+                 ancestor = ancestor->parentWidget()) {
+                ++depth;
+            }
+            widgets.append(qMakePair(depth, widget));
+        }
+    }
+    std::stable_sort(widgets.begin(), widgets.end(),
+                     [](const QPair<int, QWidget*> &a, const QPair<int, QWidget*> &b) {
+                         return a.first < b.first;
+                     });
+
+    QPainter painter(this);
+    QVector<QPair<QRect, double>> labels;
+    for (const QPair<int, QWidget*> &entry : qAsConst(widgets)) {
+        QWidget *widget = entry.second;
+        const QRect rect = visibleRect(widget);
+        if (!event->region().intersects(rect)) {
+            continue;
+        }
+
+        const double averageMs = m_profiler->cost(widget).averageMs();
+        m_shownAverages.insert(widget, averageMs);
+        const double ratio = averageMs / maxMs;
+        painter.fillRect(rect, heatColor(ratio));
+        if (ratio >= LabelRatio) {
+            labels.append(qMakePair(rect, averageMs));
+        }
+    }
+
+    const QFontMetrics metrics = fontMetrics();
+    painter.setPen(Qt::black);
+    for (const QPair<QRect, double> &label : qAsConst(labels)) {
+        const QString text = tr("%1 ms").arg(label.second, 0, 'f', 2);
+        if (label.first.width() >= metrics.horizontalAdvance(text)
+            && label.first.height() >= metrics.height()) {
+            painter.drawText(label.first, Qt::AlignCenter, text);
+        }
+    }
+
+    if (fullRepaint) {
+        m_shownMaxMs = maxMs;
+    }
+    m_paintCountAtLastPaint = m_profiler->totalPaintCount();
+    m_profiler->setPaused(false);
+}
+
+void PaintHeatmapOverlay::hideEvent(QHideEvent *event)
+{
+    // A hidden overlay does not paint, so it cannot resume the profiler there
+    m_profiler->setPaused(false);
+    QWidget::hideEvent(event);
+}
@@ -0,0 +1,78 @@
+#ifndef PAINTHEATMAPOVERLAY_H
+#define PAINTHEATMAPOVERLAY_H
+
+#include <QWidget>
+#include <QHash>
+
+class QTimer;
+class PaintProfiler;
+
+/**
+ * @brief Translucent overlay tinting widgets by their paint cost.
+ *
+ * PaintHeatmapOverlay covers a target widget and fills every visible widget
+ * profiled by a PaintProfiler with a color from green (cheap) to red (the
+ * slowest average paint), labelling the slowest ones with their time. It
+ * passes mouse events through and is excluded from profiling.
+ *
+ * The overlay refreshes on a timer, and only where a widget's cost changed
+ * by more than REFRESH_THRESHOLD of the slowest one, so steady small paints
+ * (a blinking cursor) do not repaint the gallery. Repainting the overlay
+ * repaints the widgets underneath; the profiler is paused until the overlay
+ * has painted, so those paints are not recorded.
+ */
+class PaintHeatmapOverlay : public QWidget
+{
+    Q_OBJECT
+
+public:
+    static constexpr int REFRESH_INTERVAL_MS = 500;
+
+    /**
+     * @brief Change in cost, relative to the slowest widget, that is redrawn.
+     */
+    static constexpr double REFRESH_THRESHOLD = 0.05;
+
+    /**
+     * @brief Constructs an overlay over a target widget.
+     * @param profiler The profiler whose costs are shown (must outlive the overlay).
+     * @param target The widget to cover; becomes the overlay's parent.
+     */
+    PaintHeatmapOverlay(PaintProfiler *profiler, QWidget *target);
+
+    /**
+     * @brief Destructor; resumes the profiler if a repaint was pending.
+     */
+    ~PaintHeatmapOverlay() override;
+
+    /**
+     * @brief Repaints the heatmap without recording the paints it causes.
+     * @param region The area to repaint; empty for the whole overlay.
+     */
+    void repaintHeatmap(const QRegion &region = QRegion());
+
+    /**
+     * @brief Returns the color used for a cost.
+     * @param ratio The cost relative to the slowest widget, 0 to 1.
+     */
+    static QColor heatColor(double ratio);
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+    void paintEvent(QPaintEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private slots:
+    void refresh();
+
+private:
+    QRect visibleRect(QWidget *widget) const;
+
+    PaintProfiler *m_profiler;
+    QTimer *m_refreshTimer;
+    qint64 m_paintCountAtLastPaint;
+    double m_shownMaxMs;                        ///< Slowest average when last painted
+    QHash<QWidget*, double> m_shownAverages;    ///< Averages when last painted
+};
+
+#endif // PAINTHEATMAPOVERLAY_H
@@ -0,0 +1,243 @@
+#include "PaintProfiler.h"
+#include "QssRuleSet.h"
+#include "ProfilingApplication.h"
+
+#include <QWidget>
+#include <QEvent>
+#include <QChildEvent>
+#include <QDebug>
+
+#include <algorithm>
+
+double PaintProfiler::WidgetCost::averageMs() const
+{
+    return paintCount > 0 ? totalNsecs / 1000000.0 / paintCount : 0.0;
+}
+
+double PaintProfiler::TypeCost::averageMs() const
+{
+    return paintCount > 0 ? totalNsecs / 1000000.0 / paintCount : 0.0;
+}
+
+PaintProfiler::PaintProfiler(QObject *parent)
+    : QObject(parent)
+    , m_totalPaintCount(0)
+    , m_paused(false)
+{
+}
+
+PaintProfiler::~PaintProfiler()
+{
+    detach();
+}
+
+void PaintProfiler::attach(QWidget *root)
+{
+    if (!root) {
+        return;
+    }
+
+    if (m_costs.isEmpty()) {
+        if (ProfilingApplication *app = ProfilingApplication::instance()) {
+            connect(app, &ProfilingApplication::paintTimed, this, &PaintProfiler::onPaintTimed,
+                    Qt::UniqueConnection);
+        } else {
+            qWarning() << "PaintProfiler: paints are only timed under a ProfilingApplication";
+        }
+    }
+
+    attachWidget(root);
+    const QList<QWidget*> descendants = root->findChildren<QWidget*>();
+    for (QWidget *widget : descendants) {
+        attachWidget(widget);
+    }
+}
+
+void PaintProfiler::attachWidget(QWidget *widget)
+{
+    if (m_ignored.contains(widget) || m_costs.contains(widget)) {
+        return;
+    }
+
+    m_costs.insert(widget, WidgetCost());
+    widget->installEventFilter(this);
+    connect(widget, &QObject::destroyed, this, &PaintProfiler::onWidgetDestroyed);
+}
+
+void PaintProfiler::detach()
+{
+    for (auto it = m_costs.constBegin(); it != m_costs.constEnd(); ++it) {
+        it.key()->removeEventFilter(this);
+        disconnect(it.key(), &QObject::destroyed, this, &PaintProfiler::onWidgetDestroyed);
+    }
+    m_costs.clear();
+    m_totalPaintCount = 0;
+    m_paused = false;
+
+    // Stop the application from timing paints for nobody
+    if (ProfilingApplication *app = ProfilingApplication::instance()) {
+        disconnect(app, &ProfilingApplication::paintTimed, this, &PaintProfiler::onPaintTimed);
+    }
+}
+
+bool PaintProfiler::isAttached() const
+{
+    return !m_costs.isEmpty();
+}
+
+void PaintProfiler::ignoreWidget(QWidget *widget)
+{
+    if (!widget || m_ignored.contains(widget)) {
+        return;
+    }
+
+    if (m_costs.remove(widget) > 0) {
+        widget->removeEventFilter(this);
+    } else {
+        connect(widget, &QObject::destroyed, this, &PaintProfiler::onWidgetDestroyed);
+    }
+    m_ignored.insert(widget);
+}
+
+void PaintProfiler::reset()
+{
+    for (auto it = m_costs.begin(); it != m_costs.end(); ++it) {
+        it.value() = WidgetCost();
+    }
+    m_totalPaintCount = 0;
+}
+
+void PaintProfiler::setPaused(bool paused)
+{
+    m_paused = paused;
+}
+
+bool PaintProfiler::isPaused() const
+{
+    return m_paused;
+}
+
+QList<QWidget*> PaintProfiler::profiledWidgets() const
+{
+    QList<QWidget*> widgets;
+    widgets.reserve(m_costs.size());
+    for (auto it = m_costs.constBegin(); it != m_costs.constEnd(); ++it) {
+        widgets.append(static_cast<QWidget*>(it.key()));
+    }
+    return widgets;
+}
+
+PaintProfiler::WidgetCost PaintProfiler::cost(QWidget *widget) const
+{
+    return m_costs.value(widget);
+}
+
+qint64 PaintProfiler::totalPaintCount() const
+{
+    return m_totalPaintCount;
+}
+
+double PaintProfiler::maxAverageMs() const
+{
+    double maxMs = 0.0;
+    for (const WidgetCost &cost : m_costs) {
+        maxMs = std::max(maxMs, cost.averageMs());
+    }
+    return maxMs;
+}
+
+QVector<PaintProfiler::TypeCost> PaintProfiler::slowestTypes(const QssRuleSet &rules, int limit) const
+{
+    QHash<QString, TypeCost> types;
+    QHash<QString, QList<QWidget*>> widgetsByType;
+    for (auto it = m_costs.constBegin(); it != m_costs.constEnd(); ++it) {
+        const WidgetCost &cost = it.value();
+        if (cost.paintCount == 0) {
+            continue;
+        }
+
+        QWidget *widget = static_cast<QWidget*>(it.key());
+        const QString typeName = QString::fromLatin1(widget->metaObject()->className());
+        TypeCost &type = types[typeName];
+        type.typeName = typeName;
+        ++type.widgetCount;
+        type.paintCount += cost.paintCount;
+        type.totalNsecs += cost.totalNsecs;
+        type.maxNsecs = std::max(type.maxNsecs, cost.maxNsecs);
+        widgetsByType[typeName].append(widget);
+    }
+
+    QVector<TypeCost> result;
+    result.reserve(types.size());
+    for (const TypeCost &type : qAsConst(types)) {
+        result.append(type);
+    }
+    std::sort(result.begin(), result.end(), [](const TypeCost &a, const TypeCost &b) {
+        return a.averageMs() > b.averageMs();
+    });
+    if (limit >= 0 && result.size() > limit) {
+        result.resize(limit);
+    }
+
+    // Matching only the listed types keeps refreshes cheap on large sheets
+    for (TypeCost &type : result) {
+        type.matchingRules = matchingRules(rules, widgetsByType.value(type.typeName));
+    }
+    return result;
+}
+
+QStringList PaintProfiler::matchingRules(const QssRuleSet &rules, const QList<QWidget*> &widgets)
+{
+    QStringList matches;
+    for (const QssRule &rule : rules.rules()) {
+        bool matched = false;
+        for (const QssSelector &selector : rule.selectors) {
+            for (QWidget *widget : widgets) {
+                if (selector.mayMatch(widget)) {
+                    matched = true;
+                    break;
+                }
+            }
+            if (matched) {
+                break;
+            }
+        }
+        if (matched) {
+            matches << rule.selectorText;
+        }
+    }
+    return matches;
+}
+
+bool PaintProfiler::eventFilter(QObject *watched, QEvent *event)
+{
+    // Children are polished once fully constructed, so their real type is known
+    if (event->type() == QEvent::ChildPolished) {
+        QObject *child = static_cast<QChildEvent*>(event)->child();
+        if (child && child->isWidgetType()) {
+            attach(static_cast<QWidget*>(child));
+        }
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+void PaintProfiler::onPaintTimed(QObject *receiver, qint64 nsecs)
+{
+    if (m_paused) {
+        return;
+    }
+
+    auto it = m_costs.find(receiver);
+    if (it != m_costs.end()) {
+        ++it->paintCount;
+        it->totalNsecs += nsecs;
+        it->maxNsecs = std::max(it->maxNsecs, nsecs);
+        ++m_totalPaintCount;
+    }
+}
+
+void PaintProfiler::onWidgetDestroyed(QObject *object)
+{
+    m_costs.remove(object);
+    m_ignored.remove(object);
+}
@@ -0,0 +1,175 @@
+#ifndef PAINTPROFILER_H
+#define PAINTPROFILER_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+class QWidget;
+class QEvent;
+class QssRuleSet;
+
+/**
+ * @brief Times the Paint events of every widget in a subtree.
+ *
+ * PaintProfiler follows a root widget and all of its descendants, including
+ * widgets added later, and records the Paint event times reported by
+ * ProfilingApplication. The cost recorded is the widget's whole paint under
+ * the current style and stylesheet, including event filters such as the one
+ * that paints a scroll area's viewport. Children are painted in events of
+ * their own, so costs are exclusive of descendants.
+ *
+ * Paints are only timed when the application is a ProfilingApplication.
+ *
+ * Costs are aggregated per widget and, on request, per widget type together
+ * with the stylesheet rules that may match widgets of that type, which is
+ * where border-image, gradient and radius rules show up as expensive.
+ */
+class PaintProfiler : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Paint cost of one widget.
+     */
+    struct WidgetCost
+    {
+        int paintCount = 0;
+        qint64 totalNsecs = 0;
+        qint64 maxNsecs = 0;
+
+        double averageMs() const;
+    };
+
+    /**
+     * @brief Paint cost of all widgets of one type.
+     */
+    struct TypeCost
+    {
+        QString typeName;
+        int widgetCount = 0;
+        int paintCount = 0;
+        qint64 totalNsecs = 0;
+        qint64 maxNsecs = 0;
+        QStringList matchingRules;      ///< Selector lists of rules that may apply
+
+        double averageMs() const;
+    };
+
+    /**
+     * @brief Constructs a PaintProfiler.
+     * @param parent The parent QObject.
+     */
+    explicit PaintProfiler(QObject *parent = nullptr);
+
+    /**
+     * @brief Destructor; detaches from all widgets.
+     */
+    ~PaintProfiler() override;
+
+    /**
+     * @brief Starts profiling a widget and its descendants.
+     * @param root The root of the subtree.
+     */
+    void attach(QWidget *root);
+
+    /**
+     * @brief Stops profiling all widgets and discards their costs.
+     */
+    void detach();
+
+    /**
+     * @brief Returns whether any widget is being profiled.
+     */
+    bool isAttached() const;
+
+    /**
+     * @brief Excludes a widget from profiling, such as an overlay.
+     * @param widget The widget to exclude.
+     */
+    void ignoreWidget(QWidget *widget);
+
+    /**
+     * @brief Discards the recorded costs but keeps profiling.
+     */
+    void reset();
+
+    /**
+     * @brief Stops or resumes recording paints without detaching.
+     *
+     * Used to leave out paints the caller causes itself, such as those of
+     * the widgets underneath a repainted overlay.
+     *
+     * @param paused True to ignore paints until resumed.
+     */
+    void setPaused(bool paused);
+
+    /**
+     * @brief Returns whether recording is paused.
+     */
+    bool isPaused() const;
+
+    /**
+     * @brief Returns the profiled widgets.
+     */
+    QList<QWidget*> profiledWidgets() const;
+
+    /**
+     * @brief Returns the recorded cost of a widget.
+     * @param widget The widget to query.
+     * @return The cost, empty if the widget has not painted.
+     */
+    WidgetCost cost(QWidget *widget) const;
+
+    /**
+     * @brief Returns the number of Paint events timed since the last reset.
+     */
+    qint64 totalPaintCount() const;
+
+    /**
+     * @brief Returns the largest average paint time of any widget.
+     * @return The time in milliseconds, or 0 if nothing has painted.
+     */
+    double maxAverageMs() const;
+
+    /**
+     * @brief Returns the widget types with the slowest average paint.
+     * @param rules The stylesheet to match against each type.
+     * @param limit The maximum number of types to return.
+     * @return Types sorted by average paint time, slowest first.
+     */
+    QVector<TypeCost> slowestTypes(const QssRuleSet &rules, int limit) const;
+
+    /**
+     * @brief Returns the rules that may apply to any of a set of widgets.
+     * @param rules The parsed stylesheet.
+     * @param widgets The widgets to match.
+     * @return Selector lists of the matching rules, in document order.
+     */
+    static QStringList matchingRules(const QssRuleSet &rules, const QList<QWidget*> &widgets);
+
+protected:
+    /**
+     * @brief Follows newly added children.
+     */
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private slots:
+    void onPaintTimed(QObject *receiver, qint64 nsecs);
+    void onWidgetDestroyed(QObject *object);
+
+private:
+    void attachWidget(QWidget *widget);
+
+    QHash<QObject*, WidgetCost> m_costs;
+    QSet<QObject*> m_ignored;
+    qint64 m_totalPaintCount;
+    bool m_paused;
+};
+
+#endif // PAINTPROFILER_H
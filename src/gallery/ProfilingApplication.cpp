@@ -0,0 +1,29 @@
+#include "ProfilingApplication.h"
+
+#include <QElapsedTimer>
+#include <QEvent>
+#include <QMetaMethod>
+
+ProfilingApplication::ProfilingApplication(int &argc, char **argv)
+    : QApplication(argc, argv)
+{
+}
+
+ProfilingApplication* ProfilingApplication::instance()
+{
+    return qobject_cast<ProfilingApplication*>(QCoreApplication::instance());
+}
+
+bool ProfilingApplication::notify(QObject *receiver, QEvent *event)
+{
+    static const QMetaMethod paintTimedSignal = QMetaMethod::fromSignal(&ProfilingApplication::paintTimed);
+    if (event->type() != QEvent::Paint || !isSignalConnected(paintTimedSignal)) {
+        return QApplication::notify(receiver, event);
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    const bool result = QApplication::notify(receiver, event);
+    emit paintTimed(receiver, timer.nsecsElapsed());
+    return result;
+}
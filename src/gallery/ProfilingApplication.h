@@ -0,0 +1,57 @@
+#ifndef PROFILINGAPPLICATION_H
+#define PROFILINGAPPLICATION_H
+
+#include <QApplication>
+
+/**
+ * @brief QApplication that can time the delivery of Paint events.
+ *
+ * Event filters only see an event before it is delivered, so they cannot
+ * time its handling without delivering it themselves, which skips every
+ * filter installed before them (such as the one QAbstractScrollArea uses to
+ * paint its viewport). ProfilingApplication instead times notify(), which
+ * covers all event filters and the receiver's own handling.
+ *
+ * Timing only happens while something is connected to paintTimed(); other
+ * events, and all events when nothing is connected, are delivered as by
+ * QApplication.
+ *
+ * @see PaintProfiler, FirstPaintTimer
+ */
+class ProfilingApplication : public QApplication
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Constructs the application.
+     * @param argc The argument count; must stay valid for the application's lifetime.
+     * @param argv The arguments.
+     */
+    ProfilingApplication(int &argc, char **argv);
+
+    /**
+     * @brief Returns the running ProfilingApplication.
+     * @return The application, or nullptr if it is a plain QApplication.
+     */
+    static ProfilingApplication* instance();
+
+    /**
+     * @brief Delivers an event, timing it if it is a Paint event.
+     */
+    bool notify(QObject *receiver, QEvent *event) override;
+
+signals:
+    /**
+     * @brief Emitted after a Paint event was delivered.
+     *
+     * Paint events of children are delivered separately, after their
+     * parent's, so the time does not include them.
+     *
+     * @param receiver The widget that painted.
+     * @param nsecs Time spent delivering the event, in nanoseconds.
+     */
+    void paintTimed(QObject *receiver, qint64 nsecs);
+};
+
+#endif // PROFILINGAPPLICATION_H
@@ -0,0 +1,255 @@
+#include "StressPage.h"
+#include "GeneratedItemModel.h"
+
+#include <QTableView>
+#include <QTreeView>
+#include <QHeaderView>
+#include <QScrollBar>
+#include <QSpinBox>
+#include <QPushButton>
+#include <QGroupBox>
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+#include <QLabel>
+#include <QElapsedTimer>
+
+#include <algorithm>
+#include <cmath>
+
+double StressPage::ScrollBenchmark::averageMs() const
+{
+    if (frameMs.isEmpty()) {
+        return 0.0;
+    }
+    double total = 0.0;
+    for (double ms : frameMs) {
+        total += ms;
+    }
+    return total / frameMs.size();
+}
+
+double StressPage::ScrollBenchmark::percentileMs(double percentile) const
+{
+    if (frameMs.isEmpty()) {
+        return 0.0;
+    }
+    QVector<double> sorted = frameMs;
+    std::sort(sorted.begin(), sorted.end());
+    const int rank = int(std::ceil(percentile / 100.0 * sorted.size())) - 1;
+    return sorted.at(std::clamp(rank, 0, int(sorted.size()) - 1));
+}
+
+double StressPage::ScrollBenchmark::maxMs() const
+{
+    if (frameMs.isEmpty()) {
+        return 0.0;
+    }
+    return *std::max_element(frameMs.begin(), frameMs.end());
+}
+
+StressPage::StressPage(QWidget *parent)
+    : GalleryPage(parent)
+    , m_model(nullptr)
+    , m_rowsSpinBox(nullptr)
+    , m_columnsSpinBox(nullptr)
+    , m_childrenSpinBox(nullptr)
+    , m_framesSpinBox(nullptr)
+    , m_resultLabel(nullptr)
+    , m_tableView(nullptr)
+    , m_treeView(nullptr)
+{
+    setupWidgets();
+}
+
+StressPage::~StressPage()
+{
+    // Qt handles child widget deletion
+}
+
+void StressPage::setWidgetsEnabled(bool enabled)
+{
+    for (QWidget *widget : m_widgets) {
+        widget->setEnabled(enabled);
+    }
+}
+
+GeneratedItemModel* StressPage::model() const
+{
+    return m_model;
+}
+
+QTableView* StressPage::tableView() const
+{
+    return m_tableView;
+}
+
+QTreeView* StressPage::treeView() const
+{
+    return m_treeView;
+}
+
+StressPage::ScrollBenchmark StressPage::runScrollBenchmark(QAbstractItemView *view, int frames)
+{
+    ScrollBenchmark result;
+    if (!view || frames <= 0 || !view->isVisible()) {
+        return result;
+    }
+
+    QScrollBar *scrollBar = view->verticalScrollBar();
+    const int startValue = scrollBar->value();
+    const int step = std::max(scrollBar->pageStep(), 1);
+
+    // Repainting synchronously makes each step a full frame: the scroll,
+    // the item layout for the new rows and their styled paint
+    result.frameMs.reserve(frames);
+    QElapsedTimer timer;
+    for (int frame = 0; frame < frames; ++frame) {
+        int next = scrollBar->value() + step;
+        if (next > scrollBar->maximum()) {
+            next = scrollBar->minimum();
+        }
+
+        timer.start();
+        scrollBar->setValue(next);
+        view->viewport()->repaint();
+        result.frameMs.append(timer.nsecsElapsed() / 1000000.0);
+    }
+
+    scrollBar->setValue(startValue);
+    return result;
+}
+
+void StressPage::regenerate()
+{
+    m_model->setDimensions(m_rowsSpinBox->value(), m_columnsSpinBox->value(),
+                           m_childrenSpinBox->value());
+}
+
+void StressPage::runBenchmark()
+{
+    const int frames = m_framesSpinBox->value();
+    const ScrollBenchmark tableResult = runScrollBenchmark(m_tableView, frames);
+    const ScrollBenchmark treeResult = runScrollBenchmark(m_treeView, frames);
+
+    if (tableResult.isEmpty() && treeResult.isEmpty()) {
+        m_resultLabel->setText(tr("The views must be visible to benchmark scrolling."));
+        return;
+    }
+
+    m_resultLabel->setText(formatResult(tr("QTableView"), tableResult) + QLatin1Char('\n')
+                           + formatResult(tr("QTreeView"), treeResult));
+}
+
+QString StressPage::formatResult(const QString &viewName, const ScrollBenchmark &result)
+{
+    if (result.isEmpty()) {
+        return tr("%1: not visible").arg(viewName);
+    }
+    return tr("%1: %2 frames, avg %3 ms, p95 %4 ms, max %5 ms")
+        .arg(viewName)
+        .arg(result.frameMs.size())
+        .arg(result.averageMs(), 0, 'f', 2)
+        .arg(result.percentileMs(95.0), 0, 'f', 2)
+        .arg(result.maxMs(), 0, 'f', 2);
+}
+
+void StressPage::setupWidgets()
+{
+    m_model = new GeneratedItemModel(DEFAULT_ROWS, DEFAULT_COLUMNS, DEFAULT_CHILDREN, this);
+
+    setupControls();
+    setupViews();
+}
+
+void StressPage::setupControls()
+{
+    QGroupBox *group = qobject_cast<QGroupBox*>(createGroup(tr("Model Size")));
+    QVBoxLayout *groupLayout = qobject_cast<QVBoxLayout*>(group->layout());
+
+    QFormLayout *form = new QFormLayout();
+
+    m_rowsSpinBox = new QSpinBox(group);
+    m_rowsSpinBox->setRange(0, 5000000);
+    m_rowsSpinBox->setSingleStep(10000);
+    m_rowsSpinBox->setGroupSeparatorShown(true);
+    m_rowsSpinBox->setValue(DEFAULT_ROWS);
+    form->addRow(tr("Rows:"), m_rowsSpinBox);
+    m_widgets.append(m_rowsSpinBox);
+
+    m_columnsSpinBox = new QSpinBox(group);
+    m_columnsSpinBox->setRange(1, 100);
+    m_columnsSpinBox->setValue(DEFAULT_COLUMNS);
+    form->addRow(tr("Columns:"), m_columnsSpinBox);
+    m_widgets.append(m_columnsSpinBox);
+
+    m_childrenSpinBox = new QSpinBox(group);
+    m_childrenSpinBox->setRange(0, 100);
+    m_childrenSpinBox->setValue(DEFAULT_CHILDREN);
+    m_childrenSpinBox->setToolTip(tr("Children of each top-level row in the tree view"));
+    form->addRow(tr("Children per row:"), m_childrenSpinBox);
+    m_widgets.append(m_childrenSpinBox);
+
+    m_framesSpinBox = new QSpinBox(group);
+    m_framesSpinBox->setRange(1, 1000);
+    m_framesSpinBox->setValue(DEFAULT_BENCHMARK_FRAMES);
+    form->addRow(tr("Benchmark frames:"), m_framesSpinBox);
+    m_widgets.append(m_framesSpinBox);
+
+    groupLayout->addLayout(form);
+
+    QHBoxLayout *buttonRow = new QHBoxLayout();
+    QPushButton *regenerateButton = new QPushButton(tr("Regenerate"), group);
+    connect(regenerateButton, &QPushButton::clicked, this, &StressPage::regenerate);
+    buttonRow->addWidget(regenerateButton);
+    m_widgets.append(regenerateButton);
+
+    QPushButton *benchmarkButton = new QPushButton(tr("Run Scroll Benchmark"), group);
+    connect(benchmarkButton, &QPushButton::clicked, this, &StressPage::runBenchmark);
+    buttonRow->addWidget(benchmarkButton);
+    m_widgets.append(benchmarkButton);
+    buttonRow->addStretch();
+    groupLayout->addLayout(buttonRow);
+
+    m_resultLabel = new QLabel(tr("Run the benchmark to measure frame times under the current stylesheet."), group);
+    m_resultLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    groupLayout->addWidget(m_resultLabel);
+}
+
+void StressPage::setupViews()
+{
+    QGroupBox *group = qobject_cast<QGroupBox*>(createGroup(tr("Large Views")));
+    QVBoxLayout *groupLayout = qobject_cast<QVBoxLayout*>(group->layout());
+
+    QHBoxLayout *row = new QHBoxLayout();
+    row->setSpacing(12);
+
+    // Fixed sections give every row the default height, so the header does
+    // not measure rows as the table scrolls
+    QVBoxLayout *tableCol = new QVBoxLayout();
+    QLabel *tableLabel = new QLabel(tr("QTableView:"), group);
+    m_tableView = new QTableView(group);
+    m_tableView->setModel(m_model);
+    m_tableView->setAlternatingRowColors(true);
+    m_tableView->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    m_tableView->verticalHeader()->setDefaultSectionSize(m_tableView->fontMetrics().height() + 6);
+    m_tableView->setMinimumHeight(300);
+    tableCol->addWidget(tableLabel);
+    tableCol->addWidget(m_tableView);
+    row->addLayout(tableCol);
+    m_widgets.append(m_tableView);
+
+    QVBoxLayout *treeCol = new QVBoxLayout();
+    QLabel *treeLabel = new QLabel(tr("QTreeView:"), group);
+    m_treeView = new QTreeView(group);
+    m_treeView->setModel(m_model);
+    m_treeView->setUniformRowHeights(true);
+    m_treeView->setAlternatingRowColors(true);
+    m_treeView->setMinimumHeight(300);
+    treeCol->addWidget(treeLabel);
+    treeCol->addWidget(m_treeView);
+    row->addLayout(treeCol);
+    m_widgets.append(m_treeView);
+
+    groupLayout->addLayout(row);
+}
@@ -0,0 +1,117 @@
+#ifndef STRESSPAGE_H
+#define STRESSPAGE_H
+
+#include "GalleryPage.h"
+
+#include <QList>
+#include <QVector>
+
+class QWidget;
+class QSpinBox;
+class QLabel;
+class QTableView;
+class QTreeView;
+class QAbstractItemView;
+class GeneratedItemModel;
+
+/**
+ * @brief Gallery page stress testing item views at production sizes.
+ *
+ * StressPage shows a QTableView and a QTreeView over a GeneratedItemModel
+ * with configurable row, column and child counts (100,000 rows by default),
+ * so item and branch rules can be judged at the scale real applications
+ * style. Both views use uniform row heights, which keeps layout independent
+ * of the row count.
+ *
+ * The scroll benchmark pages through each view and repaints it synchronously
+ * per step, reporting frame times under the current stylesheet.
+ */
+class StressPage : public GalleryPage
+{
+    Q_OBJECT
+
+public:
+    static constexpr int DEFAULT_ROWS = 100000;
+    static constexpr int DEFAULT_COLUMNS = 8;
+    static constexpr int DEFAULT_CHILDREN = 3;
+    static constexpr int DEFAULT_BENCHMARK_FRAMES = 60;
+
+    /**
+     * @brief Frame times of one scroll benchmark run.
+     */
+    struct ScrollBenchmark
+    {
+        QVector<double> frameMs;    ///< Repaint time per scroll step
+
+        bool isEmpty() const { return frameMs.isEmpty(); }
+        double averageMs() const;
+        double percentileMs(double percentile) const;
+        double maxMs() const;
+    };
+
+    /**
+     * @brief Constructs a StressPage.
+     * @param parent The parent widget.
+     */
+    explicit StressPage(QWidget *parent = nullptr);
+
+    /**
+     * @brief Destructor.
+     */
+    ~StressPage() override;
+
+    /**
+     * @brief Enables or disables the views and their controls.
+     * @param enabled true to enable, false to disable.
+     */
+    void setWidgetsEnabled(bool enabled) override;
+
+    /**
+     * @brief Returns the model shared by both views.
+     */
+    GeneratedItemModel* model() const;
+
+    QTableView* tableView() const;
+    QTreeView* treeView() const;
+
+    /**
+     * @brief Scrolls a view step by step, timing a repaint per step.
+     * @param view The view to scroll.
+     * @param frames The number of scroll steps.
+     * @return The frame times; empty if the view is not visible.
+     *
+     * The view scrolls a page per step, wrapping at the end, and its scroll
+     * position is restored afterwards.
+     */
+    static ScrollBenchmark runScrollBenchmark(QAbstractItemView *view, int frames);
+
+public slots:
+    /**
+     * @brief Applies the row, column and child counts from the controls.
+     */
+    void regenerate();
+
+    /**
+     * @brief Runs the scroll benchmark on both views and shows the results.
+     */
+    void runBenchmark();
+
+private:
+    void setupWidgets();
+    void setupControls();
+    void setupViews();
+    static QString formatResult(const QString &viewName, const ScrollBenchmark &result);
+
+    GeneratedItemModel *m_model;
+    QSpinBox *m_rowsSpinBox;
+    QSpinBox *m_columnsSpinBox;
+    QSpinBox *m_childrenSpinBox;
+    QSpinBox *m_framesSpinBox;
+    QLabel *m_resultLabel;
+    QTableView *m_tableView;
+    QTreeView *m_treeView;
+
+    QList<QWidget*> m_widgets;
+};
+
+#endif // STRESSPAGE_H
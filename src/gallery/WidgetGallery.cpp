@@ -8,6 +8,7 @@
 #include "DisplayPage.h"
 #include "MainWindowPage.h"
 #include "AdvancedPage.h"
+#include "StressPage.h"
 #include "CustomWidgetsPage.h"
 #include "PluginManager.h"
 
@@ -16,25 +17,28 @@
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QGroupBox>
+#include <QTabBar>
 #include <QLabel>
 #include <QLineEdit>
 #include <QTextEdit>
 
 WidgetGallery::WidgetGallery(QWidget *parent)
+    : WidgetGallery(PageCreation::Eager, parent)
+{
+}
+
+WidgetGallery::WidgetGallery(PageCreation creation, QWidget *parent)
     : QWidget(parent)
+    , m_pageCreation(creation)
     , m_tabWidget(nullptr)
     , m_enabledCheckBox(nullptr)
     , m_readOnlyCheckBox(nullptr)
-    , m_buttonsPage(nullptr)
-    , m_inputsPage(nullptr)
-    , m_viewsPage(nullptr)
-    , m_containersPage(nullptr)
-    , m_dialogsPage(nullptr)
-    , m_displayPage(nullptr)
-    , m_mainWindowPage(nullptr)
-    , m_advancedPage(nullptr)
-    , m_customWidgetsPage(nullptr)
+    , m_widgetsEnabled(true)
+    , m_inputsReadOnly(false)
+    , m_widgetsEnabledSet(false)
+    , m_inputsReadOnlySet(false)
     , m_pluginManager(nullptr)
+    , m_stressPageAdded(false)
 {
     setupUi();
 }
@@ -44,6 +48,97 @@ WidgetGallery::~WidgetGallery()
     // Qt handles child widget deletion
 }
 
+WidgetGallery::PageCreation WidgetGallery::pageCreation() const
+{
+    return m_pageCreation;
+}
+
+int WidgetGallery::pageCount() const
+{
+    return m_pages.size();
+}
+
+int WidgetGallery::createdPageCount() const
+{
+    int count = 0;
+    for (const PageSlot &slot : m_pages) {
+        if (slot.page) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+GalleryPage* WidgetGallery::page(int index) const
+{
+    if (index < 0 || index >= m_pages.size()) {
+        return nullptr;
+    }
+    return m_pages.at(index).page;
+}
+
+GalleryPage* WidgetGallery::ensurePage(int index)
+{
+    if (index < 0 || index >= m_pages.size()) {
+        return nullptr;
+    }
+
+    PageSlot &slot = m_pages[index];
+    if (slot.page) {
+        return slot.page;
+    }
+
+    QWidget *parent = slot.container ? slot.container : m_tabWidget;
+    GalleryPage *page = slot.factory(parent);
+    slot.page = page;
+    if (slot.container) {
+        slot.container->layout()->addWidget(page);
+    }
+
+    // Replay the toggles the page would have received had it existed
+    if (m_widgetsEnabledSet) {
+        page->setWidgetsEnabled(m_widgetsEnabled);
+    }
+    if (m_inputsReadOnlySet) {
+        applyInputsReadOnly(page, m_inputsReadOnly);
+    }
+
+    emit pageCreated(index, page);
+    return page;
+}
+
+void WidgetGallery::createAllPages()
+{
+    for (int i = 0; i < m_pages.size(); ++i) {
+        ensurePage(i);
+    }
+}
+
+QList<QWidget*> WidgetGallery::styleTargets() const
+{
+    QList<QWidget*> targets;
+    targets << m_enabledCheckBox->parentWidget();
+    if (QTabBar *tabBar = m_tabWidget->findChild<QTabBar*>(QString(), Qt::FindDirectChildrenOnly)) {
+        targets << tabBar;
+    }
+    for (const PageSlot &slot : m_pages) {
+        if (slot.page) {
+            targets << slot.page;
+        }
+    }
+    return targets;
+}
+
+void WidgetGallery::addStressPage()
+{
+    if (m_stressPageAdded) {
+        return;
+    }
+
+    m_stressPageAdded = true;
+    addPage(tr("Stress"), [](QWidget *parent) { return new StressPage(parent); });
+}
+
 void WidgetGallery::setupUi()
 {
     QVBoxLayout *mainLayout = new QVBoxLayout(this);
@@ -55,34 +150,50 @@ void WidgetGallery::setupUi()
 
     // Create tab widget for gallery pages
     m_tabWidget = new QTabWidget(this);
+    connect(m_tabWidget, &QTabWidget::currentChanged,
+            this, &WidgetGallery::onCurrentTabChanged);
     
     // Setup all gallery pages
     setupPages();
 
+    // The current tab is visible from the start
+    ensurePage(m_tabWidget->currentIndex());
+
     mainLayout->addWidget(m_tabWidget);
 }
 
 void WidgetGallery::setupPages()
 {
-    // Create all gallery pages
-    m_buttonsPage = new ButtonsPage(m_tabWidget);
-    m_inputsPage = new InputsPage(m_tabWidget);
-    m_viewsPage = new ViewsPage(m_tabWidget);
-    m_containersPage = new ContainersPage(m_tabWidget);
-    m_dialogsPage = new DialogsPage(m_tabWidget);
-    m_displayPage = new DisplayPage(m_tabWidget);
-    m_mainWindowPage = new MainWindowPage(m_tabWidget);
-    m_advancedPage = new AdvancedPage(m_tabWidget);
-
-    // Add pages as tabs
-    m_tabWidget->addTab(m_buttonsPage, tr("Buttons"));
-    m_tabWidget->addTab(m_inputsPage, tr("Inputs"));
-    m_tabWidget->addTab(m_viewsPage, tr("Views"));
-    m_tabWidget->addTab(m_containersPage, tr("Containers"));
-    m_tabWidget->addTab(m_dialogsPage, tr("Dialogs"));
-    m_tabWidget->addTab(m_displayPage, tr("Display"));
-    m_tabWidget->addTab(m_mainWindowPage, tr("Main Window"));
-    m_tabWidget->addTab(m_advancedPage, tr("Advanced"));
+    addPage(tr("Buttons"), [](QWidget *parent) { return new ButtonsPage(parent); });
+    addPage(tr("Inputs"), [](QWidget *parent) { return new InputsPage(parent); });
+    addPage(tr("Views"), [](QWidget *parent) { return new ViewsPage(parent); });
+    addPage(tr("Containers"), [](QWidget *parent) { return new ContainersPage(parent); });
+    addPage(tr("Dialogs"), [](QWidget *parent) { return new DialogsPage(parent); });
+    addPage(tr("Display"), [](QWidget *parent) { return new DisplayPage(parent); });
+    addPage(tr("Main Window"), [](QWidget *parent) { return new MainWindowPage(parent); });
+    addPage(tr("Advanced"), [](QWidget *parent) { return new AdvancedPage(parent); });
+}
+
+void WidgetGallery::addPage(const QString &title, const PageFactory &factory)
+{
+    PageSlot slot;
+    slot.factory = factory;
+    slot.container = nullptr;
+    slot.page = nullptr;
+
+    if (m_pageCreation == PageCreation::Eager) {
+        slot.page = factory(m_tabWidget);
+        m_pages.append(slot);
+        m_tabWidget->addTab(slot.page, title);
+        return;
+    }
+
+    // The page is built into this container when the tab is first shown
+    slot.container = new QWidget(m_tabWidget);
+    QVBoxLayout *layout = new QVBoxLayout(slot.container);
+    layout->setContentsMargins(0, 0, 0, 0);
+    m_pages.append(slot);
+    m_tabWidget->addTab(slot.container, title);
 }
 
 void WidgetGallery::setupToggleControls()
@@ -117,33 +228,14 @@ void WidgetGallery::setupToggleControls()
 
 void WidgetGallery::setWidgetsEnabled(bool enabled)
 {
-    // Propagate to all gallery pages
-    if (m_buttonsPage) {
-        m_buttonsPage->setWidgetsEnabled(enabled);
-    }
-    if (m_inputsPage) {
-        m_inputsPage->setWidgetsEnabled(enabled);
-    }
-    if (m_viewsPage) {
-        m_viewsPage->setWidgetsEnabled(enabled);
-    }
-    if (m_containersPage) {
-        m_containersPage->setWidgetsEnabled(enabled);
-    }
-    if (m_dialogsPage) {
-        m_dialogsPage->setWidgetsEnabled(enabled);
-    }
-    if (m_displayPage) {
-        m_displayPage->setWidgetsEnabled(enabled);
-    }
-    if (m_mainWindowPage) {
-        m_mainWindowPage->setWidgetsEnabled(enabled);
-    }
-    if (m_advancedPage) {
-        m_advancedPage->setWidgetsEnabled(enabled);
-    }
-    if (m_customWidgetsPage) {
-        m_customWidgetsPage->setWidgetsEnabled(enabled);
+    m_widgetsEnabled = enabled;
+    m_widgetsEnabledSet = true;
+
+    // Propagate to the gallery pages built so far; later ones start in this state
+    for (const PageSlot &slot : qAsConst(m_pages)) {
+        if (slot.page) {
+            slot.page->setWidgetsEnabled(enabled);
+        }
     }
 
     // Update checkbox state if called programmatically
@@ -158,17 +250,9 @@ void WidgetGallery::setWidgetsEnabled(bool enabled)
 
 void WidgetGallery::setInputsReadOnly(bool readOnly)
 {
-    // Set read-only state on all QLineEdit widgets in the gallery
-    QList<QLineEdit*> lineEdits = findChildren<QLineEdit*>();
-    for (QLineEdit *lineEdit : lineEdits) {
-        lineEdit->setReadOnly(readOnly);
-    }
-    
-    // Set read-only state on all QTextEdit widgets in the gallery
-    QList<QTextEdit*> textEdits = findChildren<QTextEdit*>();
-    for (QTextEdit *textEdit : textEdits) {
-        textEdit->setReadOnly(readOnly);
-    }
+    m_inputsReadOnly = readOnly;
+    m_inputsReadOnlySet = true;
+    applyInputsReadOnly(this, readOnly);
 
     // Update checkbox state if called programmatically
     if (m_readOnlyCheckBox && m_readOnlyCheckBox->isChecked() != readOnly) {
@@ -180,6 +264,26 @@ void WidgetGallery::setInputsReadOnly(bool readOnly)
     emit inputsReadOnlyChanged(readOnly);
 }
 
+void WidgetGallery::applyInputsReadOnly(QWidget *root, bool readOnly)
+{
+    // Set read-only state on all QLineEdit widgets under root
+    QList<QLineEdit*> lineEdits = root->findChildren<QLineEdit*>();
+    for (QLineEdit *lineEdit : lineEdits) {
+        lineEdit->setReadOnly(readOnly);
+    }
+    
+    // Set read-only state on all QTextEdit widgets under root
+    QList<QTextEdit*> textEdits = root->findChildren<QTextEdit*>();
+    for (QTextEdit *textEdit : textEdits) {
+        textEdit->setReadOnly(readOnly);
+    }
+}
+
+void WidgetGallery::onCurrentTabChanged(int index)
+{
+    ensurePage(index);
+}
+
 void WidgetGallery::onEnabledToggled(bool checked)
 {
     setWidgetsEnabled(checked);
@@ -196,11 +300,23 @@ void WidgetGallery::setPluginManager(PluginManager *pluginManager)
     
     if (m_pluginManager) {
         // Create CustomWidgetsPage with the PluginManager
-        m_customWidgetsPage = new CustomWidgetsPage(m_pluginManager, m_tabWidget);
-        m_tabWidget->addTab(m_customWidgetsPage, tr("Custom Widgets"));
-        
-        // Connect pluginsLoaded signal to rebuildWidgets for automatic updates
-        connect(m_pluginManager, &PluginManager::pluginsLoaded,
-                m_customWidgetsPage, &CustomWidgetsPage::rebuildWidgets);
+        addPage(tr("Custom Widgets"), [pluginManager](QWidget *parent) {
+            CustomWidgetsPage *page = new CustomWidgetsPage(pluginManager, parent);
+            
+            // Connect pluginsLoaded signal to rebuildWidgets for automatic updates
+            QObject::connect(pluginManager, &PluginManager::pluginsLoaded,
+                             page, &CustomWidgetsPage::rebuildWidgets);
+            
+            // Single-plugin reloads only rebuild the affected group
+            QObject::connect(pluginManager, &PluginManager::pluginAboutToBeUnloaded,
+                             page, &CustomWidgetsPage::onPluginAboutToBeUnloaded);
+            QObject::connect(pluginManager, &PluginManager::pluginReloaded,
+                             page, &CustomWidgetsPage::onPluginReloaded);
+            
+            // Widgets from libraries loaded in the background fill in as they arrive
+            QObject::connect(pluginManager, &PluginManager::libraryLoadFinished,
+                             page, &CustomWidgetsPage::onLibraryLoadFinished);
+            return page;
+        });
     }
 }
@@ -2,18 +2,14 @@
 #define WIDGETGALLERY_H
 
 #include <QWidget>
+#include <QString>
+#include <QVector>
+
+#include <functional>
 
 class QTabWidget;
 class QCheckBox;
-class ButtonsPage;
-class InputsPage;
-class ViewsPage;
-class ContainersPage;
-class DialogsPage;
-class DisplayPage;
-class MainWindowPage;
-class AdvancedPage;
-class CustomWidgetsPage;
+class GalleryPage;
 class PluginManager;
 
 /**
@@ -28,11 +24,17 @@ class PluginManager;
  * - Display: QLabel, QLCDNumber, QCalendarWidget
  * - Main Window: QToolBar, QStatusBar, QMenuBar, QDockWidget, QSplitter
  * - Advanced: QMdiArea, QListView, QTreeView, QTableView, QColumnView, QGraphicsView
+ * - Stress (optional): QTableView and QTreeView over a large generated model
  * 
  * Features:
  * - Toggle controls for enabled/disabled states
  * - Toggle controls for read-only states (input widgets)
  * - Propagates state changes to all gallery pages
+ *
+ * With PageCreation::OnDemand, each tab starts as an empty container and its
+ * page is built when the tab is first shown, so startup and every stylesheet
+ * apply only pay for the pages that were actually visited. The enabled and
+ * read-only states are applied to pages as they are created.
  */
 class WidgetGallery : public QWidget
 {
@@ -40,22 +42,93 @@ class WidgetGallery : public QWidget
 
 public:
     /**
-     * @brief Constructs a WidgetGallery.
+     * @brief When gallery pages are built.
+     */
+    enum class PageCreation {
+        Eager,      ///< All pages are built by the constructor
+        OnDemand    ///< A page is built when its tab is first shown
+    };
+    Q_ENUM(PageCreation)
+
+    /**
+     * @brief Constructs a WidgetGallery with all pages built.
      * @param parent The parent widget.
      */
     explicit WidgetGallery(QWidget *parent = nullptr);
 
+    /**
+     * @brief Constructs a WidgetGallery.
+     * @param creation When the pages are built.
+     * @param parent The parent widget.
+     */
+    explicit WidgetGallery(PageCreation creation, QWidget *parent = nullptr);
+
     /**
      * @brief Destructor.
      */
     ~WidgetGallery();
 
+    /**
+     * @brief Returns when the gallery pages are built.
+     */
+    PageCreation pageCreation() const;
+
+    /**
+     * @brief Returns the number of pages (tabs), built or not.
+     */
+    int pageCount() const;
+
+    /**
+     * @brief Returns the number of pages that have been built.
+     */
+    int createdPageCount() const;
+
+    /**
+     * @brief Returns the page at a tab index.
+     * @param index The tab index.
+     * @return The page, or nullptr if it has not been built yet.
+     */
+    GalleryPage* page(int index) const;
+
+    /**
+     * @brief Returns the page at a tab index, building it if needed.
+     * @param index The tab index.
+     * @return The page, or nullptr if index is out of range.
+     */
+    GalleryPage* ensurePage(int index);
+
+    /**
+     * @brief Builds every page that has not been built yet.
+     */
+    void createAllPages();
+
+    /**
+     * @brief Returns the widgets that together hold every gallery control.
+     * @return The state controls, the tab bar and each built page.
+     *
+     * Installing a stylesheet on each of these instead of on the gallery
+     * lets hidden pages be restyled separately from the visible one, since
+     * a sheet on a common ancestor re-polishes every page. Rules that select
+     * the gallery itself, the tab widget or its pane then no longer apply.
+     */
+    QList<QWidget*> styleTargets() const;
+
+    /**
+     * @brief Adds the model/view stress page as the last tab.
+     *
+     * The page is not part of the standard set because its views hold
+     * hundreds of thousands of rows; with PageCreation::OnDemand it costs
+     * nothing until its tab is shown. Calling this again has no effect.
+     */
+    void addStressPage();
+
 public slots:
     /**
      * @brief Enables or disables all widgets in the gallery.
      * @param enabled true to enable widgets, false to disable.
      * 
-     * Propagates the enabled state to all gallery pages.
+     * Propagates the enabled state to all gallery pages; pages built
+     * later start in this state.
      */
     void setWidgetsEnabled(bool enabled);
 
@@ -63,7 +136,8 @@ public slots:
      * @brief Sets read-only state for input widgets.
      * @param readOnly true to set read-only, false for editable.
      * 
-     * Propagates to InputsPage for widgets that support read-only mode.
+     * Propagates to InputsPage for widgets that support read-only mode;
+     * pages built later start in this state.
      */
     void setInputsReadOnly(bool readOnly);
 
@@ -90,29 +164,49 @@ signals:
      */
     void inputsReadOnlyChanged(bool readOnly);
 
+    /**
+     * @brief Emitted when a page has been built.
+     * @param index The tab index of the page.
+     * @param page The new page.
+     */
+    void pageCreated(int index, GalleryPage *page);
+
 private slots:
     void onEnabledToggled(bool checked);
     void onReadOnlyToggled(bool checked);
+    void onCurrentTabChanged(int index);
 
 private:
+    using PageFactory = std::function<GalleryPage*(QWidget *parent)>;
+
+    /**
+     * @brief A gallery tab; page stays nullptr until the page is built.
+     */
+    struct PageSlot
+    {
+        PageFactory factory;
+        QWidget *container;     ///< Holds the page in OnDemand mode
+        GalleryPage *page;
+    };
+
     void setupUi();
     void setupPages();
     void setupToggleControls();
+    void addPage(const QString &title, const PageFactory &factory);
+    void applyInputsReadOnly(QWidget *root, bool readOnly);
 
+    PageCreation m_pageCreation;
     QTabWidget *m_tabWidget;
     QCheckBox *m_enabledCheckBox;
     QCheckBox *m_readOnlyCheckBox;
 
-    ButtonsPage *m_buttonsPage;
-    InputsPage *m_inputsPage;
-    ViewsPage *m_viewsPage;
-    ContainersPage *m_containersPage;
-    DialogsPage *m_dialogsPage;
-    DisplayPage *m_displayPage;
-    MainWindowPage *m_mainWindowPage;
-    AdvancedPage *m_advancedPage;
-    CustomWidgetsPage *m_customWidgetsPage;
+    QVector<PageSlot> m_pages;
+    bool m_widgetsEnabled;
+    bool m_inputsReadOnly;
+    bool m_widgetsEnabledSet;     // Whether the toggles have been used, so
+    bool m_inputsReadOnlySet;     // pages built later must replay them
     PluginManager *m_pluginManager;
+    bool m_stressPageAdded;
 };
 
 #endif // WIDGETGALLERY_H
@@ -1,11 +1,12 @@
 #include "MainWindow.h"
+#include "gallery/ProfilingApplication.h"
 
-#include <QApplication>
 #include <QDebug>
 
 int main(int argc, char *argv[])
 {
-    QApplication app(argc, argv);
+    // Lets the paint heatmap time paints without changing how they are delivered
+    ProfilingApplication app(argc, argv);
     
     // Set application metadata
     QCoreApplication::setApplicationName("QtVanity");
@@ -0,0 +1,31 @@
+#include "PluginLoadTask.h"
+
+#include <QElapsedTimer>
+#include <QPluginLoader>
+
+PluginLoadTask::PluginLoadTask(int generation, const QString &filePath, QPluginLoader *loader)
+    : m_generation(generation)
+    , m_filePath(filePath)
+    , m_loader(loader)
+{
+    setAutoDelete(false);
+}
+
+void PluginLoadTask::run()
+{
+    QElapsedTimer timer;
+    timer.start();
+    const bool success = m_loader->load();
+    emit libraryLoaded(m_generation, m_filePath, success, timer.nsecsElapsed());
+    m_done.release();
+
+    // The task lives on the UI thread, where the queued result is delivered
+    deleteLater();
+}
+
+void PluginLoadTask::wait()
+{
+    // Release again so later calls return at once
+    m_done.acquire();
+    m_done.release();
+}
@@ -0,0 +1,64 @@
+#ifndef PLUGINLOADTASK_H
+#define PLUGINLOADTASK_H
+
+#include <QObject>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QString>
+
+class QPluginLoader;
+
+/**
+ * @brief Loads a plugin library on a worker thread.
+ *
+ * The task calls QPluginLoader::load(), which maps the library and runs its
+ * relocations and static initializers, then reports the outcome through a
+ * queued signal tagged with the generation it was started for. Creating the
+ * plugin instance and casting it to its interface is left to the UI thread.
+ *
+ * The loader must not be used or deleted elsewhere until the task has run;
+ * PluginManager either takes the task back from the pool before it starts
+ * or calls wait(). The task deletes itself (via deleteLater()) once run()
+ * returns.
+ */
+class PluginLoadTask : public QObject, public QRunnable
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Constructs a PluginLoadTask.
+     * @param generation Tag passed back with the result.
+     * @param filePath The plugin file, passed back with the result.
+     * @param loader The loader for the plugin file.
+     */
+    PluginLoadTask(int generation, const QString &filePath, QPluginLoader *loader);
+
+    void run() override;
+
+    /**
+     * @brief Blocks until run() is done with the loader.
+     *
+     * Must only be called for a task that was started and not taken back
+     * from its pool.
+     */
+    void wait();
+
+signals:
+    /**
+     * @brief Emitted from the worker thread once the library load finished.
+     * @param generation The generation the task was started for.
+     * @param filePath The plugin file.
+     * @param success Whether the library was loaded.
+     * @param nsecs Time spent loading, in nanoseconds.
+     */
+    void libraryLoaded(int generation, const QString &filePath, bool success, qint64 nsecs);
+
+private:
+    const int m_generation;
+    const QString m_filePath;
+    QPluginLoader *m_loader;
+    QSemaphore m_done;
+};
+
+#endif // PLUGINLOADTASK_H
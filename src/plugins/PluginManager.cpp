@@ -1,19 +1,45 @@
 #include "PluginManager.h"
 #include "WidgetPluginInterface.h"
+#include "PluginLoadTask.h"
 
 #include <QDir>
 #include <QFileInfo>
 #include <QPluginLoader>
+#include <QJsonObject>
+#include <QElapsedTimer>
+#include <QDateTime>
+#include <QFileSystemWatcher>
+#include <QTimer>
+#include <QThreadPool>
 #include <QDebug>
 
+#include <algorithm>
+
 PluginManager::PluginManager(QObject *parent)
     : QObject(parent)
+    , m_lastScanNsecs(0)
+    , m_deferredLoadNsecs(0)
+    , m_lastScanCacheHits(0)
+    , m_watcher(nullptr)
+    , m_reloadTimer(nullptr)
+    , m_cacheSaveTimer(new QTimer(this))
+    , m_loadPool(new QThreadPool(this))
+    , m_loadGeneration(0)
+    , m_backgroundLoadNsecs(0)
+    , m_parallelLoading(false)
+    , m_widgetBudgetMs(0.0)
 {
+    qRegisterMetaType<PluginMetadata>();
+    
+    m_cacheSaveTimer->setSingleShot(true);
+    m_cacheSaveTimer->setInterval(CACHE_SAVE_DELAY_MS);
+    connect(m_cacheSaveTimer, &QTimer::timeout, this, &PluginManager::saveCache);
 }
 
 PluginManager::~PluginManager()
 {
     unloadPlugins();
+    saveCache();
 }
 
 // -----------------------------------------------------------------------------
@@ -30,6 +56,21 @@ QString PluginManager::pluginDirectory() const
     return m_pluginDirectory;
 }
 
+void PluginManager::setCacheFile(const QString &filePath)
+{
+    m_cacheFile = filePath;
+    if (m_cacheFile.isEmpty()) {
+        m_scanCache.clear();
+    } else {
+        m_scanCache.load(m_cacheFile);
+    }
+}
+
+QString PluginManager::cacheFile() const
+{
+    return m_cacheFile;
+}
+
 // -----------------------------------------------------------------------------
 // Plugin Operations
 // -----------------------------------------------------------------------------
@@ -37,11 +78,33 @@ QString PluginManager::pluginDirectory() const
 void PluginManager::loadPlugins()
 {
     // Clear any previous state
+    cancelLibraryLoads();
     m_errors.clear();
+    m_errorFiles.clear();
     m_metadata.clear();
+    m_fileStamps.clear();
+    qDeleteAll(m_pendingLoaders);
+    m_pendingLoaders.clear();
+    m_deferredLoadNsecs = 0;
+    m_backgroundLoadNsecs = 0;
+    m_lastScanCacheHits = 0;
     
     // Scan directory for plugin files
+    QElapsedTimer timer;
+    timer.start();
     scanDirectory();
+    m_scanCache.prune();
+    saveCache();
+    m_lastScanNsecs = timer.nsecsElapsed();
+    resetWatcher();
+    
+    qInfo().noquote() << QString("PluginManager: Scanned %1 plugin(s) in %2 ms, %3 from cache, "
+                                 "%4 library load(s) deferred, %5 in the background")
+                         .arg(m_metadata.size() + m_errors.size() + m_libraryLoads.size())
+                         .arg(lastScanDurationMs(), 0, 'f', 2)
+                         .arg(m_lastScanCacheHits)
+                         .arg(m_pendingLoaders.size())
+                         .arg(m_libraryLoads.size());
     
     emit pluginsLoaded();
 }
@@ -52,18 +115,146 @@ void PluginManager::refreshPlugins()
     loadPlugins();
 }
 
+bool PluginManager::reloadPlugin(const QString &filePath)
+{
+    const QFileInfo fileInfo(filePath);
+    const QString path = fileInfo.absoluteFilePath();
+    
+    // Widgets created by the plugin must go before its library is unloaded
+    const PluginMetadata previous = pluginMetadataForFile(path);
+    if (previous.isValid) {
+        emit pluginAboutToBeUnloaded(previous);
+    }
+    releasePlugin(path);
+    
+    bool loaded = false;
+    if (fileInfo.exists() && isPluginFile(path)) {
+        m_fileStamps.insert(path, FileStamp::of(fileInfo));
+        loaded = loadPlugin(path);
+    } else {
+        m_fileStamps.remove(path);
+    }
+    saveCache();
+    
+    PluginMetadata current = pluginMetadataForFile(path);
+    current.filePath = path;
+    if (!loaded) {
+        const int errorIndex = m_errorFiles.lastIndexOf(path);
+        current.errorMessage = errorIndex >= 0 ? m_errors.at(errorIndex) : QString();
+    }
+    
+    qDebug() << "PluginManager: Reloaded plugin file" << path;
+    emit pluginReloaded(previous, current);
+    return loaded;
+}
+
+void PluginManager::setWatchingEnabled(bool enabled)
+{
+    if (enabled == isWatchingEnabled()) {
+        return;
+    }
+    
+    if (enabled) {
+        m_watcher = new QFileSystemWatcher(this);
+        connect(m_watcher, &QFileSystemWatcher::fileChanged,
+                this, &PluginManager::onPluginPathChanged);
+        connect(m_watcher, &QFileSystemWatcher::directoryChanged,
+                this, &PluginManager::onPluginPathChanged);
+        
+        m_reloadTimer = new QTimer(this);
+        m_reloadTimer->setSingleShot(true);
+        m_reloadTimer->setInterval(RELOAD_DELAY_MS);
+        connect(m_reloadTimer, &QTimer::timeout, this, &PluginManager::reloadChangedPlugins);
+        
+        resetWatcher();
+    } else {
+        delete m_watcher;
+        m_watcher = nullptr;
+        delete m_reloadTimer;
+        m_reloadTimer = nullptr;
+    }
+}
+
+bool PluginManager::isWatchingEnabled() const
+{
+    return m_watcher != nullptr;
+}
+
+void PluginManager::setWidgetBudgetMs(double budgetMs)
+{
+    m_widgetBudgetMs = budgetMs;
+}
+
+double PluginManager::widgetBudgetMs() const
+{
+    return m_widgetBudgetMs;
+}
+
+bool PluginManager::exceedsWidgetBudget(const QString &name) const
+{
+    return m_widgetBudgetMs > 0.0 && pluginMetadata(name).widgetCostMs() > m_widgetBudgetMs;
+}
+
+void PluginManager::setWidgetTimings(const QString &name, double createWidgetMs,
+                                     double polishMs, double firstPaintMs)
+{
+    auto metadata = std::find_if(m_metadata.begin(), m_metadata.end(),
+                                 [&name](const PluginMetadata &meta) {
+                                     return meta.isValid && meta.name == name;
+                                 });
+    if (metadata == m_metadata.end()) {
+        return;
+    }
+    metadata->createWidgetMs = createWidgetMs;
+    metadata->polishMs = polishMs;
+    metadata->firstPaintMs = firstPaintMs;
+    
+    // Keep the timings so the budget applies from the next launch on
+    if (!m_cacheFile.isEmpty()) {
+        const QFileInfo fileInfo(metadata->filePath);
+        if (const PluginScanCache::Entry *cached = m_scanCache.lookup(fileInfo)) {
+            PluginScanCache::Entry entry = *cached;
+            entry.createWidgetMs = createWidgetMs;
+            entry.polishMs = polishMs;
+            entry.firstPaintMs = firstPaintMs;
+            m_scanCache.insert(fileInfo, entry);
+            
+            // Timings arrive once or twice per widget; write them together
+            m_cacheSaveTimer->start();
+        }
+    }
+}
+
+void PluginManager::setParallelLoadingEnabled(bool enabled)
+{
+    m_parallelLoading = enabled;
+}
+
+bool PluginManager::isParallelLoadingEnabled() const
+{
+    return m_parallelLoading;
+}
+
 void PluginManager::unloadPlugins()
 {
+    cancelLibraryLoads();
+    
     // Unload all plugins
     for (QPluginLoader *loader : m_loaders) {
         loader->unload();
         delete loader;
     }
     
+    // Pending loaders never loaded their library
+    qDeleteAll(m_pendingLoaders);
+    
     m_loaders.clear();
+    m_pendingLoaders.clear();
     m_plugins.clear();
     m_metadata.clear();
     m_errors.clear();
+    m_errorFiles.clear();
+    m_fileStamps.clear();
     
     emit pluginsUnloaded();
 }
@@ -82,9 +273,107 @@ QList<QString> PluginManager::loadingErrors() const
     return m_errors;
 }
 
-WidgetPluginInterface* PluginManager::pluginInterface(const QString &name) const
+WidgetPluginInterface* PluginManager::pluginInterface(const QString &name)
+{
+    if (WidgetPluginInterface *interface = m_plugins.value(name, nullptr)) {
+        return interface;
+    }
+    
+    const QString filePath = pluginMetadata(name).filePath;
+    if (filePath.isEmpty()) {
+        return nullptr;
+    }
+    
+    QElapsedTimer timer;
+    timer.start();
+    if (m_libraryLoads.contains(filePath)) {
+        // Already loading in the background: wait rather than load it twice
+        waitForLibraryLoad(filePath);
+    } else if (QPluginLoader *loader = m_pendingLoaders.take(name)) {
+        // First use of a plugin discovered from its metadata: load the library now
+        LibraryLoad load;
+        load.loader = loader;
+        m_libraryLoads.insert(filePath, load);
+    } else {
+        return nullptr;
+    }
+    const PluginMetadata metadata = finishLibraryLoad(filePath);
+    m_deferredLoadNsecs += timer.nsecsElapsed();
+    
+    return metadata.isLoaded ? m_plugins.value(name, nullptr) : nullptr;
+}
+
+bool PluginManager::loadPluginAsync(const QString &name)
+{
+    if (!m_parallelLoading) {
+        return false;
+    }
+    
+    const QString filePath = pluginMetadata(name).filePath;
+    if (filePath.isEmpty()) {
+        return false;
+    }
+    if (m_libraryLoads.contains(filePath)) {
+        return true;
+    }
+    
+    QPluginLoader *loader = m_pendingLoaders.take(name);
+    if (!loader) {
+        return false;
+    }
+    startLibraryLoad(filePath, loader);
+    return true;
+}
+
+PluginMetadata PluginManager::pluginMetadata(const QString &name) const
+{
+    for (const PluginMetadata &metadata : m_metadata) {
+        if (metadata.name == name) {
+            return metadata;
+        }
+    }
+    return PluginMetadata();
+}
+
+PluginMetadata PluginManager::pluginMetadataForFile(const QString &filePath) const
+{
+    const QString path = QFileInfo(filePath).absoluteFilePath();
+    for (const PluginMetadata &metadata : m_metadata) {
+        if (metadata.filePath == path) {
+            return metadata;
+        }
+    }
+    return PluginMetadata();
+}
+
+double PluginManager::lastScanDurationMs() const
+{
+    return m_lastScanNsecs / 1000000.0;
+}
+
+int PluginManager::lastScanCacheHits() const
+{
+    return m_lastScanCacheHits;
+}
+
+int PluginManager::libraryLoadsInProgress() const
+{
+    return m_libraryLoads.size();
+}
+
+double PluginManager::backgroundLoadDurationMs() const
+{
+    return m_backgroundLoadNsecs / 1000000.0;
+}
+
+int PluginManager::deferredPluginCount() const
+{
+    return m_pendingLoaders.size();
+}
+
+double PluginManager::deferredLoadDurationMs() const
 {
-    return m_plugins.value(name, nullptr);
+    return m_deferredLoadNsecs / 1000000.0;
 }
 
 // -----------------------------------------------------------------------------
@@ -138,6 +427,7 @@ void PluginManager::scanDirectory()
         
         // Only process files with valid plugin extensions
         if (isPluginFile(filePath)) {
+            m_fileStamps.insert(filePath, FileStamp::of(fileInfo));
             loadPlugin(filePath);
         }
     }
@@ -145,17 +435,244 @@ void PluginManager::scanDirectory()
 
 bool PluginManager::loadPlugin(const QString &filePath)
 {
-    QPluginLoader *loader = new QPluginLoader(filePath, this);
+    const QFileInfo fileInfo(filePath);
+    PluginScanCache::Entry entry;
+    QPluginLoader *loader = nullptr;
+    
+    const PluginScanCache::Entry *cached = m_cacheFile.isEmpty() ? nullptr : m_scanCache.lookup(fileInfo);
+    if (cached) {
+        // Unchanged since the last scan: reuse what inspecting it found
+        ++m_lastScanCacheHits;
+        entry = *cached;
+        if (entry.isBroken()) {
+            m_errors.append(entry.errorMessage);
+            m_errorFiles.append(filePath);
+            emit pluginLoadError(filePath, entry.error);
+            return false;
+        }
+        loader = new QPluginLoader(filePath, this);
+    } else {
+        loader = new QPluginLoader(filePath, this);
+        
+        // Reading the metadata does not load the library
+        const QJsonObject pluginData = loader->metaData();
+        if (pluginData.isEmpty()) {
+            QString errorMsg = QString("Failed to load %1: %2")
+                              .arg(fileInfo.fileName())
+                              .arg(loader->errorString());
+            reportError(filePath, errorMsg, loader->errorString());
+            delete loader;
+            return false;
+        }
+        
+        entry.iid = pluginData.value(QStringLiteral("IID")).toString();
+        const QJsonObject json = pluginData.value(QStringLiteral("MetaData")).toObject();
+        entry.name = json.value(QStringLiteral("widgetName")).toString();
+        entry.description = json.value(QStringLiteral("widgetDescription")).toString();
+        entry.category = json.value(QStringLiteral("widgetCategory")).toString();
+        
+        if (entry.iid != QLatin1String(WidgetPluginInterface_iid)) {
+            QString errorMsg = QString("%1 does not implement WidgetPluginInterface")
+                              .arg(fileInfo.fileName());
+            reportError(filePath, errorMsg, "Plugin does not implement WidgetPluginInterface");
+            delete loader;
+            return false;
+        }
+        
+        if (!m_cacheFile.isEmpty()) {
+            m_scanCache.insert(fileInfo, entry);
+        }
+    }
+    
+    const QString name = entry.name;
+    
+    PluginMetadata metadata;
+    metadata.filePath = filePath;
+    
+    if (!name.isEmpty() && !m_plugins.contains(name) && !m_pendingLoaders.contains(name)) {
+        // Described by its metadata: defer loading until the widget is needed
+        m_pendingLoaders.insert(name, loader);
+        
+        metadata.name = name;
+        metadata.description = entry.description;
+        metadata.category = entry.category.isEmpty() ? QStringLiteral("Custom") : entry.category;
+        metadata.createWidgetMs = entry.createWidgetMs;
+        metadata.polishMs = entry.polishMs;
+        metadata.firstPaintMs = entry.firstPaintMs;
+    } else if (m_parallelLoading) {
+        // Older plugins only describe themselves through the interface: load
+        // the library on the pool and describe the plugin once it is ready
+        startLibraryLoad(filePath, loader);
+        return true;
+    } else {
+        // Older plugins only describe themselves through the interface
+        WidgetPluginInterface *interface = instantiatePlugin(loader, filePath);
+        if (!interface) {
+            return false;
+        }
+        metadata = describePlugin(filePath, interface);
+        m_plugins.insert(metadata.name, interface);
+        metadata.createWidgetMs = entry.createWidgetMs;
+        metadata.polishMs = entry.polishMs;
+        metadata.firstPaintMs = entry.firstPaintMs;
+    }
+    
+    metadata.isValid = true;
+    m_metadata.append(metadata);
+    
+    // Emit signal on success
+    emit pluginLoaded(metadata);
+    
+    qDebug() << "PluginManager: Discovered plugin" << metadata.name << "from" << filePath
+             << (metadata.isLoaded ? "(loaded)" : "(deferred)");
+    
+    return true;
+}
+
+PluginMetadata PluginManager::describePlugin(const QString &filePath, WidgetPluginInterface *interface) const
+{
+    PluginMetadata metadata;
+    metadata.filePath = filePath;
+    metadata.name = interface->widgetName();
+    metadata.description = interface->widgetDescription();
+    metadata.icon = interface->widgetIcon();
+    // Assign default "Custom" category if plugin returns empty category
+    metadata.category = interface->widgetCategory().isEmpty() 
+                       ? QStringLiteral("Custom") 
+                       : interface->widgetCategory();
+    metadata.isValid = true;
+    metadata.isLoaded = true;
+    return metadata;
+}
+
+void PluginManager::startLibraryLoad(const QString &filePath, QPluginLoader *loader)
+{
+    // Each load gets its own tag, so the result of an earlier load of the
+    // same file cannot be taken for this one
+    LibraryLoad load;
+    load.loader = loader;
+    load.generation = ++m_loadGeneration;
+    load.task = new PluginLoadTask(load.generation, filePath, loader);
+    connect(load.task, &PluginLoadTask::libraryLoaded,
+            this, &PluginManager::onLibraryLoaded, Qt::QueuedConnection);
+    m_libraryLoads.insert(filePath, load);
+    m_loadPool->start(load.task);
+}
+
+void PluginManager::waitForLibraryLoad(const QString &filePath)
+{
+    auto load = m_libraryLoads.find(filePath);
+    if (load == m_libraryLoads.end() || !load->task) {
+        return;
+    }
+    
+    PluginLoadTask *task = load->task;
+    load->task.clear();
+    if (m_loadPool->tryTake(task)) {
+        // Never started; the caller loads the library instead
+        delete task;
+    } else {
+        task->wait();
+    }
+}
+
+PluginMetadata PluginManager::finishLibraryLoad(const QString &filePath)
+{
+    PluginMetadata result;
+    result.filePath = filePath;
+    
+    QPluginLoader *loader = m_libraryLoads.take(filePath).loader;
+    if (!loader) {
+        return result;
+    }
+    
+    // load() returns at once if a PluginLoadTask already loaded the library
+    WidgetPluginInterface *interface = instantiatePlugin(loader, filePath);
+    
+    auto metadata = std::find_if(m_metadata.begin(), m_metadata.end(),
+                                 [&filePath](const PluginMetadata &meta) {
+                                     return meta.isValid && meta.filePath == filePath;
+                                 });
+    if (metadata != m_metadata.end()) {
+        // Discovered from its metadata; only the icon was missing
+        if (interface) {
+            metadata->icon = interface->widgetIcon();
+            metadata->isLoaded = true;
+            m_plugins.insert(metadata->name, interface);
+        } else {
+            metadata->isValid = false;
+            metadata->errorMessage = m_errors.isEmpty() ? QString() : m_errors.last();
+        }
+        result = *metadata;
+    } else if (interface) {
+        result = describePlugin(filePath, interface);
+        if (const PluginScanCache::Entry *entry = m_scanCache.lookup(QFileInfo(filePath))) {
+            result.createWidgetMs = entry->createWidgetMs;
+            result.polishMs = entry->polishMs;
+            result.firstPaintMs = entry->firstPaintMs;
+        }
+        m_plugins.insert(result.name, interface);
+        m_metadata.append(result);
+    } else {
+        result.errorMessage = m_errors.isEmpty() ? QString() : m_errors.last();
+    }
+    
+    saveCache();
+    return result;
+}
+
+void PluginManager::cancelLibraryLoads()
+{
+    // Results already queued are dropped once their load is gone
+    for (auto it = m_libraryLoads.constBegin(); it != m_libraryLoads.constEnd(); ++it) {
+        waitForLibraryLoad(it.key());
+    }
+    for (const LibraryLoad &load : qAsConst(m_libraryLoads)) {
+        load.loader->unload();
+        delete load.loader;
+    }
+    m_libraryLoads.clear();
+}
+
+void PluginManager::onLibraryLoaded(int generation, const QString &filePath, bool success, qint64 nsecs)
+{
+    Q_UNUSED(success);
+    
+    // Stale, or already finished by pluginInterface() or releasePlugin()
+    auto load = m_libraryLoads.constFind(filePath);
+    if (load == m_libraryLoads.constEnd() || load->generation != generation) {
+        return;
+    }
     
+    m_backgroundLoadNsecs += nsecs;
+    
+    // Plugins discovered from their JSON metadata were announced by the scan
+    const bool discovered = std::any_of(m_metadata.constBegin(), m_metadata.constEnd(),
+                                        [&filePath](const PluginMetadata &meta) {
+                                            return meta.isValid && meta.filePath == filePath;
+                                        });
+    const PluginMetadata metadata = finishLibraryLoad(filePath);
+    if (metadata.isValid && !discovered) {
+        emit pluginLoaded(metadata);
+    }
+    emit libraryLoadFinished(metadata);
+    
+    if (m_libraryLoads.isEmpty()) {
+        qInfo().noquote() << QString("PluginManager: Background library loads finished, %1 ms on worker threads")
+                             .arg(backgroundLoadDurationMs(), 0, 'f', 2);
+    }
+}
+
+WidgetPluginInterface* PluginManager::instantiatePlugin(QPluginLoader *loader, const QString &filePath)
+{
     // Attempt to load the plugin
     if (!loader->load()) {
         QString errorMsg = QString("Failed to load %1: %2")
                           .arg(QFileInfo(filePath).fileName())
                           .arg(loader->errorString());
-        m_errors.append(errorMsg);
-        emit pluginLoadError(filePath, loader->errorString());
+        reportError(filePath, errorMsg, loader->errorString());
         delete loader;
-        return false;
+        return nullptr;
     }
     
     // Get the plugin instance
@@ -163,11 +680,10 @@ bool PluginManager::loadPlugin(const QString &filePath)
     if (!plugin) {
         QString errorMsg = QString("Failed to get instance from %1")
                           .arg(QFileInfo(filePath).fileName());
-        m_errors.append(errorMsg);
-        emit pluginLoadError(filePath, "Failed to get plugin instance");
+        reportError(filePath, errorMsg, "Failed to get plugin instance");
         loader->unload();
         delete loader;
-        return false;
+        return nullptr;
     }
     
     // Verify plugin implements WidgetPluginInterface
@@ -175,36 +691,144 @@ bool PluginManager::loadPlugin(const QString &filePath)
     if (!interface) {
         QString errorMsg = QString("%1 does not implement WidgetPluginInterface")
                           .arg(QFileInfo(filePath).fileName());
-        m_errors.append(errorMsg);
-        emit pluginLoadError(filePath, "Plugin does not implement WidgetPluginInterface");
+        reportError(filePath, errorMsg, "Plugin does not implement WidgetPluginInterface");
         loader->unload();
         delete loader;
-        return false;
+        return nullptr;
     }
     
-    // Success - store loader and interface
-    m_loaders.append(loader);
-    m_plugins.insert(interface->widgetName(), interface);
+    m_loaders.insert(filePath, loader);
+    return interface;
+}
+
+void PluginManager::reportError(const QString &filePath, const QString &errorMsg,
+                                const QString &reason)
+{
+    m_errors.append(errorMsg);
+    m_errorFiles.append(filePath);
+    emit pluginLoadError(filePath, reason);
     
-    // Extract metadata
-    PluginMetadata metadata;
-    metadata.filePath = filePath;
-    metadata.name = interface->widgetName();
-    metadata.description = interface->widgetDescription();
-    metadata.icon = interface->widgetIcon();
-    // Assign default "Custom" category if plugin returns empty category
-    metadata.category = interface->widgetCategory().isEmpty() 
-                       ? QStringLiteral("Custom") 
-                       : interface->widgetCategory();
-    metadata.isValid = true;
-    m_metadata.append(metadata);
+    // Remember the failure so the file is not retried until it changes
+    if (!m_cacheFile.isEmpty()) {
+        PluginScanCache::Entry entry;
+        entry.error = reason;
+        entry.errorMessage = errorMsg;
+        m_scanCache.insert(QFileInfo(filePath), entry);
+    }
+}
+
+void PluginManager::saveCache()
+{
+    m_cacheSaveTimer->stop();
+    if (m_cacheFile.isEmpty() || !m_scanCache.isModified()) {
+        return;
+    }
+    if (!m_scanCache.save(m_cacheFile)) {
+        qWarning() << "PluginManager: Failed to write plugin cache:" << m_cacheFile;
+    }
+}
+
+void PluginManager::releasePlugin(const QString &filePath)
+{
+    for (int i = m_metadata.size() - 1; i >= 0; --i) {
+        if (m_metadata.at(i).filePath != filePath) {
+            continue;
+        }
+        const QString name = m_metadata.at(i).name;
+        delete m_pendingLoaders.take(name);
+        m_plugins.remove(name);
+        m_metadata.removeAt(i);
+    }
     
-    // Emit signal on success
-    emit pluginLoaded(metadata);
+    if (QPluginLoader *loader = m_loaders.take(filePath)) {
+        loader->unload();
+        delete loader;
+    }
     
-    qDebug() << "PluginManager: Loaded plugin" << metadata.name << "from" << filePath;
+    if (m_libraryLoads.contains(filePath)) {
+        // Its queued result is ignored once the load is gone
+        waitForLibraryLoad(filePath);
+        QPluginLoader *loader = m_libraryLoads.take(filePath).loader;
+        loader->unload();
+        delete loader;
+    }
     
-    return true;
+    for (int i = m_errorFiles.size() - 1; i >= 0; --i) {
+        if (m_errorFiles.at(i) == filePath) {
+            m_errorFiles.removeAt(i);
+            m_errors.removeAt(i);
+        }
+    }
+}
+
+void PluginManager::resetWatcher()
+{
+    if (!m_watcher) {
+        return;
+    }
+    
+    const QStringList watched = m_watcher->files() + m_watcher->directories();
+    if (!watched.isEmpty()) {
+        m_watcher->removePaths(watched);
+    }
+    
+    QStringList paths = m_fileStamps.keys();
+    if (!m_pluginDirectory.isEmpty() && QFileInfo::exists(m_pluginDirectory)) {
+        paths.prepend(m_pluginDirectory);
+    }
+    if (!paths.isEmpty()) {
+        m_watcher->addPaths(paths);
+    }
+}
+
+void PluginManager::onPluginPathChanged()
+{
+    // Builds write plugin files in several steps; wait for them to settle
+    m_reloadTimer->start();
+}
+
+void PluginManager::reloadChangedPlugins()
+{
+    QHash<QString, FileStamp> current;
+    const QFileInfoList files = QDir(m_pluginDirectory).entryInfoList(QDir::Files | QDir::NoDotAndDotDot);
+    for (const QFileInfo &fileInfo : files) {
+        if (isPluginFile(fileInfo.absoluteFilePath())) {
+            current.insert(fileInfo.absoluteFilePath(), FileStamp::of(fileInfo));
+        }
+    }
+    
+    QStringList changed;
+    for (auto it = current.constBegin(); it != current.constEnd(); ++it) {
+        auto known = m_fileStamps.constFind(it.key());
+        if (known == m_fileStamps.constEnd() || !(known.value() == it.value())) {
+            changed << it.key();
+        }
+    }
+    for (auto it = m_fileStamps.constBegin(); it != m_fileStamps.constEnd(); ++it) {
+        if (!current.contains(it.key())) {
+            changed << it.key();
+        }
+    }
+    
+    for (const QString &filePath : qAsConst(changed)) {
+        reloadPlugin(filePath);
+    }
+    
+    // Replaced files drop out of the watcher, so re-add them
+    resetWatcher();
+}
+
+PluginManager::FileStamp PluginManager::FileStamp::of(const QFileInfo &fileInfo)
+{
+    FileStamp stamp;
+    stamp.size = fileInfo.size();
+    stamp.modified = fileInfo.lastModified().toMSecsSinceEpoch();
+    return stamp;
+}
+
+bool PluginManager::FileStamp::operator==(const FileStamp &other) const
+{
+    return size == other.size && modified == other.modified;
 }
 
 bool PluginManager::isPluginFile(const QString &filePath) const
@@ -6,23 +6,54 @@
 #include <QStringList>
 #include <QList>
 #include <QMap>
+#include <QHash>
+#include <QPointer>
 
 #include "PluginMetadata.h"
+#include "PluginScanCache.h"
 
 class QPluginLoader;
+class QFileSystemWatcher;
+class QTimer;
+class QThreadPool;
+class QFileInfo;
 class WidgetPluginInterface;
+class PluginLoadTask;
 
 /**
  * @brief Manages plugin discovery, loading, and lifecycle.
  * 
  * PluginManager is the core component of QtVanity's plugin system. It handles:
  * - Discovering plugin files in the configured plugin directory
- * - Loading plugins using Qt's QPluginLoader mechanism
+ * - Reading plugin metadata without loading the library
+ * - Loading plugins using Qt's QPluginLoader mechanism, on first use
  * - Verifying plugins implement the WidgetPluginInterface
  * - Extracting metadata from loaded plugins
  * - Managing plugin lifecycle (load, unload, refresh)
  * - Error handling and reporting for failed plugin loads
  * 
+ * Plugins whose Q_PLUGIN_METADATA JSON contains "widgetName" (and optionally
+ * "widgetDescription" and "widgetCategory") are listed from that metadata
+ * alone; their library is loaded the first time pluginInterface() is asked
+ * for them. Plugins without it are loaded during the scan, as before.
+ * 
+ * With a cache file set, what each scan finds is kept on disk by file path,
+ * size and modification time. Unchanged files are not inspected again, and
+ * files that failed are reported from the cache without another load
+ * attempt until they change.
+ * 
+ * With watching enabled, the plugin directory and each plugin file are
+ * watched, and only files that were added, changed or removed are reloaded
+ * through reloadPlugin(); other plugins stay loaded.
+ * 
+ * With parallel loading enabled, libraries are loaded on a worker pool
+ * instead: plugins that must be loaded to be described during a scan, and
+ * plugins requested through loadPluginAsync(). Only QPluginLoader::load()
+ * runs on the workers; the plugin instance is created and cast to
+ * WidgetPluginInterface on the UI thread when the result arrives, followed
+ * by libraryLoadFinished(), and by pluginLoaded() first for plugins the scan
+ * could not describe without the library.
+ * 
  * The PluginManager supports platform-specific plugin extensions:
  * - Linux: .so
  * - Windows: .dll
@@ -51,6 +82,16 @@ class PluginManager : public QObject
     Q_OBJECT
 
 public:
+    /**
+     * @brief Delay after a file change before changed plugins are reloaded.
+     */
+    static constexpr int RELOAD_DELAY_MS = 250;
+    
+    /**
+     * @brief Delay after recorded widget timings before the scan cache is written.
+     */
+    static constexpr int CACHE_SAVE_DELAY_MS = 2000;
+    
     /**
      * @brief Constructs a PluginManager.
      * 
@@ -87,6 +128,24 @@ public:
      */
     QString pluginDirectory() const;
     
+    /**
+     * @brief Sets the file the plugin scan cache is kept in.
+     * 
+     * Loads the cache from the file if it exists; scans update and rewrite
+     * it. An empty path disables the cache, so every file is inspected on
+     * every scan.
+     * 
+     * @param filePath The cache file path, typically in the app data location.
+     */
+    void setCacheFile(const QString &filePath);
+    
+    /**
+     * @brief Returns the plugin scan cache file path.
+     * 
+     * @return The path, or an empty string if the cache is disabled.
+     */
+    QString cacheFile() const;
+    
     // -------------------------------------------------------------------------
     // Plugin Operations
     // -------------------------------------------------------------------------
@@ -135,6 +194,110 @@ public:
      */
     void unloadPlugins();
     
+    /**
+     * @brief Reloads a single plugin file, leaving other plugins loaded.
+     * 
+     * Emits pluginAboutToBeUnloaded() if the file provided a plugin, then
+     * unloads it and drops its metadata and errors. If the file still
+     * exists it is loaded again, emitting pluginLoaded() or
+     * pluginLoadError() as during a scan. Emits pluginReloaded() at the end.
+     * 
+     * @param filePath The path to the plugin file.
+     * @return True if the file provided a plugin after reloading, or its
+     *         library is loading in the background.
+     */
+    bool reloadPlugin(const QString &filePath);
+    
+    /**
+     * @brief Enables or disables reloading plugins when their files change.
+     * 
+     * While enabled, changes in the plugin directory are collected for
+     * RELOAD_DELAY_MS, then reloadPlugin() is called for each plugin file
+     * that was added, modified or removed.
+     * 
+     * @param enabled True to watch the plugin directory.
+     */
+    void setWatchingEnabled(bool enabled);
+    
+    /**
+     * @brief Returns whether plugin files are being watched.
+     */
+    bool isWatchingEnabled() const;
+    
+    /**
+     * @brief Enables or disables loading plugin libraries on worker threads.
+     * 
+     * Takes effect for the next scan and for loadPluginAsync(); loads
+     * already started are not affected.
+     * 
+     * @param enabled True to load libraries in the background.
+     */
+    void setParallelLoadingEnabled(bool enabled);
+    
+    /**
+     * @brief Returns whether plugin libraries are loaded on worker threads.
+     */
+    bool isParallelLoadingEnabled() const;
+    
+    /**
+     * @brief Starts loading a discovered plugin's library in the background.
+     * 
+     * When the load finishes, the plugin is instantiated on the UI thread and
+     * libraryLoadFinished() is emitted; pluginLoaded() was already emitted
+     * when the plugin was discovered.
+     * pluginInterface() may still be called meanwhile; it waits for that
+     * load only.
+     * 
+     * @param name The widget name of the plugin.
+     * @return True if the library is now loading; false if parallel loading
+     *         is disabled or the plugin is unknown or already loaded.
+     */
+    bool loadPluginAsync(const QString &name);
+    
+    // -------------------------------------------------------------------------
+    // Widget Costs
+    // -------------------------------------------------------------------------
+    
+    /**
+     * @brief Sets the time a plugin widget may take to be shown.
+     * 
+     * Plugins whose measured widgetCostMs() exceeds the budget are reported
+     * by exceedsWidgetBudget(), so their widget can be created on demand
+     * instead of with the page.
+     * 
+     * @param budgetMs The budget in milliseconds; 0 disables it (the default).
+     */
+    void setWidgetBudgetMs(double budgetMs);
+    
+    /**
+     * @brief Returns the widget budget in milliseconds, 0 if disabled.
+     */
+    double widgetBudgetMs() const;
+    
+    /**
+     * @brief Returns whether a plugin's widget was measured over the budget.
+     * 
+     * @param name The widget name of the plugin.
+     * @return False if the budget is disabled or the widget was not measured.
+     */
+    bool exceedsWidgetBudget(const QString &name) const;
+    
+    /**
+     * @brief Records the measured cost of a plugin's widget.
+     * 
+     * Updates the plugin's metadata and, if the scan cache is enabled, its
+     * cache entry, so the budget applies before the widget is created again.
+     * The cache file is written CACHE_SAVE_DELAY_MS after the last timings
+     * are recorded, with the next scan or reload, or on destruction.
+     * 
+     * @param name The widget name of the plugin.
+     * @param createWidgetMs Time createWidget() took.
+     * @param polishMs Time the first polish took.
+     * @param firstPaintMs Time the first paint took, or -1 if not painted yet.
+     */
+    void setWidgetTimings(const QString &name, double createWidgetMs,
+                          double polishMs, double firstPaintMs);
+    
     // -------------------------------------------------------------------------
     // Accessors
     // -------------------------------------------------------------------------
@@ -160,15 +323,75 @@ public:
     QList<QString> loadingErrors() const;
     
     /**
-     * @brief Returns the plugin interface for a loaded plugin.
+     * @brief Returns the plugin interface for a discovered plugin.
+     * 
+     * Retrieves the WidgetPluginInterface for a plugin by its widget name,
+     * loading the plugin library first if discovery deferred it. If that
+     * load fails, the error is recorded and emitted as for a failed scan,
+     * and the plugin's metadata is marked invalid. If the library is
+     * loading in the background, this waits for that load to finish.
+     * 
+     * @param name The widget name of the plugin.
+     * @return Pointer to the WidgetPluginInterface, or nullptr if not found
+     *         or the library could not be loaded.
+     */
+    WidgetPluginInterface* pluginInterface(const QString &name);
+    
+    /**
+     * @brief Returns the current metadata of a discovered plugin.
+     * 
+     * @param name The widget name of the plugin.
+     * @return The metadata, or a default (invalid) PluginMetadata if not found.
+     */
+    PluginMetadata pluginMetadata(const QString &name) const;
+    
+    /**
+     * @brief Returns the metadata of the plugin discovered in a file.
+     * 
+     * @param filePath The path to the plugin file.
+     * @return The metadata, or a default (invalid) PluginMetadata if the
+     *         file did not provide a plugin.
+     */
+    PluginMetadata pluginMetadataForFile(const QString &filePath) const;
+    
+    /**
+     * @brief Returns how long the last loadPlugins() scan took.
      * 
-     * Retrieves the WidgetPluginInterface for a plugin by its widget name.
-     * Returns nullptr if no plugin with the given name is loaded.
+     * @return The duration in milliseconds.
+     */
+    double lastScanDurationMs() const;
+    
+    /**
+     * @brief Returns how many plugin files the last scan took from the cache.
+     */
+    int lastScanCacheHits() const;
+    
+    /**
+     * @brief Returns the number of libraries loading in the background.
+     */
+    int libraryLoadsInProgress() const;
+    
+    /**
+     * @brief Returns the time worker threads spent loading libraries since
+     *        the last scan.
+     * 
+     * @return The duration in milliseconds, summed over all workers.
+     */
+    double backgroundLoadDurationMs() const;
+    
+    /**
+     * @brief Returns the number of discovered plugins whose library has
+     *        not been loaded yet.
+     */
+    int deferredPluginCount() const;
+    
+    /**
+     * @brief Returns the total time spent loading deferred plugin libraries
+     *        since the last scan.
      * 
-     * @param name The widget name (from widgetName()) of the plugin.
-     * @return Pointer to the WidgetPluginInterface, or nullptr if not found.
+     * @return The duration in milliseconds.
      */
-    WidgetPluginInterface* pluginInterface(const QString &name) const;
+    double deferredLoadDurationMs() const;
     
     // -------------------------------------------------------------------------
     // Utility
@@ -235,8 +458,68 @@ signals:
      * of refreshPlugins() when existing plugins are cleared.
      */
     void pluginsUnloaded();
+    
+    /**
+     * @brief Emitted by reloadPlugin() before a plugin's library is unloaded.
+     * 
+     * Widgets created by the plugin must be deleted before this returns.
+     * 
+     * @param metadata The metadata of the plugin being unloaded.
+     */
+    void pluginAboutToBeUnloaded(const PluginMetadata &metadata);
+    
+    /**
+     * @brief Emitted when reloadPlugin() has finished with a plugin file.
+     * 
+     * @param previous The metadata before reloading; invalid if the file did
+     *                 not provide a plugin.
+     * @param current The metadata after reloading; invalid, with filePath
+     *                and errorMessage set, if the file no longer provides one.
+     */
+    void pluginReloaded(const PluginMetadata &previous, const PluginMetadata &current);
+    
+    /**
+     * @brief Emitted when a library loaded in the background is ready.
+     * 
+     * On success the metadata is valid and isLoaded is set. pluginLoaded()
+     * precedes it only for a plugin first described by this load; one
+     * discovered from its JSON metadata was announced by the scan. On
+     * failure, after pluginLoadError(), the metadata is invalid; name and
+     * category are still set if the plugin was discovered from its JSON
+     * metadata.
+     * 
+     * @param metadata The plugin's metadata after the load.
+     */
+    void libraryLoadFinished(const PluginMetadata &metadata);
+
+private slots:
+    void onPluginPathChanged();
+    void reloadChangedPlugins();
+    void onLibraryLoaded(int generation, const QString &filePath, bool success, qint64 nsecs);
 
 private:
+    /**
+     * @brief Size and modification time of a plugin file.
+     */
+    struct FileStamp
+    {
+        qint64 size = -1;
+        qint64 modified = -1;
+        
+        static FileStamp of(const QFileInfo &fileInfo);
+        bool operator==(const FileStamp &other) const;
+    };
+    
+    /**
+     * @brief A library load started for one plugin file.
+     */
+    struct LibraryLoad
+    {
+        QPluginLoader *loader = nullptr;    ///< Loader, used by the task until it is done
+        QPointer<PluginLoadTask> task;      ///< Background task, null if none is pending
+        int generation = 0;                 ///< Tag of this load's queued result
+    };
+    
     /**
      * @brief Scans the plugin directory for plugin files.
      * 
@@ -252,11 +535,107 @@ private:
      */
     bool loadPlugin(const QString &filePath);
     
+    /**
+     * @brief Loads a plugin library and verifies its interface.
+     * 
+     * On success the loader is kept in m_loaders; on failure the error is
+     * recorded and the loader is deleted.
+     * 
+     * @param loader The loader for the plugin file.
+     * @param filePath The path to the plugin file, used in error messages.
+     * @return The plugin interface, or nullptr if loading failed.
+     */
+    WidgetPluginInterface* instantiatePlugin(QPluginLoader *loader, const QString &filePath);
+    
+    /**
+     * @brief Records a plugin failure and marks the file broken in the cache.
+     * 
+     * @param filePath The path to the plugin file.
+     * @param errorMsg The message added to loadingErrors().
+     * @param reason The error passed to pluginLoadError().
+     */
+    void reportError(const QString &filePath, const QString &errorMsg, const QString &reason);
+    
+    /**
+     * @brief Builds the metadata of a plugin from its interface.
+     */
+    PluginMetadata describePlugin(const QString &filePath, WidgetPluginInterface *interface) const;
+    
+    /**
+     * @brief Starts loading a plugin library on the worker pool.
+     * 
+     * @param filePath The path to the plugin file.
+     * @param loader The loader, owned by m_libraryLoads until finished.
+     */
+    void startLibraryLoad(const QString &filePath, QPluginLoader *loader);
+    
+    /**
+     * @brief Makes sure no worker uses the loader of one file any more.
+     * 
+     * A task that has not started yet is taken back from the pool, leaving
+     * the library to be loaded on the calling thread; a running task is
+     * waited for. Other loads are not waited for.
+     * 
+     * @param filePath The path to the plugin file.
+     */
+    void waitForLibraryLoad(const QString &filePath);
+    
+    /**
+     * @brief Instantiates a plugin whose library load was started.
+     * 
+     * Must only be called after waitForLibraryLoad() or once the load's
+     * result arrived. Updates
+     * or adds the plugin's metadata and records errors as during a scan.
+     * 
+     * @param filePath The path to the plugin file.
+     * @return The plugin's metadata; invalid if instantiation failed.
+     */
+    PluginMetadata finishLibraryLoad(const QString &filePath);
+    
+    /**
+     * @brief Waits for running library loads and discards them all.
+     */
+    void cancelLibraryLoads();
+    
+    /**
+     * @brief Writes the scan cache if it is enabled and has changed.
+     */
+    void saveCache();
+    
+    /**
+     * @brief Unloads the plugin from a file and drops its metadata and errors.
+     * 
+     * @param filePath The absolute path to the plugin file.
+     */
+    void releasePlugin(const QString &filePath);
+    
+    /**
+     * @brief Points the watcher at the plugin directory and known plugin files.
+     */
+    void resetWatcher();
+    
     QString m_pluginDirectory;                      ///< Path to the plugin directory
-    QList<QPluginLoader*> m_loaders;                ///< Active plugin loaders
+    QMap<QString, QPluginLoader*> m_loaders;        ///< Path-to-loader mapping of loaded libraries
+    QMap<QString, QPluginLoader*> m_pendingLoaders; ///< Name-to-loader mapping for unloaded libraries
+    QHash<QString, LibraryLoad> m_libraryLoads;     ///< Library loads started, by file path
     QMap<QString, WidgetPluginInterface*> m_plugins; ///< Name-to-interface mapping
     QList<PluginMetadata> m_metadata;               ///< Metadata for all discovered plugins
     QList<QString> m_errors;                        ///< Accumulated error messages
+    QList<QString> m_errorFiles;                    ///< Plugin file of each error message
+    QHash<QString, FileStamp> m_fileStamps;         ///< Plugin files seen by the last scan
+    QString m_cacheFile;                            ///< Scan cache file, empty if disabled
+    PluginScanCache m_scanCache;                    ///< Scan results by file path
+    qint64 m_lastScanNsecs;                         ///< Duration of the last scan
+    qint64 m_deferredLoadNsecs;                     ///< Time spent loading deferred libraries
+    int m_lastScanCacheHits;                        ///< Files taken from the cache in the last scan
+    QFileSystemWatcher *m_watcher;                  ///< Watches plugin files, if enabled
+    QTimer *m_reloadTimer;                          ///< Debounces file change notifications
+    QTimer *m_cacheSaveTimer;                       ///< Debounces writing recorded widget timings
+    QThreadPool *m_loadPool;                        ///< Workers for background library loads
+    int m_loadGeneration;                           ///< Tag of the last library load started
+    qint64 m_backgroundLoadNsecs;                   ///< Worker time spent loading libraries
+    bool m_parallelLoading;                         ///< Whether libraries load in the background
+    double m_widgetBudgetMs;                        ///< Widget cost budget, 0 if disabled
 };
 
 #endif // PLUGINMANAGER_H
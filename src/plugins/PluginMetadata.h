@@ -3,6 +3,7 @@
 
 #include <QString>
 #include <QIcon>
+#include <QMetaType>
 
 /**
  * @brief Data structure storing extracted information about a loaded plugin.
@@ -13,7 +14,9 @@
  * 
  * For successfully loaded plugins:
  * - isValid is true
- * - name, description, category, and icon are populated from the plugin interface
+ * - name, description, and category are populated from the plugin's JSON
+ *   metadata, or from the plugin interface if the JSON does not name the widget
+ * - icon is populated from the plugin interface once the library is loaded
  * - errorMessage is empty
  * 
  * For failed plugins:
@@ -34,7 +37,8 @@ struct PluginMetadata
     /**
      * @brief Display name of the widget.
      * 
-     * Extracted from the plugin's widgetName() method. This name is shown
+     * Read from "widgetName" in the plugin's JSON metadata, or from its
+     * widgetName() method. This name is shown
      * in the Custom Widgets gallery page to identify the widget.
      */
     QString name;
@@ -42,7 +46,8 @@ struct PluginMetadata
     /**
      * @brief Description of the widget.
      * 
-     * Extracted from the plugin's widgetDescription() method. Provides
+     * Read from "widgetDescription" in the plugin's JSON metadata, or from
+     * its widgetDescription() method. Provides
      * information about the widget's purpose and usage.
      */
     QString description;
@@ -50,8 +55,9 @@ struct PluginMetadata
     /**
      * @brief Category for grouping widgets.
      * 
-     * Extracted from the plugin's widgetCategory() method. If the plugin
-     * returns an empty string, this is set to "Custom" by the PluginManager.
+     * Read from "widgetCategory" in the plugin's JSON metadata, or from its
+     * widgetCategory() method. If the plugin provides an empty string, this
+     * is set to "Custom" by the PluginManager.
      * Widgets with the same category are grouped together in the gallery.
      */
     QString category;
@@ -72,6 +78,52 @@ struct PluginMetadata
      * any reason (file not found, corrupted, interface mismatch, etc.).
      */
     bool isValid = false;
+
+    /**
+     * @brief Indicates whether the plugin library has been loaded.
+     * 
+     * Plugins that describe their widget in their JSON metadata are
+     * discovered without loading the library; it is loaded when the widget
+     * is first needed. False until then, or if loading failed.
+     */
+    bool isLoaded = false;
+    
+    /**
+     * @brief Time the plugin's createWidget() took, in milliseconds.
+     * 
+     * Measured by the Custom Widgets page and kept in the plugin scan
+     * cache. -1 until the widget has been created.
+     */
+    double createWidgetMs = -1.0;
+    
+    /**
+     * @brief Time the widget's first style polish took, in milliseconds.
+     * 
+     * -1 until the widget has been created.
+     */
+    double polishMs = -1.0;
+    
+    /**
+     * @brief Time the widget's first paint took, in milliseconds.
+     * 
+     * Includes the first paint of its child widgets. -1 until the widget
+     * has been shown.
+     */
+    double firstPaintMs = -1.0;
+    
+    /**
+     * @brief Returns the measured cost of showing the widget.
+     * 
+     * @return The sum of the measured times in milliseconds, or -1 if the
+     *         widget has not been created yet.
+     */
+    double widgetCostMs() const
+    {
+        if (createWidgetMs < 0.0) {
+            return -1.0;
+        }
+        return createWidgetMs + qMax(polishMs, 0.0) + qMax(firstPaintMs, 0.0);
+    }
     
     /**
      * @brief Error message if loading failed.
@@ -82,4 +134,6 @@ struct PluginMetadata
     QString errorMessage;
 };
 
+Q_DECLARE_METATYPE(PluginMetadata)
+
 #endif // PLUGINMETADATA_H
@@ -0,0 +1,140 @@
+#include "PluginScanCache.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QSaveFile>
+
+bool PluginScanCache::load(const QString &filePath)
+{
+    m_entries.clear();
+    m_modified = false;
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    if (root.value(QStringLiteral("version")).toInt() != FORMAT_VERSION) {
+        return false;
+    }
+
+    const QJsonArray plugins = root.value(QStringLiteral("plugins")).toArray();
+    for (const QJsonValue &value : plugins) {
+        const QJsonObject object = value.toObject();
+        const QString path = object.value(QStringLiteral("path")).toString();
+        if (path.isEmpty()) {
+            continue;
+        }
+
+        Entry entry;
+        // Sizes and times are stored as strings to keep their full 64-bit range
+        entry.size = object.value(QStringLiteral("size")).toString().toLongLong();
+        entry.modified = object.value(QStringLiteral("modified")).toString().toLongLong();
+        entry.iid = object.value(QStringLiteral("iid")).toString();
+        entry.name = object.value(QStringLiteral("name")).toString();
+        entry.description = object.value(QStringLiteral("description")).toString();
+        entry.category = object.value(QStringLiteral("category")).toString();
+        entry.error = object.value(QStringLiteral("error")).toString();
+        entry.errorMessage = object.value(QStringLiteral("errorMessage")).toString();
+        entry.createWidgetMs = object.value(QStringLiteral("createWidgetMs")).toDouble(-1.0);
+        entry.polishMs = object.value(QStringLiteral("polishMs")).toDouble(-1.0);
+        entry.firstPaintMs = object.value(QStringLiteral("firstPaintMs")).toDouble(-1.0);
+        m_entries.insert(path, entry);
+    }
+    return true;
+}
+
+bool PluginScanCache::save(const QString &filePath)
+{
+    QJsonArray plugins;
+    for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it) {
+        const Entry &entry = it.value();
+        QJsonObject object;
+        object.insert(QStringLiteral("path"), it.key());
+        object.insert(QStringLiteral("size"), QString::number(entry.size));
+        object.insert(QStringLiteral("modified"), QString::number(entry.modified));
+        object.insert(QStringLiteral("iid"), entry.iid);
+        object.insert(QStringLiteral("name"), entry.name);
+        object.insert(QStringLiteral("description"), entry.description);
+        object.insert(QStringLiteral("category"), entry.category);
+        object.insert(QStringLiteral("error"), entry.error);
+        object.insert(QStringLiteral("errorMessage"), entry.errorMessage);
+        object.insert(QStringLiteral("createWidgetMs"), entry.createWidgetMs);
+        object.insert(QStringLiteral("polishMs"), entry.polishMs);
+        object.insert(QStringLiteral("firstPaintMs"), entry.firstPaintMs);
+        plugins.append(object);
+    }
+
+    QJsonObject root;
+    root.insert(QStringLiteral("version"), FORMAT_VERSION);
+    root.insert(QStringLiteral("plugins"), plugins);
+
+    QDir().mkpath(QFileInfo(filePath).absolutePath());
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    if (!file.commit()) {
+        return false;
+    }
+
+    m_modified = false;
+    return true;
+}
+
+const PluginScanCache::Entry* PluginScanCache::lookup(const QFileInfo &fileInfo) const
+{
+    auto it = m_entries.constFind(fileInfo.absoluteFilePath());
+    if (it == m_entries.constEnd()
+        || it->size != fileInfo.size()
+        || it->modified != fileInfo.lastModified().toMSecsSinceEpoch()) {
+        return nullptr;
+    }
+    return &it.value();
+}
+
+void PluginScanCache::insert(const QFileInfo &fileInfo, Entry entry)
+{
+    entry.size = fileInfo.size();
+    entry.modified = fileInfo.lastModified().toMSecsSinceEpoch();
+    m_entries.insert(fileInfo.absoluteFilePath(), entry);
+    m_modified = true;
+}
+
+void PluginScanCache::prune()
+{
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        if (!QFileInfo::exists(it.key())) {
+            it = m_entries.erase(it);
+            m_modified = true;
+        } else {
+            ++it;
+        }
+    }
+}
+
+void PluginScanCache::clear()
+{
+    if (!m_entries.isEmpty()) {
+        m_entries.clear();
+        m_modified = true;
+    }
+}
+
+int PluginScanCache::size() const
+{
+    return m_entries.size();
+}
+
+bool PluginScanCache::isModified() const
+{
+    return m_modified;
+}
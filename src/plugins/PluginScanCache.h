@@ -0,0 +1,115 @@
+#ifndef PLUGINSCANCACHE_H
+#define PLUGINSCANCACHE_H
+
+#include <QString>
+#include <QHash>
+
+class QFileInfo;
+
+/**
+ * @brief On-disk record of what a plugin scan found in each plugin file.
+ *
+ * PluginScanCache remembers, per absolute file path, the file's size and
+ * modification time together with what inspecting it produced: the
+ * interface IID and widget metadata, or the error that made it unusable.
+ * It also keeps the widget's last measured creation, polish and paint
+ * times, so slow widgets are known before they are created. An entry is
+ * only returned while the file's size and modification time still match,
+ * so any change to a file invalidates its entry.
+ *
+ * The cache is stored as a JSON file. A missing, unreadable or outdated
+ * file simply yields an empty cache.
+ *
+ * @see PluginManager
+ */
+class PluginScanCache
+{
+public:
+    /**
+     * @brief Version of the cache file format; older files are discarded.
+     */
+    static constexpr int FORMAT_VERSION = 1;
+
+    /**
+     * @brief What a scan found in one plugin file.
+     */
+    struct Entry
+    {
+        qint64 size = -1;           ///< File size in bytes
+        qint64 modified = -1;       ///< Modification time, ms since the epoch
+        QString iid;                ///< Interface IID from the plugin metadata
+        QString name;               ///< "widgetName" from the plugin metadata
+        QString description;        ///< "widgetDescription" from the plugin metadata
+        QString category;           ///< "widgetCategory" from the plugin metadata
+        QString error;              ///< Reason the plugin failed, empty if it did not
+        QString errorMessage;       ///< Error as reported in PluginManager::loadingErrors()
+        double createWidgetMs = -1.0;   ///< Last measured createWidget() time, -1 if unknown
+        double polishMs = -1.0;         ///< Last measured first polish time, -1 if unknown
+        double firstPaintMs = -1.0;     ///< Last measured first paint time, -1 if unknown
+
+        /**
+         * @brief Returns whether the plugin failed to load.
+         */
+        bool isBroken() const { return !error.isEmpty(); }
+    };
+
+    /**
+     * @brief Reads the cache from a file, replacing the current entries.
+     *
+     * @param filePath The cache file.
+     * @return True if the file was read; false leaves the cache empty.
+     */
+    bool load(const QString &filePath);
+
+    /**
+     * @brief Writes the cache to a file, creating its directory if needed.
+     *
+     * @param filePath The cache file.
+     * @return True if the file was written.
+     */
+    bool save(const QString &filePath);
+
+    /**
+     * @brief Returns the entry for a file if it is still up to date.
+     *
+     * @param fileInfo The plugin file.
+     * @return The entry, or nullptr if there is none or the file changed.
+     */
+    const Entry* lookup(const QFileInfo &fileInfo) const;
+
+    /**
+     * @brief Records what a scan found in a file.
+     *
+     * The entry's size and modification time are taken from the file.
+     *
+     * @param fileInfo The plugin file.
+     * @param entry The scan result.
+     */
+    void insert(const QFileInfo &fileInfo, Entry entry);
+
+    /**
+     * @brief Drops the entries of files that no longer exist.
+     */
+    void prune();
+
+    /**
+     * @brief Drops every entry.
+     */
+    void clear();
+
+    /**
+     * @brief Returns the number of entries.
+     */
+    int size() const;
+
+    /**
+     * @brief Returns whether entries changed since the last load() or save().
+     */
+    bool isModified() const;
+
+private:
+    QHash<QString, Entry> m_entries;
+    bool m_modified = false;
+};
+
+#endif // PLUGINSCANCACHE_H
@@ -22,6 +22,11 @@
  * Optional methods (with defaults):
  * - widgetIcon(): Returns an optional icon for the widget
  * - widgetCategory(): Returns an optional category for grouping widgets
+ * 
+ * Plugins should also repeat the name, description and category as
+ * "widgetName", "widgetDescription" and "widgetCategory" in their
+ * Q_PLUGIN_METADATA JSON file. QtVanity then lists the widget without
+ * loading the library, and loads it only when the widget is shown.
  */
 class WidgetPluginInterface
 {
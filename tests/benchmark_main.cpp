@@ -0,0 +1,33 @@
+#include <QApplication>
+#include <QtTest>
+
+#include "benchmark_qsssyntaxhighlighter.h"
+#include "benchmark_textsearch.h"
+#include "benchmark_widgetgallery.h"
+
+int main(int argc, char *argv[])
+{
+    // Use offscreen platform by default for benchmarks to avoid display requirements
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QApplication app(argc, argv);
+
+    int status = 0;
+
+    {
+        BenchmarkQssSyntaxHighlighter benchmark;
+        status |= QTest::qExec(&benchmark, argc, argv);
+    }
+
+    {
+        BenchmarkTextSearch benchmark;
+        status |= QTest::qExec(&benchmark, argc, argv);
+    }
+
+    {
+        BenchmarkWidgetGallery benchmark;
+        status |= QTest::qExec(&benchmark, argc, argv);
+    }
+
+    return status;
+}
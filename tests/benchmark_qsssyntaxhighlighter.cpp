@@ -0,0 +1,198 @@
+#include "benchmark_qsssyntaxhighlighter.h"
+#include "benchmark_styles.h"
+#include "QssSyntaxHighlighter.h"
+
+#include <QRegularExpression>
+#include <QSyntaxHighlighter>
+#include <QTextDocument>
+#include <QVector>
+
+#include <memory>
+
+namespace {
+
+/**
+ * @brief The regex-based highlighter the lexer replaced, kept as a baseline.
+ *
+ * Every rule is matched over the whole block, so a block is scanned once per
+ * rule; comments are handled in a final pass.
+ */
+class LegacyQssSyntaxHighlighter : public QSyntaxHighlighter
+{
+public:
+    explicit LegacyQssSyntaxHighlighter(QTextDocument *parent)
+        : QSyntaxHighlighter(parent)
+        , m_commentStart(QStringLiteral("/\\*"))
+        , m_commentEnd(QStringLiteral("\\*/"))
+    {
+        m_format.setForeground(Qt::darkBlue);
+        m_commentFormat.setForeground(Qt::darkGray);
+
+        const QStringList patterns = {
+            QStringLiteral(
+                "::add-line|::add-page|::branch|::chunk|::close-button|::corner|"
+                "::down-arrow|::down-button|::drop-down|::float-button|::groove|"
+                "::indicator|::handle|::icon|::item|::left-arrow|::left-corner|"
+                "::menu-arrow|::menu-button|::menu-indicator|::right-arrow|::pane|"
+                "::right-corner|::scroller|::section|::separator|::sub-line|"
+                "::sub-page|::tab|::tab-bar|::tear|::tearoff|::text|::title|"
+                "::up-arrow|::up-button"),
+            QStringLiteral(
+                "(?<!:)(:active|:adjoins-item|:alternate|:bottom|:checked|:closable|"
+                ":closed|:default|:disabled|:editable|:edit-focus|:enabled|"
+                ":exclusive|:first|:flat|:floatable|:focus|:has-children|"
+                ":has-siblings|:horizontal|:hover|:indeterminate|:last|:left|"
+                ":maximized|:middle|:minimized|:movable|:no-frame|:non-exclusive|"
+                ":off|:on|:only-one|:open|:next-selected|:pressed|"
+                ":previous-selected|:read-only|:right|:selected|:top|"
+                ":unchecked|:vertical|:window)(?!:[^:])"),
+            QStringLiteral(
+                "\\bQAbstractScrollArea\\b|\\bQAbstractSpinBox\\b|\\bQAbstractItemView\\b|"
+                "\\bQCheckBox\\b|\\bQColumnView\\b|\\bQComboBox\\b|"
+                "\\bQDateEdit\\b|\\bQDateTimeEdit\\b|\\bQDialog\\b|\\bQDialogButtonBox\\b|"
+                "\\bQDockWidget\\b|\\bQDoubleSpinBox\\b|"
+                "\\bQFrame\\b|\\bQGroupBox\\b|\\bQHeaderView\\b|"
+                "\\bQLabel\\b|\\bQLineEdit\\b|\\bQListView\\b|\\bQListWidget\\b|"
+                "\\bQMainWindow\\b|\\bQMenu\\b|\\bQMenuBar\\b|\\bQMessageBox\\b|"
+                "\\bQProgressBar\\b|\\bQPushButton\\b|\\bQRadioButton\\b|"
+                "\\bQScrollArea\\b|\\bQScrollBar\\b|\\bQSizeGrip\\b|\\bQSlider\\b|"
+                "\\bQSpinBox\\b|\\bQSplitter\\b|\\bQStatusBar\\b|"
+                "\\bQTabBar\\b|\\bQTabWidget\\b|\\bQTableView\\b|\\bQTableWidget\\b|"
+                "\\bQTextEdit\\b|\\bQTimeEdit\\b|\\bQToolBar\\b|\\bQToolBox\\b|"
+                "\\bQToolButton\\b|\\bQToolTip\\b|\\bQTreeView\\b|\\bQTreeWidget\\b|"
+                "\\bQWidget\\b|\\bQAbstractButton\\b|\\bQPlainTextEdit\\b|"
+                "\\bQCalendarWidget\\b|\\bQFontComboBox\\b|\\bQMdiArea\\b|\\bQMdiSubWindow\\b"),
+            QStringLiteral("(?<![\\w#.])\\*(?![\\w])"),
+            QStringLiteral("#[a-zA-Z_][a-zA-Z0-9_]*"),
+            QStringLiteral("\\.[A-Z][a-zA-Z0-9]*"),
+            QStringLiteral(
+                "\\b(background|background-color|background-image|background-repeat|"
+                "background-position|background-attachment|background-clip|background-origin|"
+                "alternate-background-color|accent-color|"
+                "border|border-color|border-width|border-style|border-radius|border-image|"
+                "border-top|border-right|border-bottom|border-left|"
+                "border-top-color|border-right-color|border-bottom-color|border-left-color|"
+                "border-top-width|border-right-width|border-bottom-width|border-left-width|"
+                "border-top-style|border-right-style|border-bottom-style|border-left-style|"
+                "border-top-left-radius|border-top-right-radius|"
+                "border-bottom-left-radius|border-bottom-right-radius|"
+                "margin|margin-top|margin-right|margin-bottom|margin-left|"
+                "padding|padding-top|padding-right|padding-bottom|padding-left|"
+                "spacing|min-width|min-height|max-width|max-height|width|height|"
+                "font|font-family|font-size|font-weight|font-style|"
+                "color|selection-color|selection-background-color|"
+                "placeholder-text-color|gridline-color|"
+                "position|top|left|right|bottom|"
+                "subcontrol-origin|subcontrol-position|"
+                "image|image-position|icon|icon-size|opacity|"
+                "text-align|text-decoration|letter-spacing|word-spacing|"
+                "outline|outline-color|outline-offset|outline-style|outline-radius|"
+                "outline-bottom-left-radius|outline-bottom-right-radius|"
+                "outline-top-left-radius|outline-top-right-radius|"
+                "lineedit-password-character|lineedit-password-mask-delay|"
+                "messagebox-text-interaction-flags|show-decoration-selected|"
+                "button-layout|dialogbuttonbox-buttons-have-icons|"
+                "titlebar-show-tooltips-on-buttons|widget-animation-duration|"
+                "paint-alternating-row-colors-for-empty-area|"
+                "-qt-background-role|-qt-style-features)\\s*:"),
+            QStringLiteral("#[0-9a-fA-F]{3,8}\\b"),
+            QStringLiteral("\\b(rgb|rgba|hsv|hsva|hsl|hsla)\\s*\\([^)]*\\)"),
+            QStringLiteral("\\b(qlineargradient|qradialgradient|qconicalgradient)\\s*\\([^)]*\\)"),
+            QStringLiteral("\\burl\\s*\\([^)]*\\)"),
+            QStringLiteral("\\bpalette\\s*\\([^)]*\\)"),
+            QStringLiteral(
+                "(?i)\\b(transparent|black|white|red|green|blue|yellow|cyan|magenta|"
+                "gray|grey|darkgray|darkgrey|lightgray|lightgrey|"
+                "darkred|darkgreen|darkblue|darkcyan|darkmagenta|darkyellow|"
+                "orange|pink|purple|brown|navy|teal|olive|maroon|aqua|fuchsia|lime|silver)\\b"),
+            QStringLiteral(
+                "\\b(none|solid|dashed|dotted|double|groove|ridge|inset|outset|"
+                "dot-dash|dot-dot-dash)\\b"),
+            QStringLiteral("\\b(normal|bold|italic|oblique|underline|overline|line-through)\\b"),
+            QStringLiteral(
+                "\\b(relative|absolute|top|bottom|left|right|center|"
+                "margin|border|padding|content|"
+                "repeat|repeat-x|repeat-y|no-repeat|"
+                "scroll|fixed)\\b"),
+            QStringLiteral("-?\\d+(\\.\\d+)?\\s*(px|pt|em|ex|%)?\\b"),
+            QStringLiteral("\"[^\"]*\"|'[^']*'"),
+            QStringLiteral("\\$\\{[a-zA-Z_][a-zA-Z0-9_-]*\\}")
+        };
+        for (const QString &pattern : patterns) {
+            m_rules.append(QRegularExpression(pattern));
+        }
+    }
+
+protected:
+    void highlightBlock(const QString &text) override
+    {
+        for (const QRegularExpression &rule : qAsConst(m_rules)) {
+            QRegularExpressionMatchIterator it = rule.globalMatch(text);
+            while (it.hasNext()) {
+                const QRegularExpressionMatch match = it.next();
+                setFormat(match.capturedStart(), match.capturedLength(), m_format);
+            }
+        }
+
+        setCurrentBlockState(0);
+        int startIndex = 0;
+        if (previousBlockState() != 1) {
+            const QRegularExpressionMatch match = m_commentStart.match(text);
+            startIndex = match.hasMatch() ? match.capturedStart() : -1;
+        }
+        while (startIndex >= 0) {
+            const QRegularExpressionMatch endMatch = m_commentEnd.match(text, startIndex);
+            int commentLength;
+            if (!endMatch.hasMatch()) {
+                setCurrentBlockState(1);
+                commentLength = text.length() - startIndex;
+            } else {
+                commentLength = endMatch.capturedEnd() - startIndex;
+            }
+            setFormat(startIndex, commentLength, m_commentFormat);
+            const QRegularExpressionMatch next = m_commentStart.match(text, startIndex + commentLength);
+            startIndex = next.hasMatch() ? next.capturedStart() : -1;
+        }
+    }
+
+private:
+    QVector<QRegularExpression> m_rules;
+    QRegularExpression m_commentStart;
+    QRegularExpression m_commentEnd;
+    QTextCharFormat m_format;
+    QTextCharFormat m_commentFormat;
+};
+
+} // namespace
+
+void BenchmarkQssSyntaxHighlighter::benchmarkHighlightStyles_data()
+{
+    QTest::addColumn<QString>("qss");
+    QTest::addColumn<bool>("legacy");
+
+    const QMap<QString, QString> templates = bundledStyleTemplates();
+    for (auto it = templates.constBegin(); it != templates.constEnd(); ++it) {
+        QTest::newRow(qPrintable(it.key() + QStringLiteral(" regex"))) << it.value() << true;
+        QTest::newRow(qPrintable(it.key() + QStringLiteral(" lexer"))) << it.value() << false;
+    }
+}
+
+void BenchmarkQssSyntaxHighlighter::benchmarkHighlightStyles()
+{
+    QFETCH(QString, qss);
+    QFETCH(bool, legacy);
+
+    QTextDocument doc;
+    doc.setPlainText(qss);
+
+    std::unique_ptr<QSyntaxHighlighter> highlighter;
+    if (legacy) {
+        highlighter.reset(new LegacyQssSyntaxHighlighter(&doc));
+    } else {
+        highlighter.reset(new QssSyntaxHighlighter(&doc));
+    }
+
+    QBENCHMARK {
+        highlighter->rehighlight();
+    }
+}
@@ -0,0 +1,22 @@
+#ifndef BENCHMARK_QSSSYNTAXHIGHLIGHTER_H
+#define BENCHMARK_QSSSYNTAXHIGHLIGHTER_H
+
+#include <QObject>
+#include <QtTest>
+
+/**
+ * @brief Compares the single-pass QSS lexer with the former regex highlighter.
+ *
+ * Each bundled style under styles/ is highlighted by both implementations;
+ * QBENCHMARK reports the time of a full rehighlight per row.
+ */
+class BenchmarkQssSyntaxHighlighter : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void benchmarkHighlightStyles_data();
+    void benchmarkHighlightStyles();
+};
+
+#endif // BENCHMARK_QSSSYNTAXHIGHLIGHTER_H
@@ -0,0 +1,20 @@
+#include "benchmark_styles.h"
+#include "VariableManager.h"
+
+#include <QDir>
+
+QMap<QString, QString> bundledStyleTemplates()
+{
+    const QDir stylesDir(QStringLiteral(QTVANITY_SOURCE_DIR "/styles"));
+    const QStringList files = stylesDir.entryList({QStringLiteral("*.qvp")}, QDir::Files, QDir::Name);
+
+    QMap<QString, QString> templates;
+    for (const QString &fileName : files) {
+        VariableManager variables;
+        QString qss;
+        if (variables.loadProject(stylesDir.filePath(fileName), qss) && !qss.isEmpty()) {
+            templates.insert(fileName, qss);
+        }
+    }
+    return templates;
+}
@@ -0,0 +1,17 @@
+#ifndef BENCHMARK_STYLES_H
+#define BENCHMARK_STYLES_H
+
+#include <QMap>
+#include <QString>
+
+/**
+ * @brief Loads the QSS templates of the bundled style projects.
+ *
+ * Reads every .qvp project in styles/ through VariableManager::loadProject();
+ * projects that fail to load or have an empty template are left out.
+ *
+ * @return Unsubstituted templates keyed by project file name, in name order.
+ */
+QMap<QString, QString> bundledStyleTemplates();
+
+#endif // BENCHMARK_STYLES_H
@@ -0,0 +1,119 @@
+#include "benchmark_textsearch.h"
+#include "benchmark_styles.h"
+#include "TextSearchPattern.h"
+
+#include <QElapsedTimer>
+#include <QRegularExpression>
+#include <QTextCursor>
+#include <QTextDocument>
+
+namespace {
+
+/**
+ * @brief Counts matches the way FindReplaceBar did before TextSearchPattern.
+ */
+int documentFindCount(QTextDocument *doc, const QString &query,
+                      TextSearchPattern::Options options)
+{
+    QTextDocument::FindFlags flags;
+    if (options.testFlag(TextSearchPattern::CaseSensitive)) {
+        flags |= QTextDocument::FindCaseSensitively;
+    }
+    if (options.testFlag(TextSearchPattern::WholeWords)) {
+        flags |= QTextDocument::FindWholeWords;
+    }
+
+    QRegularExpression regex;
+    if (options.testFlag(TextSearchPattern::RegularExpression)) {
+        regex.setPattern(query);
+    }
+
+    int count = 0;
+    QTextCursor cursor(doc);
+    while (!cursor.isNull() && !cursor.atEnd()) {
+        cursor = options.testFlag(TextSearchPattern::RegularExpression)
+            ? doc->find(regex, cursor, flags)
+            : doc->find(query, cursor, flags);
+        if (!cursor.isNull()) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+} // namespace
+
+void BenchmarkTextSearch::initTestCase()
+{
+    const QStringList templates = bundledStyleTemplates().values();
+    if (templates.isEmpty()) {
+        QSKIP("No style templates found");
+    }
+
+    m_corpus.reserve(CORPUS_SIZE + templates.first().size());
+    while (m_corpus.size() < CORPUS_SIZE) {
+        for (const QString &qss : qAsConst(templates)) {
+            m_corpus += qss;
+            m_corpus += QLatin1Char('\n');
+        }
+    }
+}
+
+void BenchmarkTextSearch::benchmarkFindAll_data()
+{
+    QTest::addColumn<QString>("query");
+    QTest::addColumn<int>("options");
+    QTest::addColumn<bool>("document");
+
+    struct Mode
+    {
+        const char *name;
+        QString query;
+        int options;
+    };
+    const QVector<Mode> modes = {
+        { "literal", QStringLiteral("background-color"), TextSearchPattern::CaseSensitive },
+        { "literal ci", QStringLiteral("Background-Color"), TextSearchPattern::NoOptions },
+        { "rare literal", QStringLiteral("QCalendarWidget"), TextSearchPattern::CaseSensitive },
+        { "whole word", QStringLiteral("color"), TextSearchPattern::WholeWords },
+        { "regex", QStringLiteral("#[0-9a-fA-F]{6}\\b"),
+          int(TextSearchPattern::RegularExpression) | int(TextSearchPattern::CaseSensitive) }
+    };
+
+    for (const Mode &mode : modes) {
+        QTest::newRow(qPrintable(QStringLiteral("%1 document").arg(QLatin1String(mode.name))))
+            << mode.query << mode.options << true;
+        QTest::newRow(qPrintable(QStringLiteral("%1 flat").arg(QLatin1String(mode.name))))
+            << mode.query << mode.options << false;
+    }
+}
+
+void BenchmarkTextSearch::benchmarkFindAll()
+{
+    QFETCH(QString, query);
+    QFETCH(int, options);
+    QFETCH(bool, document);
+
+    const TextSearchPattern::Options searchOptions = TextSearchPattern::Options(QFlag(options));
+    const TextSearchPattern pattern(query, searchOptions);
+
+    QTextDocument doc;
+    if (document) {
+        doc.setPlainText(m_corpus);
+    }
+
+    int count = 0;
+    qint64 runs = 0;
+    QElapsedTimer timer;
+    timer.start();
+    QBENCHMARK {
+        count = document ? documentFindCount(&doc, query, searchOptions)
+                         : pattern.findAll(m_corpus).size();
+        ++runs;
+    }
+    const double seconds = timer.nsecsElapsed() / 1e9;
+
+    QVERIFY(count > 0);
+    qInfo("%s: %d matches, %.1f MB/s", QTest::currentDataTag(), count,
+          seconds > 0.0 ? m_corpus.size() * double(runs) / seconds / 1e6 : 0.0);
+}
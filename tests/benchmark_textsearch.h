@@ -0,0 +1,33 @@
+#ifndef BENCHMARK_TEXTSEARCH_H
+#define BENCHMARK_TEXTSEARCH_H
+
+#include <QObject>
+#include <QtTest>
+
+/**
+ * @brief Compares flat-text TextSearchPattern scans with QTextDocument::find().
+ *
+ * The bundled style templates are concatenated into a corpus of roughly
+ * CORPUS_SIZE characters. Every search mode is run both through the former
+ * QTextDocument::find() loop and through TextSearchPattern; besides the
+ * QBENCHMARK time, each row logs its throughput in MB/s (the templates are
+ * ASCII, so one character is one byte of source).
+ */
+class BenchmarkTextSearch : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int CORPUS_SIZE = 2 * 1024 * 1024;
+
+private slots:
+    void initTestCase();
+
+    void benchmarkFindAll_data();
+    void benchmarkFindAll();
+
+private:
+    QString m_corpus;
+};
+
+#endif // BENCHMARK_TEXTSEARCH_H
@@ -0,0 +1,104 @@
+#include "benchmark_widgetgallery.h"
+#include "WidgetGallery.h"
+#include "ThemeCache.h"
+#include "StressPage.h"
+
+#include <QTableView>
+#include <QTreeView>
+
+#include <QElapsedTimer>
+
+void BenchmarkWidgetGallery::initTestCase()
+{
+    ThemeCache cache;
+    cache.setTemplatesPath(QStringLiteral(QTVANITY_SOURCE_DIR "/styles"));
+    m_darkStyleSheet = cache.styleSheet(QStringLiteral("dark"));
+    m_lightStyleSheet = cache.styleSheet(QStringLiteral("vscode-light"));
+    if (m_darkStyleSheet.isEmpty() || m_lightStyleSheet.isEmpty()) {
+        QSKIP("Bundled themes not found");
+    }
+}
+
+void BenchmarkWidgetGallery::benchmarkConstruction_data()
+{
+    QTest::addColumn<int>("creation");
+
+    QTest::newRow("eager") << int(WidgetGallery::PageCreation::Eager);
+    QTest::newRow("on demand") << int(WidgetGallery::PageCreation::OnDemand);
+}
+
+void BenchmarkWidgetGallery::benchmarkConstruction()
+{
+    QFETCH(int, creation);
+    const auto pageCreation = static_cast<WidgetGallery::PageCreation>(creation);
+
+    int widgets = 0;
+    QBENCHMARK {
+        WidgetGallery gallery(pageCreation);
+        widgets = gallery.findChildren<QWidget*>().size();
+    }
+
+    qInfo("%s: %d widgets after construction", QTest::currentDataTag(), widgets);
+}
+
+void BenchmarkWidgetGallery::benchmarkApplyStyleSheet_data()
+{
+    benchmarkConstruction_data();
+}
+
+void BenchmarkWidgetGallery::benchmarkApplyStyleSheet()
+{
+    QFETCH(int, creation);
+
+    WidgetGallery gallery(static_cast<WidgetGallery::PageCreation>(creation));
+    gallery.resize(800, 600);
+    gallery.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&gallery));
+
+    // Alternate themes so every apply restyles
+    bool dark = false;
+    qint64 applies = 0;
+    QElapsedTimer timer;
+    timer.start();
+    QBENCHMARK {
+        dark = !dark;
+        gallery.setStyleSheet(dark ? m_darkStyleSheet : m_lightStyleSheet);
+        ++applies;
+    }
+    const double ms = timer.nsecsElapsed() / 1e6;
+
+    qInfo("%s: %d widgets polished, %.2f ms per apply", QTest::currentDataTag(),
+          int(gallery.findChildren<QWidget*>().size()), applies > 0 ? ms / applies : 0.0);
+}
+
+void BenchmarkWidgetGallery::benchmarkStressPageScroll_data()
+{
+    QTest::addColumn<bool>("styled");
+
+    QTest::newRow("unstyled") << false;
+    QTest::newRow("dark theme") << true;
+}
+
+void BenchmarkWidgetGallery::benchmarkStressPageScroll()
+{
+    QFETCH(bool, styled);
+
+    StressPage page;
+    page.resize(1000, 900);
+    if (styled) {
+        page.setStyleSheet(m_darkStyleSheet);
+    }
+    page.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&page));
+
+    StressPage::ScrollBenchmark table;
+    StressPage::ScrollBenchmark tree;
+    QBENCHMARK {
+        table = StressPage::runScrollBenchmark(page.tableView(), StressPage::DEFAULT_BENCHMARK_FRAMES);
+        tree = StressPage::runScrollBenchmark(page.treeView(), StressPage::DEFAULT_BENCHMARK_FRAMES);
+    }
+
+    qInfo("%s: table avg %.2f ms p95 %.2f ms, tree avg %.2f ms p95 %.2f ms per frame",
+          QTest::currentDataTag(), table.averageMs(), table.percentileMs(95.0),
+          tree.averageMs(), tree.percentileMs(95.0));
+}
@@ -0,0 +1,39 @@
+#ifndef BENCHMARK_WIDGETGALLERY_H
+#define BENCHMARK_WIDGETGALLERY_H
+
+#include <QObject>
+#include <QtTest>
+
+/**
+ * @brief Compares eager and on-demand construction of the widget gallery.
+ *
+ * Measures building the gallery and applying a bundled theme to it, once with
+ * every page built up front and once with only the visible page built. Each
+ * row also logs the number of widgets the gallery holds, which is what a
+ * stylesheet apply has to polish.
+ *
+ * The stress page benchmark scrolls the large table and tree views with and
+ * without a theme and logs their frame times.
+ */
+class BenchmarkWidgetGallery : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void benchmarkConstruction_data();
+    void benchmarkConstruction();
+
+    void benchmarkApplyStyleSheet_data();
+    void benchmarkApplyStyleSheet();
+
+    void benchmarkStressPageScroll_data();
+    void benchmarkStressPageScroll();
+
+private:
+    QString m_darkStyleSheet;
+    QString m_lightStyleSheet;
+};
+
+#endif // BENCHMARK_WIDGETGALLERY_H
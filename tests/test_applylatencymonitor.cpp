@@ -0,0 +1,167 @@
+#include "test_applylatencymonitor.h"
+#include "ApplyLatencyMonitor.h"
+
+#include <QSignalSpy>
+#include <QRandomGenerator>
+
+#include <algorithm>
+
+namespace {
+    constexpr qint64 NsecsPerMs = 1000000;
+}
+
+void TestApplyLatencyMonitor::testEmptyMonitorReportsNoSamples()
+{
+    ApplyLatencyMonitor monitor;
+
+    for (int stage = 0; stage < ApplyLatencyMonitor::StageCount; ++stage) {
+        auto s = static_cast<ApplyLatencyMonitor::Stage>(stage);
+        QCOMPARE(monitor.sampleCount(s), 0);
+        QCOMPARE(monitor.lastMs(s), -1.0);
+        QCOMPARE(monitor.percentileMs(s, 95.0), -1.0);
+        QCOMPARE(monitor.maxMs(s), -1.0);
+        QVERIFY(!ApplyLatencyMonitor::stageName(s).isEmpty());
+    }
+}
+
+void TestApplyLatencyMonitor::testRecordUpdatesLastAndCount()
+{
+    ApplyLatencyMonitor monitor;
+    monitor.record(ApplyLatencyMonitor::Substitute, 2 * NsecsPerMs);
+    monitor.record(ApplyLatencyMonitor::Substitute, 5 * NsecsPerMs);
+
+    QCOMPARE(monitor.sampleCount(ApplyLatencyMonitor::Substitute), 2);
+    QCOMPARE(monitor.lastMs(ApplyLatencyMonitor::Substitute), 5.0);
+    QCOMPARE(monitor.maxMs(ApplyLatencyMonitor::Substitute), 5.0);
+    QCOMPARE(monitor.sampleCount(ApplyLatencyMonitor::Restyle), 0);
+}
+
+void TestApplyLatencyMonitor::testWindowIsBounded()
+{
+    ApplyLatencyMonitor monitor;
+
+    // Fill the window with large samples, then push them all out
+    for (int i = 0; i < ApplyLatencyMonitor::WINDOW_SIZE; ++i) {
+        monitor.record(ApplyLatencyMonitor::Restyle, 100 * NsecsPerMs);
+    }
+    for (int i = 0; i < ApplyLatencyMonitor::WINDOW_SIZE; ++i) {
+        monitor.record(ApplyLatencyMonitor::Restyle, 1 * NsecsPerMs);
+    }
+
+    QCOMPARE(monitor.sampleCount(ApplyLatencyMonitor::Restyle), ApplyLatencyMonitor::WINDOW_SIZE);
+    QCOMPARE(monitor.maxMs(ApplyLatencyMonitor::Restyle), 1.0);
+}
+
+void TestApplyLatencyMonitor::testCycleRecordsTotal()
+{
+    ApplyLatencyMonitor monitor;
+    QSignalSpy finishedSpy(&monitor, &ApplyLatencyMonitor::cycleFinished);
+
+    monitor.beginApply();
+    QVERIFY(monitor.isInApply());
+    monitor.endApply();
+    QVERIFY(!monitor.isInApply());
+    QCOMPARE(finishedSpy.count(), 1);
+    QCOMPARE(monitor.sampleCount(ApplyLatencyMonitor::Total), 1);
+
+    // The cycle is timed from its outermost begin
+    monitor.beginApply();
+    QTest::qWait(20);
+    monitor.beginApply();  // Nested begin is ignored
+    monitor.endApply();
+    monitor.endApply();    // Unbalanced end is ignored
+
+    QCOMPARE(finishedSpy.count(), 2);
+    QCOMPARE(monitor.sampleCount(ApplyLatencyMonitor::Total), 2);
+    QVERIFY(monitor.lastMs(ApplyLatencyMonitor::Total) >= 15.0);
+}
+
+void TestApplyLatencyMonitor::testCycleNsecsAccumulatesWithinCycle()
+{
+    ApplyLatencyMonitor monitor;
+
+    monitor.record(ApplyLatencyMonitor::SwatchRefresh, 3 * NsecsPerMs);
+    QCOMPARE(monitor.cycleNsecs(ApplyLatencyMonitor::SwatchRefresh), qint64(0));
+
+    monitor.beginApply();
+    monitor.record(ApplyLatencyMonitor::SwatchRefresh, 1 * NsecsPerMs);
+    monitor.record(ApplyLatencyMonitor::SwatchRefresh, 2 * NsecsPerMs);
+    QCOMPARE(monitor.cycleNsecs(ApplyLatencyMonitor::SwatchRefresh), 3 * NsecsPerMs);
+    monitor.endApply();
+
+    monitor.beginApply();
+    QCOMPARE(monitor.cycleNsecs(ApplyLatencyMonitor::SwatchRefresh), qint64(0));
+    monitor.endApply();
+}
+
+void TestApplyLatencyMonitor::testHistogramBuckets()
+{
+    ApplyLatencyMonitor monitor;
+    const QVector<double> bounds = ApplyLatencyMonitor::bucketUpperBoundsMs();
+
+    monitor.record(ApplyLatencyMonitor::Total, 0);
+    monitor.record(ApplyLatencyMonitor::Total, qint64(bounds.first() * NsecsPerMs));
+    monitor.record(ApplyLatencyMonitor::Total, qint64(bounds.last() * NsecsPerMs) + 1);
+
+    const QVector<int> counts = monitor.histogram(ApplyLatencyMonitor::Total);
+    QCOMPARE(counts.size(), bounds.size() + 1);
+    QCOMPARE(counts.first(), 2);
+    QCOMPARE(counts.last(), 1);
+}
+
+void TestApplyLatencyMonitor::testReset()
+{
+    ApplyLatencyMonitor monitor;
+    monitor.record(ApplyLatencyMonitor::Total, NsecsPerMs);
+    monitor.beginApply();
+    monitor.reset();
+
+    QCOMPARE(monitor.sampleCount(ApplyLatencyMonitor::Total), 0);
+    QVERIFY(!monitor.isInApply());
+}
+
+/**
+ * Property 1: Percentiles are ordered and bounded by the samples
+ *
+ * For any set of samples, p50 <= p95 <= max, p100 == max, and every
+ * percentile is one of the recorded samples.
+ */
+void TestApplyLatencyMonitor::testPercentileOrderingProperty_data()
+{
+    QTest::addColumn<QVector<qint64>>("samples");
+
+    QRandomGenerator *rng = QRandomGenerator::global();
+    for (int i = 0; i < 100; ++i) {
+        QVector<qint64> samples;
+        int count = 1 + (rng->generate() % (ApplyLatencyMonitor::WINDOW_SIZE * 2));
+        for (int j = 0; j < count; ++j) {
+            samples.append(qint64(rng->bounded(50 * 1000000)));
+        }
+        QTest::newRow(qPrintable(QString("samples_%1").arg(i))) << samples;
+    }
+}
+
+void TestApplyLatencyMonitor::testPercentileOrderingProperty()
+{
+    // Feature: apply-latency, Property 1: Percentiles are ordered and bounded by the samples
+
+    QFETCH(QVector<qint64>, samples);
+
+    ApplyLatencyMonitor monitor;
+    for (qint64 sample : samples) {
+        monitor.record(ApplyLatencyMonitor::Restyle, sample);
+    }
+
+    const double p50 = monitor.percentileMs(ApplyLatencyMonitor::Restyle, 50.0);
+    const double p95 = monitor.percentileMs(ApplyLatencyMonitor::Restyle, 95.0);
+    const double max = monitor.maxMs(ApplyLatencyMonitor::Restyle);
+
+    QVERIFY(p50 <= p95);
+    QVERIFY(p95 <= max);
+    QCOMPARE(monitor.percentileMs(ApplyLatencyMonitor::Restyle, 100.0), max);
+
+    // Only the last WINDOW_SIZE samples count
+    const QVector<qint64> window = samples.mid(qMax(0, samples.size() - ApplyLatencyMonitor::WINDOW_SIZE));
+    const qint64 windowMax = *std::max_element(window.constBegin(), window.constEnd());
+    QCOMPARE(max, windowMax / 1000000.0);
+}
@@ -0,0 +1,27 @@
+#ifndef TEST_APPLYLATENCYMONITOR_H
+#define TEST_APPLYLATENCYMONITOR_H
+
+#include <QObject>
+#include <QtTest>
+
+class TestApplyLatencyMonitor : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    // Unit tests
+    void testEmptyMonitorReportsNoSamples();
+    void testRecordUpdatesLastAndCount();
+    void testWindowIsBounded();
+    void testCycleRecordsTotal();
+    void testCycleNsecsAccumulatesWithinCycle();
+    void testHistogramBuckets();
+    void testReset();
+
+    // Property-based tests
+    // Property 1: Percentiles are ordered and bounded by the samples
+    void testPercentileOrderingProperty();
+    void testPercentileOrderingProperty_data();
+};
+
+#endif // TEST_APPLYLATENCYMONITOR_H
@@ -0,0 +1,238 @@
+#include "test_colorswatchoverlay.h"
+#include "ColorSwatchOverlay.h"
+
+#include <QTextEdit>
+#include <QScrollBar>
+#include <QAbstractTextDocumentLayout>
+#include <QTextBlock>
+#include <QTextCursor>
+#include <QRandomGenerator>
+
+namespace {
+
+QString numberedColors(int lines)
+{
+    QStringList text;
+    for (int i = 0; i < lines; ++i) {
+        text << QStringLiteral("QLabel#l%1 { color: #%2; }").arg(i).arg(i % 0x1000, 3, 16, QLatin1Char('0'));
+    }
+    return text.join(QLatin1Char('\n'));
+}
+
+/**
+ * Compares the colors kept by an overlay with a fresh full parse.
+ */
+bool matchesFullParse(QTextEdit *editor, ColorSwatchOverlay *overlay)
+{
+    ColorSwatchOverlay reference(editor);
+    const QVector<ColorSwatchOverlay::ColorInfo> &expected = reference.colors();
+    const QVector<ColorSwatchOverlay::ColorInfo> &actual = overlay->colors();
+    if (expected.size() != actual.size()) {
+        return false;
+    }
+    for (int i = 0; i < expected.size(); ++i) {
+        if (expected[i].line != actual[i].line || expected[i].startPos != actual[i].startPos
+            || expected[i].length != actual[i].length || expected[i].colorCode != actual[i].colorCode) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Lays out the whole document so that later scrolling does not resize it.
+ */
+void layoutDocument(QTextEdit *editor)
+{
+    QTextDocument *doc = editor->document();
+    doc->documentLayout()->blockBoundingRect(doc->lastBlock());
+}
+
+} // namespace
+
+void TestColorSwatchOverlay::testParsesHexColors()
+{
+    QTextEdit editor;
+    editor.setPlainText("QLabel { color: #f00; background: #00ff00; }\n"
+                        "QWidget { border-color: #80112233; margin: #12345; }");
+    ColorSwatchOverlay overlay(&editor);
+
+    const QVector<ColorSwatchOverlay::ColorInfo> &colors = overlay.colors();
+    QCOMPARE(colors.size(), 3);
+    QCOMPARE(colors[0].colorCode, QString("#f00"));
+    QCOMPARE(colors[0].line, 0);
+    QCOMPARE(colors[1].colorCode, QString("#00ff00"));
+    QCOMPARE(colors[2].colorCode, QString("#80112233"));
+    QCOMPARE(colors[2].line, 1);
+    QCOMPARE(editor.toPlainText().mid(colors[2].startPos, colors[2].length), QString("#80112233"));
+}
+
+void TestColorSwatchOverlay::testEditReparsesOnlyTouchedBlocks()
+{
+    QTextEdit editor;
+    editor.setPlainText(numberedColors(2000));
+    ColorSwatchOverlay overlay(&editor);
+    QCOMPARE(overlay.colors().size(), 2000);
+
+    // Typing on one line scans that line only
+    const int parsedBefore = overlay.parsedBlockCount();
+    QTextCursor cursor(editor.document()->findBlockByNumber(1000));
+    cursor.movePosition(QTextCursor::EndOfBlock);
+    cursor.insertText(" /* #abc */");
+    QCOMPARE(overlay.parsedBlockCount() - parsedBefore, 1);
+    QCOMPARE(overlay.colors().size(), 2001);
+    QVERIFY(matchesFullParse(&editor, &overlay));
+}
+
+void TestColorSwatchOverlay::testEditShiftsLaterSwatches()
+{
+    QTextEdit editor;
+    editor.setPlainText(numberedColors(10));
+    ColorSwatchOverlay overlay(&editor);
+
+    const ColorSwatchOverlay::ColorInfo before = overlay.colors().at(5);
+
+    QTextCursor cursor(editor.document()->findBlockByNumber(2));
+    cursor.insertText("QFrame { color: #123456; }\n");
+
+    const ColorSwatchOverlay::ColorInfo after = overlay.colors().at(6);
+    QCOMPARE(after.colorCode, before.colorCode);
+    QCOMPARE(after.line, before.line + 1);
+    QCOMPARE(after.startPos, before.startPos + int(QString("QFrame { color: #123456; }\n").size()));
+
+    // Removing the line restores the original offsets
+    cursor.movePosition(QTextCursor::StartOfBlock);
+    cursor.movePosition(QTextCursor::PreviousBlock, QTextCursor::KeepAnchor);
+    cursor.removeSelectedText();
+    QCOMPARE(overlay.colors().at(5).startPos, before.startPos);
+    QCOMPARE(overlay.colors().at(5).line, before.line);
+}
+
+void TestColorSwatchOverlay::testDisabledOverlayReparsesOnEnable()
+{
+    QTextEdit editor;
+    editor.setPlainText(numberedColors(5));
+    ColorSwatchOverlay overlay(&editor);
+
+    overlay.setEnabled(false);
+    editor.append("QLabel { color: #abcdef; }");
+    overlay.setEnabled(true);
+
+    QCOMPARE(overlay.colors().size(), 6);
+    QVERIFY(matchesFullParse(&editor, &overlay));
+}
+
+void TestColorSwatchOverlay::testOnlyVisibleSwatchesAreLaidOut()
+{
+    QTextEdit editor;
+    editor.resize(400, 300);
+    editor.setPlainText(numberedColors(2000));
+    editor.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&editor));
+    layoutDocument(&editor);
+
+    ColorSwatchOverlay overlay(&editor);
+    overlay.refreshSwatchPositions();
+
+    // One swatch per line, and only a screenful of lines is visible
+    QVERIFY(overlay.layoutRectCount() > 0);
+    QVERIFY(overlay.layoutRectCount() < 200);
+    QVERIFY(!overlay.colors().first().swatchRect.isNull());
+    QVERIFY(overlay.colors().last().swatchRect.isNull());
+}
+
+void TestColorSwatchOverlay::testSwatchFollowsColorCode()
+{
+    QTextEdit editor;
+    editor.resize(400, 300);
+    editor.setPlainText(numberedColors(20));
+    editor.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&editor));
+    layoutDocument(&editor);
+
+    ColorSwatchOverlay overlay(&editor);
+    overlay.refreshSwatchPositions();
+
+    const ColorSwatchOverlay::ColorInfo info = overlay.colors().at(3);
+    QTextCursor cursor(editor.document());
+    cursor.setPosition(info.startPos + info.length);
+    const QRect cursorRect = editor.cursorRect(cursor);
+
+    QVERIFY(qAbs(info.swatchRect.left() - (cursorRect.left() + 4)) <= 1);
+    QVERIFY(info.swatchRect.center().y() >= cursorRect.top());
+    QVERIFY(info.swatchRect.center().y() <= cursorRect.bottom());
+}
+
+void TestColorSwatchOverlay::testScrollingReusesCachedGeometry()
+{
+    QTextEdit editor;
+    editor.resize(400, 300);
+    editor.setPlainText(numberedColors(2000));
+    editor.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&editor));
+    layoutDocument(&editor);
+
+    ColorSwatchOverlay overlay(&editor);
+    overlay.refreshSwatchPositions();
+    const QRect topRect = overlay.colors().first().swatchRect;
+
+    QScrollBar *scrollBar = editor.verticalScrollBar();
+    scrollBar->setValue(scrollBar->maximum() / 2);
+    QVERIFY(overlay.colors().first().swatchRect.isNull());
+    const int computed = overlay.layoutRectCount();
+
+    // Returning to the top translates cached rectangles only
+    scrollBar->setValue(0);
+    QCOMPARE(overlay.layoutRectCount(), computed);
+    QCOMPARE(overlay.colors().first().swatchRect, topRect);
+}
+
+/**
+ * Property 1: Incremental parsing matches a full parse
+ *
+ * For any sequence of insertions and removals, the colors an overlay keeps
+ * up to date from contentsChange equal those of a full parse of the result.
+ */
+void TestColorSwatchOverlay::testIncrementalParsingProperty_data()
+{
+    QTest::addColumn<QString>("initial");
+    QTest::addColumn<quint32>("seed");
+
+    QRandomGenerator *rng = QRandomGenerator::global();
+    for (int i = 0; i < 50; ++i) {
+        QTest::newRow(qPrintable(QString("random_edits_%1").arg(i)))
+            << numberedColors(1 + rng->bounded(40)) << rng->generate();
+    }
+}
+
+void TestColorSwatchOverlay::testIncrementalParsingProperty()
+{
+    // Feature: qtvanity, Property 1: Incremental parsing matches a full parse
+    QFETCH(QString, initial);
+    QFETCH(quint32, seed);
+
+    QRandomGenerator rng(seed);
+    const QStringList fragments = {
+        "#fff", "#00ff00", " ", "\n", "#", "a", "0", "color: #123456;\n", "}\n", "#80ffffff"
+    };
+
+    QTextEdit editor;
+    editor.setPlainText(initial);
+    ColorSwatchOverlay overlay(&editor);
+
+    for (int edit = 0; edit < 30; ++edit) {
+        const int length = editor.document()->characterCount() - 1;
+        QTextCursor cursor(editor.document());
+        cursor.setPosition(rng.bounded(length + 1));
+        if (rng.bounded(3) == 0 && length > 0) {
+            const int end = qMin(length, cursor.position() + 1 + rng.bounded(20));
+            cursor.setPosition(end, QTextCursor::KeepAnchor);
+            cursor.removeSelectedText();
+        } else {
+            cursor.insertText(fragments.at(rng.bounded(fragments.size())));
+        }
+
+        QVERIFY2(matchesFullParse(&editor, &overlay),
+                 qPrintable(QString("Mismatch after edit %1").arg(edit)));
+    }
+}
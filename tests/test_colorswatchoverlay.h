@@ -0,0 +1,27 @@
+#ifndef TEST_COLORSWATCHOVERLAY_H
+#define TEST_COLORSWATCHOVERLAY_H
+
+#include <QObject>
+#include <QtTest>
+
+class TestColorSwatchOverlay : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    // Unit tests
+    void testParsesHexColors();
+    void testEditReparsesOnlyTouchedBlocks();
+    void testEditShiftsLaterSwatches();
+    void testDisabledOverlayReparsesOnEnable();
+    void testOnlyVisibleSwatchesAreLaidOut();
+    void testSwatchFollowsColorCode();
+    void testScrollingReusesCachedGeometry();
+
+    // Property-based tests
+    // Property 1: Incremental parsing matches a full parse
+    void testIncrementalParsingProperty();
+    void testIncrementalParsingProperty_data();
+};
+
+#endif // TEST_COLORSWATCHOVERLAY_H
@@ -2,12 +2,21 @@
 #include "CustomWidgetsPage.h"
 #include "PluginManager.h"
 #include "PluginMetadata.h"
+#include "FirstPaintTimer.h"
 
 #include <QRandomGenerator>
 #include <QTemporaryDir>
+#include <QFile>
 #include <QLabel>
 #include <QGroupBox>
 #include <QVBoxLayout>
+#include <QSignalSpy>
+#include <QPointer>
+#include <QTableView>
+#include <QStandardItemModel>
+#include <QImage>
+#include <QPushButton>
+#include <QDir>
 
 void TestCustomWidgetsPage::initTestCase()
 {
@@ -146,6 +155,229 @@ void TestCustomWidgetsPage::testEmptyStateDisplay()
              "Expected empty state message when no plugins are loaded");
 }
 
+void TestCustomWidgetsPage::testPluginReloadKeepsEmptyState()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    
+    PluginManager manager;
+    manager.setPluginDirectory(tempDir.path());
+    manager.loadPlugins();
+    
+    CustomWidgetsPage page(&manager);
+    connect(&manager, &PluginManager::pluginAboutToBeUnloaded,
+            &page, &CustomWidgetsPage::onPluginAboutToBeUnloaded);
+    connect(&manager, &PluginManager::pluginReloaded,
+            &page, &CustomWidgetsPage::onPluginReloaded);
+    
+    const QString pluginPath = tempDir.filePath(QStringLiteral("broken.") + PluginManager::supportedExtensions().first());
+    QFile pluginFile(pluginPath);
+    QVERIFY(pluginFile.open(QIODevice::WriteOnly));
+    pluginFile.write("not a plugin");
+    pluginFile.close();
+    
+    QVERIFY(!manager.reloadPlugin(pluginPath));
+    
+    const QList<QGroupBox*> groups = page.findChildren<QGroupBox*>();
+    QCOMPARE(groups.size(), 1);
+    QCOMPARE(groups.first()->title(), QStringLiteral("No Plugins Loaded"));
+}
+
+void TestCustomWidgetsPage::testPluginReloadRecreatesDisplay()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    const QString pluginPath = copyTestPlugin(tempDir.path());
+    QVERIFY(!pluginPath.isEmpty());
+    
+    PluginManager manager;
+    manager.setPluginDirectory(tempDir.path());
+    manager.loadPlugins();
+    
+    CustomWidgetsPage page(&manager);
+    connect(&manager, &PluginManager::pluginAboutToBeUnloaded,
+            &page, &CustomWidgetsPage::onPluginAboutToBeUnloaded);
+    connect(&manager, &PluginManager::pluginReloaded,
+            &page, &CustomWidgetsPage::onPluginReloaded);
+    
+    QLabel *nameLabel = nullptr;
+    for (QLabel *label : page.findChildren<QLabel*>()) {
+        if (label->text() == QStringLiteral("Example Widget")) {
+            nameLabel = label;
+        }
+    }
+    QVERIFY(nameLabel != nullptr);
+    QPointer<QWidget> oldDisplay(nameLabel->parentWidget());
+    
+    QVERIFY(manager.reloadPlugin(pluginPath));
+    
+    // The old display and its widget are gone, a new one took their place
+    QVERIFY(oldDisplay.isNull());
+    const QList<QGroupBox*> groups = page.findChildren<QGroupBox*>();
+    QCOMPARE(groups.size(), 1);
+    QCOMPARE(groups.first()->title(), QStringLiteral("Examples"));
+    int nameLabels = 0;
+    for (QLabel *label : groups.first()->findChildren<QLabel*>()) {
+        if (label->text() == QStringLiteral("Example Widget")) {
+            ++nameLabels;
+        }
+    }
+    QCOMPARE(nameLabels, 1);
+}
+
+void TestCustomWidgetsPage::testFirstPaintTimer()
+{
+    QWidget widget;
+    QVBoxLayout *layout = new QVBoxLayout(&widget);
+    layout->addWidget(new QLabel(QStringLiteral("Child"), &widget));
+    
+    QPointer<FirstPaintTimer> timer = new FirstPaintTimer(&widget);
+    QSignalSpy finishedSpy(timer.data(), &FirstPaintTimer::finished);
+    QVERIFY(finishedSpy.isValid());
+    
+    // Nothing is reported while the widget is hidden
+    QTest::qWait(50);
+    QCOMPARE(finishedSpy.count(), 0);
+    QVERIFY(!timer.isNull());
+    
+    widget.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&widget));
+    
+    QTRY_COMPARE(finishedSpy.count(), 1);
+    QVERIFY(finishedSpy.first().first().toDouble() >= 0.0);
+    QTRY_VERIFY(timer.isNull());
+    
+    // Later paints are no longer reported
+    widget.repaint();
+    QCOMPARE(finishedSpy.count(), 1);
+}
+
+void TestCustomWidgetsPage::testFirstPaintTimerKeepsViewportPainting()
+{
+    QStandardItemModel model(4, 2);
+    for (int row = 0; row < model.rowCount(); ++row) {
+        model.setData(model.index(row, 0), QBrush(Qt::red), Qt::BackgroundRole);
+    }
+    
+    QTableView view;
+    view.setModel(&model);
+    view.resize(300, 200);
+    QTableView empty;
+    empty.resize(300, 200);
+    
+    view.show();
+    empty.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&view));
+    QVERIFY(QTest::qWaitForWindowExposed(&empty));
+    
+    // The viewport is painted by QAbstractScrollArea's own event filter
+    QSignalSpy finishedSpy(new FirstPaintTimer(&view), &FirstPaintTimer::finished);
+    QVERIFY(view.viewport()->grab().toImage() != empty.viewport()->grab().toImage());
+    
+    view.repaint();
+    QTRY_COMPARE(finishedSpy.count(), 1);
+}
+
+void TestCustomWidgetsPage::testOverBudgetPluginDeferred()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    QVERIFY(!copyTestPlugin(tempDir.path()).isEmpty());
+    const QString name = QStringLiteral("Example Widget");
+    
+    PluginManager manager;
+    manager.setPluginDirectory(tempDir.path());
+    manager.setWidgetBudgetMs(1.0);
+    manager.loadPlugins();
+    manager.setWidgetTimings(name, 100.0, 0.0, 0.0);
+    QVERIFY(manager.exceedsWidgetBudget(name));
+    
+    CustomWidgetsPage page(&manager);
+    QPushButton *createButton = findCreateButton(&page);
+    QVERIFY(createButton != nullptr);
+    
+    // Not even the library is loaded for the placeholder
+    QVERIFY(!manager.pluginMetadata(name).isLoaded);
+    
+    createButton->click();
+    const PluginMetadata metadata = manager.pluginMetadata(name);
+    QVERIFY(metadata.isLoaded);
+    QVERIFY(metadata.createWidgetMs >= 0.0);
+    QVERIFY(metadata.createWidgetMs != 100.0);
+    QVERIFY(metadata.polishMs >= 0.0);
+    
+    // Once asked for, the widget is created with the page again
+    page.rebuildWidgets();
+    QVERIFY(findCreateButton(&page) == nullptr);
+}
+
+void TestCustomWidgetsPage::testWithinBudgetPluginCreated()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    QVERIFY(!copyTestPlugin(tempDir.path()).isEmpty());
+    const QString name = QStringLiteral("Example Widget");
+    
+    PluginManager manager;
+    manager.setPluginDirectory(tempDir.path());
+    manager.setWidgetBudgetMs(1000.0);
+    manager.loadPlugins();
+    QVERIFY(manager.pluginMetadata(name).createWidgetMs < 0.0);
+    
+    CustomWidgetsPage page(&manager);
+    QVERIFY(findCreateButton(&page) == nullptr);
+    
+    const PluginMetadata metadata = manager.pluginMetadata(name);
+    QVERIFY(metadata.isLoaded);
+    QVERIFY(metadata.createWidgetMs >= 0.0);
+    QVERIFY(metadata.polishMs >= 0.0);
+    
+    // The first paint is added once the page is shown
+    page.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&page));
+    QTRY_VERIFY(manager.pluginMetadata(name).firstPaintMs >= 0.0);
+}
+
+void TestCustomWidgetsPage::testLibraryLoadReplacesPlaceholder()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    QVERIFY(!copyTestPlugin(tempDir.path()).isEmpty());
+    const QString name = QStringLiteral("Example Widget");
+    
+    PluginManager manager;
+    manager.setParallelLoadingEnabled(true);
+    manager.setPluginDirectory(tempDir.path());
+    manager.loadPlugins();
+    
+    CustomWidgetsPage page(&manager);
+    connect(&manager, &PluginManager::libraryLoadFinished,
+            &page, &CustomWidgetsPage::onLibraryLoadFinished);
+    QSignalSpy finishedSpy(&manager, &PluginManager::libraryLoadFinished);
+    
+    // The library loads in the background behind a placeholder
+    QLabel *loadingLabel = nullptr;
+    for (QLabel *label : page.findChildren<QLabel*>()) {
+        if (label->text() == QStringLiteral("Loading plugin library...")) {
+            loadingLabel = label;
+        }
+    }
+    QVERIFY(loadingLabel != nullptr);
+    QPointer<QLabel> placeholder(loadingLabel);
+    QPointer<QWidget> container(loadingLabel->parentWidget());
+    QPointer<QGroupBox> group(page.findChild<QGroupBox*>());
+    QVERIFY(group);
+    
+    // Only the placeholder is replaced; the group and display stay
+    QTRY_COMPARE(finishedSpy.count(), 1);
+    QVERIFY(placeholder.isNull());
+    QVERIFY(group);
+    QVERIFY(container);
+    QVERIFY(manager.pluginMetadata(name).isLoaded);
+    QVERIFY(manager.pluginMetadata(name).createWidgetMs >= 0.0);
+    QCOMPARE(container->findChildren<QWidget*>(QString(), Qt::FindDirectChildrenOnly).size(), 4);
+}
+
 void TestCustomWidgetsPage::testRebuildWidgets()
 {
     // Create a PluginManager with an empty directory
@@ -775,3 +1007,24 @@ void TestCustomWidgetsPage::testEnabledStatePropagation()
     // and its integration with the page lifecycle.
     // =========================================================================
 }
+
+QString TestCustomWidgetsPage::copyTestPlugin(const QString &directory)
+{
+    const QString path = QDir(directory).filePath(QStringLiteral("example.")
+                                                  + PluginManager::supportedExtensions().first());
+    if (!QFile::copy(QStringLiteral(QTVANITY_TEST_PLUGIN), path)) {
+        return QString();
+    }
+    return path;
+}
+
+QPushButton* TestCustomWidgetsPage::findCreateButton(QWidget *page)
+{
+    const QList<QPushButton*> buttons = page->findChildren<QPushButton*>();
+    for (QPushButton *button : buttons) {
+        if (button->text() == QStringLiteral("Create Widget")) {
+            return button;
+        }
+    }
+    return nullptr;
+}
@@ -5,6 +5,7 @@
 #include <QtTest>
 
 class PluginManager;
+class QPushButton;
 
 /**
  * @brief Test class for CustomWidgetsPage functionality.
@@ -40,6 +41,48 @@ private slots:
      */
     void testRebuildWidgets();
     
+    /**
+     * @brief Tests that a single-plugin reload keeps the empty state when
+     *        the reloaded file does not provide a plugin.
+     */
+    void testPluginReloadKeepsEmptyState();
+    
+    /**
+     * @brief Tests that reloading a plugin replaces its display in the
+     *        category group with a new one.
+     */
+    void testPluginReloadRecreatesDisplay();
+    
+    /**
+     * @brief Tests that FirstPaintTimer reports the first paint of a widget
+     *        once, waiting while it is hidden, and then deletes itself.
+     */
+    void testFirstPaintTimer();
+    
+    /**
+     * @brief Tests that a scroll area's viewport still paints while its
+     *        first paint is timed.
+     */
+    void testFirstPaintTimerKeepsViewportPainting();
+    
+    /**
+     * @brief Tests that a plugin over the widget budget gets a placeholder
+     *        and is created, and timed, only when asked for.
+     */
+    void testOverBudgetPluginDeferred();
+    
+    /**
+     * @brief Tests that a plugin within the budget is created and timed
+     *        with the page.
+     */
+    void testWithinBudgetPluginCreated();
+    
+    /**
+     * @brief Tests that a library loaded in the background replaces only
+     *        its plugin's placeholder, keeping the category group.
+     */
+    void testLibraryLoadReplacesPlaceholder();
+    
     // Property-based tests
     
     /**
@@ -106,6 +149,19 @@ private:
      * @return A random category name or empty string (for default category).
      */
     QString generateRandomCategory();
+    
+    /**
+     * @brief Copies the fixture plugin built from ExampleWidgetPlugin.
+     * 
+     * @param directory The plugin directory to copy it into.
+     * @return The path of the copy, or an empty string if copying failed.
+     */
+    QString copyTestPlugin(const QString &directory);
+    
+    /**
+     * @brief Returns the page's "Create Widget" placeholder button, if any.
+     */
+    QPushButton* findCreateButton(QWidget *page);
 };
 
 #endif // TEST_CUSTOMWIDGETSPAGE_H
@@ -1,6 +1,6 @@
-#include <QApplication>
 #include <QtTest>
 
+#include "ProfilingApplication.h"
 #include "test_customwidgetspage.h"
 
 /**
@@ -14,7 +14,7 @@ int main(int argc, char *argv[])
     // Use offscreen platform by default for tests to avoid display requirements
     qputenv("QT_QPA_PLATFORM", "offscreen");
     
-    QApplication app(argc, argv);
+    ProfilingApplication app(argc, argv);
     
     TestCustomWidgetsPage test;
     return QTest::qExec(&test, argc, argv);
@@ -4,9 +4,62 @@
 #include <QTextEdit>
 #include <QLineEdit>
 #include <QLabel>
+#include <QTextDocument>
+#include <QScrollBar>
 #include <QSignalSpy>
 #include <QRandomGenerator>
 
+#include <algorithm>
+
+namespace {
+
+/**
+ * @brief Repeats a style sheet line until the text reaches minimumLength.
+ */
+QString repeatedLines(const QString &line, int minimumLength)
+{
+    QString text;
+    text.reserve(minimumLength + line.size() + 1);
+    while (text.size() < minimumLength) {
+        text += line;
+        text += QLatin1Char('\n');
+    }
+    return text;
+}
+
+/**
+ * @brief Returns the start positions QTextDocument::find() reports.
+ */
+QVector<int> documentFindPositions(QTextDocument *document, const QString &query,
+                                   QTextDocument::FindFlags flags)
+{
+    QVector<int> positions;
+    QTextCursor cursor(document);
+    while (!cursor.isNull() && !cursor.atEnd()) {
+        cursor = document->find(query, cursor, flags);
+        if (!cursor.isNull()) {
+            positions.append(cursor.selectionStart());
+        }
+    }
+    return positions;
+}
+
+/**
+ * @brief Returns the start positions of the highlighted matches, in order.
+ */
+QVector<int> highlightedPositions(const QTextEdit &editor)
+{
+    QVector<int> positions;
+    const QList<QTextEdit::ExtraSelection> selections = editor.extraSelections();
+    for (const QTextEdit::ExtraSelection &selection : selections) {
+        positions.append(selection.cursor.selectionStart());
+    }
+    std::sort(positions.begin(), positions.end());
+    return positions;
+}
+
+} // namespace
+
 void TestFindReplaceBar::initTestCase()
 {
     // Setup code if needed
@@ -130,6 +183,265 @@ void TestFindReplaceBar::testNoMatches()
     QCOMPARE(bar.currentMatchIndex(), -1);
 }
 
+void TestFindReplaceBar::testBackgroundSearchStreamsMatches()
+{
+    const QString line = QStringLiteral("QPushButton { color: #336699; }");
+    const QString content = repeatedLines(line, FindReplaceBar::BACKGROUND_SEARCH_THRESHOLD);
+    const int lineCount = content.count(QLatin1Char('\n'));
+    
+    QTextEdit editor;
+    editor.setPlainText(content);
+    FindReplaceBar bar(&editor);
+    QSignalSpy countSpy(&bar, &FindReplaceBar::matchCountChanged);
+    
+    bar.showFindMode();
+    bar.setSearchText("color");
+    
+    // Results arrive through the event loop, never inside setSearchText()
+    QVERIFY(bar.isSearching());
+    QCOMPARE(bar.matchCount(), 0);
+    
+    QTRY_VERIFY_WITH_TIMEOUT(!bar.isSearching(), 10000);
+    QCOMPARE(bar.matchCount(), lineCount);
+    QCOMPARE(bar.currentMatchIndex(), 0);
+    QCOMPARE(editor.textCursor().selectionStart(), line.indexOf("color"));
+    QCOMPARE(editor.textCursor().selectedText(), QString("color"));
+    
+    // The last reported count is the final one
+    QVERIFY(countSpy.count() >= 2);
+    QCOMPARE(countSpy.last().at(0).toInt(), lineCount);
+}
+
+void TestFindReplaceBar::testNewQueryCancelsBackgroundSearch()
+{
+    const QString content = repeatedLines(QStringLiteral("QLabel { color: red; border: none; }"),
+                                          FindReplaceBar::BACKGROUND_SEARCH_THRESHOLD);
+    const int lineCount = content.count(QLatin1Char('\n'));
+    
+    QTextEdit editor;
+    editor.setPlainText(content);
+    FindReplaceBar bar(&editor);
+    
+    bar.showFindMode();
+    bar.setSearchText("color");
+    bar.setSearchText("border: none");
+    
+    QTRY_VERIFY_WITH_TIMEOUT(!bar.isSearching(), 10000);
+    
+    // Let any batch the first scan queued before cancellation arrive
+    QTest::qWait(50);
+    QCOMPARE(bar.matchCount(), lineCount);
+    
+    const QList<QTextEdit::ExtraSelection> selections = editor.extraSelections();
+    QVERIFY(!selections.isEmpty());
+    for (const QTextEdit::ExtraSelection &selection : selections) {
+        QCOMPARE(selection.cursor.selectedText(), QString("border: none"));
+    }
+}
+
+void TestFindReplaceBar::testHighlightsOnlyNearViewport()
+{
+    const int lineCount = 3 * FindReplaceBar::HIGHLIGHT_ALL_LIMIT;
+    QString content;
+    for (int i = 0; i < lineCount; ++i) {
+        content += QStringLiteral("QWidget#w%1 { color: red; }\n").arg(i);
+    }
+    
+    QTextEdit editor;
+    editor.resize(400, 300);
+    editor.setPlainText(content);
+    editor.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&editor));
+    
+    FindReplaceBar bar(&editor);
+    bar.showFindMode();
+    bar.setSearchText("color");
+    QCOMPARE(bar.matchCount(), lineCount);
+    
+    // Property: only a window around the viewport is highlighted
+    QList<QTextEdit::ExtraSelection> selections = editor.extraSelections();
+    QVERIFY(!selections.isEmpty());
+    QVERIFY(selections.count() < bar.matchCount());
+    for (const QTextEdit::ExtraSelection &selection : selections) {
+        QCOMPARE(selection.cursor.selectedText(), QString("color"));
+    }
+    
+    // Scrolling to the end moves the window; the current match stays highlighted
+    QScrollBar *scrollBar = editor.verticalScrollBar();
+    scrollBar->setValue(scrollBar->maximum());
+    selections = editor.extraSelections();
+    QVERIFY(selections.count() < bar.matchCount());
+    
+    const int lastLineStart = content.lastIndexOf(QLatin1Char('\n'), content.size() - 2) + 1;
+    bool hasCurrent = false;
+    bool hasLast = false;
+    for (const QTextEdit::ExtraSelection &selection : selections) {
+        hasCurrent = hasCurrent || selection.cursor.selectionStart() == content.indexOf("color");
+        hasLast = hasLast || selection.cursor.selectionStart() > lastLineStart;
+    }
+    QVERIFY(hasCurrent);
+    QVERIFY(hasLast);
+}
+
+void TestFindReplaceBar::testEditRefreshesMatches()
+{
+    QTextEdit editor;
+    editor.setPlainText("color: red;\ncolor: blue;");
+    FindReplaceBar bar(&editor);
+    
+    bar.showFindMode();
+    bar.setSearchText("color");
+    QCOMPARE(bar.matchCount(), 2);
+    
+    // Typing in the editor keeps matches aligned with the text
+    QTextCursor cursor(editor.document());
+    cursor.movePosition(QTextCursor::End);
+    cursor.insertText("\nborder-color: green;");
+    editor.setTextCursor(cursor);
+    QCOMPARE(bar.matchCount(), 3);
+    
+    cursor.setPosition(0);
+    cursor.insertText("/* header */\n");
+    QCOMPARE(bar.matchCount(), 3);
+    
+    const QList<QTextEdit::ExtraSelection> selections = editor.extraSelections();
+    QCOMPARE(selections.count(), 3);
+    for (const QTextEdit::ExtraSelection &selection : selections) {
+        QCOMPARE(selection.cursor.selectedText(), QString("color"));
+    }
+    
+    // The editor cursor was not moved by the refresh
+    QCOMPARE(editor.textCursor().position(), editor.document()->characterCount() - 1);
+}
+
+void TestFindReplaceBar::testReplaceCurrentUpdatesIncrementally()
+{
+    const QString content = repeatedLines(QStringLiteral("QFrame { color: gray; }"),
+                                          FindReplaceBar::BACKGROUND_SEARCH_THRESHOLD);
+    const int lineCount = content.count(QLatin1Char('\n'));
+    
+    QTextEdit editor;
+    editor.setPlainText(content);
+    FindReplaceBar bar(&editor);
+    
+    bar.showReplaceMode();
+    bar.setSearchText("color");
+    QTRY_VERIFY_WITH_TIMEOUT(!bar.isSearching(), 10000);
+    QCOMPARE(bar.matchCount(), lineCount);
+    
+    QList<QLineEdit*> lineEdits = bar.findChildren<QLineEdit*>();
+    QVERIFY(lineEdits.size() >= 2);
+    lineEdits[1]->setText("fill");
+    
+    // Property: each replacement removes one match and selects the next,
+    // without starting another search over this large document
+    for (int i = 1; i <= 20; ++i) {
+        bar.replaceCurrent();
+        QVERIFY(!bar.isSearching());
+        QCOMPARE(bar.matchCount(), lineCount - i);
+        QCOMPARE(bar.currentMatchIndex(), 0);
+        QCOMPARE(editor.textCursor().selectedText(), QString("color"));
+        QCOMPARE(editor.textCursor().selectionStart(),
+                 i * QString("QFrame { fill: gray; }\n").size()
+                 + QString("QFrame { ").size());
+    }
+}
+
+void TestFindReplaceBar::testWholeWordsMode()
+{
+    QTextEdit editor;
+    editor.setPlainText("color: red; border-color: blue; colors: none;");
+    FindReplaceBar bar(&editor);
+    
+    bar.showFindMode();
+    bar.setSearchText("color");
+    QCOMPARE(bar.matchCount(), 3);
+    
+    // "border-color" splits at the hyphen; "colors" is a longer word
+    bar.setWholeWords(true);
+    QVERIFY(bar.isWholeWords());
+    QCOMPARE(bar.matchCount(), 2);
+    
+    bar.setWholeWords(false);
+    QCOMPARE(bar.matchCount(), 3);
+}
+
+void TestFindReplaceBar::testRegularExpressionMode()
+{
+    QTextEdit editor;
+    editor.setPlainText("color: #fff;\nbackground: #1e1e2e;\nborder: 1px solid #ABCDEF;");
+    FindReplaceBar bar(&editor);
+    
+    bar.showFindMode();
+    bar.setRegularExpression(true);
+    QVERIFY(bar.isRegularExpression());
+    bar.setSearchText("#[0-9a-f]{3,6}\\b");
+    
+    // Case-insensitive by default
+    QCOMPARE(bar.matchCount(), 3);
+    bar.setCaseSensitive(true);
+    QCOMPARE(bar.matchCount(), 2);
+    
+    // Anchors apply per line
+    bar.setCaseSensitive(false);
+    bar.setSearchText("^b\\w+");
+    QCOMPARE(bar.matchCount(), 2);
+    QCOMPARE(editor.textCursor().selectedText(), QString("background"));
+}
+
+void TestFindReplaceBar::testRegularExpressionReplaceWithCaptures()
+{
+    QTextEdit editor;
+    editor.setPlainText("margin-left: 4px;\nmargin-right: 8px;");
+    FindReplaceBar bar(&editor);
+    
+    bar.showReplaceMode();
+    bar.setRegularExpression(true);
+    bar.setSearchText("margin-(\\w+): (\\d+)px");
+    QCOMPARE(bar.matchCount(), 2);
+    
+    QList<QLineEdit*> lineEdits = bar.findChildren<QLineEdit*>();
+    QVERIFY(lineEdits.size() >= 2);
+    lineEdits[1]->setText("padding-$1: \\2pt");
+    
+    bar.replaceCurrent();
+    QCOMPARE(editor.toPlainText(), QString("padding-left: 4pt;\nmargin-right: 8px;"));
+    QCOMPARE(bar.matchCount(), 1);
+    
+    bar.replaceAll();
+    QCOMPARE(editor.toPlainText(), QString("padding-left: 4pt;\npadding-right: 8pt;"));
+    
+    // Replace All is still a single undo step
+    editor.undo();
+    QCOMPARE(editor.toPlainText(), QString("padding-left: 4pt;\nmargin-right: 8px;"));
+}
+
+void TestFindReplaceBar::testInvalidRegularExpression()
+{
+    QTextEdit editor;
+    editor.setPlainText("color: (red);");
+    FindReplaceBar bar(&editor);
+    
+    bar.showFindMode();
+    bar.setRegularExpression(true);
+    bar.setSearchText("(red");
+    
+    QCOMPARE(bar.matchCount(), 0);
+    QCOMPARE(bar.currentMatchIndex(), -1);
+    QLabel *label = nullptr;
+    for (QLabel *candidate : bar.findChildren<QLabel*>()) {
+        if (candidate->text() == QString("Invalid pattern")) {
+            label = candidate;
+        }
+    }
+    QVERIFY(label);
+    QVERIFY(!label->toolTip().isEmpty());
+    
+    // The same text is a valid literal
+    bar.setRegularExpression(false);
+    QCOMPARE(bar.matchCount(), 1);
+}
+
 // ============================================================================
 // Property-Based Tests
 // ============================================================================
@@ -822,3 +1134,212 @@ void TestFindReplaceBar::testUndoAtomicity()
     bar.setSearchText(searchQuery);
     QCOMPARE(bar.matchCount(), expectedReplacements);
 }
+
+// ============================================================================
+// Property 7: Background Search Equivalence
+// ============================================================================
+
+/**
+ * Feature: find-replace, Property 7: Background Search Equivalence
+ * 
+ * For any document of at least BACKGROUND_SEARCH_THRESHOLD characters,
+ * the matches found on the worker thread SHALL be exactly the matches
+ * QTextDocument::find() enumerates.
+ */
+void TestFindReplaceBar::testBackgroundSearchEquivalence_data()
+{
+    QTest::addColumn<QString>("documentContent");
+    QTest::addColumn<QString>("searchQuery");
+    QTest::addColumn<bool>("caseSensitive");
+    
+    QRandomGenerator *rng = QRandomGenerator::global();
+    
+    const QStringList words = {
+        "color", "Color", "background-color", "border", "QPushButton",
+        "qpushbutton", "{", "}", ":", ";", "#ff0000", "red", "aa"
+    };
+    const QStringList queries = { "color", "COLOR", "QPushButton", "aa", "a", ": red" };
+    
+    // Large documents are expensive to build, so keep the case count low
+    for (int i = 0; i < 6; ++i) {
+        QString content;
+        content.reserve(FindReplaceBar::BACKGROUND_SEARCH_THRESHOLD + 64);
+        while (content.size() < FindReplaceBar::BACKGROUND_SEARCH_THRESHOLD) {
+            content += words[rng->generate() % words.size()];
+            content += (rng->generate() % 8 == 0) ? QLatin1Char('\n') : QLatin1Char(' ');
+        }
+        
+        QTest::newRow(qPrintable(QString("background_%1").arg(i)))
+            << content
+            << queries[rng->generate() % queries.size()]
+            << bool(rng->generate() % 2);
+    }
+}
+
+void TestFindReplaceBar::testBackgroundSearchEquivalence()
+{
+    // Feature: find-replace, Property 7: Background Search Equivalence
+    
+    QFETCH(QString, documentContent);
+    QFETCH(QString, searchQuery);
+    QFETCH(bool, caseSensitive);
+    
+    QTextEdit editor;
+    editor.setPlainText(documentContent);
+    FindReplaceBar bar(&editor);
+    
+    bar.showFindMode();
+    bar.setCaseSensitive(caseSensitive);
+    bar.setSearchText(searchQuery);
+    QTRY_VERIFY_WITH_TIMEOUT(!bar.isSearching(), 10000);
+    
+    QTextDocument::FindFlags flags;
+    if (caseSensitive) {
+        flags |= QTextDocument::FindCaseSensitively;
+    }
+    const QVector<int> expected = documentFindPositions(editor.document(), searchQuery, flags);
+    
+    // Property: same number of matches
+    QCOMPARE(bar.matchCount(), expected.count());
+    
+    if (expected.isEmpty()) {
+        return;
+    }
+    
+    // Property: the first match is current, and wrap-around reaches the last
+    QCOMPARE(editor.textCursor().selectionStart(), expected.first());
+    bar.findPrevious();
+    QCOMPARE(editor.textCursor().selectionStart(), expected.last());
+    
+    // Property: the snapshot scanner reports the same positions
+    const TextSearchPattern pattern(searchQuery, caseSensitive ? TextSearchPattern::CaseSensitive
+                                                               : TextSearchPattern::NoOptions);
+    const QVector<TextMatch> snapshot = pattern.findAll(editor.toPlainText());
+    QVector<int> positions;
+    for (const TextMatch &match : snapshot) {
+        positions.append(match.start);
+    }
+    QCOMPARE(positions, expected);
+}
+
+// ============================================================================
+// Property 8: Incremental Match Maintenance
+// ============================================================================
+
+/**
+ * Feature: find-replace, Property 8: Incremental Match Maintenance
+ * 
+ * For any sequence of edits made while a search is active, the matches
+ * kept by the bar SHALL equal the matches of a fresh search over the
+ * edited document.
+ */
+void TestFindReplaceBar::testIncrementalMatchMaintenance_data()
+{
+    QTest::addColumn<QString>("documentContent");
+    QTest::addColumn<QString>("searchQuery");
+    QTest::addColumn<bool>("caseSensitive");
+    QTest::addColumn<bool>("wholeWords");
+    QTest::addColumn<bool>("regularExpression");
+    QTest::addColumn<quint32>("seed");
+    
+    QRandomGenerator *rng = QRandomGenerator::global();
+    
+    // Fragments that build, split and join matches of the queries below
+    const QStringList words = {
+        "color", "col", "or", "COLOR", "aa", "a", "b", " ", "\n", ";", "{ }"
+    };
+    const QStringList queries = { "color", "aa", "a", "or;", "col" };
+    const QStringList expressions = { "col(or)?", "a+", "^a", "r;$", "[ab]{2}" };
+    
+    for (int i = 0; i < 100; ++i) {
+        QString content;
+        const int wordCount = rng->generate() % 40;
+        for (int j = 0; j < wordCount; ++j) {
+            content += words[rng->generate() % words.size()];
+        }
+        const bool regularExpression = rng->generate() % 3 == 0;
+        const QString query = regularExpression ? expressions[rng->generate() % expressions.size()]
+                                                : queries[rng->generate() % queries.size()];
+        QTest::newRow(qPrintable(QString("incremental_%1").arg(i)))
+            << content
+            << query
+            << bool(rng->generate() % 2)
+            << bool(rng->generate() % 3 == 0)
+            << regularExpression
+            << rng->generate();
+    }
+    
+    QTest::newRow("overlapping_pattern") << QString("aaaaaaa") << QString("aa")
+                                         << false << false << false << 7u;
+    QTest::newRow("whole_words") << QString("a aa a\naa a") << QString("a")
+                                 << false << true << false << 5u;
+    QTest::newRow("empty_document") << QString() << QString("color")
+                                    << false << false << false << 11u;
+}
+
+void TestFindReplaceBar::testIncrementalMatchMaintenance()
+{
+    // Feature: find-replace, Property 8: Incremental Match Maintenance
+    
+    QFETCH(QString, documentContent);
+    QFETCH(QString, searchQuery);
+    QFETCH(bool, caseSensitive);
+    QFETCH(bool, wholeWords);
+    QFETCH(bool, regularExpression);
+    QFETCH(quint32, seed);
+    
+    QTextEdit editor;
+    editor.setPlainText(documentContent);
+    FindReplaceBar bar(&editor);
+    
+    bar.showFindMode();
+    bar.setCaseSensitive(caseSensitive);
+    bar.setWholeWords(wholeWords);
+    bar.setRegularExpression(regularExpression);
+    bar.setSearchText(searchQuery);
+    
+    TextSearchPattern::Options options;
+    if (caseSensitive) {
+        options |= TextSearchPattern::CaseSensitive;
+    }
+    if (wholeWords) {
+        options |= TextSearchPattern::WholeWords;
+    }
+    if (regularExpression) {
+        options |= TextSearchPattern::RegularExpression;
+    }
+    const TextSearchPattern pattern(searchQuery, options);
+    
+    const QStringList insertions = {
+        "color", "c", "olor", "COL", "a", "aa", "r;", ";", "\n", " ", ""
+    };
+    
+    QRandomGenerator rng(seed);
+    for (int step = 0; step < 20; ++step) {
+        const int length = editor.document()->characterCount() - 1;
+        const int position = int(rng.generate() % quint32(length + 1));
+        const int removed = qMin(int(rng.generate() % 6), length - position);
+        
+        QTextCursor cursor(editor.document());
+        cursor.setPosition(position);
+        cursor.setPosition(position + removed, QTextCursor::KeepAnchor);
+        cursor.insertText(insertions[rng.generate() % insertions.size()]);
+        
+        // Property: the kept matches equal a fresh search
+        QVector<int> expected;
+        const QVector<TextMatch> fresh = pattern.findAll(editor.toPlainText());
+        for (const TextMatch &match : fresh) {
+            expected.append(match.start);
+        }
+        QCOMPARE(bar.matchCount(), expected.count());
+        QCOMPARE(highlightedPositions(editor), expected);
+        
+        // Property: the current match is valid whenever there are matches
+        if (expected.isEmpty()) {
+            QCOMPARE(bar.currentMatchIndex(), -1);
+        } else {
+            QVERIFY(bar.currentMatchIndex() >= 0);
+            QVERIFY(bar.currentMatchIndex() < expected.count());
+        }
+    }
+}
@@ -30,6 +30,15 @@ private slots:
     void testCaseSensitivity();
     void testEmptySearch();
     void testNoMatches();
+    void testBackgroundSearchStreamsMatches();
+    void testNewQueryCancelsBackgroundSearch();
+    void testHighlightsOnlyNearViewport();
+    void testEditRefreshesMatches();
+    void testReplaceCurrentUpdatesIncrementally();
+    void testWholeWordsMode();
+    void testRegularExpressionMode();
+    void testRegularExpressionReplaceWithCaptures();
+    void testInvalidRegularExpression();
     
     // Property-Based Tests
     
@@ -89,6 +98,26 @@ private slots:
      */
     void testUndoAtomicity_data();
     void testUndoAtomicity();
+    
+    /**
+     * Feature: find-replace, Property 7: Background Search Equivalence
+     * 
+     * For any document of at least BACKGROUND_SEARCH_THRESHOLD characters,
+     * the matches found on the worker thread SHALL be exactly the matches
+     * QTextDocument::find() enumerates.
+     */
+    void testBackgroundSearchEquivalence_data();
+    void testBackgroundSearchEquivalence();
+    
+    /**
+     * Feature: find-replace, Property 8: Incremental Match Maintenance
+     * 
+     * For any sequence of edits made while a search is active, the matches
+     * kept by the bar SHALL equal the matches of a fresh search over the
+     * edited document.
+     */
+    void testIncrementalMatchMaintenance_data();
+    void testIncrementalMatchMaintenance();
 };
 
 #endif // TEST_FINDREPLACEBAR_H
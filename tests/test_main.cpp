@@ -1,15 +1,22 @@
-#include <QApplication>
 #include <QtTest>
 
+#include "ProfilingApplication.h"
+
 // Include all test classes
 #include "test_stylemanager.h"
+#include "test_qssruleset.h"
+#include "test_applylatencymonitor.h"
 #include "test_thememanager.h"
+#include "test_themecache.h"
 #include "test_qsssyntaxhighlighter.h"
 #include "test_qsseditor.h"
+#include "test_colorswatchoverlay.h"
 #include "test_widgetgallery.h"
 #include "test_displaypage.h"
 #include "test_mainwindowpage.h"
 #include "test_advancedpage.h"
+#include "test_stresspage.h"
+#include "test_paintprofiler.h"
 #include "test_inputspage.h"
 #include "test_containerspage.h"
 #include "test_dialogspage.h"
@@ -18,6 +25,7 @@
 #include "test_settingsmanager.h"
 #include "test_variablepanel.h"
 #include "test_findreplacebar.h"
+#include "test_textsearchpattern.h"
 #include "test_pluginmanager.h"
 #include "test_customwidgetspage.h"
 
@@ -26,7 +34,7 @@ int main(int argc, char *argv[])
     // Use offscreen platform by default for tests to avoid display requirements
     qputenv("QT_QPA_PLATFORM", "offscreen");
     
-    QApplication app(argc, argv);
+    ProfilingApplication app(argc, argv);
     
     int status = 0;
     
@@ -36,11 +44,29 @@ int main(int argc, char *argv[])
         status |= QTest::qExec(&test, argc, argv);
     }
     
+    // Run QssRuleSet tests
+    {
+        TestQssRuleSet test;
+        status |= QTest::qExec(&test, argc, argv);
+    }
+    
+    // Run ApplyLatencyMonitor tests
+    {
+        TestApplyLatencyMonitor test;
+        status |= QTest::qExec(&test, argc, argv);
+    }
+    
     // Run ThemeManager tests
     {
         TestThemeManager test;
         status |= QTest::qExec(&test, argc, argv);
     }
+
+    // Run ThemeCache tests
+    {
+        TestThemeCache test;
+        status |= QTest::qExec(&test, argc, argv);
+    }
     
     // Run QssSyntaxHighlighter tests
     {
@@ -54,6 +80,12 @@ int main(int argc, char *argv[])
         status |= QTest::qExec(&test, argc, argv);
     }
     
+    // Run ColorSwatchOverlay tests
+    {
+        TestColorSwatchOverlay test;
+        status |= QTest::qExec(&test, argc, argv);
+    }
+    
     // Run WidgetGallery tests
     {
         TestWidgetGallery test;
@@ -77,6 +109,18 @@ int main(int argc, char *argv[])
         TestAdvancedPage test;
         status |= QTest::qExec(&test, argc, argv);
     }
+
+    // Run StressPage tests
+    {
+        TestStressPage test;
+        status |= QTest::qExec(&test, argc, argv);
+    }
+
+    // Run PaintProfiler tests
+    {
+        TestPaintProfiler test;
+        status |= QTest::qExec(&test, argc, argv);
+    }
     
     // Run InputsPage tests
     {
@@ -126,6 +170,12 @@ int main(int argc, char *argv[])
         status |= QTest::qExec(&test, argc, argv);
     }
     
+    // Run TextSearchPattern tests
+    {
+        TestTextSearchPattern test;
+        status |= QTest::qExec(&test, argc, argv);
+    }
+    
     // Run PluginManager tests
     {
         TestPluginManager test;
@@ -0,0 +1,291 @@
+#include "test_paintprofiler.h"
+#include "PaintProfiler.h"
+#include "PaintHeatmapOverlay.h"
+#include "QssRuleSet.h"
+
+#include <QWidget>
+#include <QLabel>
+#include <QPushButton>
+#include <QFrame>
+#include <QVBoxLayout>
+#include <QThread>
+#include <QTableView>
+#include <QStandardItemModel>
+#include <QImage>
+
+namespace {
+
+// Paints slowly enough to stand out from stock widgets
+class SlowWidget : public QWidget
+{
+public:
+    using QWidget::QWidget;
+
+protected:
+    void paintEvent(QPaintEvent *) override
+    {
+        QThread::msleep(5);
+    }
+};
+
+} // namespace
+
+void TestPaintProfiler::initTestCase()
+{
+    // Setup code if needed
+}
+
+void TestPaintProfiler::cleanupTestCase()
+{
+    // Cleanup code if needed
+}
+
+void TestPaintProfiler::testAttachCoversSubtree()
+{
+    QWidget root;
+    QWidget *inner = new QWidget(&root);
+    new QLabel("Label", inner);
+    new QPushButton("Button", &root);
+
+    PaintProfiler profiler;
+    QVERIFY(!profiler.isAttached());
+    profiler.attach(&root);
+
+    QVERIFY(profiler.isAttached());
+    QCOMPARE(profiler.profiledWidgets().size(), 4);
+    QCOMPARE(profiler.cost(inner).paintCount, 0);
+}
+
+void TestPaintProfiler::testFollowsNewChildren()
+{
+    QWidget root;
+    PaintProfiler profiler;
+    profiler.attach(&root);
+
+    QWidget *container = new QWidget(&root);
+    QLabel *label = new QLabel("Label", container);
+    container->ensurePolished();
+
+    const QList<QWidget*> widgets = profiler.profiledWidgets();
+    QVERIFY(widgets.contains(container));
+    QVERIFY(widgets.contains(label));
+}
+
+void TestPaintProfiler::testPaintEventsTimed()
+{
+    QWidget root;
+    QVBoxLayout *layout = new QVBoxLayout(&root);
+    QLabel *label = new QLabel("Label", &root);
+    layout->addWidget(label);
+    root.resize(200, 100);
+
+    PaintProfiler profiler;
+    profiler.attach(&root);
+    root.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&root));
+
+    const qint64 before = profiler.totalPaintCount();
+    label->repaint();
+
+    const PaintProfiler::WidgetCost cost = profiler.cost(label);
+    QVERIFY(cost.paintCount > 0);
+    QVERIFY(cost.totalNsecs >= cost.maxNsecs);
+    QVERIFY(profiler.totalPaintCount() > before);
+    QVERIFY(profiler.maxAverageMs() >= cost.averageMs());
+}
+
+void TestPaintProfiler::testScrollAreaViewportStillPaints()
+{
+    // Cell backgrounds render without fonts on the offscreen platform
+    QStandardItemModel model(6, 3);
+    for (int row = 0; row < model.rowCount(); ++row) {
+        for (int column = 0; column < model.columnCount(); ++column) {
+            model.setData(model.index(row, column), QBrush(Qt::red), Qt::BackgroundRole);
+        }
+    }
+
+    QTableView view;
+    view.setModel(&model);
+    view.resize(300, 200);
+    QTableView empty;
+    empty.resize(300, 200);
+
+    PaintProfiler profiler;
+    profiler.attach(&view);
+    view.show();
+    empty.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&view));
+    QVERIFY(QTest::qWaitForWindowExposed(&empty));
+
+    // The viewport is painted by QAbstractScrollArea's own event filter
+    const QImage rendered = view.viewport()->grab().toImage();
+    const QImage blank = empty.viewport()->grab().toImage();
+    QVERIFY(rendered != blank);
+    QVERIFY(profiler.cost(view.viewport()).paintCount > 0);
+}
+
+void TestPaintProfiler::testPausedPaintsNotRecorded()
+{
+    QWidget root;
+    root.resize(100, 100);
+    PaintProfiler profiler;
+    profiler.attach(&root);
+    root.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&root));
+
+    profiler.reset();
+    profiler.setPaused(true);
+    QVERIFY(profiler.isPaused());
+    root.repaint();
+    QCOMPARE(profiler.totalPaintCount(), qint64(0));
+
+    profiler.setPaused(false);
+    root.repaint();
+    QVERIFY(profiler.totalPaintCount() > 0);
+}
+
+void TestPaintProfiler::testResetKeepsProfiling()
+{
+    QWidget root;
+    root.resize(100, 100);
+    PaintProfiler profiler;
+    profiler.attach(&root);
+    root.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&root));
+    root.repaint();
+    QVERIFY(profiler.totalPaintCount() > 0);
+
+    profiler.reset();
+    QCOMPARE(profiler.totalPaintCount(), qint64(0));
+    QCOMPARE(profiler.cost(&root).paintCount, 0);
+
+    root.repaint();
+    QVERIFY(profiler.cost(&root).paintCount > 0);
+}
+
+void TestPaintProfiler::testDetachStopsProfiling()
+{
+    QWidget root;
+    root.resize(100, 100);
+    PaintProfiler profiler;
+    profiler.attach(&root);
+    root.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&root));
+
+    profiler.detach();
+    QVERIFY(!profiler.isAttached());
+    root.repaint();
+    QCOMPARE(profiler.totalPaintCount(), qint64(0));
+}
+
+void TestPaintProfiler::testDestroyedWidgetsForgotten()
+{
+    QWidget root;
+    QLabel *label = new QLabel("Label", &root);
+
+    PaintProfiler profiler;
+    profiler.attach(&root);
+    QCOMPARE(profiler.profiledWidgets().size(), 2);
+
+    delete label;
+    QCOMPARE(profiler.profiledWidgets().size(), 1);
+}
+
+void TestPaintProfiler::testSlowestTypesListMatchingRules()
+{
+    // A plain QWidget root would share the slow widget's type
+    QFrame root;
+    QVBoxLayout *layout = new QVBoxLayout(&root);
+    SlowWidget *slow = new SlowWidget(&root);
+    slow->setMinimumSize(50, 50);
+    layout->addWidget(slow);
+    QLabel *label = new QLabel("Label", &root);
+    layout->addWidget(label);
+    root.resize(200, 200);
+
+    PaintProfiler profiler;
+    profiler.attach(&root);
+    root.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&root));
+    slow->repaint();
+    label->repaint();
+
+    const QssRuleSet rules = QssRuleSet::parse(
+        "QLabel { color: red; } QWidget#nothing { border: 1px solid; } QPushButton { color: blue; }");
+    const QVector<PaintProfiler::TypeCost> types = profiler.slowestTypes(rules, 1);
+    QCOMPARE(types.size(), 1);
+
+    // SlowWidget has no meta object of its own, so it is reported as QWidget
+    const PaintProfiler::TypeCost &slowest = types.first();
+    QCOMPARE(slowest.typeName, QString("QWidget"));
+    QVERIFY(slowest.averageMs() >= 5.0);
+    QVERIFY(slowest.paintCount > 0);
+    QCOMPARE(slowest.matchingRules, QStringList());
+
+    slow->setObjectName("nothing");
+    const QStringList matches = PaintProfiler::matchingRules(rules, {slow, label});
+    QCOMPARE(matches, QStringList({"QLabel", "QWidget#nothing"}));
+}
+
+void TestPaintProfiler::testOverlayCoversTargetAndIsIgnored()
+{
+    QWidget root;
+    new QLabel("Label", &root);
+    root.resize(300, 200);
+
+    PaintProfiler profiler;
+    profiler.attach(&root);
+    PaintHeatmapOverlay *overlay = new PaintHeatmapOverlay(&profiler, &root);
+    root.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&root));
+
+    QCOMPARE(overlay->geometry(), root.rect());
+    QVERIFY(overlay->testAttribute(Qt::WA_TransparentForMouseEvents));
+    QVERIFY(!profiler.profiledWidgets().contains(overlay));
+
+    root.resize(400, 250);
+    QCOMPARE(overlay->geometry(), root.rect());
+
+    // Widgets added later stay underneath the overlay
+    QLabel *later = new QLabel("Later", &root);
+    later->show();
+    QCOMPARE(root.children().last(), static_cast<QObject*>(overlay));
+}
+
+void TestPaintProfiler::testOverlayRepaintNotRecorded()
+{
+    QWidget root;
+    QVBoxLayout *layout = new QVBoxLayout(&root);
+    layout->addWidget(new QLabel("Label", &root));
+    root.resize(300, 200);
+
+    PaintProfiler profiler;
+    profiler.attach(&root);
+    PaintHeatmapOverlay *overlay = new PaintHeatmapOverlay(&profiler, &root);
+    root.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&root));
+    QTest::qWait(50);
+
+    // The overlay is translucent, so repainting it repaints the widgets below
+    const qint64 before = profiler.totalPaintCount();
+    overlay->repaintHeatmap();
+    QVERIFY(profiler.isPaused());
+    QTRY_VERIFY(!profiler.isPaused());
+    QCOMPARE(profiler.totalPaintCount(), before);
+
+    // Hiding the overlay before it paints resumes the profiler too
+    overlay->repaintHeatmap();
+    overlay->hide();
+    QVERIFY(!profiler.isPaused());
+}
+
+void TestPaintProfiler::testHeatColorRange()
+{
+    const QColor cheap = PaintHeatmapOverlay::heatColor(0.0);
+    const QColor slow = PaintHeatmapOverlay::heatColor(1.0);
+
+    QCOMPARE(cheap.hue(), 120);
+    QCOMPARE(slow.hue(), 0);
+    QVERIFY(slow.alpha() > cheap.alpha());
+    QCOMPARE(PaintHeatmapOverlay::heatColor(2.0), slow);
+}
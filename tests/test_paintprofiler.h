@@ -0,0 +1,40 @@
+#ifndef TEST_PAINTPROFILER_H
+#define TEST_PAINTPROFILER_H
+
+#include <QObject>
+#include <QtTest>
+
+/**
+ * @brief Test class for PaintProfiler and PaintHeatmapOverlay.
+ *
+ * Tests include:
+ * - Subtree attachment, including children added later
+ * - Paint event timing and reset, without changing what is painted
+ * - Slowest types with their matching rules
+ * - Heatmap overlay placement and exclusion from profiling, including
+ *   the paints its own repaints cause
+ */
+class TestPaintProfiler : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    // Unit tests
+    void testAttachCoversSubtree();
+    void testFollowsNewChildren();
+    void testPaintEventsTimed();
+    void testScrollAreaViewportStillPaints();
+    void testPausedPaintsNotRecorded();
+    void testResetKeepsProfiling();
+    void testDetachStopsProfiling();
+    void testDestroyedWidgetsForgotten();
+    void testSlowestTypesListMatchingRules();
+    void testOverlayCoversTargetAndIsIgnored();
+    void testOverlayRepaintNotRecorded();
+    void testHeatColorRange();
+};
+
+#endif // TEST_PAINTPROFILER_H
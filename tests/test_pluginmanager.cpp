@@ -1,12 +1,20 @@
 #include "test_pluginmanager.h"
 #include "PluginManager.h"
 #include "PluginMetadata.h"
+#include "PluginScanCache.h"
+#include "PluginLoadTask.h"
+#include "WidgetPluginInterface.h"
 
 #include <QRandomGenerator>
 #include <QDir>
 #include <QTemporaryDir>
 #include <QFile>
+#include <QFileInfo>
 #include <QSignalSpy>
+#include <QPluginLoader>
+#include <QThreadPool>
+#include <QPointer>
+#include <QWidget>
 
 void TestPluginManager::initTestCase()
 {
@@ -1045,3 +1053,486 @@ void TestPluginManager::testRefreshOperationCompleteness()
                        .arg(expectedErrorCount)
                        .arg(errorsAfterSecondRefresh.size())));
 }
+
+
+void TestPluginManager::testMetadataOnlyDiscovery()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    
+    const QString extension = PluginManager::supportedExtensions().first();
+    const QStringList filenames = {
+        QStringLiteral("not_a_plugin.") + extension,
+        QStringLiteral("empty_plugin.") + extension
+    };
+    QFile textFile(tempDir.filePath(filenames.at(0)));
+    QVERIFY(textFile.open(QIODevice::WriteOnly));
+    textFile.write("{\"widgetName\": \"Fake Widget\"}");
+    textFile.close();
+    QFile emptyFile(tempDir.filePath(filenames.at(1)));
+    QVERIFY(emptyFile.open(QIODevice::WriteOnly));
+    emptyFile.close();
+    
+    PluginManager manager;
+    manager.setPluginDirectory(tempDir.path());
+    QSignalSpy pluginLoadedSpy(&manager, &PluginManager::pluginLoaded);
+    manager.loadPlugins();
+    
+    QCOMPARE(pluginLoadedSpy.count(), 0);
+    QCOMPARE(manager.loadingErrors().size(), filenames.size());
+    QCOMPARE(manager.deferredPluginCount(), 0);
+    QVERIFY(manager.lastScanDurationMs() >= 0.0);
+    
+    // Names that were never discovered do not trigger a load
+    QVERIFY(manager.pluginInterface(QStringLiteral("Fake Widget")) == nullptr);
+    QVERIFY(!manager.pluginMetadata(QStringLiteral("Fake Widget")).isValid);
+    QCOMPARE(manager.loadingErrors().size(), filenames.size());
+    QCOMPARE(manager.deferredLoadDurationMs(), 0.0);
+    
+    manager.unloadPlugins();
+    QCOMPARE(manager.deferredPluginCount(), 0);
+    QVERIFY(manager.loadedPlugins().isEmpty());
+}
+
+void TestPluginManager::testRealPluginLoadedOnFirstUse()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    const QString pluginPath = copyTestPlugin(tempDir.path());
+    QVERIFY(!pluginPath.isEmpty());
+    const QString name = QStringLiteral("Example Widget");
+    
+    PluginManager manager;
+    manager.setPluginDirectory(tempDir.path());
+    QSignalSpy pluginLoadedSpy(&manager, &PluginManager::pluginLoaded);
+    manager.loadPlugins();
+    
+    // Discovered from the JSON metadata alone
+    QVERIFY(manager.loadingErrors().isEmpty());
+    QCOMPARE(pluginLoadedSpy.count(), 1);
+    QCOMPARE(manager.deferredPluginCount(), 1);
+    PluginMetadata metadata = manager.pluginMetadata(name);
+    QVERIFY(metadata.isValid);
+    QVERIFY(!metadata.isLoaded);
+    QCOMPARE(metadata.category, QStringLiteral("Examples"));
+    QCOMPARE(metadata.filePath, pluginPath);
+    QVERIFY(!QPluginLoader(pluginPath).isLoaded());
+    
+    // Loaded when the interface is first asked for
+    WidgetPluginInterface *interface = manager.pluginInterface(name);
+    QVERIFY(interface != nullptr);
+    QVERIFY(QPluginLoader(pluginPath).isLoaded());
+    metadata = manager.pluginMetadata(name);
+    QVERIFY(metadata.isLoaded);
+    QCOMPARE(manager.deferredPluginCount(), 0);
+    QVERIFY(manager.deferredLoadDurationMs() > 0.0);
+    QCOMPARE(manager.pluginInterface(name), interface);
+    
+    QWidget *widget = interface->createWidget(nullptr);
+    QVERIFY(widget != nullptr);
+    delete widget;
+    
+    manager.unloadPlugins();
+    QVERIFY(!QPluginLoader(pluginPath).isLoaded());
+}
+
+void TestPluginManager::testPluginScanCacheRoundTrip()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    
+    const QString pluginPath = tempDir.filePath(QStringLiteral("cached.") + PluginManager::supportedExtensions().first());
+    QFile pluginFile(pluginPath);
+    QVERIFY(pluginFile.open(QIODevice::WriteOnly));
+    pluginFile.write("not a plugin");
+    pluginFile.close();
+    
+    PluginScanCache cache;
+    PluginScanCache::Entry entry;
+    entry.iid = QStringLiteral(WidgetPluginInterface_iid);
+    entry.name = QStringLiteral("Cached Widget");
+    entry.description = QStringLiteral("From the cache");
+    entry.category = QStringLiteral("Examples");
+    entry.createWidgetMs = 12.5;
+    entry.polishMs = 3.25;
+    cache.insert(QFileInfo(pluginPath), entry);
+    QVERIFY(cache.isModified());
+    
+    const QString cachePath = tempDir.filePath(QStringLiteral("cache/plugincache.json"));
+    QVERIFY(cache.save(cachePath));
+    QVERIFY(!cache.isModified());
+    
+    PluginScanCache loaded;
+    QVERIFY(loaded.load(cachePath));
+    QCOMPARE(loaded.size(), 1);
+    const PluginScanCache::Entry *found = loaded.lookup(QFileInfo(pluginPath));
+    QVERIFY(found != nullptr);
+    QCOMPARE(found->name, entry.name);
+    QCOMPARE(found->description, entry.description);
+    QCOMPARE(found->category, entry.category);
+    QCOMPARE(found->iid, entry.iid);
+    QCOMPARE(found->createWidgetMs, 12.5);
+    QCOMPARE(found->polishMs, 3.25);
+    QCOMPARE(found->firstPaintMs, -1.0);
+    QVERIFY(!found->isBroken());
+    
+    // A different size means the file changed
+    QVERIFY(pluginFile.open(QIODevice::Append));
+    pluginFile.write(" any more");
+    pluginFile.close();
+    QVERIFY(loaded.lookup(QFileInfo(pluginPath)) == nullptr);
+    
+    QVERIFY(QFile::remove(pluginPath));
+    loaded.prune();
+    QCOMPARE(loaded.size(), 0);
+    QVERIFY(loaded.isModified());
+}
+
+void TestPluginManager::testScanCacheSkipsUnchangedFiles()
+{
+    QTemporaryDir pluginDir;
+    QTemporaryDir dataDir;
+    QVERIFY(pluginDir.isValid());
+    QVERIFY(dataDir.isValid());
+    
+    const QString pluginPath = pluginDir.filePath(QStringLiteral("broken.") + PluginManager::supportedExtensions().first());
+    QFile pluginFile(pluginPath);
+    QVERIFY(pluginFile.open(QIODevice::WriteOnly));
+    pluginFile.write("not a plugin");
+    pluginFile.close();
+    
+    const QString cachePath = dataDir.filePath(QStringLiteral("plugincache.json"));
+    QStringList firstErrors;
+    {
+        PluginManager manager;
+        manager.setPluginDirectory(pluginDir.path());
+        manager.setCacheFile(cachePath);
+        manager.loadPlugins();
+        QCOMPARE(manager.lastScanCacheHits(), 0);
+        firstErrors = manager.loadingErrors();
+        QCOMPARE(firstErrors.size(), 1);
+        QVERIFY(QFile::exists(cachePath));
+    }
+    
+    PluginManager manager;
+    manager.setPluginDirectory(pluginDir.path());
+    manager.setCacheFile(cachePath);
+    QSignalSpy errorSpy(&manager, &PluginManager::pluginLoadError);
+    manager.loadPlugins();
+    QCOMPARE(manager.lastScanCacheHits(), 1);
+    QCOMPARE(QStringList(manager.loadingErrors()), firstErrors);
+    QCOMPARE(errorSpy.count(), 1);
+    QCOMPARE(errorSpy.at(0).at(0).toString(), pluginPath);
+    
+    // Changing the file invalidates its entry
+    QVERIFY(pluginFile.open(QIODevice::Append));
+    pluginFile.write(" either");
+    pluginFile.close();
+    manager.refreshPlugins();
+    QCOMPARE(manager.lastScanCacheHits(), 0);
+    QCOMPARE(manager.loadingErrors().size(), 1);
+    
+    // Removed files are dropped from the cache
+    QVERIFY(QFile::remove(pluginPath));
+    manager.refreshPlugins();
+    PluginScanCache cache;
+    QVERIFY(cache.load(cachePath));
+    QCOMPARE(cache.size(), 0);
+}
+
+void TestPluginManager::testReloadPluginAffectsOnlyThatFile()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    
+    const QString extension = PluginManager::supportedExtensions().first();
+    const QString keptPath = tempDir.filePath(QStringLiteral("kept.") + extension);
+    const QString reloadedPath = tempDir.filePath(QStringLiteral("reloaded.") + extension);
+    for (const QString &path : {keptPath, reloadedPath}) {
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("not a plugin");
+    }
+    
+    PluginManager manager;
+    manager.setPluginDirectory(tempDir.path());
+    manager.loadPlugins();
+    QCOMPARE(manager.loadingErrors().size(), 2);
+    
+    QSignalSpy loadedSpy(&manager, &PluginManager::pluginsLoaded);
+    QSignalSpy unloadedSpy(&manager, &PluginManager::pluginsUnloaded);
+    QSignalSpy aboutToUnloadSpy(&manager, &PluginManager::pluginAboutToBeUnloaded);
+    QSignalSpy reloadedSpy(&manager, &PluginManager::pluginReloaded);
+    
+    QVERIFY(!manager.reloadPlugin(reloadedPath));
+    QCOMPARE(manager.loadingErrors().size(), 2);
+    QCOMPARE(reloadedSpy.count(), 1);
+    const PluginMetadata current = reloadedSpy.at(0).at(1).value<PluginMetadata>();
+    QVERIFY(!current.isValid);
+    QCOMPARE(current.filePath, QFileInfo(reloadedPath).absoluteFilePath());
+    QVERIFY(current.errorMessage.contains(QStringLiteral("reloaded.")));
+    
+    // Removing the file drops its error; the other file is untouched
+    QVERIFY(QFile::remove(reloadedPath));
+    QVERIFY(!manager.reloadPlugin(reloadedPath));
+    QCOMPARE(manager.loadingErrors().size(), 1);
+    QVERIFY(manager.loadingErrors().first().contains(QStringLiteral("kept.")));
+    
+    // Single-file reloads never go through a full unload and rescan
+    QCOMPARE(loadedSpy.count(), 0);
+    QCOMPARE(unloadedSpy.count(), 0);
+    QCOMPARE(aboutToUnloadSpy.count(), 0);
+}
+
+void TestPluginManager::testWatchingReloadsAddedFiles()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    
+    PluginManager manager;
+    manager.setPluginDirectory(tempDir.path());
+    manager.loadPlugins();
+    manager.setWatchingEnabled(true);
+    QVERIFY(manager.isWatchingEnabled());
+    QVERIFY(manager.loadingErrors().isEmpty());
+    
+    QSignalSpy loadedSpy(&manager, &PluginManager::pluginsLoaded);
+    QSignalSpy reloadedSpy(&manager, &PluginManager::pluginReloaded);
+    
+    QFile file(tempDir.filePath(QStringLiteral("added.") + PluginManager::supportedExtensions().first()));
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write("not a plugin");
+    file.close();
+    
+    QTRY_COMPARE_WITH_TIMEOUT(reloadedSpy.count(), 1, 5000);
+    QCOMPARE(manager.loadingErrors().size(), 1);
+    QCOMPARE(loadedSpy.count(), 0);
+    
+    manager.setWatchingEnabled(false);
+    QVERIFY(!manager.isWatchingEnabled());
+}
+
+void TestPluginManager::testPluginLoadTaskReportsResult()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    
+    const QString pluginPath = tempDir.filePath(QStringLiteral("broken.") + PluginManager::supportedExtensions().first());
+    QFile pluginFile(pluginPath);
+    QVERIFY(pluginFile.open(QIODevice::WriteOnly));
+    pluginFile.write("not a plugin");
+    pluginFile.close();
+    
+    QPluginLoader loader(pluginPath);
+    PluginLoadTask *task = new PluginLoadTask(7, pluginPath, &loader);
+    QPointer<PluginLoadTask> guard(task);
+    QSignalSpy spy(task, &PluginLoadTask::libraryLoaded);
+    
+    QThreadPool pool;
+    pool.start(task);
+    task->wait();
+    
+    // wait() returns once the loader is free, and again after that
+    task->wait();
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.at(0).at(0).toInt(), 7);
+    QCOMPARE(spy.at(0).at(1).toString(), pluginPath);
+    QCOMPARE(spy.at(0).at(2).toBool(), false);
+    QVERIFY(spy.at(0).at(3).toLongLong() >= 0);
+    QVERIFY(!loader.isLoaded());
+    
+    // The task deletes itself on the UI thread
+    QTRY_VERIFY(guard.isNull());
+}
+
+void TestPluginManager::testParallelLoadingScan()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    
+    const QString extension = PluginManager::supportedExtensions().first();
+    for (int i = 0; i < 4; ++i) {
+        QFile file(tempDir.filePath(QString("broken_%1.%2").arg(i).arg(extension)));
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("not a plugin");
+    }
+    
+    PluginManager manager;
+    manager.setParallelLoadingEnabled(true);
+    QVERIFY(manager.isParallelLoadingEnabled());
+    manager.setPluginDirectory(tempDir.path());
+    
+    QSignalSpy finishedSpy(&manager, &PluginManager::libraryLoadFinished);
+    manager.loadPlugins();
+    
+    QCOMPARE(manager.loadingErrors().size(), 4);
+    QCOMPARE(manager.libraryLoadsInProgress(), 0);
+    QVERIFY(!manager.loadPluginAsync(QStringLiteral("Unknown Widget")));
+    QCOMPARE(finishedSpy.count(), 0);
+    QCOMPARE(manager.backgroundLoadDurationMs(), 0.0);
+    
+    manager.setParallelLoadingEnabled(false);
+    QVERIFY(!manager.loadPluginAsync(QStringLiteral("Unknown Widget")));
+}
+
+void TestPluginManager::testParallelLoadingRealPlugin()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    const QString pluginPath = copyTestPlugin(tempDir.path());
+    QVERIFY(!pluginPath.isEmpty());
+    const QString name = QStringLiteral("Example Widget");
+    
+    PluginManager manager;
+    manager.setParallelLoadingEnabled(true);
+    manager.setPluginDirectory(tempDir.path());
+    manager.loadPlugins();
+    QVERIFY(!manager.pluginMetadata(name).isLoaded);
+    
+    QSignalSpy pluginLoadedSpy(&manager, &PluginManager::pluginLoaded);
+    QSignalSpy finishedSpy(&manager, &PluginManager::libraryLoadFinished);
+    QVERIFY(manager.loadPluginAsync(name));
+    QCOMPARE(manager.libraryLoadsInProgress(), 1);
+    QCOMPARE(manager.deferredPluginCount(), 0);
+    
+    // Asking again while it loads does not start a second load
+    QVERIFY(manager.loadPluginAsync(name));
+    QCOMPARE(manager.libraryLoadsInProgress(), 1);
+    
+    // The scan already announced the plugin; only the load is reported
+    QTRY_COMPARE(finishedSpy.count(), 1);
+    QCOMPARE(pluginLoadedSpy.count(), 0);
+    const PluginMetadata metadata = finishedSpy.at(0).at(0).value<PluginMetadata>();
+    QCOMPARE(metadata.name, name);
+    QVERIFY(metadata.isValid);
+    QVERIFY(metadata.isLoaded);
+    QCOMPARE(manager.libraryLoadsInProgress(), 0);
+    QVERIFY(manager.backgroundLoadDurationMs() > 0.0);
+    QVERIFY(manager.pluginInterface(name) != nullptr);
+    
+    // Already loaded, so there is nothing left to load in the background
+    QVERIFY(!manager.loadPluginAsync(name));
+}
+
+void TestPluginManager::testReloadDuringLibraryLoad()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    const QString pluginPath = copyTestPlugin(tempDir.path());
+    QVERIFY(!pluginPath.isEmpty());
+    const QString name = QStringLiteral("Example Widget");
+    
+    PluginManager manager;
+    manager.setParallelLoadingEnabled(true);
+    manager.setPluginDirectory(tempDir.path());
+    manager.loadPlugins();
+    QSignalSpy finishedSpy(&manager, &PluginManager::libraryLoadFinished);
+    
+    // The reload waits for the load it replaces; its result is then stale
+    QVERIFY(manager.loadPluginAsync(name));
+    QVERIFY(manager.reloadPlugin(pluginPath));
+    QCOMPARE(manager.libraryLoadsInProgress(), 0);
+    QTest::qWait(100);
+    QCOMPARE(finishedSpy.count(), 0);
+    QVERIFY(!manager.pluginMetadata(name).isLoaded);
+    
+    // A new load of the same file is finished by its own result only
+    QVERIFY(manager.loadPluginAsync(name));
+    QTRY_COMPARE(finishedSpy.count(), 1);
+    QVERIFY(manager.pluginMetadata(name).isLoaded);
+    
+    // pluginInterface() finishes a pending load itself
+    QVERIFY(manager.reloadPlugin(pluginPath));
+    QVERIFY(manager.loadPluginAsync(name));
+    QVERIFY(manager.pluginInterface(name) != nullptr);
+    QCOMPARE(manager.libraryLoadsInProgress(), 0);
+    QTest::qWait(100);
+    QCOMPARE(finishedSpy.count(), 1);
+    QVERIFY(manager.loadingErrors().isEmpty());
+}
+
+void TestPluginManager::testWidgetBudget()
+{
+    PluginMetadata metadata;
+    QCOMPARE(metadata.widgetCostMs(), -1.0);
+    metadata.createWidgetMs = 20.0;
+    QCOMPARE(metadata.widgetCostMs(), 20.0);
+    metadata.polishMs = 5.0;
+    metadata.firstPaintMs = 15.0;
+    QCOMPARE(metadata.widgetCostMs(), 40.0);
+    
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    
+    PluginManager manager;
+    manager.setPluginDirectory(tempDir.path());
+    manager.loadPlugins();
+    
+    QCOMPARE(manager.widgetBudgetMs(), 0.0);
+    QVERIFY(!manager.exceedsWidgetBudget(QStringLiteral("Unknown Widget")));
+    
+    manager.setWidgetBudgetMs(1.0);
+    QCOMPARE(manager.widgetBudgetMs(), 1.0);
+    QVERIFY(!manager.exceedsWidgetBudget(QStringLiteral("Unknown Widget")));
+    
+    // Timings of unknown plugins are ignored
+    manager.setWidgetTimings(QStringLiteral("Unknown Widget"), 100.0, 100.0, 100.0);
+    QCOMPARE(manager.pluginMetadata(QStringLiteral("Unknown Widget")).createWidgetMs, -1.0);
+    QVERIFY(!manager.exceedsWidgetBudget(QStringLiteral("Unknown Widget")));
+}
+
+void TestPluginManager::testWidgetTimingsPersistInCache()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    QVERIFY(QDir(tempDir.path()).mkdir(QStringLiteral("plugins")));
+    const QString pluginDir = tempDir.filePath(QStringLiteral("plugins"));
+    QVERIFY(!copyTestPlugin(pluginDir).isEmpty());
+    const QString cachePath = tempDir.filePath(QStringLiteral("plugincache.json"));
+    const QString name = QStringLiteral("Example Widget");
+    
+    {
+        PluginManager manager;
+        manager.setCacheFile(cachePath);
+        manager.setPluginDirectory(pluginDir);
+        manager.setWidgetBudgetMs(50.0);
+        manager.loadPlugins();
+        QVERIFY(!manager.exceedsWidgetBudget(name));
+        
+        manager.setWidgetTimings(name, 80.0, 5.0, -1.0);
+        manager.setWidgetTimings(name, 80.0, 5.0, -1.0);
+        QCOMPARE(manager.pluginMetadata(name).widgetCostMs(), 85.0);
+        QVERIFY(manager.exceedsWidgetBudget(name));
+        
+        // Recorded timings are written later, not once per call
+        QFile cacheFile(cachePath);
+        QVERIFY(cacheFile.open(QIODevice::ReadOnly));
+        QVERIFY(!cacheFile.readAll().contains("\"createWidgetMs\":80"));
+    }
+    
+    PluginManager manager;
+    manager.setCacheFile(cachePath);
+    manager.setPluginDirectory(pluginDir);
+    manager.setWidgetBudgetMs(50.0);
+    manager.loadPlugins();
+    
+    const PluginMetadata metadata = manager.pluginMetadata(name);
+    QVERIFY(!metadata.isLoaded);
+    QCOMPARE(metadata.createWidgetMs, 80.0);
+    QCOMPARE(metadata.polishMs, 5.0);
+    QCOMPARE(metadata.firstPaintMs, -1.0);
+    QVERIFY(manager.exceedsWidgetBudget(name));
+    
+    manager.setWidgetBudgetMs(100.0);
+    QVERIFY(!manager.exceedsWidgetBudget(name));
+}
+
+QString TestPluginManager::copyTestPlugin(const QString &directory, const QString &baseName)
+{
+    const QString path = QDir(directory).filePath(baseName + QLatin1Char('.')
+                                                  + PluginManager::supportedExtensions().first());
+    if (!QFile::copy(QStringLiteral(QTVANITY_TEST_PLUGIN), path)) {
+        return QString();
+    }
+    return QFileInfo(path).absoluteFilePath();
+}
@@ -80,6 +80,84 @@ private slots:
      */
     void testRefreshOperationCompleteness();
     void testRefreshOperationCompleteness_data();
+    
+    /**
+     * Discovery reads plugin metadata without loading libraries: files that
+     * are not plugins are rejected from their metadata, nothing is left
+     * pending, and unknown names resolve to no interface.
+     */
+    void testMetadataOnlyDiscovery();
+    
+    /**
+     * A real plugin that names its widget in its metadata is discovered
+     * without loading its library, which is loaded on first use.
+     */
+    void testRealPluginLoadedOnFirstUse();
+    
+    /**
+     * PluginScanCache entries, including measured widget times, survive a
+     * save/load round trip and stop matching once the file's size changes.
+     */
+    void testPluginScanCacheRoundTrip();
+    
+    /**
+     * With a cache file set, a second scan takes unchanged broken files from
+     * the cache and reports the same errors, and changed files are inspected
+     * again.
+     */
+    void testScanCacheSkipsUnchangedFiles();
+    
+    /**
+     * reloadPlugin() replaces the errors and metadata of one file only, and
+     * drops them when the file is removed.
+     */
+    void testReloadPluginAffectsOnlyThatFile();
+    
+    /**
+     * With watching enabled, a plugin file added to the directory is picked
+     * up without a full rescan.
+     */
+    void testWatchingReloadsAddedFiles();
+    
+    /**
+     * PluginLoadTask loads a library on a pool thread, reports the result
+     * with the generation and file it was started for, and can be waited
+     * for on its own.
+     */
+    void testPluginLoadTaskReportsResult();
+    
+    /**
+     * With parallel loading enabled, files rejected from their metadata are
+     * still reported during the scan, and nothing is left loading.
+     */
+    void testParallelLoadingScan();
+    
+    /**
+     * loadPluginAsync() loads a real plugin's library on the pool, then
+     * instantiates it and emits libraryLoadFinished() without announcing
+     * the plugin through pluginLoaded() a second time.
+     */
+    void testParallelLoadingRealPlugin();
+    
+    /**
+     * Reloading a plugin, or asking for its interface, while its library
+     * loads in the background drops the old load's result instead of
+     * applying it to a newer load.
+     */
+    void testReloadDuringLibraryLoad();
+    
+    /**
+     * A widget's cost sums its measured times, and no plugin is over a
+     * disabled budget or one it has never been measured against.
+     */
+    void testWidgetBudget();
+    
+    /**
+     * Timings recorded for a real plugin are kept in the scan cache, so a
+     * new manager knows the plugin is over budget before creating it. The
+     * file is written once the timings settle, not on every call.
+     */
+    void testWidgetTimingsPersistInCache();
 
 private:
     /**
@@ -94,6 +172,15 @@ private:
      * @return A random filename base string.
      */
     QString generateRandomFilenameBase();
+    
+    /**
+     * @brief Copies the fixture plugin built from ExampleWidgetPlugin.
+     * 
+     * @param directory The plugin directory to copy it into.
+     * @param baseName The file name without extension.
+     * @return The path of the copy, or an empty string if copying failed.
+     */
+    QString copyTestPlugin(const QString &directory, const QString &baseName = QStringLiteral("example"));
 };
 
 #endif // TEST_PLUGINMANAGER_H
@@ -0,0 +1,210 @@
+#include "test_qssruleset.h"
+#include "QssRuleSet.h"
+
+#include <QPushButton>
+#include <QLabel>
+#include <QRandomGenerator>
+
+void TestQssRuleSet::testParseRulesAndDeclarations()
+{
+    QssRuleSet set = QssRuleSet::parse(
+        "QPushButton, QToolButton { color: red; background: url(a;b.png) }\n"
+        "QLabel { font-weight: bold; }");
+
+    QVERIFY(set.isWellFormed());
+    QCOMPARE(set.rules().size(), 2);
+
+    const QssRule &first = set.rules().at(0);
+    QCOMPARE(first.selectors.size(), 2);
+    QCOMPARE(first.selectorText, QString("QPushButton, QToolButton"));
+    QCOMPARE(first.propertyNames, QStringList({"color", "background"}));
+    QCOMPARE(first.declarations, QString("color: red; background: url(a;b.png)"));
+
+    QCOMPARE(set.rules().at(1).propertyNames, QStringList({"font-weight"}));
+}
+
+void TestQssRuleSet::testParseIgnoresCommentsAndWhitespace()
+{
+    QssRuleSet compact = QssRuleSet::parse("QLabel{color:red;margin:1px 2px}");
+    QssRuleSet spaced = QssRuleSet::parse(
+        "/* header */\nQLabel  {\n    color : red; /* inline */\n    margin: 1px   2px;\n}\n");
+
+    QCOMPARE(spaced.rules().size(), 1);
+    QCOMPARE(spaced.rules().at(0).selectorText, compact.rules().at(0).selectorText);
+    QCOMPARE(spaced.rules().at(0).declarations, compact.rules().at(0).declarations);
+}
+
+void TestQssRuleSet::testParseSelectorSubjects()
+{
+    QssRuleSet set = QssRuleSet::parse(
+        "QDialog>QPushButton#ok:hover { color: red; }"
+        ".QLabel[flat=\"true\"]::indicator { color: red; }"
+        "* { color: red; }"
+        ":disabled { color: gray; }");
+    QCOMPARE(set.rules().size(), 4);
+
+    const QssSelector &button = set.rules().at(0).selectors.at(0);
+    QCOMPARE(button.text, QString("QDialog > QPushButton#ok:hover"));
+    QCOMPARE(button.typeName, QString("QPushButton"));
+    QCOMPARE(button.objectName, QString("ok"));
+    QCOMPARE(button.text.mid(button.subjectEnd), QString(":hover"));
+    QVERIFY(button.isTargetable());
+
+    const QssSelector &label = set.rules().at(1).selectors.at(0);
+    QCOMPARE(label.className, QString("QLabel"));
+    QVERIFY(label.typeName.isEmpty());
+    QCOMPARE(label.text.mid(label.subjectEnd), QString("::indicator"));
+
+    QVERIFY(!set.rules().at(2).selectors.at(0).isTargetable());
+    QVERIFY(!set.rules().at(3).selectors.at(0).isTargetable());
+    QCOMPARE(set.rules().at(3).selectors.at(0).subjectEnd, 0);
+}
+
+void TestQssRuleSet::testParseBareDeclarationsNotWellFormed()
+{
+    QVERIFY(!QssRuleSet::parse("color: red;").isWellFormed());
+    QVERIFY(!QssRuleSet::parse("QLabel { color: red;").isWellFormed());
+    QVERIFY(QssRuleSet::parse(QString()).isWellFormed());
+    QVERIFY(QssRuleSet::parse(QString()).isEmpty());
+}
+
+void TestQssRuleSet::testSelectorMayMatchWidget()
+{
+    QPushButton button;
+    button.setObjectName("ok");
+    QLabel label;
+
+    QssRuleSet set = QssRuleSet::parse(
+        "QAbstractButton { color: red; }"
+        ".QAbstractButton { color: red; }"
+        "#ok { color: red; }"
+        "QPushButton#cancel { color: red; }"
+        "* { color: red; }");
+
+    QVERIFY(set.rules().at(0).selectors.at(0).mayMatch(&button));
+    QVERIFY(!set.rules().at(0).selectors.at(0).mayMatch(&label));
+    QVERIFY(!set.rules().at(1).selectors.at(0).mayMatch(&button));
+    QVERIFY(set.rules().at(2).selectors.at(0).mayMatch(&button));
+    QVERIFY(!set.rules().at(3).selectors.at(0).mayMatch(&button));
+    QVERIFY(set.rules().at(4).selectors.at(0).mayMatch(&label));
+}
+
+void TestQssRuleSet::testNormalizeIgnoresFormatting()
+{
+    const QString compact = QssRuleSet::normalize("QLabel,QPushButton{color:red;border:1px solid black}");
+    QCOMPARE(compact, QString("QLabel,QPushButton{color:red;border:1px solid black}"));
+
+    QCOMPARE(QssRuleSet::normalize(
+                 "/* theme */\nQLabel ,\n  QPushButton {\n    color : red;\n"
+                 "    border: 1px   solid black; /* outline */\n}\n"),
+             compact);
+}
+
+void TestQssRuleSet::testNormalizeKeepsSignificantWhitespace()
+{
+    // A space before a pseudo-state is a descendant combinator
+    QVERIFY(QssRuleSet::normalize("QDialog :hover { color: red; }")
+            != QssRuleSet::normalize("QDialog:hover { color: red; }"));
+
+    // Quoted strings are kept verbatim, including comment-like content
+    QCOMPARE(QssRuleSet::normalize("QLabel { qproperty-text: \"a  /* b */\"; }"),
+             QString("QLabel{qproperty-text:\"a  /* b */\"}"));
+
+    // Values are different content
+    QVERIFY(QssRuleSet::normalize("QLabel { margin: 1px 2px; }")
+            != QssRuleSet::normalize("QLabel { margin: 1px2px; }"));
+}
+
+void TestQssRuleSet::testDiffValueChangeIsIncremental()
+{
+    QssRuleSet from = QssRuleSet::parse("QLabel { color: red; } QPushButton { color: red; }");
+    QssRuleSet to = QssRuleSet::parse("QLabel { color: red; } QPushButton { color: blue; }");
+
+    QssRuleSet::Diff diff = QssRuleSet::diff(from, to);
+    QVERIFY(!diff.requiresFullRestyle);
+    QCOMPARE(diff.changedRules, QVector<int>({1}));
+}
+
+void TestQssRuleSet::testDiffAddedRuleIsIncremental()
+{
+    QssRuleSet from = QssRuleSet::parse("QLabel { color: red; }");
+    QssRuleSet to = QssRuleSet::parse("QCheckBox { spacing: 4px; } QLabel { color: red; padding: 2px; }");
+
+    QssRuleSet::Diff diff = QssRuleSet::diff(from, to);
+    QVERIFY(!diff.requiresFullRestyle);
+    QCOMPARE(diff.changedRules, QVector<int>({0, 1}));
+}
+
+void TestQssRuleSet::testDiffRemovalRequiresFullRestyle()
+{
+    QssRuleSet from = QssRuleSet::parse("QLabel { color: red; padding: 2px; } QPushButton { color: red; }");
+
+    QVERIFY(QssRuleSet::diff(from, QssRuleSet::parse("QLabel { color: red; padding: 2px; }"))
+                .requiresFullRestyle);
+    QVERIFY(QssRuleSet::diff(from, QssRuleSet::parse("QLabel { color: red; } QPushButton { color: red; }"))
+                .requiresFullRestyle);
+}
+
+void TestQssRuleSet::testDiffReorderRequiresFullRestyle()
+{
+    QssRuleSet from = QssRuleSet::parse("QLabel { color: red; } QPushButton { color: red; }");
+    QssRuleSet to = QssRuleSet::parse("QPushButton { color: red; } QLabel { color: red; }");
+
+    QVERIFY(QssRuleSet::diff(from, to).requiresFullRestyle);
+}
+
+/**
+ * Property 1: Formatting-only changes produce an empty diff
+ *
+ * For any stylesheet, re-serializing it with different whitespace and added
+ * comments should yield a diff with no changed rules and no full restyle.
+ */
+void TestQssRuleSet::testFormattingOnlyChangesProperty_data()
+{
+    QTest::addColumn<QString>("compact");
+    QTest::addColumn<QString>("reformatted");
+
+    QRandomGenerator *rng = QRandomGenerator::global();
+
+    QStringList selectors = {
+        "QPushButton", "QLabel", "QLineEdit:focus", "QComboBox::drop-down",
+        "QDialog > QPushButton", "#ok", ".QCheckBox", "QSlider::handle:horizontal"
+    };
+    QStringList properties = {"color", "background-color", "border", "padding", "margin"};
+    QStringList values = {"red", "#ffffff", "1px solid black", "rgb(1, 2, 3)", "4px 2px"};
+
+    for (int i = 0; i < 100; ++i) {
+        QString compact;
+        QString reformatted = "/* generated */\n";
+        int numRules = 1 + (rng->generate() % 5);
+        for (int r = 0; r < numRules; ++r) {
+            QString selector = selectors[rng->generate() % selectors.size()];
+            compact += selector + "{";
+            reformatted += "  " + selector + "\n{\n";
+            int numProps = 1 + (rng->generate() % 3);
+            for (int p = 0; p < numProps; ++p) {
+                QString prop = properties[rng->generate() % properties.size()];
+                QString val = values[rng->generate() % values.size()];
+                compact += prop + ":" + val + ";";
+                reformatted += "    " + prop + " :  " + val + " ; /* note */\n";
+            }
+            compact += "}";
+            reformatted += "}\n\n";
+        }
+        QTest::newRow(qPrintable(QString("formatting_%1").arg(i))) << compact << reformatted;
+    }
+}
+
+void TestQssRuleSet::testFormattingOnlyChangesProperty()
+{
+    // Feature: incremental-restyle, Property 1: Formatting-only changes produce an empty diff
+
+    QFETCH(QString, compact);
+    QFETCH(QString, reformatted);
+
+    QssRuleSet::Diff diff = QssRuleSet::diff(QssRuleSet::parse(compact),
+                                             QssRuleSet::parse(reformatted));
+    QVERIFY(!diff.requiresFullRestyle);
+    QVERIFY2(diff.changedRules.isEmpty(),
+             qPrintable(QString("Unexpected changes between:\n%1\n%2").arg(compact, reformatted)));
+}
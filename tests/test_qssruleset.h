@@ -0,0 +1,33 @@
+#ifndef TEST_QSSRULESET_H
+#define TEST_QSSRULESET_H
+
+#include <QObject>
+#include <QtTest>
+
+class TestQssRuleSet : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    // Parsing tests
+    void testParseRulesAndDeclarations();
+    void testParseIgnoresCommentsAndWhitespace();
+    void testParseSelectorSubjects();
+    void testParseBareDeclarationsNotWellFormed();
+    void testSelectorMayMatchWidget();
+    void testNormalizeIgnoresFormatting();
+    void testNormalizeKeepsSignificantWhitespace();
+
+    // Diff tests
+    void testDiffValueChangeIsIncremental();
+    void testDiffAddedRuleIsIncremental();
+    void testDiffRemovalRequiresFullRestyle();
+    void testDiffReorderRequiresFullRestyle();
+
+    // Property-based tests
+    // Property 1: Formatting-only changes produce an empty diff
+    void testFormattingOnlyChangesProperty();
+    void testFormattingOnlyChangesProperty_data();
+};
+
+#endif // TEST_QSSRULESET_H
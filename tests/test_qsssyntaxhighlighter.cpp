@@ -4,6 +4,7 @@
 #include <QTextDocument>
 #include <QTextBlock>
 #include <QTextCursor>
+#include <QTextLayout>
 #include <QRandomGenerator>
 #include <QCoreApplication>
 
@@ -69,6 +70,64 @@ private:
     bool m_tracking;
 };
 
+/**
+ * Returns the foreground color applied at a document position, or an
+ * invalid color if the position is unformatted.
+ */
+static QColor colorAt(QTextDocument *doc, int position)
+{
+    const QTextBlock block = doc->findBlock(position);
+    const int offset = position - block.position();
+    const auto ranges = block.layout()->formats();
+    for (const auto &range : ranges) {
+        if (offset >= range.start && offset < range.start + range.length
+            && range.format.foreground().style() != Qt::NoBrush) {
+            return range.format.foreground().color();
+        }
+    }
+    return QColor();
+}
+
+/**
+ * Returns the foreground color of every character in the document, with
+ * 0 for unformatted characters.
+ */
+static QVector<QRgb> foregroundMap(QTextDocument *doc)
+{
+    QVector<QRgb> colors(doc->characterCount(), 0);
+    for (QTextBlock block = doc->begin(); block.isValid(); block = block.next()) {
+        const auto ranges = block.layout()->formats();
+        for (const auto &range : ranges) {
+            if (range.format.foreground().style() == Qt::NoBrush) {
+                continue;
+            }
+            for (int i = 0; i < range.length; ++i) {
+                colors[block.position() + range.start + i] = range.format.foreground().color().rgba();
+            }
+        }
+    }
+    return colors;
+}
+
+/**
+ * Builds a stylesheet of the given number of rules, with a comment that
+ * spans several lines before every tenth rule.
+ */
+static QString generatedStyleSheet(int rules)
+{
+    QString qss;
+    for (int i = 0; i < rules; ++i) {
+        if (i % 10 == 0) {
+            qss += QStringLiteral("/* Section %1\n   QLabel { color: red; }\n*/\n").arg(i);
+        }
+        qss += QStringLiteral("QPushButton#button%1:hover {\n"
+                              "    background-color: #%2;\n"
+                              "    border: 1px solid ${border};\n"
+                              "}\n").arg(i).arg(i % 0x1000, 3, 16, QLatin1Char('0'));
+    }
+    return qss;
+}
+
 void TestQssSyntaxHighlighter::initTestCase()
 {
 }
@@ -355,3 +414,225 @@ void TestQssSyntaxHighlighter::testColorSchemeSwitch()
     // Should be same as original dark color
     QCOMPARE(darkSelectorColor, darkSelectorColorAgain);
 }
+
+void TestQssSyntaxHighlighter::testPropertyNameIsNotValueKeyword()
+{
+    // "border" and "margin" are both property names and value keywords
+    QTextDocument doc;
+    QssSyntaxHighlighter highlighter(&doc);
+    const QString qss = QStringLiteral("QLabel { border: 1px solid red; subcontrol-origin: margin; }");
+    doc.setPlainText(qss);
+    highlighter.rehighlight();
+
+    const QColor propertyColor = highlighter.propertyFormat().foreground().color();
+    const QColor valueColor = highlighter.valueFormat().foreground().color();
+
+    QCOMPARE(colorAt(&doc, qss.indexOf(QLatin1String("border"))), propertyColor);
+    QCOMPARE(colorAt(&doc, qss.indexOf(QLatin1String("solid"))), valueColor);
+    QCOMPARE(colorAt(&doc, qss.indexOf(QLatin1String("red"))), valueColor);
+    QCOMPARE(colorAt(&doc, qss.indexOf(QLatin1String("subcontrol-origin"))), propertyColor);
+    QCOMPARE(colorAt(&doc, qss.indexOf(QLatin1String("margin"))), valueColor);
+}
+
+void TestQssSyntaxHighlighter::testHexColorVersusObjectName()
+{
+    QTextDocument doc;
+    QssSyntaxHighlighter highlighter(&doc);
+    const QString qss = QStringLiteral("#okButton { color: #ff0000; } #abc { color: #abc; }");
+    doc.setPlainText(qss);
+    highlighter.rehighlight();
+
+    const QColor selectorColor = highlighter.selectorFormat().foreground().color();
+    const QColor valueColor = highlighter.valueFormat().foreground().color();
+
+    QCOMPARE(colorAt(&doc, 0), selectorColor);
+    QCOMPARE(colorAt(&doc, qss.indexOf(QLatin1String("#ff0000"))), valueColor);
+    QCOMPARE(colorAt(&doc, qss.indexOf(QLatin1String("#abc {"))), selectorColor);
+    QCOMPARE(colorAt(&doc, qss.lastIndexOf(QLatin1String("#abc"))), valueColor);
+}
+
+void TestQssSyntaxHighlighter::testVariableAndStringFormats()
+{
+    QTextDocument doc;
+    QssSyntaxHighlighter highlighter(&doc);
+    const QString qss = QStringLiteral(
+        "QLabel { color: ${primary-color}; image: url(\"icons/a.png\"); font-family: 'Sans'; }");
+    doc.setPlainText(qss);
+    highlighter.rehighlight();
+
+    const QColor variableColor = highlighter.variableFormat().foreground().color();
+    const int variable = qss.indexOf(QLatin1String("${"));
+    QCOMPARE(colorAt(&doc, variable), variableColor);
+    QCOMPARE(colorAt(&doc, qss.indexOf(QLatin1Char('}'), variable)), variableColor);
+
+    // url() and quoted strings share a format distinct from variables
+    const QColor urlColor = colorAt(&doc, qss.indexOf(QLatin1String("url")));
+    QVERIFY(urlColor.isValid());
+    QVERIFY(urlColor != variableColor);
+    QCOMPARE(colorAt(&doc, qss.indexOf(QLatin1String("'Sans'"))), urlColor);
+}
+
+void TestQssSyntaxHighlighter::testStateCarriesAcrossBlocks()
+{
+    QTextDocument doc;
+    QssSyntaxHighlighter highlighter(&doc);
+    const QString qss = QStringLiteral(
+        "QPushButton {\n"
+        "    border:\n"
+        "        1px solid gray;\n"
+        "    /* top\n"
+        "       QLabel */\n"
+        "    top: 2px;\n"
+        "}\n"
+        "QLabel:hover { }");
+    doc.setPlainText(qss);
+    highlighter.rehighlight();
+
+    const QColor selectorColor = highlighter.selectorFormat().foreground().color();
+    const QColor propertyColor = highlighter.propertyFormat().foreground().color();
+    const QColor valueColor = highlighter.valueFormat().foreground().color();
+    const QColor commentColor = highlighter.commentFormat().foreground().color();
+    const QColor pseudoStateColor = highlighter.pseudoStateFormat().foreground().color();
+
+    // A value continued on the next line is still a value
+    QCOMPARE(colorAt(&doc, qss.indexOf(QLatin1String("solid"))), valueColor);
+
+    // Words inside a comment spanning blocks are comment text
+    QCOMPARE(colorAt(&doc, qss.indexOf(QLatin1String("QLabel"))), commentColor);
+
+    // After the comment the rule continues with a property
+    QCOMPARE(colorAt(&doc, qss.indexOf(QLatin1String("top:"))), propertyColor);
+
+    // After the closing brace selectors are recognized again
+    const int selector = qss.lastIndexOf(QLatin1String("QLabel"));
+    QCOMPARE(colorAt(&doc, selector), selectorColor);
+    QCOMPARE(colorAt(&doc, qss.indexOf(QLatin1String(":hover"))), pseudoStateColor);
+}
+
+void TestQssSyntaxHighlighter::testLazyHighlightingDefersHiddenBlocks()
+{
+    QTextDocument doc;
+    QssSyntaxHighlighter highlighter(&doc);
+    highlighter.setLazyHighlighting(true);
+    highlighter.setVisibleBlockRange(0, 9);
+    doc.setPlainText(generatedStyleSheet(500));
+
+    const QColor selectorColor = highlighter.selectorFormat().foreground().color();
+    const QTextBlock visible = doc.findBlockByNumber(3);
+    const QTextBlock hidden = doc.findBlockByNumber(doc.blockCount() - 5);
+    QVERIFY(visible.text().startsWith(QLatin1String("QPushButton")));
+    QVERIFY(hidden.text().startsWith(QLatin1String("QPushButton")));
+
+    QCOMPARE(colorAt(&doc, visible.position()), selectorColor);
+    QVERIFY(!colorAt(&doc, hidden.position()).isValid());
+    QVERIFY(highlighter.isHighlightingPending());
+
+    // Scrolling to a block highlights it right away
+    highlighter.setVisibleBlockRange(hidden.blockNumber(), hidden.blockNumber());
+    QCOMPARE(colorAt(&doc, hidden.position()), selectorColor);
+
+    QSignalSpy finishedSpy(&highlighter, &QssSyntaxHighlighter::highlightingFinished);
+    highlighter.highlightPendingBlocks();
+    QVERIFY(!highlighter.isHighlightingPending());
+    QCOMPARE(finishedSpy.count(), 1);
+}
+
+void TestQssSyntaxHighlighter::testLazyHighlightingCompletesWhenIdle()
+{
+    QTextDocument doc;
+    QssSyntaxHighlighter highlighter(&doc);
+    highlighter.setLazyHighlighting(true);
+    highlighter.setVisibleBlockRange(0, 20);
+    doc.setPlainText(generatedStyleSheet(2000));
+    QVERIFY(highlighter.isHighlightingPending());
+
+    QTRY_VERIFY_WITH_TIMEOUT(!highlighter.isHighlightingPending(), 10000);
+
+    QTextDocument eagerDoc;
+    QssSyntaxHighlighter eager(&eagerDoc);
+    eagerDoc.setPlainText(doc.toPlainText());
+    QCOMPARE(foregroundMap(&doc), foregroundMap(&eagerDoc));
+}
+
+void TestQssSyntaxHighlighter::testLazyColorSchemeSwitch()
+{
+    QTextDocument doc;
+    QssSyntaxHighlighter highlighter(&doc);
+    highlighter.setLazyHighlighting(true);
+    highlighter.setVisibleBlockRange(0, 9);
+    doc.setPlainText(generatedStyleSheet(300));
+    highlighter.highlightPendingBlocks();
+
+    highlighter.setColorScheme(QssSyntaxHighlighter::LightScheme);
+    const QColor lightSelectorColor = highlighter.selectorFormat().foreground().color();
+    const QTextBlock visible = doc.findBlockByNumber(3);
+    const QTextBlock hidden = doc.findBlockByNumber(doc.blockCount() - 5);
+
+    // Visible blocks switch at once, hidden ones once the queue is drained
+    QCOMPARE(colorAt(&doc, visible.position()), lightSelectorColor);
+    QVERIFY(colorAt(&doc, hidden.position()) != lightSelectorColor);
+    QVERIFY(highlighter.isHighlightingPending());
+
+    highlighter.highlightPendingBlocks();
+    QCOMPARE(colorAt(&doc, hidden.position()), lightSelectorColor);
+}
+
+/**
+ * Property 3: Lazy Highlighting Convergence
+ *
+ * For any document and visible range, once all queued blocks are processed
+ * a lazy highlighter has applied exactly the formats of an eager one,
+ * including blocks inside comments that start above the visible range.
+ */
+void TestQssSyntaxHighlighter::testLazyHighlightingConvergence_data()
+{
+    QTest::addColumn<QString>("qss");
+    QTest::addColumn<int>("firstVisible");
+    QTest::addColumn<int>("visibleCount");
+
+    QRandomGenerator *rng = QRandomGenerator::global();
+
+    const QStringList lines = {
+        "QPushButton {", "QLabel#title:hover {", "}", "/* open comment",
+        "still commented { color: red; }", "close */", "    color: #ff0000;",
+        "    border: 1px solid black;", "    background: ${accent};",
+        "    image: url(\"a.png\");", "QComboBox::drop-down { border: none; }",
+        "/* single */ QSlider::handle {", "    margin:", "        2px 4px;"
+    };
+
+    for (int i = 0; i < 50; ++i) {
+        QStringList docLines;
+        const int lineCount = 20 + rng->bounded(200);
+        for (int j = 0; j < lineCount; ++j) {
+            docLines << lines.at(rng->bounded(lines.size()));
+        }
+        QTest::newRow(qPrintable(QString("random_document_%1").arg(i)))
+            << docLines.join(QLatin1Char('\n'))
+            << rng->bounded(lineCount) << 1 + rng->bounded(30);
+    }
+}
+
+void TestQssSyntaxHighlighter::testLazyHighlightingConvergence()
+{
+    // Feature: qtvanity, Property 3: Lazy Highlighting Convergence
+    QFETCH(QString, qss);
+    QFETCH(int, firstVisible);
+    QFETCH(int, visibleCount);
+
+    QTextDocument lazyDoc;
+    QssSyntaxHighlighter lazy(&lazyDoc);
+    lazy.setLazyHighlighting(true);
+    lazy.setVisibleBlockRange(firstVisible, firstVisible + visibleCount - 1);
+    lazyDoc.setPlainText(qss);
+
+    // Edit inside the visible range before the queue has drained
+    QTextCursor cursor(lazyDoc.findBlockByNumber(firstVisible));
+    cursor.insertText(QStringLiteral("/* */ "));
+    lazy.highlightPendingBlocks();
+
+    QTextDocument eagerDoc;
+    QssSyntaxHighlighter eager(&eagerDoc);
+    eagerDoc.setPlainText(lazyDoc.toPlainText());
+
+    QCOMPARE(foregroundMap(&lazyDoc), foregroundMap(&eagerDoc));
+}
@@ -20,10 +20,19 @@ private slots:
     void testCommentHighlighting();
     void testMultilineCommentHighlighting();
     void testColorSchemeSwitch();
+    void testPropertyNameIsNotValueKeyword();
+    void testHexColorVersusObjectName();
+    void testVariableAndStringFormats();
+    void testStateCarriesAcrossBlocks();
+    void testLazyHighlightingDefersHiddenBlocks();
+    void testLazyHighlightingCompletesWhenIdle();
+    void testLazyColorSchemeSwitch();
     
     // Property-based tests
     void testSyntaxHighlightingCoverage();
     void testSyntaxHighlightingCoverage_data();
+    void testLazyHighlightingConvergence();
+    void testLazyHighlightingConvergence_data();
 };
 
 #endif // TEST_QSSSYNTAXHIGHLIGHTER_H
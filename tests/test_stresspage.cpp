@@ -0,0 +1,177 @@
+#include "test_stresspage.h"
+#include "StressPage.h"
+#include "GeneratedItemModel.h"
+#include "WidgetGallery.h"
+
+#include <QTableView>
+#include <QTreeView>
+#include <QHeaderView>
+#include <QScrollBar>
+#include <QSpinBox>
+#include <QTabWidget>
+#include <QSignalSpy>
+
+void TestStressPage::initTestCase()
+{
+    // Setup code if needed
+}
+
+void TestStressPage::cleanupTestCase()
+{
+    // Cleanup code if needed
+}
+
+void TestStressPage::testModelDimensions()
+{
+    GeneratedItemModel model(500000, 6);
+
+    QCOMPARE(model.rowCount(), 500000);
+    QCOMPARE(model.columnCount(), 6);
+    QVERIFY(!model.hasChildren(model.index(0, 0)));
+
+    // Data is computed from the index, so any row can be read
+    QModelIndex last = model.index(499999, 0);
+    QVERIFY(last.isValid());
+    QCOMPARE(model.data(last).toString(), QString("Item 500000"));
+    QVERIFY(model.data(model.index(499999, 5)).isValid());
+    QVERIFY(!model.index(500000, 0).isValid());
+    QCOMPARE(model.headerData(0, Qt::Horizontal).toString(), QString("Name"));
+}
+
+void TestStressPage::testModelTreeStructure()
+{
+    GeneratedItemModel model(10, 3, 4);
+
+    QModelIndex top = model.index(7, 0);
+    QVERIFY(model.hasChildren(top));
+    QCOMPARE(model.rowCount(top), 4);
+    QVERIFY(!model.parent(top).isValid());
+
+    QModelIndex child = model.index(2, 1, top);
+    QVERIFY(child.isValid());
+    QCOMPARE(model.parent(child), top);
+    QCOMPARE(model.rowCount(child), 0);
+    QCOMPARE(model.data(model.index(2, 0, top)).toString(), QString("Item 8.3"));
+
+    // Only the first column has children
+    QCOMPARE(model.rowCount(model.index(7, 1)), 0);
+}
+
+void TestStressPage::testModelSetDimensions()
+{
+    GeneratedItemModel model(10, 2);
+    QSignalSpy resetSpy(&model, &QAbstractItemModel::modelReset);
+
+    model.setDimensions(20, 3, 1);
+    QCOMPARE(resetSpy.count(), 1);
+    QCOMPARE(model.rowCount(), 20);
+    QCOMPARE(model.columnCount(), 3);
+    QCOMPARE(model.childrenPerRow(), 1);
+
+    // Unchanged dimensions do not reset views
+    model.setDimensions(20, 3, 1);
+    QCOMPARE(resetSpy.count(), 1);
+
+    model.setDimensions(-5, 3, -1);
+    QCOMPARE(model.rowCount(), 0);
+    QCOMPARE(model.childrenPerRow(), 0);
+}
+
+void TestStressPage::testViewsShareModel()
+{
+    StressPage page;
+
+    QVERIFY(page.model() != nullptr);
+    QCOMPARE(page.model()->rowCount(), StressPage::DEFAULT_ROWS);
+    QCOMPARE(page.model()->columnCount(), StressPage::DEFAULT_COLUMNS);
+    QCOMPARE(page.tableView()->model(), static_cast<QAbstractItemModel*>(page.model()));
+    QCOMPARE(page.treeView()->model(), static_cast<QAbstractItemModel*>(page.model()));
+
+    QVERIFY(page.treeView()->uniformRowHeights());
+    QCOMPARE(page.tableView()->verticalHeader()->sectionResizeMode(0), QHeaderView::Fixed);
+}
+
+void TestStressPage::testRegenerateAppliesControls()
+{
+    StressPage page;
+    const QList<QSpinBox*> spinBoxes = page.findChildren<QSpinBox*>();
+    QCOMPARE(spinBoxes.size(), 4);
+
+    spinBoxes.at(0)->setValue(1234);
+    spinBoxes.at(1)->setValue(3);
+    spinBoxes.at(2)->setValue(0);
+    page.regenerate();
+
+    QCOMPARE(page.model()->rowCount(), 1234);
+    QCOMPARE(page.model()->columnCount(), 3);
+    QCOMPARE(page.model()->childrenPerRow(), 0);
+    QCOMPARE(page.tableView()->verticalHeader()->count(), 1234);
+}
+
+void TestStressPage::testScrollBenchmarkRequiresVisibleView()
+{
+    StressPage page;
+
+    QVERIFY(StressPage::runScrollBenchmark(page.tableView(), 10).isEmpty());
+    QVERIFY(StressPage::runScrollBenchmark(nullptr, 10).isEmpty());
+
+    StressPage::ScrollBenchmark empty;
+    QCOMPARE(empty.averageMs(), 0.0);
+    QCOMPARE(empty.percentileMs(95.0), 0.0);
+}
+
+void TestStressPage::testScrollBenchmarkRecordsFrames()
+{
+    StressPage page;
+    page.resize(800, 900);
+    page.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&page));
+
+    QScrollBar *scrollBar = page.tableView()->verticalScrollBar();
+    QVERIFY(scrollBar->maximum() > 0);
+    const int startValue = scrollBar->value();
+
+    const StressPage::ScrollBenchmark result = StressPage::runScrollBenchmark(page.tableView(), 12);
+    QCOMPARE(result.frameMs.size(), 12);
+    QVERIFY(result.averageMs() >= 0.0);
+    QVERIFY(result.percentileMs(95.0) <= result.maxMs());
+    QVERIFY(result.averageMs() <= result.maxMs());
+
+    // The view is left where it was
+    QCOMPARE(scrollBar->value(), startValue);
+
+    QVERIFY(!StressPage::runScrollBenchmark(page.treeView(), 5).isEmpty());
+}
+
+void TestStressPage::testSetWidgetsEnabled()
+{
+    StressPage page;
+
+    page.setWidgetsEnabled(false);
+    QVERIFY(!page.tableView()->isEnabled());
+    QVERIFY(!page.treeView()->isEnabled());
+    for (QSpinBox *spinBox : page.findChildren<QSpinBox*>()) {
+        QVERIFY(!spinBox->isEnabled());
+    }
+
+    page.setWidgetsEnabled(true);
+    QVERIFY(page.tableView()->isEnabled());
+    QVERIFY(page.treeView()->isEnabled());
+}
+
+void TestStressPage::testGalleryAddsStressPageOnce()
+{
+    WidgetGallery gallery(WidgetGallery::PageCreation::OnDemand);
+    const int standardPages = gallery.pageCount();
+
+    gallery.addStressPage();
+    gallery.addStressPage();
+    QCOMPARE(gallery.pageCount(), standardPages + 1);
+
+    // Nothing is built until the tab is shown
+    QVERIFY(gallery.findChild<StressPage*>() == nullptr);
+    QTabWidget *tabWidget = gallery.findChild<QTabWidget*>();
+    QVERIFY(tabWidget != nullptr);
+    tabWidget->setCurrentIndex(standardPages);
+    QVERIFY(qobject_cast<StressPage*>(gallery.page(standardPages)) != nullptr);
+}
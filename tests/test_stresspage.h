@@ -0,0 +1,36 @@
+#ifndef TEST_STRESSPAGE_H
+#define TEST_STRESSPAGE_H
+
+#include <QObject>
+#include <QtTest>
+
+/**
+ * @brief Test class for StressPage and GeneratedItemModel.
+ *
+ * Tests include:
+ * - Generated model dimensions, parents and data
+ * - Views sharing the model with uniform row heights
+ * - Scroll benchmark frame times
+ * - Enabled state propagation
+ */
+class TestStressPage : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    // Unit tests
+    void testModelDimensions();
+    void testModelTreeStructure();
+    void testModelSetDimensions();
+    void testViewsShareModel();
+    void testRegenerateAppliesControls();
+    void testScrollBenchmarkRequiresVisibleView();
+    void testScrollBenchmarkRecordsFrames();
+    void testSetWidgetsEnabled();
+    void testGalleryAddsStressPageOnce();
+};
+
+#endif // TEST_STRESSPAGE_H
@@ -12,6 +12,10 @@
 #include <QCoreApplication>
 #include <QSignalSpy>
 #include <QStyleFactory>
+#include <QWidget>
+#include <QPushButton>
+#include <QLabel>
+#include <QGroupBox>
 
 void TestStyleManager::initTestCase()
 {
@@ -1106,3 +1110,445 @@ void TestStyleManager::testTemplateDiscoveryReturnsOnlyQvpFiles()
                  qPrintable(QString("Other file '%1' should not be in availableTemplates()").arg(otherFile)));
     }
 }
+
+
+// ============================================================================
+// Apply Scope Tests
+// ============================================================================
+
+void TestStyleManager::testApplyScopeDefaultsToApplication()
+{
+    StyleManager manager;
+    QCOMPARE(manager.applyScope(), StyleManager::ApplyScope::Application);
+    QVERIFY(manager.scopeWidgets().isEmpty());
+    QCOMPARE(manager.lastApplyDurationMs(StyleManager::ApplyScope::Application), -1.0);
+    QCOMPARE(manager.lastApplyDurationMs(StyleManager::ApplyScope::Widgets), -1.0);
+}
+
+void TestStyleManager::testWidgetsScopeStylesOnlyScopeWidgets()
+{
+    QWidget scoped;
+    QWidget outside;
+    StyleManager manager;
+    manager.setScopeWidgets({&scoped});
+    manager.setApplyScope(StyleManager::ApplyScope::Widgets);
+
+    QString qss = "QLabel { color: red; }";
+    QSignalSpy appliedSpy(&manager, &StyleManager::styleApplied);
+    manager.applyStyleSheet(qss);
+
+    QCOMPARE(appliedSpy.count(), 1);
+    QCOMPARE(manager.currentStyleSheet(), qss);
+    QCOMPARE(scoped.styleSheet(), qss);
+    QVERIFY(outside.styleSheet().isEmpty());
+    QVERIFY(qApp->styleSheet().isEmpty());
+
+    manager.clearStyleSheet();
+    QVERIFY(scoped.styleSheet().isEmpty());
+    QVERIFY(!manager.hasCustomStyleSheet());
+}
+
+void TestStyleManager::testSwitchingScopeMovesStyleSheet()
+{
+    QWidget scoped;
+    StyleManager manager;
+    manager.setScopeWidgets({&scoped});
+
+    QString qss = "QPushButton { background: blue; }";
+    manager.applyStyleSheet(qss);
+    QCOMPARE(qApp->styleSheet(), qss);
+    QVERIFY(scoped.styleSheet().isEmpty());
+
+    // Switching to widgets scope moves the sheet off the application
+    manager.setApplyScope(StyleManager::ApplyScope::Widgets);
+    QVERIFY(qApp->styleSheet().isEmpty());
+    QCOMPARE(scoped.styleSheet(), qss);
+
+    // And switching back restores the global sheet
+    manager.setApplyScope(StyleManager::ApplyScope::Application);
+    QCOMPARE(qApp->styleSheet(), qss);
+    QVERIFY(scoped.styleSheet().isEmpty());
+
+    manager.clearStyleSheet();
+    QVERIFY(qApp->styleSheet().isEmpty());
+}
+
+void TestStyleManager::testApplyDurationTrackedPerScope()
+{
+    QWidget scoped;
+    StyleManager manager;
+    manager.setScopeWidgets({&scoped});
+
+    manager.setApplyScope(StyleManager::ApplyScope::Widgets);
+    manager.applyStyleSheet("QLabel { color: green; }");
+    QVERIFY(manager.lastApplyDurationMs(StyleManager::ApplyScope::Widgets) >= 0.0);
+    QCOMPARE(manager.lastApplyDurationMs(StyleManager::ApplyScope::Application), -1.0);
+
+    manager.setApplyScope(StyleManager::ApplyScope::Application);
+    QVERIFY(manager.lastApplyDurationMs(StyleManager::ApplyScope::Application) >= 0.0);
+
+    manager.clearStyleSheet();
+}
+
+
+// ============================================================================
+// Incremental Restyle Tests
+// ============================================================================
+
+void TestStyleManager::testIncrementalRestyleOverlaysAffectedWidgets()
+{
+    QWidget root;
+    QPushButton *button = new QPushButton("Plain", &root);
+    QPushButton *special = new QPushButton("Special", &root);
+    special->setObjectName("special");
+    QLabel *label = new QLabel("Label", &root);
+    for (int i = 0; i < 4; ++i) {
+        new QLabel(QString("Filler %1").arg(i), &root);
+    }
+
+    StyleManager manager;
+    manager.setScopeWidgets({&root});
+    manager.setApplyScope(StyleManager::ApplyScope::Widgets);
+    manager.setIncrementalRestyle(true);
+
+    QString first = "QPushButton { color: red; } QPushButton#special { color: navy; } "
+                    "QLabel { color: blue; }";
+    QString second = "QPushButton { color: green; } QPushButton#special { color: navy; } "
+                     "QLabel { color: blue; }";
+
+    manager.applyStyleSheet(first);
+    QVERIFY(!manager.lastApplyWasIncremental());
+
+    manager.applyStyleSheet(second);
+    QVERIFY(manager.lastApplyWasIncremental());
+    QCOMPARE(manager.lastRestyledWidgetCount(), 2);
+    QCOMPARE(manager.currentStyleSheet(), second);
+
+    // The installed sheet is untouched; only the buttons carry overlays
+    QCOMPARE(root.styleSheet(), first);
+    QVERIFY(button->styleSheet().contains("green"));
+    QVERIFY(special->styleSheet().contains("navy"));
+    QVERIFY(label->styleSheet().isEmpty());
+
+    // The overlay preserves the cascade of the new document
+    button->ensurePolished();
+    special->ensurePolished();
+    QCOMPARE(button->palette().color(button->foregroundRole()), QColor("green"));
+    QCOMPARE(special->palette().color(special->foregroundRole()), QColor("navy"));
+
+    // Reverting the edit drops the overlays again
+    manager.applyStyleSheet(first);
+    QVERIFY(manager.lastApplyWasIncremental());
+    QVERIFY(button->styleSheet().isEmpty());
+    QVERIFY(special->styleSheet().isEmpty());
+
+    manager.clearStyleSheet();
+}
+
+void TestStyleManager::testIncrementalRestyleFallsBackOnRemoval()
+{
+    QWidget root;
+    QLabel *label = new QLabel("Label", &root);
+    for (int i = 0; i < 4; ++i) {
+        new QPushButton(QString("Button %1").arg(i), &root);
+    }
+
+    StyleManager manager;
+    manager.setScopeWidgets({&root});
+    manager.setApplyScope(StyleManager::ApplyScope::Widgets);
+    manager.setIncrementalRestyle(true);
+
+    manager.applyStyleSheet("QLabel { color: red; padding: 2px; }");
+    manager.applyStyleSheet("QLabel { color: red; }");
+
+    QVERIFY(!manager.lastApplyWasIncremental());
+    QCOMPARE(root.styleSheet(), QString("QLabel { color: red; }"));
+    QVERIFY(label->styleSheet().isEmpty());
+
+    manager.clearStyleSheet();
+}
+
+void TestStyleManager::testIncrementalRestyleKeepsOverlays()
+{
+    QWidget root;
+    QPushButton *button = new QPushButton("Button", &root);
+    button->setObjectName("b0");
+    for (int i = 0; i < 4; ++i) {
+        new QLabel(QString("Label %1").arg(i), &root);
+    }
+
+    StyleManager manager;
+    manager.setScopeWidgets({&root});
+    manager.setApplyScope(StyleManager::ApplyScope::Widgets);
+    manager.setIncrementalRestyle(true);
+    QSignalSpy appliedSpy(&manager, &StyleManager::styleApplied);
+
+    // One rule per possible overlay rule, plus one
+    QStringList rules;
+    for (int i = 0; i <= StyleManager::MAX_OVERLAY_RULES; ++i) {
+        rules << QString("QPushButton#b%1 { color: red; }").arg(i);
+    }
+    const QString first = rules.join(' ');
+    manager.applyStyleSheet(first);
+    QCOMPARE(appliedSpy.count(), 1);
+
+    // Overlays are not replaced by a later full apply on their own
+    QString edited = first;
+    edited.replace("QPushButton#b0 { color: red; }", "QPushButton#b0 { color: green; }");
+    manager.applyStyleSheet(edited);
+    QVERIFY(manager.lastApplyWasIncremental());
+    QTest::qWait(50);
+    QCOMPARE(root.styleSheet(), first);
+    QVERIFY(button->styleSheet().contains("green"));
+    QCOMPARE(appliedSpy.count(), 2);
+
+    // Edits keep stacking onto the overlays up to the limit
+    for (int i = 1; i < StyleManager::MAX_OVERLAY_RULES; ++i) {
+        edited.replace(QString("QPushButton#b%1 { color: red; }").arg(i),
+                       QString("QPushButton#b%1 { color: green; }").arg(i));
+        manager.applyStyleSheet(edited);
+        QVERIFY(manager.lastApplyWasIncremental());
+    }
+
+    // One more changed rule installs the complete sheet instead
+    const int last = StyleManager::MAX_OVERLAY_RULES;
+    edited.replace(QString("QPushButton#b%1 { color: red; }").arg(last),
+                   QString("QPushButton#b%1 { color: green; }").arg(last));
+    manager.applyStyleSheet(edited);
+    QVERIFY(!manager.lastApplyWasIncremental());
+    QCOMPARE(root.styleSheet(), edited);
+    QVERIFY(button->styleSheet().isEmpty());
+
+    manager.clearStyleSheet();
+}
+
+void TestStyleManager::testIncrementalRestyleCountsDescendants()
+{
+    QWidget root;
+    QGroupBox *group = new QGroupBox("Group", &root);
+    new QPushButton("One", group);
+    new QPushButton("Two", group);
+    for (int i = 0; i < 4; ++i) {
+        new QLabel(QString("Label %1").arg(i), &root);
+    }
+
+    StyleManager manager;
+    manager.setScopeWidgets({&root});
+    manager.setApplyScope(StyleManager::ApplyScope::Widgets);
+    manager.setIncrementalRestyle(true);
+
+    manager.applyStyleSheet("QGroupBox { color: red; }");
+    manager.applyStyleSheet("QGroupBox { color: green; }");
+
+    // The overlay on the group re-polishes both of its buttons too
+    QVERIFY(manager.lastApplyWasIncremental());
+    QVERIFY(group->styleSheet().contains("green"));
+    QCOMPARE(manager.lastRestyledWidgetCount(), 3);
+
+    manager.clearStyleSheet();
+}
+
+
+// ============================================================================
+// Redundant Apply Tests
+// ============================================================================
+
+void TestStyleManager::testRedundantApplySkipped()
+{
+    StyleManager manager;
+    QSignalSpy appliedSpy(&manager, &StyleManager::styleApplied);
+    QSignalSpy skippedSpy(&manager, &StyleManager::styleApplySkipped);
+
+    QString qss = "QLabel { color: red; }";
+    manager.applyStyleSheet(qss);
+    QCOMPARE(appliedSpy.count(), 1);
+    QCOMPARE(manager.skippedApplyCount(), 0);
+
+    // Comment and whitespace edits do not restyle
+    QString reformatted = "/* note */\nQLabel {\n    color: red;\n}\n";
+    manager.applyStyleSheet(reformatted);
+    manager.applyStyleSheet(qss);
+    QCOMPARE(appliedSpy.count(), 1);
+    QCOMPARE(skippedSpy.count(), 2);
+    QCOMPARE(manager.skippedApplyCount(), 2);
+    QCOMPARE(manager.currentStyleSheet(), qss);
+    QCOMPARE(qApp->styleSheet(), qss);
+
+    // A real change is applied
+    manager.applyStyleSheet("QLabel { color: blue; }");
+    QCOMPARE(appliedSpy.count(), 2);
+    QCOMPARE(manager.skippedApplyCount(), 2);
+
+    // Clearing forgets the applied content
+    manager.clearStyleSheet();
+    manager.applyStyleSheet("QLabel { color: blue; }");
+    QCOMPARE(appliedSpy.count(), 3);
+
+    manager.clearStyleSheet();
+}
+
+void TestStyleManager::testSkipRequiresInstalledStyleSheet()
+{
+    StyleManager manager;
+    QString qss = "QPushButton { color: red; }";
+    manager.applyStyleSheet(qss);
+
+    // Replacing the application sheet directly invalidates the applied state
+    qApp->setStyleSheet(QString());
+    manager.applyStyleSheet(qss);
+
+    QCOMPARE(manager.skippedApplyCount(), 0);
+    QCOMPARE(qApp->styleSheet(), qss);
+
+    manager.clearStyleSheet();
+}
+
+void TestStyleManager::testApplyChangedRulesRestylesHintedRules()
+{
+    QWidget root;
+    QPushButton *button = new QPushButton("Button", &root);
+    QLabel *label = new QLabel("Label", &root);
+    for (int i = 0; i < 4; ++i) {
+        new QLabel(QString("Filler %1").arg(i), &root);
+    }
+    label->setObjectName("title");
+
+    StyleManager manager;
+    manager.setScopeWidgets({&root});
+    manager.setApplyScope(StyleManager::ApplyScope::Widgets);
+    manager.setIncrementalRestyle(true);
+    QSignalSpy skippedSpy(&manager, &StyleManager::styleApplySkipped);
+
+    QString first = "/* accent: red */ QPushButton { color: red; } QLabel#title { color: blue; }";
+    QString second = "/* accent: green */ QPushButton { color: green; } QLabel#title { color: blue; }";
+    QString third = "/* accent: green */ QPushButton { color: green; } QLabel#title { color: navy; }";
+
+    manager.applyStyleSheet(first);
+
+    // Only the button rule is hinted, so only the button is restyled
+    manager.applyChangedRules(second, first, {0});
+    QVERIFY(manager.lastApplyWasIncremental());
+    QCOMPARE(manager.lastRestyledWidgetCount(), 1);
+    QVERIFY(button->styleSheet().contains("green"));
+    QVERIFY(label->styleSheet().isEmpty());
+
+    // Earlier changes stay in the overlay set
+    manager.applyChangedRules(third, second, {1});
+    QVERIFY(manager.lastApplyWasIncremental());
+    QVERIFY(button->styleSheet().contains("green"));
+    QVERIFY(label->styleSheet().contains("navy"));
+    QCOMPARE(manager.currentStyleSheet(), third);
+
+    // No changed rules means only comments differ
+    QString commented = third;
+    commented.replace("accent: green", "accent: lime");
+    manager.applyChangedRules(commented, third, {});
+    QCOMPARE(skippedSpy.count(), 1);
+    QCOMPARE(manager.currentStyleSheet(), commented);
+
+    // A plain apply afterwards still detects redundant content
+    manager.applyStyleSheet(third);
+    QCOMPARE(skippedSpy.count(), 2);
+
+    manager.clearStyleSheet();
+}
+
+void TestStyleManager::testApplyChangedRulesIgnoresStaleHint()
+{
+    StyleManager manager;
+    QSignalSpy appliedSpy(&manager, &StyleManager::styleApplied);
+
+    manager.applyStyleSheet("QLabel { color: red; }");
+
+    // The hint is relative to a sheet that is not current, so the new sheet
+    // is applied in full even though no rules are listed
+    manager.applyChangedRules("QLabel { color: blue; }", "QLabel { color: green; }", {});
+    QCOMPARE(appliedSpy.count(), 2);
+    QCOMPARE(manager.skippedApplyCount(), 0);
+    QCOMPARE(qApp->styleSheet(), QString("QLabel { color: blue; }"));
+
+    manager.clearStyleSheet();
+}
+
+
+// ============================================================================
+// Deferred Restyle Tests
+// ============================================================================
+
+void TestStyleManager::testDeferredRestyleSkipsHiddenScopeWidgets()
+{
+    QWidget shown;
+    for (int i = 0; i < 3; ++i) {
+        new QLabel(QString("Shown %1").arg(i), &shown);
+    }
+    QWidget hidden;
+    for (int i = 0; i < 5; ++i) {
+        new QLabel(QString("Hidden %1").arg(i), &hidden);
+    }
+    shown.show();
+
+    StyleManager manager;
+    manager.setScopeWidgets({&shown, &hidden});
+    manager.setApplyScope(StyleManager::ApplyScope::Widgets);
+    manager.setDeferredRestyle(true);
+    QVERIFY(manager.isDeferredRestyle());
+    QSignalSpy deferredSpy(&manager, &StyleManager::deferredRestyleApplied);
+
+    QString qss = "QLabel { color: red; }";
+    manager.applyStyleSheet(qss);
+
+    // Only the visible subtree is polished
+    QCOMPARE(shown.styleSheet(), qss);
+    QVERIFY(hidden.styleSheet().isEmpty());
+    QCOMPARE(manager.staleScopeWidgetCount(), 1);
+    QCOMPARE(manager.lastRestyledWidgetCount(), 4);
+
+    // A stale widget still counts as installed, so repeats are skipped
+    manager.applyStyleSheet(qss);
+    QCOMPARE(manager.skippedApplyCount(), 1);
+
+    // Showing the hidden widget catches it up
+    hidden.show();
+    QCOMPARE(hidden.styleSheet(), qss);
+    QCOMPARE(manager.staleScopeWidgetCount(), 0);
+    QCOMPARE(deferredSpy.count(), 1);
+    QCOMPARE(deferredSpy.at(0).at(0).value<QWidget*>(), &hidden);
+    QCOMPARE(deferredSpy.at(0).at(1).toInt(), 6);
+
+    // Widgets added later are deferred the same way
+    QWidget added;
+    manager.addScopeWidget(&added);
+    QCOMPARE(manager.staleScopeWidgetCount(), 1);
+    added.show();
+    QCOMPARE(added.styleSheet(), qss);
+
+    manager.clearStyleSheet();
+    QVERIFY(shown.styleSheet().isEmpty());
+    QVERIFY(hidden.styleSheet().isEmpty());
+    QVERIFY(added.styleSheet().isEmpty());
+}
+
+void TestStyleManager::testDisablingDeferredRestyleRestylesStaleWidgets()
+{
+    QWidget hidden;
+    new QLabel("Label", &hidden);
+
+    StyleManager manager;
+    manager.setScopeWidgets({&hidden});
+    manager.setApplyScope(StyleManager::ApplyScope::Widgets);
+    manager.setDeferredRestyle(true);
+
+    QString qss = "QLabel { color: blue; }";
+    manager.applyStyleSheet(qss);
+    QVERIFY(hidden.styleSheet().isEmpty());
+
+    manager.setDeferredRestyle(false);
+    QCOMPARE(hidden.styleSheet(), qss);
+    QCOMPARE(manager.staleScopeWidgetCount(), 0);
+
+    // Without deferral hidden widgets are styled right away
+    manager.applyStyleSheet("QLabel { color: green; }");
+    QCOMPARE(hidden.styleSheet(), QString("QLabel { color: green; }"));
+
+    manager.clearStyleSheet();
+}
@@ -56,6 +56,30 @@ private slots:
     void testStyleApplicationConsistencyProperty();
     void testStyleApplicationConsistencyProperty_data();
     
+    // Apply scope tests
+    void testApplyScopeDefaultsToApplication();
+    void testWidgetsScopeStylesOnlyScopeWidgets();
+    void testSwitchingScopeMovesStyleSheet();
+    void testApplyDurationTrackedPerScope();
+    
+    // Incremental restyle tests
+    void testIncrementalRestyleOverlaysAffectedWidgets();
+    void testIncrementalRestyleFallsBackOnRemoval();
+    void testIncrementalRestyleKeepsOverlays();
+    void testIncrementalRestyleCountsDescendants();
+    
+    // Redundant apply tests
+    void testRedundantApplySkipped();
+    void testSkipRequiresInstalledStyleSheet();
+
+    // Hinted apply tests
+    void testApplyChangedRulesRestylesHintedRules();
+    void testApplyChangedRulesIgnoresStaleHint();
+
+    // Deferred restyle tests
+    void testDeferredRestyleSkipsHiddenScopeWidgets();
+    void testDisablingDeferredRestyleRestylesStaleWidgets();
+    
     // Feature: load-template-project-files
     // Property 1: Template Discovery Returns Only QVP Files
     void testTemplateDiscoveryReturnsOnlyQvpFiles();
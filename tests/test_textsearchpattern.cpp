@@ -0,0 +1,246 @@
+#include "test_textsearchpattern.h"
+#include "TextSearchPattern.h"
+
+#include <QRandomGenerator>
+
+namespace {
+
+QVector<int> starts(const QVector<TextMatch> &matches)
+{
+    QVector<int> result;
+    for (const TextMatch &match : matches) {
+        result.append(match.start);
+    }
+    return result;
+}
+
+/**
+ * Non-overlapping occurrences as QString::indexOf() finds them.
+ */
+QVector<int> indexOfStarts(const QString &text, const QString &query, Qt::CaseSensitivity cs)
+{
+    QVector<int> result;
+    int from = 0;
+    int index;
+    while ((index = text.indexOf(query, from, cs)) >= 0) {
+        result.append(index);
+        from = index + query.size();
+    }
+    return result;
+}
+
+} // namespace
+
+// ============================================================================
+// Unit Tests
+// ============================================================================
+
+void TestTextSearchPattern::testEmptyPatternMatchesNothing()
+{
+    QVERIFY(TextSearchPattern().findAll(QStringLiteral("anything")).isEmpty());
+    QVERIFY(TextSearchPattern(QString(), TextSearchPattern::NoOptions).isEmpty());
+    QVERIFY(TextSearchPattern(QString(), TextSearchPattern::RegularExpression)
+                .findAll(QStringLiteral("anything")).isEmpty());
+}
+
+void TestTextSearchPattern::testLiteralIsNonOverlapping()
+{
+    const TextSearchPattern pattern(QStringLiteral("aa"), TextSearchPattern::NoOptions);
+    QCOMPARE(starts(pattern.findAll(QStringLiteral("aaaaa"))), QVector<int>({0, 2}));
+    QCOMPARE(pattern.findAll(QStringLiteral("aaaaa")).first().length, 2);
+}
+
+void TestTextSearchPattern::testCaseFolding()
+{
+    const QString text = QStringLiteral("Color COLOR color cOLOR");
+    QCOMPARE(TextSearchPattern(QStringLiteral("color"), TextSearchPattern::NoOptions)
+                 .findAll(text).size(), 4);
+    QCOMPARE(starts(TextSearchPattern(QStringLiteral("color"), TextSearchPattern::CaseSensitive)
+                        .findAll(text)), QVector<int>({12}));
+
+    // Non-ASCII letters fold too
+    QCOMPARE(TextSearchPattern(QStringLiteral("ÄRGER"), TextSearchPattern::NoOptions)
+                 .findAll(QStringLiteral("kein ärger")).size(), 1);
+}
+
+void TestTextSearchPattern::testWholeWords()
+{
+    const TextSearchPattern pattern(QStringLiteral("color"), TextSearchPattern::WholeWords);
+    const QString text = QStringLiteral("color border-color colors _color color_ (color)");
+    QCOMPARE(starts(pattern.findAll(text)), QVector<int>({0, 13, 41}));
+
+    // A rejected occurrence does not hide an overlapping whole word
+    const TextSearchPattern doubled(QStringLiteral("aa"), TextSearchPattern::WholeWords);
+    QCOMPARE(starts(doubled.findAll(QStringLiteral("aaa aa"))), QVector<int>({4}));
+}
+
+void TestTextSearchPattern::testRegularExpressionIsLineBased()
+{
+    const TextSearchPattern pattern(QStringLiteral("^\\w+:"), TextSearchPattern::RegularExpression);
+    QVERIFY(pattern.isLineBased());
+    const QString text = QStringLiteral("color: red;\n  margin: 0;\npadding: 2px;");
+    QCOMPARE(starts(pattern.findAll(text)), QVector<int>({0, 25}));
+
+    // A match never spans a line break
+    const TextSearchPattern spanning(QStringLiteral("red;.margin"), TextSearchPattern::RegularExpression);
+    QVERIFY(spanning.findAll(text).isEmpty());
+}
+
+void TestTextSearchPattern::testEmptyRegularExpressionMatchesAreSkipped()
+{
+    const TextSearchPattern pattern(QStringLiteral("a*"), TextSearchPattern::RegularExpression);
+    const QVector<TextMatch> matches = pattern.findAll(QStringLiteral("baab\naaa"));
+    QCOMPARE(starts(matches), QVector<int>({1, 5}));
+    QCOMPARE(matches.at(0).length, 2);
+    QCOMPARE(matches.at(1).length, 3);
+}
+
+void TestTextSearchPattern::testInvalidRegularExpression()
+{
+    const TextSearchPattern pattern(QStringLiteral("(red"), TextSearchPattern::RegularExpression);
+    QVERIFY(!pattern.isValid());
+    QVERIFY(!pattern.errorString().isEmpty());
+    QVERIFY(pattern.findAll(QStringLiteral("(red")).isEmpty());
+
+    const TextSearchPattern literal(QStringLiteral("(red"), TextSearchPattern::NoOptions);
+    QVERIFY(literal.isValid());
+    QVERIFY(literal.errorString().isEmpty());
+    QCOMPARE(literal.findAll(QStringLiteral("(red")).size(), 1);
+}
+
+void TestTextSearchPattern::testReplacementExpandsCaptures()
+{
+    const QString line = QStringLiteral("  border: 1px solid red;");
+    const TextSearchPattern pattern(QStringLiteral("(\\d+)px (\\w+)"),
+                                    TextSearchPattern::RegularExpression);
+    const QVector<TextMatch> matches = pattern.findAll(line);
+    QCOMPARE(matches.size(), 1);
+
+    QCOMPARE(pattern.replacementFor(line, 0, matches.first(), QStringLiteral("$2 \\1pt")),
+             QStringLiteral("solid 1pt"));
+    QCOMPARE(pattern.replacementFor(line, 0, matches.first(), QStringLiteral("[\\0]\\t\\\\")),
+             QStringLiteral("[1px solid]\t\\"));
+
+    // Line offsets are relative to the text the match refers to
+    TextMatch shifted = matches.first();
+    shifted.start += 100;
+    QCOMPARE(pattern.replacementFor(line, 100, shifted, QStringLiteral("$1")), QStringLiteral("1"));
+
+    // Literal patterns insert the replacement unchanged
+    const TextSearchPattern literal(QStringLiteral("1px"), TextSearchPattern::NoOptions);
+    QCOMPARE(literal.replacementFor(line, 0, literal.findAll(line).first(), QStringLiteral("$1")),
+             QStringLiteral("$1"));
+}
+
+// ============================================================================
+// Property 1: Literal search agrees with QString::indexOf
+// ============================================================================
+
+void TestTextSearchPattern::testLiteralMatchesIndexOf_data()
+{
+    QTest::addColumn<QString>("text");
+    QTest::addColumn<QString>("query");
+    QTest::addColumn<bool>("caseSensitive");
+
+    QRandomGenerator *rng = QRandomGenerator::global();
+
+    // A small alphabet makes partial and repeated matches common
+    const QString alphabet = QStringLiteral("abAB-#\n ");
+    for (int i = 0; i < 200; ++i) {
+        QString text;
+        const int textLength = rng->generate() % 200;
+        for (int j = 0; j < textLength; ++j) {
+            text += alphabet.at(rng->generate() % alphabet.size());
+        }
+        QString query;
+        const int queryLength = 1 + rng->generate() % 5;
+        for (int j = 0; j < queryLength; ++j) {
+            query += alphabet.at(rng->generate() % alphabet.size());
+        }
+        QTest::newRow(qPrintable(QString("literal_%1").arg(i)))
+            << text << query << bool(rng->generate() % 2);
+    }
+}
+
+void TestTextSearchPattern::testLiteralMatchesIndexOf()
+{
+    // Feature: find-replace, Property 1: Literal search agrees with QString::indexOf
+
+    QFETCH(QString, text);
+    QFETCH(QString, query);
+    QFETCH(bool, caseSensitive);
+
+    const TextSearchPattern pattern(query, caseSensitive ? TextSearchPattern::CaseSensitive
+                                                         : TextSearchPattern::NoOptions);
+    QCOMPARE(starts(pattern.findAll(text)),
+             indexOfStarts(text, query, caseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive));
+}
+
+// ============================================================================
+// Property 2: Scanning in ranges equals one full scan
+// ============================================================================
+
+void TestTextSearchPattern::testRangesMatchFullScan_data()
+{
+    QTest::addColumn<QString>("text");
+    QTest::addColumn<QString>("query");
+    QTest::addColumn<int>("options");
+    QTest::addColumn<int>("chunkSize");
+
+    QRandomGenerator *rng = QRandomGenerator::global();
+
+    const QStringList words = { "color", "col", "a", "aa", "b", "_", " ", "\n", "-" };
+    const QStringList literals = { "color", "aa", "a", "col" };
+    const QStringList expressions = { "col(or)?", "a+", "^a", "b$", "\\ba\\w*" };
+
+    for (int i = 0; i < 100; ++i) {
+        QString text;
+        const int wordCount = rng->generate() % 80;
+        for (int j = 0; j < wordCount; ++j) {
+            text += words[rng->generate() % words.size()];
+        }
+
+        int options = TextSearchPattern::NoOptions;
+        if (rng->generate() % 2) {
+            options |= TextSearchPattern::CaseSensitive;
+        }
+        if (rng->generate() % 3 == 0) {
+            options |= TextSearchPattern::WholeWords;
+        }
+        const bool regularExpression = rng->generate() % 3 == 0;
+        if (regularExpression) {
+            options |= TextSearchPattern::RegularExpression;
+        }
+        const QString query = regularExpression ? expressions[rng->generate() % expressions.size()]
+                                                : literals[rng->generate() % literals.size()];
+
+        QTest::newRow(qPrintable(QString("ranges_%1").arg(i)))
+            << text << query << options << int(1 + rng->generate() % 16);
+    }
+}
+
+void TestTextSearchPattern::testRangesMatchFullScan()
+{
+    // Feature: find-replace, Property 2: Scanning in ranges equals one full scan
+
+    QFETCH(QString, text);
+    QFETCH(QString, query);
+    QFETCH(int, options);
+    QFETCH(int, chunkSize);
+
+    const TextSearchPattern pattern(query, TextSearchPattern::Options(QFlag(options)));
+
+    // The background search scans fixed-size chunks, resuming where the
+    // previous chunk left off
+    QVector<TextMatch> chunked;
+    int position = 0;
+    while (position < text.size()) {
+        position = pattern.findInRange(text, position, position + chunkSize, &chunked);
+    }
+
+    const QVector<TextMatch> full = pattern.findAll(text);
+    QCOMPARE(starts(chunked), starts(full));
+    for (int i = 0; i < full.size(); ++i) {
+        QCOMPARE(chunked.at(i).length, full.at(i).length);
+    }
+}
@@ -0,0 +1,31 @@
+#ifndef TEST_TEXTSEARCHPATTERN_H
+#define TEST_TEXTSEARCHPATTERN_H
+
+#include <QObject>
+#include <QtTest>
+
+class TestTextSearchPattern : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    // Unit tests
+    void testEmptyPatternMatchesNothing();
+    void testLiteralIsNonOverlapping();
+    void testCaseFolding();
+    void testWholeWords();
+    void testRegularExpressionIsLineBased();
+    void testEmptyRegularExpressionMatchesAreSkipped();
+    void testInvalidRegularExpression();
+    void testReplacementExpandsCaptures();
+
+    // Property-based tests
+    // Property 1: Literal search agrees with QString::indexOf
+    void testLiteralMatchesIndexOf_data();
+    void testLiteralMatchesIndexOf();
+    // Property 2: Scanning in ranges equals one full scan
+    void testRangesMatchFullScan_data();
+    void testRangesMatchFullScan();
+};
+
+#endif // TEST_TEXTSEARCHPATTERN_H
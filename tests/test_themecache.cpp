@@ -0,0 +1,259 @@
+#include "test_themecache.h"
+#include "ThemeCache.h"
+#include "VariableManager.h"
+
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QFile>
+#include <QRandomGenerator>
+
+namespace {
+
+const QString THEME_TEMPLATE = QStringLiteral(
+    "QWidget { background-color: ${background}; color: ${foreground}; }\n"
+    "QPushButton { border-radius: ${radius}; }\n");
+
+bool writeProject(const QString &filePath, const QMap<QString, QString> &variables,
+                  const QString &qssTemplate = THEME_TEMPLATE)
+{
+    VariableManager manager;
+    for (auto it = variables.constBegin(); it != variables.constEnd(); ++it) {
+        manager.setVariable(it.key(), it.value());
+    }
+    return manager.saveProject(filePath, qssTemplate);
+}
+
+bool writeFile(const QString &filePath, const QByteArray &content)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+    return file.write(content) == content.size();
+}
+
+QMap<QString, QString> darkVariables()
+{
+    QMap<QString, QString> variables;
+    variables.insert(QStringLiteral("background"), QStringLiteral("#1e1e1e"));
+    variables.insert(QStringLiteral("foreground"), QStringLiteral("#cccccc"));
+    variables.insert(QStringLiteral("radius"), QStringLiteral("6px"));
+    return variables;
+}
+
+} // namespace
+
+void TestThemeCache::testResolvesProjectVariables()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QVERIFY(writeProject(dir.filePath(QStringLiteral("dark.qvp")), darkVariables()));
+
+    ThemeCache cache;
+    cache.setTemplatesPath(dir.path());
+
+    const QString qss = cache.styleSheet(QStringLiteral("dark"));
+    QVERIFY(qss.contains(QStringLiteral("background-color: #1e1e1e")));
+    QVERIFY(qss.contains(QStringLiteral("border-radius: 6px")));
+    QVERIFY(!qss.contains(QStringLiteral("${")));
+}
+
+void TestThemeCache::testFallsBackToStyleSheet()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QVERIFY(writeFile(dir.filePath(QStringLiteral("light.qss")),
+                      "QWidget { background-color: #ffffff; }"));
+
+    ThemeCache cache;
+    cache.setTemplatesPath(dir.path());
+
+    QCOMPARE(cache.styleSheet(QStringLiteral("light")),
+             QStringLiteral("QWidget { background-color: #ffffff; }"));
+}
+
+void TestThemeCache::testProjectTakesPrecedence()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QVERIFY(writeProject(dir.filePath(QStringLiteral("dark.qvp")), darkVariables()));
+    QVERIFY(writeFile(dir.filePath(QStringLiteral("dark.qss")), "QWidget { color: red; }"));
+
+    ThemeCache cache;
+    cache.setTemplatesPath(dir.path());
+
+    QVERIFY(cache.styleSheet(QStringLiteral("dark")).contains(QStringLiteral("#1e1e1e")));
+}
+
+void TestThemeCache::testMissingTemplateIsEmpty()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    ThemeCache cache;
+    cache.setTemplatesPath(dir.path());
+    QSignalSpy errorSpy(&cache, &ThemeCache::loadError);
+
+    QVERIFY(cache.styleSheet(QStringLiteral("light")).isEmpty());
+    QVERIFY(cache.contains(QStringLiteral("light")));
+    QCOMPARE(cache.loadCount(), 0);
+    QCOMPARE(errorSpy.count(), 0);
+}
+
+void TestThemeCache::testLoadsEachTemplateOnce()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QVERIFY(writeProject(dir.filePath(QStringLiteral("dark.qvp")), darkVariables()));
+    QVERIFY(writeFile(dir.filePath(QStringLiteral("light.qss")), "QWidget { color: black; }"));
+
+    ThemeCache cache;
+    cache.setTemplatesPath(dir.path());
+    cache.preload(QStringList() << QStringLiteral("dark") << QStringLiteral("light"));
+    QCOMPARE(cache.loadCount(), 2);
+
+    const QString dark = cache.styleSheet(QStringLiteral("dark"));
+    for (int i = 0; i < 10; ++i) {
+        QCOMPARE(cache.styleSheet(QStringLiteral("dark")), dark);
+        QCOMPARE(cache.styleSheet(QStringLiteral("light")), QStringLiteral("QWidget { color: black; }"));
+    }
+    QCOMPARE(cache.loadCount(), 2);
+}
+
+void TestThemeCache::testChangedTemplateIsReloaded()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString projectPath = dir.filePath(QStringLiteral("dark.qvp"));
+    QVERIFY(writeProject(projectPath, darkVariables()));
+
+    ThemeCache cache;
+    cache.setTemplatesPath(dir.path());
+    QVERIFY(cache.styleSheet(QStringLiteral("dark")).contains(QStringLiteral("#1e1e1e")));
+
+    QSignalSpy spy(&cache, &ThemeCache::templateReloaded);
+
+    QMap<QString, QString> variables = darkVariables();
+    variables.insert(QStringLiteral("background"), QStringLiteral("#000000"));
+    QVERIFY(writeProject(projectPath, variables));
+
+    QTRY_VERIFY_WITH_TIMEOUT(spy.count() >= 1, 5000);
+    QCOMPARE(spy.at(0).at(0).toString(), QStringLiteral("dark"));
+    QVERIFY(cache.contains(QStringLiteral("dark")));
+
+    const int loads = cache.loadCount();
+    QVERIFY(cache.styleSheet(QStringLiteral("dark")).contains(QStringLiteral("#000000")));
+    QCOMPARE(cache.loadCount(), loads);
+}
+
+void TestThemeCache::testNewTemplateIsPickedUp()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    ThemeCache cache;
+    cache.setTemplatesPath(dir.path());
+    QVERIFY(cache.styleSheet(QStringLiteral("light")).isEmpty());
+
+    QSignalSpy spy(&cache, &ThemeCache::templateReloaded);
+    QVERIFY(writeFile(dir.filePath(QStringLiteral("light.qss")), "QWidget { color: black; }"));
+
+    QTRY_VERIFY_WITH_TIMEOUT(spy.count() >= 1, 5000);
+    QCOMPARE(cache.styleSheet(QStringLiteral("light")), QStringLiteral("QWidget { color: black; }"));
+}
+
+void TestThemeCache::testInvalidProjectReportsError()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QVERIFY(writeFile(dir.filePath(QStringLiteral("dark.qvp")), "{ not json"));
+
+    ThemeCache cache;
+    cache.setTemplatesPath(dir.path());
+    QSignalSpy errorSpy(&cache, &ThemeCache::loadError);
+
+    QVERIFY(cache.styleSheet(QStringLiteral("dark")).isEmpty());
+    QCOMPARE(errorSpy.count(), 1);
+    QVERIFY(errorSpy.at(0).at(0).toString().contains(QStringLiteral("dark")));
+
+    // The failure is cached too, until the file changes
+    QVERIFY(cache.styleSheet(QStringLiteral("dark")).isEmpty());
+    QCOMPARE(errorSpy.count(), 1);
+}
+
+void TestThemeCache::testTemplatesPathChangeClearsCache()
+{
+    QTemporaryDir first;
+    QTemporaryDir second;
+    QVERIFY(first.isValid());
+    QVERIFY(second.isValid());
+    QVERIFY(writeFile(first.filePath(QStringLiteral("dark.qss")), "QWidget { color: white; }"));
+    QVERIFY(writeFile(second.filePath(QStringLiteral("dark.qss")), "QWidget { color: gray; }"));
+
+    ThemeCache cache;
+    cache.setTemplatesPath(first.path());
+    QCOMPARE(cache.styleSheet(QStringLiteral("dark")), QStringLiteral("QWidget { color: white; }"));
+
+    cache.setTemplatesPath(second.path());
+    QVERIFY(!cache.contains(QStringLiteral("dark")));
+    QCOMPARE(cache.styleSheet(QStringLiteral("dark")), QStringLiteral("QWidget { color: gray; }"));
+    QCOMPARE(cache.templatesPath(), second.path());
+}
+
+/**
+ * Feature: theme-cache, Property 1: Cached Resolution Matches Direct Substitution
+ *
+ * For any set of variable values, the stylesheet the cache resolves from a
+ * project equals VariableManager::substitute() over the loaded project.
+ */
+void TestThemeCache::testCachedResolutionProperty_data()
+{
+    QTest::addColumn<QString>("background");
+    QTest::addColumn<QString>("foreground");
+    QTest::addColumn<QString>("radius");
+
+    auto randomColor = []() {
+        return QStringLiteral("#%1").arg(QRandomGenerator::global()->generate() % 0x1000000,
+                                         6, 16, QLatin1Char('0'));
+    };
+
+    for (int i = 0; i < 100; ++i) {
+        // Some values reference other variables
+        const QString foreground = (QRandomGenerator::global()->generate() % 4 == 0)
+            ? QStringLiteral("${background}") : randomColor();
+        QTest::newRow(qPrintable(QStringLiteral("resolution_%1").arg(i)))
+            << randomColor()
+            << foreground
+            << QStringLiteral("%1px").arg(QRandomGenerator::global()->generate() % 16);
+    }
+}
+
+void TestThemeCache::testCachedResolutionProperty()
+{
+    // Feature: theme-cache, Property 1: Cached Resolution Matches Direct Substitution
+
+    QFETCH(QString, background);
+    QFETCH(QString, foreground);
+    QFETCH(QString, radius);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString projectPath = dir.filePath(QStringLiteral("theme.qvp"));
+
+    QMap<QString, QString> variables;
+    variables.insert(QStringLiteral("background"), background);
+    variables.insert(QStringLiteral("foreground"), foreground);
+    variables.insert(QStringLiteral("radius"), radius);
+    QVERIFY(writeProject(projectPath, variables));
+
+    VariableManager manager;
+    QString qssTemplate;
+    QVERIFY(manager.loadProject(projectPath, qssTemplate));
+    const QString expected = manager.substitute(qssTemplate);
+
+    ThemeCache cache;
+    cache.setTemplatesPath(dir.path());
+    QCOMPARE(cache.styleSheet(QStringLiteral("theme")), expected);
+    QCOMPARE(cache.styleSheet(QStringLiteral("theme")), expected);
+    QCOMPARE(cache.loadCount(), 1);
+}
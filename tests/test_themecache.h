@@ -0,0 +1,29 @@
+#ifndef TEST_THEMECACHE_H
+#define TEST_THEMECACHE_H
+
+#include <QObject>
+#include <QtTest>
+
+class TestThemeCache : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    // Unit tests
+    void testResolvesProjectVariables();
+    void testFallsBackToStyleSheet();
+    void testProjectTakesPrecedence();
+    void testMissingTemplateIsEmpty();
+    void testLoadsEachTemplateOnce();
+    void testChangedTemplateIsReloaded();
+    void testNewTemplateIsPickedUp();
+    void testInvalidProjectReportsError();
+    void testTemplatesPathChangeClearsCache();
+
+    // Property-based tests
+    // Property 1: Cached Resolution Matches Direct Substitution
+    void testCachedResolutionProperty();
+    void testCachedResolutionProperty_data();
+};
+
+#endif // TEST_THEMECACHE_H
@@ -1,6 +1,8 @@
 #include "test_thememanager.h"
 #include "ThemeManager.h"
 #include "StyleManager.h"
+#include "ThemeCache.h"
+#include "VariableManager.h"
 
 #include <QSettings>
 #include <QSignalSpy>
@@ -8,6 +10,53 @@
 #include <QFile>
 #include <QRandomGenerator>
 #include <QCoreApplication>
+#include <QDir>
+
+#if QT_VERSION >= QT_VERSION_CHECK(6, 5, 0)
+#include <QGuiApplication>
+#include <QStyleHints>
+#endif
+
+namespace {
+
+/**
+ * @brief Points HOME at another directory for the lifetime of the object.
+ */
+class HomeOverride
+{
+public:
+    explicit HomeOverride(const QString &path)
+        : m_hadHome(qEnvironmentVariableIsSet("HOME"))
+        , m_home(qgetenv("HOME"))
+    {
+        qputenv("HOME", QFile::encodeName(path));
+    }
+
+    ~HomeOverride()
+    {
+        if (m_hadHome) {
+            qputenv("HOME", m_home);
+        } else {
+            qunsetenv("HOME");
+        }
+    }
+
+private:
+    bool m_hadHome;
+    QByteArray m_home;
+};
+
+bool writeGtkTheme(const QString &settingsPath, const QString &themeName)
+{
+    QFile file(settingsPath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        return false;
+    }
+    file.write(QStringLiteral("[Settings]\ngtk-theme-name=%1\n").arg(themeName).toUtf8());
+    return true;
+}
+
+} // namespace
 
 void TestThemeManager::initTestCase()
 {
@@ -28,6 +77,7 @@ void TestThemeManager::init()
     // Clear settings before each test
     QSettings settings;
     settings.remove(QStringLiteral("appearance/themeMode"));
+    settings.remove(QStringLiteral("appearance/lastSystemDark"));
 }
 
 void TestThemeManager::cleanup()
@@ -35,6 +85,7 @@ void TestThemeManager::cleanup()
     // Clean up after each test
     QSettings settings;
     settings.remove(QStringLiteral("appearance/themeMode"));
+    settings.remove(QStringLiteral("appearance/lastSystemDark"));
 }
 
 void TestThemeManager::testDefaultModeIsSystem()
@@ -73,6 +124,141 @@ void TestThemeManager::testEffectiveThemeResolvesSystem()
             effective == ThemeManager::ThemeMode::Light);
 }
 
+void TestThemeManager::testSystemThemeFollowsSettingsFile()
+{
+#ifndef Q_OS_LINUX
+    QSKIP("The GTK settings file is only consulted on Linux");
+#else
+#if QT_VERSION >= QT_VERSION_CHECK(6, 5, 0)
+    if (QGuiApplication::styleHints()->colorScheme() != Qt::ColorScheme::Unknown) {
+        QSKIP("The platform theme reports the color scheme");
+    }
+#endif
+
+    QTemporaryDir home;
+    QVERIFY(home.isValid());
+    QVERIFY(QDir(home.path()).mkpath(QStringLiteral(".config/gtk-3.0")));
+    const QString settingsPath = home.path() + QStringLiteral("/.config/gtk-3.0/settings.ini");
+    QVERIFY(writeGtkTheme(settingsPath, QStringLiteral("Adwaita-dark")));
+
+    HomeOverride homeOverride(home.path());
+
+    StyleManager styleManager;
+    ThemeManager themeManager(&styleManager);
+    QCOMPARE(themeManager.currentMode(), ThemeManager::ThemeMode::System);
+    QVERIFY(themeManager.isSystemDarkMode());
+    QCOMPARE(themeManager.effectiveTheme(), ThemeManager::ThemeMode::Dark);
+
+    QSignalSpy spy(&themeManager, &ThemeManager::effectiveThemeChanged);
+
+    // Editing the file is noticed without polling
+    QVERIFY(writeGtkTheme(settingsPath, QStringLiteral("Adwaita")));
+    QTRY_COMPARE_WITH_TIMEOUT(spy.count(), 1, 5000);
+    QCOMPARE(spy.at(0).at(0).value<ThemeManager::ThemeMode>(), ThemeManager::ThemeMode::Light);
+    QVERIFY(!themeManager.isSystemDarkMode());
+
+    // So is replacing it, which drops the file from the watch list
+    const QString replacementPath = settingsPath + QStringLiteral(".new");
+    QVERIFY(writeGtkTheme(replacementPath, QStringLiteral("Adwaita-dark")));
+    QVERIFY(QFile::remove(settingsPath));
+    QVERIFY(QFile::rename(replacementPath, settingsPath));
+    QTRY_COMPARE_WITH_TIMEOUT(spy.count(), 2, 5000);
+    QCOMPARE(themeManager.effectiveTheme(), ThemeManager::ThemeMode::Dark);
+#endif
+}
+
+void TestThemeManager::testSystemModeStartsWithLastDetectedTheme()
+{
+#ifndef Q_OS_LINUX
+    QSKIP("Only Linux falls back to the gsettings helper");
+#else
+#if QT_VERSION >= QT_VERSION_CHECK(6, 5, 0)
+    if (QGuiApplication::styleHints()->colorScheme() != Qt::ColorScheme::Unknown) {
+        QSKIP("The platform theme reports the color scheme");
+    }
+#endif
+    if (qEnvironmentVariableIsSet("GTK_THEME")) {
+        QSKIP("GTK_THEME decides the appearance without the helper");
+    }
+
+    // Without a GTK settings file only the helper process can tell
+    QTemporaryDir home;
+    QVERIFY(home.isValid());
+    HomeOverride homeOverride(home.path());
+
+    {
+        QSettings settings;
+        settings.setValue(QStringLiteral("appearance/lastSystemDark"), true);
+    }
+
+    // The remembered appearance applies before the helper reports back
+    StyleManager styleManager;
+    ThemeManager themeManager(&styleManager);
+    QVERIFY(themeManager.isSystemDarkMode());
+    QCOMPARE(themeManager.effectiveTheme(), ThemeManager::ThemeMode::Dark);
+#endif
+}
+
+void TestThemeManager::testThemeSwitchUsesCache()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+
+    QFile darkFile(tempDir.path() + QStringLiteral("/dark.qss"));
+    QVERIFY(darkFile.open(QIODevice::WriteOnly));
+    darkFile.write("QWidget { background-color: #2d2d2d; }");
+    darkFile.close();
+    QFile lightFile(tempDir.path() + QStringLiteral("/light.qss"));
+    QVERIFY(lightFile.open(QIODevice::WriteOnly));
+    lightFile.write("QWidget { background-color: #ffffff; }");
+    lightFile.close();
+
+    StyleManager styleManager;
+    styleManager.setTemplatesPath(tempDir.path());
+    ThemeManager themeManager(&styleManager);
+
+    // Both themes are resolved when the manager is created
+    ThemeCache *cache = themeManager.themeCache();
+    QVERIFY(cache->contains(QStringLiteral("dark")));
+    QVERIFY(cache->contains(QStringLiteral("light")));
+    const int loads = cache->loadCount();
+
+    QSignalSpy spy(&themeManager, &ThemeManager::themeApplied);
+    for (int i = 0; i < 10; ++i) {
+        const ThemeManager::ThemeMode mode = (i % 2 == 0) ? ThemeManager::ThemeMode::Dark
+                                                          : ThemeManager::ThemeMode::Light;
+        themeManager.setThemeMode(mode);
+        QCOMPARE(spy.count(), i + 1);
+        QCOMPARE(spy.last().at(0).value<ThemeManager::ThemeMode>(), mode);
+        QVERIFY(spy.last().at(1).toDouble() >= 0.0);
+        QVERIFY(themeManager.lastSwitchDurationMs() >= 0.0);
+    }
+
+    // Switching did not touch the disk
+    QCOMPARE(cache->loadCount(), loads);
+    QCOMPARE(styleManager.currentStyleSheet(), QStringLiteral("QWidget { background-color: #ffffff; }"));
+}
+
+void TestThemeManager::testThemeResolvesProjectTemplates()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+
+    VariableManager variables;
+    variables.setVariable(QStringLiteral("background"), QStringLiteral("#1e1e1e"));
+    QVERIFY(variables.saveProject(tempDir.path() + QStringLiteral("/dark.qvp"),
+                                  QStringLiteral("QWidget { background-color: ${background}; }")));
+
+    StyleManager styleManager;
+    styleManager.setTemplatesPath(tempDir.path());
+    ThemeManager themeManager(&styleManager);
+    themeManager.setThemeMode(ThemeManager::ThemeMode::Light);
+    themeManager.setThemeMode(ThemeManager::ThemeMode::Dark);
+
+    QCOMPARE(styleManager.currentStyleSheet(),
+             QStringLiteral("QWidget { background-color: #1e1e1e; }"));
+}
+
 /**
  * Feature: ui-theme-preference, Property 1: Theme Mode Persistence Round-Trip
  * 
@@ -18,6 +18,10 @@ private slots:
     void testDefaultModeIsSystem();
     void testSetThemeModeEmitsSignal();
     void testEffectiveThemeResolvesSystem();
+    void testSystemThemeFollowsSettingsFile();
+    void testSystemModeStartsWithLastDetectedTheme();
+    void testThemeSwitchUsesCache();
+    void testThemeResolvesProjectTemplates();
     
     // Property-based tests
     // Property 1: Theme Mode Persistence Round-Trip
@@ -1,5 +1,6 @@
 #include "test_variablemanager.h"
 #include "VariableManager.h"
+#include "QssRuleSet.h"
 
 #include <QRandomGenerator>
 #include <QSignalSpy>
@@ -9,6 +10,7 @@
 #include <QTextStream>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QRegularExpression>
 
 void TestVariableManager::initTestCase()
 {
@@ -1297,3 +1299,500 @@ void TestVariableManager::testVariableReferenceFormattingProperty()
              qPrintable(QString("Extracted name mismatch. Expected: '%1', Got: '%2'")
                        .arg(variableName, extractedName)));
 }
+
+// =============================================================================
+// Property 12: Compiled Substitution Equivalence
+// Feature: qss-variables, Property 12: Compiled Substitution Equivalence
+// =============================================================================
+
+void TestVariableManager::testCompiledSubstitutionEquivalenceProperty_data()
+{
+    QTest::addColumn<QString>("qssTemplate");
+    QTest::addColumn<StringMap>("variables");
+
+    QRandomGenerator *rng = QRandomGenerator::global();
+
+    // Fragments chosen to exercise reference boundaries
+    const QStringList fragments = {
+        "${a}", "${b}", "${undefined}", "${_x-1}", "${", "$", "{", "}",
+        "${1a}", "${a", "${}", "$${a}", "${${a}}", "${a}}", "${ a}",
+        "QWidget { color: ", "; }\n", "/* ${b} */", "\"${a}\"", " ", "é"
+    };
+
+    for (int i = 0; i < 100; ++i) {
+        StringMap variables;
+        variables["a"] = rng->bounded(2) == 0 ? QString("#FF0000") : QString();
+        variables["b"] = "${a}";
+        variables["_x-1"] = "10px";
+
+        QString qssTemplate;
+        const int count = rng->bounded(0, 40);
+        for (int j = 0; j < count; ++j) {
+            qssTemplate += fragments[rng->bounded(fragments.size())];
+        }
+
+        QTest::newRow(qPrintable(QString("compiled_%1").arg(i))) << qssTemplate << variables;
+    }
+
+    StringMap single;
+    single["a"] = "x";
+    QTest::newRow("empty") << QString() << single;
+    QTest::newRow("only_reference") << QString("${a}") << single;
+    QTest::newRow("adjacent_references") << QString("${a}${a}${a}") << single;
+    QTest::newRow("trailing_dollar") << QString("${a}$") << single;
+    QTest::newRow("unterminated") << QString("color: ${a") << single;
+}
+
+void TestVariableManager::testCompiledSubstitutionEquivalenceProperty()
+{
+    // Feature: qss-variables, Property 12: Compiled Substitution Equivalence
+
+    QFETCH(QString, qssTemplate);
+    QFETCH(StringMap, variables);
+
+    VariableManager manager;
+    for (auto it = variables.constBegin(); it != variables.constEnd(); ++it) {
+        manager.setVariable(it.key(), it.value());
+    }
+
+    // Reference implementation: replace regex matches from the end
+    static const QRegularExpression varPattern(
+        QStringLiteral("\\$\\{([a-zA-Z_][a-zA-Z0-9_-]*)\\}")
+    );
+    QList<QRegularExpressionMatch> matches;
+    QRegularExpressionMatchIterator it = varPattern.globalMatch(qssTemplate);
+    while (it.hasNext()) {
+        matches.append(it.next());
+    }
+    QString expected = qssTemplate;
+    QStringList expectedReferences;
+    for (int i = matches.size() - 1; i >= 0; --i) {
+        const QString name = matches[i].captured(1);
+        if (variables.contains(name)) {
+            expected.replace(matches[i].capturedStart(), matches[i].capturedLength(),
+                             variables.value(name));
+        }
+    }
+    for (const QRegularExpressionMatch &match : qAsConst(matches)) {
+        if (!expectedReferences.contains(match.captured(1))) {
+            expectedReferences.append(match.captured(1));
+        }
+    }
+
+    QCOMPARE(manager.substitute(qssTemplate), expected);
+    QCOMPARE(manager.findVariableReferences(qssTemplate), expectedReferences);
+
+    // A second pass over the cached tokens must give the same result
+    QCOMPARE(manager.substitute(qssTemplate), expected);
+}
+
+void TestVariableManager::testTemplateCompiledOnce()
+{
+    VariableManager manager;
+    manager.setVariable("accent", "#FF0000");
+
+    const QString qssTemplate = "QPushButton { color: ${accent}; border: 1px solid ${accent}; }";
+    QCOMPARE(manager.substitute(qssTemplate),
+             QString("QPushButton { color: #FF0000; border: 1px solid #FF0000; }"));
+    const int compiles = manager.templateCompileCount();
+
+    // Variable edits re-join the cached segments
+    manager.setVariable("accent", "#00FF00");
+    QCOMPARE(manager.substitute(qssTemplate),
+             QString("QPushButton { color: #00FF00; border: 1px solid #00FF00; }"));
+    manager.removeVariable("accent");
+    QCOMPARE(manager.substitute(qssTemplate), qssTemplate);
+    QCOMPARE(manager.templateCompileCount(), compiles);
+
+    // A different template is tokenized again
+    manager.setVariable("accent", "#0000FF");
+    QCOMPARE(manager.substitute("QLabel { color: ${accent}; }"),
+             QString("QLabel { color: #0000FF; }"));
+    QCOMPARE(manager.templateCompileCount(), compiles + 1);
+}
+
+void TestVariableManager::testReferenceIndex()
+{
+    VariableManager manager;
+    manager.setVariable("accent", "#FF0000");
+    manager.setVariable("bg", "#000000");
+
+    const QString qssTemplate =
+        "QPushButton { color: ${accent}; }\n"            // rule 0
+        "/* ${accent} { } */\n"                           // comment
+        "QLabel[text=\"}\"] { background: ${bg}; }\n"     // rule 1
+        "QLineEdit { border: 1px solid ${accent}; }\n";   // rule 2
+
+    manager.substitute(qssTemplate);
+
+    QVector<int> offsets = manager.referenceOffsets("accent");
+    QCOMPARE(offsets.size(), 3);
+    for (int offset : offsets) {
+        QCOMPARE(qssTemplate.mid(offset, 9), QString("${accent}"));
+    }
+    QCOMPARE(manager.rulesReferencing("accent"), QVector<int>({0, 2}));
+    QCOMPARE(manager.rulesReferencing("bg"), QVector<int>({1}));
+    QVERIFY(manager.rulesReferencing("missing").isEmpty());
+
+    // A new template is tokenized, so its changes are unknown
+    QVector<int> rules;
+    QVERIFY(!manager.lastChangedRules(&rules));
+
+    // Re-resolving the same template reports the rules an edit touched
+    const QString before = manager.substitute(qssTemplate);
+    QVERIFY(manager.lastChangedRules(&rules));
+    QVERIFY(rules.isEmpty());
+
+    manager.setVariable("bg", "#FFFFFF");
+    const QString after = manager.substitute(qssTemplate);
+    QString previous;
+    QVERIFY(manager.lastChangedRules(&rules, &previous));
+    QCOMPARE(rules, QVector<int>({1}));
+    QCOMPARE(previous, before);
+    QVERIFY(after.contains("#FFFFFF"));
+}
+
+// =============================================================================
+// Property 13: Changed Rule Reporting
+// Feature: qss-variables, Property 13: Changed Rule Reporting
+// =============================================================================
+
+void TestVariableManager::testChangedRuleReportingProperty_data()
+{
+    QTest::addColumn<QString>("qssTemplate");
+    QTest::addColumn<StringMap>("before");
+    QTest::addColumn<StringMap>("after");
+
+    QRandomGenerator *rng = QRandomGenerator::global();
+    const QStringList names = {"a", "b", "c", "d"};
+    const QStringList types = {"QPushButton", "QLabel", "QLineEdit", "QCheckBox"};
+
+    auto randomColor = [rng]() {
+        return QString("#%1").arg(rng->bounded(0x1000000), 6, 16, QLatin1Char('0'));
+    };
+
+    for (int i = 0; i < 100; ++i) {
+        QString qssTemplate;
+        const int ruleCount = rng->bounded(1, 8);
+        for (int r = 0; r < ruleCount; ++r) {
+            qssTemplate += QString("%1#r%2 {").arg(types[rng->bounded(types.size())]).arg(r);
+            const int declarationCount = rng->bounded(0, 4);
+            for (int d = 0; d < declarationCount; ++d) {
+                qssTemplate += QString(" p%1: ${%2};").arg(d).arg(names[rng->bounded(names.size())]);
+            }
+            qssTemplate += " }\n";
+            if (rng->bounded(3) == 0) {
+                qssTemplate += QString("/* ${%1} */\n").arg(names[rng->bounded(names.size())]);
+            }
+        }
+
+        StringMap before;
+        for (const QString &name : names) {
+            before[name] = randomColor();
+        }
+        StringMap after = before;
+        for (const QString &name : names) {
+            if (rng->bounded(3) == 0) {
+                after[name] = randomColor();
+            }
+        }
+
+        QTest::newRow(qPrintable(QString("changed_rules_%1").arg(i)))
+            << qssTemplate << before << after;
+    }
+}
+
+void TestVariableManager::testChangedRuleReportingProperty()
+{
+    // Feature: qss-variables, Property 13: Changed Rule Reporting
+
+    QFETCH(QString, qssTemplate);
+    QFETCH(StringMap, before);
+    QFETCH(StringMap, after);
+
+    VariableManager manager;
+    for (auto it = before.constBegin(); it != before.constEnd(); ++it) {
+        manager.setVariable(it.key(), it.value());
+    }
+    const QString previous = manager.substitute(qssTemplate);
+
+    for (auto it = after.constBegin(); it != after.constEnd(); ++it) {
+        manager.setVariable(it.key(), it.value());
+    }
+    const QString current = manager.substitute(qssTemplate);
+
+    QVector<int> reported;
+    QString reportedPrevious;
+    QVERIFY(manager.lastChangedRules(&reported, &reportedPrevious));
+    QCOMPARE(reportedPrevious, previous);
+
+    const QssRuleSet previousRules = QssRuleSet::parse(previous);
+    const QssRuleSet currentRules = QssRuleSet::parse(current);
+    QCOMPARE(previousRules.rules().size(), currentRules.rules().size());
+
+    QVector<int> expected;
+    for (int i = 0; i < currentRules.rules().size(); ++i) {
+        const QssRule &oldRule = previousRules.rules().at(i);
+        const QssRule &newRule = currentRules.rules().at(i);
+        if (oldRule.selectorText != newRule.selectorText
+            || oldRule.declarations != newRule.declarations) {
+            expected.append(i);
+        }
+    }
+
+    // A variable changed to a new value always changes its rules' text,
+    // so the report is exact rather than a superset
+    QCOMPARE(reported, expected);
+}
+
+void TestVariableManager::testNestedVariableResolution()
+{
+    VariableManager manager;
+    manager.setVariable("accent", "#3366FF");
+    manager.setVariable("button_bg", "${accent}");
+    manager.setVariable("button_border", "1px solid ${button_bg}");
+    manager.setVariable("missing_ref", "${nowhere}");
+
+    QCOMPARE(manager.variable("button_bg"), QString("${accent}"));
+    QCOMPARE(manager.resolvedValue("button_bg"), QString("#3366FF"));
+    QCOMPARE(manager.resolvedValue("button_border"), QString("1px solid #3366FF"));
+    QCOMPARE(manager.resolvedValue("missing_ref"), QString("${nowhere}"));
+    QCOMPARE(manager.resolveValue("${button_bg} ${nowhere}"), QString("#3366FF ${nowhere}"));
+
+    const QString qssTemplate = "QPushButton { background: ${button_bg}; border: ${button_border}; }";
+    QCOMPARE(manager.substitute(qssTemplate),
+             QString("QPushButton { background: #3366FF; border: 1px solid #3366FF; }"));
+
+    // Changing the base color reaches every dependent, and the rule that
+    // only references dependents is reported as changed
+    manager.setVariable("accent", "#FF0000");
+    QCOMPARE(manager.substitute(qssTemplate),
+             QString("QPushButton { background: #FF0000; border: 1px solid #FF0000; }"));
+    QVector<int> rules;
+    QVERIFY(manager.lastChangedRules(&rules));
+    QCOMPARE(rules, QVector<int>({0}));
+
+    QCOMPARE(manager.dependencies("button_border"), QStringList({"button_bg"}));
+    QStringList dependents = manager.dependents("accent");
+    dependents.sort();
+    QCOMPARE(dependents, QStringList({"button_bg", "button_border"}));
+}
+
+void TestVariableManager::testNestedInvalidationIsTransitiveOnly()
+{
+    VariableManager manager;
+    manager.setVariable("base", "#000000");
+    manager.setVariable("derived", "${base}");
+    manager.setVariable("derived2", "${derived}");
+    for (int i = 0; i < 20; ++i) {
+        manager.setVariable(QString("other%1").arg(i), QString("${unrelated}"));
+    }
+    manager.setVariable("unrelated", "#FFFFFF");
+
+    for (const QString &name : manager.variableNames()) {
+        manager.resolvedValue(name);
+    }
+    const int resolved = manager.valueResolveCount();
+
+    // Memoized values are reused
+    for (const QString &name : manager.variableNames()) {
+        manager.resolvedValue(name);
+    }
+    QCOMPARE(manager.valueResolveCount(), resolved);
+
+    // Only the edited variable and its two dependents are recomputed
+    manager.setVariable("base", "#111111");
+    for (const QString &name : manager.variableNames()) {
+        manager.resolvedValue(name);
+    }
+    QCOMPARE(manager.valueResolveCount(), resolved + 3);
+    QCOMPARE(manager.resolvedValue("derived2"), QString("#111111"));
+}
+
+void TestVariableManager::testCycleDetection()
+{
+    VariableManager manager;
+    QSignalSpy cycleSpy(&manager, &VariableManager::cycleDetected);
+
+    manager.setVariable("a", "${b}");
+    manager.setVariable("b", "1px ${c}");
+    QCOMPARE(cycleSpy.count(), 0);
+
+    manager.setVariable("c", "${a}");
+    QCOMPARE(cycleSpy.count(), 1);
+    QCOMPARE(cycleSpy.first().first().toStringList(), QStringList({"c", "a", "b", "c"}));
+    QCOMPARE(manager.findCycle("a"), QStringList({"a", "b", "c", "a"}));
+
+    // Variables on the cycle keep their references; dependents still resolve
+    manager.setVariable("user", "border: ${a}");
+    QCOMPARE(manager.resolvedValue("a"), QString("${b}"));
+    QCOMPARE(manager.resolvedValue("user"), QString("border: ${b}"));
+
+    QStringList blocked;
+    const QStringList order = manager.resolutionOrder(&blocked);
+    blocked.sort();
+    QCOMPARE(blocked, QStringList({"a", "b", "c", "user"}));
+    QVERIFY(order.isEmpty());
+
+    // Breaking the cycle resolves everything
+    manager.setVariable("c", "#123456");
+    QVERIFY(manager.findCycle("a").isEmpty());
+    QCOMPARE(manager.resolvedValue("user"), QString("border: 1px #123456"));
+}
+
+void TestVariableManager::testLoadProjectWithCycle()
+{
+    QTemporaryFile file;
+    file.setFileTemplate(QDir::tempPath() + "/cycle_XXXXXX.qvp");
+    QVERIFY(file.open());
+    file.close();
+
+    // A cycle accepted while editing is saved as is
+    VariableManager saved;
+    saved.setVariable("accent", "${button_bg}");
+    saved.setVariable("button_bg", "${accent}");
+    saved.setVariable("self", "${self}");
+    saved.setVariable("border", "1px solid ${accent}");
+    saved.setVariable("plain", "#FFFFFF");
+    QVERIFY(saved.saveProject(file.fileName(), "QWidget { color: ${accent}; }"));
+
+    VariableManager manager;
+    manager.setVariable("kept", "#000000");
+    QSignalSpy errorSpy(&manager, &VariableManager::loadError);
+    QSignalSpy warningSpy(&manager, &VariableManager::loadWarning);
+    QSignalSpy loadedSpy(&manager, &VariableManager::projectLoaded);
+
+    // ...and loads back, with all cycles reported in one warning
+    QString qssTemplate;
+    QVERIFY(manager.loadProject(file.fileName(), qssTemplate));
+    QCOMPARE(loadedSpy.count(), 1);
+    QCOMPARE(errorSpy.count(), 0);
+    QCOMPARE(warningSpy.count(), 1);
+    const QString warning = warningSpy.first().first().toString();
+    QVERIFY(warning.contains("accent"));
+    QVERIFY(warning.contains("self -> self"));
+    QCOMPARE(qssTemplate, QString("QWidget { color: ${accent}; }"));
+
+    // Variables on the cycle stay unresolved, the rest resolve
+    QCOMPARE(manager.variableNames(), saved.variableNames());
+    QCOMPARE(manager.resolvedValue("accent"), QString("${button_bg}"));
+    QCOMPARE(manager.resolvedValue("border"), QString("1px solid ${button_bg}"));
+    QCOMPARE(manager.resolvedValue("plain"), QString("#FFFFFF"));
+}
+
+void TestVariableManager::testCycleCheckMemoized()
+{
+    VariableManager manager;
+    manager.setVariable("a", "${b}");
+    manager.setVariable("b", "${a}");
+    manager.setVariable("self", "${self}");
+    for (int i = 0; i < 20; ++i) {
+        manager.setVariable(QString("chain%1").arg(i),
+                            i == 0 ? QString("${a}") : QString("${chain%1}").arg(i - 1));
+    }
+
+    // Self-references and multi-variable cycles are both found
+    QCOMPARE(manager.resolvedValue("self"), QString("${self}"));
+    QCOMPARE(manager.resolvedValue("chain19"), QString("${b}"));
+
+    // Cached values survive repeated lookups without new resolves
+    const int resolved = manager.valueResolveCount();
+    for (const QString &name : manager.variableNames()) {
+        manager.resolvedValue(name);
+    }
+    QCOMPARE(manager.valueResolveCount(), resolved + 1);
+
+    // Editing the graph refreshes the cycle check
+    manager.setVariable("b", "#222222");
+    QCOMPARE(manager.resolvedValue("chain19"), QString("#222222"));
+    QCOMPARE(manager.resolvedValue("a"), QString("#222222"));
+}
+
+// =============================================================================
+// Property 14: Topological Resolution
+// Feature: qss-variables, Property 14: Topological Resolution
+// =============================================================================
+
+void TestVariableManager::testTopologicalResolutionProperty_data()
+{
+    QTest::addColumn<StringMap>("variables");
+
+    QRandomGenerator *rng = QRandomGenerator::global();
+
+    for (int i = 0; i < 100; ++i) {
+        // Variable k only references variables with a smaller index, so the
+        // graph is acyclic; names are shuffled so order carries no hint
+        const int count = rng->bounded(1, 12);
+        QStringList names;
+        for (int k = 0; k < count; ++k) {
+            names << QString("v%1_%2").arg(rng->bounded(1000)).arg(k);
+        }
+
+        StringMap variables;
+        for (int k = 0; k < count; ++k) {
+            QString value = QString("#%1").arg(rng->bounded(0x1000000), 6, 16, QLatin1Char('0'));
+            const int references = k == 0 ? 0 : rng->bounded(0, 3);
+            for (int r = 0; r < references; ++r) {
+                value += QString(" ${%1}").arg(names[rng->bounded(k)]);
+            }
+            if (rng->bounded(5) == 0) {
+                value += " ${undefined_name}";
+            }
+            variables[names[k]] = value;
+        }
+
+        QTest::newRow(qPrintable(QString("topological_%1").arg(i))) << variables;
+    }
+}
+
+void TestVariableManager::testTopologicalResolutionProperty()
+{
+    // Feature: qss-variables, Property 14: Topological Resolution
+
+    QFETCH(StringMap, variables);
+
+    VariableManager manager;
+    for (auto it = variables.constBegin(); it != variables.constEnd(); ++it) {
+        manager.setVariable(it.key(), it.value());
+    }
+
+    QStringList blocked;
+    const QStringList order = manager.resolutionOrder(&blocked);
+    QVERIFY(blocked.isEmpty());
+    QCOMPARE(order.size(), variables.size());
+    for (const QString &name : order) {
+        for (const QString &dependency : manager.dependencies(name)) {
+            if (variables.contains(dependency)) {
+                QVERIFY2(order.indexOf(dependency) < order.indexOf(name),
+                         qPrintable(QString("%1 ordered before its dependency %2")
+                                   .arg(name, dependency)));
+            }
+        }
+    }
+
+    // Reference expansion by repeated substitution until nothing changes
+    static const QRegularExpression varPattern(
+        QStringLiteral("\\$\\{([a-zA-Z_][a-zA-Z0-9_-]*)\\}")
+    );
+    for (auto it = variables.constBegin(); it != variables.constEnd(); ++it) {
+        QString expected = it.value();
+        for (;;) {
+            QString next;
+            int pos = 0;
+            QRegularExpressionMatchIterator matches = varPattern.globalMatch(expected);
+            while (matches.hasNext()) {
+                const QRegularExpressionMatch match = matches.next();
+                next += expected.mid(pos, match.capturedStart() - pos);
+                next += variables.contains(match.captured(1))
+                    ? variables.value(match.captured(1)) : match.captured(0);
+                pos = match.capturedEnd();
+            }
+            next += expected.mid(pos);
+            if (next == expected) {
+                break;
+            }
+            expected = next;
+        }
+        QCOMPARE(manager.resolvedValue(it.key()), expected);
+    }
+}
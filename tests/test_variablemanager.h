@@ -75,6 +75,41 @@ private slots:
     // variable reference pattern.
     void testVariableReferenceFormattingProperty();
     void testVariableReferenceFormattingProperty_data();
+
+    // Property 12: Compiled Substitution Equivalence
+    // For any template, including malformed and adjacent references, the
+    // tokenized substitute SHALL produce the same output as replacing each
+    // regex match of ${name} with its defined value.
+    void testCompiledSubstitutionEquivalenceProperty();
+    void testCompiledSubstitutionEquivalenceProperty_data();
+
+    // Template cache: a template is tokenized once and re-joined on
+    // variable edits; a changed template is tokenized again
+    void testTemplateCompiledOnce();
+
+    // Reverse index: reference offsets and rules per variable
+    void testReferenceIndex();
+
+    // Property 13: Changed Rule Reporting
+    // For any template and any edit of defined variables, the rules reported
+    // by lastChangedRules SHALL be exactly the rules of the resolved document
+    // whose selector or declarations differ from the previous result.
+    void testChangedRuleReportingProperty();
+    void testChangedRuleReportingProperty_data();
+
+    // Nested variables
+    void testNestedVariableResolution();
+    void testNestedInvalidationIsTransitiveOnly();
+    void testCycleDetection();
+    void testLoadProjectWithCycle();
+    void testCycleCheckMemoized();
+
+    // Property 14: Topological Resolution
+    // For any acyclic set of variables referencing each other, resolutionOrder
+    // SHALL list every variable after the variables it references, and
+    // resolvedValue SHALL equal the recursive expansion of its value.
+    void testTopologicalResolutionProperty();
+    void testTopologicalResolutionProperty_data();
 };
 
 #endif // TEST_VARIABLEMANAGER_H
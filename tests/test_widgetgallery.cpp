@@ -8,6 +8,7 @@
 #include "DisplayPage.h"
 #include "MainWindowPage.h"
 #include "AdvancedPage.h"
+#include "GalleryPage.h"
 
 #include <QSignalSpy>
 #include <QRandomGenerator>
@@ -178,6 +179,69 @@ void TestWidgetGallery::testSignalEmission()
     QCOMPARE(readOnlySpy.takeFirst().at(0).toBool(), false);
 }
 
+void TestWidgetGallery::testOnDemandBuildsCurrentPageOnly()
+{
+    WidgetGallery gallery(WidgetGallery::PageCreation::OnDemand);
+    QCOMPARE(gallery.pageCreation(), WidgetGallery::PageCreation::OnDemand);
+
+    // All tabs are there, but only the visible page is built
+    QTabWidget *tabWidget = gallery.findChild<QTabWidget*>();
+    QVERIFY(tabWidget != nullptr);
+    QCOMPARE(tabWidget->count(), 8);
+    QCOMPARE(gallery.pageCount(), 8);
+    QCOMPARE(gallery.createdPageCount(), 1);
+    QVERIFY(qobject_cast<ButtonsPage*>(gallery.page(0)) != nullptr);
+    QVERIFY(gallery.page(5) == nullptr);
+    QVERIFY(gallery.findChild<DisplayPage*>() == nullptr);
+    QVERIFY(gallery.findChild<AdvancedPage*>() == nullptr);
+
+    WidgetGallery eagerGallery;
+    QCOMPARE(eagerGallery.createdPageCount(), 8);
+    QVERIFY(gallery.findChildren<QWidget*>().size() < eagerGallery.findChildren<QWidget*>().size());
+}
+
+void TestWidgetGallery::testOnDemandBuildsPageOnActivation()
+{
+    WidgetGallery gallery(WidgetGallery::PageCreation::OnDemand);
+    QSignalSpy spy(&gallery, &WidgetGallery::pageCreated);
+
+    gallery.setWidgetsEnabled(false);
+    gallery.setInputsReadOnly(true);
+
+    QTabWidget *tabWidget = gallery.findChild<QTabWidget*>();
+    QVERIFY(tabWidget != nullptr);
+    tabWidget->setCurrentIndex(1);
+
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.at(0).at(0).toInt(), 1);
+    InputsPage *inputsPage = gallery.findChild<InputsPage*>();
+    QVERIFY(inputsPage != nullptr);
+    QCOMPARE(gallery.page(1), static_cast<GalleryPage*>(inputsPage));
+
+    // The page starts in the state set before it existed
+    const QList<QLineEdit*> lineEdits = inputsPage->findChildren<QLineEdit*>();
+    QVERIFY(!lineEdits.isEmpty());
+    for (QLineEdit *lineEdit : lineEdits) {
+        QVERIFY(lineEdit->isReadOnly());
+    }
+    const QList<QSpinBox*> spinBoxes = inputsPage->findChildren<QSpinBox*>();
+    QVERIFY(!spinBoxes.isEmpty());
+    for (QSpinBox *spinBox : spinBoxes) {
+        QVERIFY(!spinBox->isEnabled());
+    }
+
+    // Visiting the tab again does not build it twice
+    tabWidget->setCurrentIndex(0);
+    tabWidget->setCurrentIndex(1);
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(gallery.ensurePage(1), static_cast<GalleryPage*>(inputsPage));
+    QVERIFY(gallery.ensurePage(42) == nullptr);
+
+    gallery.createAllPages();
+    QCOMPARE(gallery.createdPageCount(), gallery.pageCount());
+    QVERIFY(gallery.findChild<AdvancedPage*>() != nullptr);
+}
+
 // ============================================================================
 // Property-Based Tests
 // ============================================================================
@@ -188,6 +252,29 @@ void TestWidgetGallery::testSignalEmission()
  * For any widget in the Widget_Gallery, when the enabled toggle is switched,
  * all gallery widgets should have their enabled property match the toggle state.
  */
+void TestWidgetGallery::testStyleTargetsCoverBuiltPages()
+{
+    WidgetGallery gallery(WidgetGallery::PageCreation::OnDemand);
+    QTabWidget *tabWidget = gallery.findChild<QTabWidget*>();
+    QVERIFY(tabWidget != nullptr);
+
+    QList<QWidget*> targets = gallery.styleTargets();
+    QVERIFY(targets.contains(gallery.page(0)));
+    QVERIFY(targets.contains(tabWidget->tabBar()));
+
+    // The targets are disjoint, so no target styles another
+    for (QWidget *target : targets) {
+        for (QWidget *other : targets) {
+            QVERIFY(target == other || !target->isAncestorOf(other));
+        }
+    }
+
+    tabWidget->setCurrentIndex(2);
+    targets = gallery.styleTargets();
+    QVERIFY(targets.contains(gallery.page(2)));
+    QCOMPARE(targets.size(), 4);
+}
+
 void TestWidgetGallery::testWidgetEnabledStateToggle_data()
 {
     QTest::addColumn<bool>("enabledState");
@@ -548,3 +635,90 @@ void TestWidgetGallery::testNewPagesEnabledStatePropagation()
     
     QVERIFY2(checkedCount > 0, "Should have checked at least one widget on new pages");
 }
+
+
+/**
+ * Property 2: On-Demand Pages Match Eager Pages
+ *
+ * For any enabled and read-only toggle states and any order in which tabs are
+ * visited, a page built on demand ends up in the same state as the page of
+ * an eagerly built gallery given the same toggles.
+ */
+void TestWidgetGallery::testOnDemandPagesMatchEager_data()
+{
+    QTest::addColumn<bool>("enabledState");
+    QTest::addColumn<bool>("readOnlyState");
+    QTest::addColumn<QVector<int>>("visitOrder");
+
+    QRandomGenerator *rng = QRandomGenerator::global();
+
+    for (int i = 0; i < 25; ++i) {
+        const bool enabled = rng->generate() % 2 == 0;
+        const bool readOnly = rng->generate() % 2 == 0;
+
+        // Visit a random subset of tabs in random order; the rest are built last
+        QVector<int> visitOrder;
+        const int visits = rng->generate() % 12;
+        for (int v = 0; v < visits; ++v) {
+            visitOrder << int(rng->generate() % 8);
+        }
+
+        QTest::newRow(qPrintable(QString("on_demand_%1").arg(i)))
+            << enabled << readOnly << visitOrder;
+    }
+}
+
+void TestWidgetGallery::testOnDemandPagesMatchEager()
+{
+    // Feature: lazy-gallery, Property 2: On-Demand Pages Match Eager Pages
+
+    QFETCH(bool, enabledState);
+    QFETCH(bool, readOnlyState);
+    QFETCH(QVector<int>, visitOrder);
+
+    WidgetGallery eagerGallery;
+    eagerGallery.setWidgetsEnabled(enabledState);
+    eagerGallery.setInputsReadOnly(readOnlyState);
+
+    WidgetGallery lazyGallery(WidgetGallery::PageCreation::OnDemand);
+    QTabWidget *tabWidget = lazyGallery.findChild<QTabWidget*>();
+    QVERIFY(tabWidget != nullptr);
+
+    // Toggle before and in between visits, ending in the expected state
+    lazyGallery.setWidgetsEnabled(!enabledState);
+    for (int index : qAsConst(visitOrder)) {
+        tabWidget->setCurrentIndex(index);
+        if (index % 3 == 0) {
+            lazyGallery.setInputsReadOnly(!readOnlyState);
+        }
+    }
+    lazyGallery.setWidgetsEnabled(enabledState);
+    lazyGallery.setInputsReadOnly(readOnlyState);
+    lazyGallery.createAllPages();
+
+    QCOMPARE(lazyGallery.pageCount(), eagerGallery.pageCount());
+    for (int index = 0; index < eagerGallery.pageCount(); ++index) {
+        const QList<QWidget*> expected = eagerGallery.page(index)->findChildren<QWidget*>();
+        const QList<QWidget*> actual = lazyGallery.page(index)->findChildren<QWidget*>();
+        QCOMPARE(actual.size(), expected.size());
+
+        for (int i = 0; i < expected.size(); ++i) {
+            QCOMPARE(QString::fromLatin1(actual.at(i)->metaObject()->className()),
+                     QString::fromLatin1(expected.at(i)->metaObject()->className()));
+            QVERIFY2(actual.at(i)->isEnabled() == expected.at(i)->isEnabled(),
+                     qPrintable(QString("Page %1: %2 enabled state differs")
+                               .arg(index).arg(expected.at(i)->metaObject()->className())));
+
+            QLineEdit *expectedEdit = qobject_cast<QLineEdit*>(expected.at(i));
+            if (expectedEdit) {
+                QCOMPARE(qobject_cast<QLineEdit*>(actual.at(i))->isReadOnly(),
+                         expectedEdit->isReadOnly());
+            }
+            QTextEdit *expectedText = qobject_cast<QTextEdit*>(expected.at(i));
+            if (expectedText) {
+                QCOMPARE(qobject_cast<QTextEdit*>(actual.at(i))->isReadOnly(),
+                         expectedText->isReadOnly());
+            }
+        }
+    }
+}
@@ -10,6 +10,7 @@
  * Tests include:
  * - Property 3: Widget Enabled State Toggle
  * - Property 4: Input Read-Only State Toggle
+ * - Property 2: On-Demand Pages Match Eager Pages
  */
 class TestWidgetGallery : public QObject
 {
@@ -24,6 +25,9 @@ private slots:
     void testSetWidgetsEnabled();
     void testSetInputsReadOnly();
     void testSignalEmission();
+    void testOnDemandBuildsCurrentPageOnly();
+    void testOnDemandBuildsPageOnActivation();
+    void testStyleTargetsCoverBuiltPages();
 
     // Property-based tests
     void testWidgetEnabledStateToggle_data();
@@ -35,6 +39,10 @@ private slots:
     // Property 1: Enabled State Propagation for new pages
     void testNewPagesEnabledStatePropagation_data();
     void testNewPagesEnabledStatePropagation();
+
+    // Property 2: On-Demand Pages Match Eager Pages
+    void testOnDemandPagesMatchEager_data();
+    void testOnDemandPagesMatchEager();
 };
 
 #endif // TEST_WIDGETGALLERY_H